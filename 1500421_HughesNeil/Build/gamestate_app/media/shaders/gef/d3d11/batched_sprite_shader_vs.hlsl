@@ -0,0 +1,27 @@
+cbuffer MatrixBuffer
+{
+	matrix proj_matrix;
+};
+
+struct VertexInput
+{
+    float3 position : POSITION;
+    float2 uv : TEXCOORD;
+    float4 colour : COLOR;
+};
+
+struct PixelInput
+{
+    float4 position : SV_POSITION;
+    float4 colour : COLOR;
+    float2 uv : TEXCOORD;
+};
+
+// the sprite corners are transformed when the batch is built
+void VS( in VertexInput input,
+         out PixelInput output )
+{
+    output.position = mul(float4(input.position, 1), proj_matrix);
+    output.colour = input.colour;
+    output.uv = input.uv;
+}
@@ -149,7 +149,7 @@ gef::Mesh* PrimitiveBuilder::CreateBoxMesh(const gef::Vector4& half_size, gef::V
 	for (int primitive_num = 0; primitive_num < num_faces; ++primitive_num)
 	{
 		gef::Primitive* primitive = mesh->GetPrimitive(primitive_num);
-		primitive->InitIndexBuffer(platform_, &indices[primitive_num*6], 6, sizeof(Int32));
+		primitive->InitCompactIndexBuffer(platform_, &indices[primitive_num*6], 6, sizeof(Int32), kNumVertices);
 		primitive->set_type(gef::TRIANGLE_LIST);
 
 		// if materials pointer is valid then assume we have an array of Material pointers
@@ -285,7 +285,7 @@ gef::Mesh* PrimitiveBuilder::CreateSphereMesh(const float radius, const int phi,
 	primitive = mesh->GetPrimitive(0);
 	primitive->set_type(gef::TRIANGLE_LIST);
 	primitive->set_material(material);
-	primitive->InitIndexBuffer(platform_, &index_buffer[0], (UInt32)index_buffer.size(), sizeof(Int32));
+	primitive->InitCompactIndexBuffer(platform_, &index_buffer[0], (UInt32)index_buffer.size(), sizeof(Int32), kNumVertices);
 
 	// top/bottom triangles
 	index_buffer.resize(phi * 3 + phi * 3);
@@ -311,7 +311,7 @@ gef::Mesh* PrimitiveBuilder::CreateSphereMesh(const float radius, const int phi,
 	primitive = mesh->GetPrimitive(1);
 	primitive->set_type(gef::TRIANGLE_LIST);
 	primitive->set_material(material);
-	primitive->InitIndexBuffer(platform_, &index_buffer[0], (UInt32)index_buffer.size(), sizeof(Int32));
+	primitive->InitCompactIndexBuffer(platform_, &index_buffer[0], (UInt32)index_buffer.size(), sizeof(Int32), kNumVertices);
 
 	// bounds
 	gef::Aabb aabb(gef::Vector4(-radius, -radius, -radius) - origin, gef::Vector4(radius, radius, radius)+ origin);
@@ -8,7 +8,6 @@
 #include <maths/math_utils.h>
 #include <input/sony_controller_input_manager.h>
 #include <graphics/sprite.h>
-#include "load_texture.h"
 
 SceneApp::SceneApp(gef::Platform& platform) :
 	Application(platform),
@@ -17,12 +16,14 @@ SceneApp::SceneApp(gef::Platform& platform) :
 	primitive_builder_(NULL),
 	input_manager_(NULL),
 	audio_manager_(NULL),
+	resource_cache_(NULL),
 	font_(NULL),
+	fps_text_(NULL, 1.0f, gef::TJ_LEFT),
+	score_text_(NULL, 1.0f, gef::TJ_CENTRE),
+	difficulty_text_(NULL, 1.0f, gef::TJ_CENTRE),
 	world_(NULL),
 	player_body_(NULL),
-	sfx_id_(-1),
-	sfx_voice_id_(-1),
-	button_icon_(NULL)
+	sfx_voice_id_(-1)
 {
 }
 
@@ -38,6 +39,8 @@ void SceneApp::Init()
 	// initialise audio manager
 	audio_manager_ = gef::AudioManager::Create();
 
+	resource_cache_ = new gef::ResourceCache(platform_);
+	resource_cache_->set_audio_manager(audio_manager_);
 	
 
 	// set the initial state of the game state machine
@@ -47,6 +50,16 @@ void SceneApp::Init()
 
 void SceneApp::CleanUp()
 {
+	// handles have to be released before the cache is deleted
+	button_icon_.Release();
+	Scroller_Bkgrd_.Release();
+	gameOverScreen.Release();
+	sfx_.Release();
+
+	// the cache unloads its samples so goes before the audio manager
+	delete resource_cache_;
+	resource_cache_ = NULL;
+
 	delete audio_manager_;
 	audio_manager_ = NULL;
 
@@ -234,10 +247,18 @@ void SceneApp::InitFont()
 {
 	font_ = new gef::Font(platform_);
 	font_->Load("comic_sans");
+
+	fps_text_.set_font(font_);
+	score_text_.set_font(font_);
+	difficulty_text_.set_font(font_);
 }
 
 void SceneApp::CleanUpFont()
 {
+	fps_text_.set_font(NULL);
+	score_text_.set_font(NULL);
+	difficulty_text_.set_font(NULL);
+
 	delete font_;
 	font_ = NULL;
 }
@@ -246,8 +267,9 @@ void SceneApp::DrawHUD()
 {
 	if(font_)
 	{
-		// display frame rate
-		font_->RenderText(sprite_renderer_, gef::Vector4(850.0f, 510.0f, -0.9f), 1.0f, 0xffffffff, gef::TJ_LEFT, "FPS: %.1f", fps_);
+		// display frame rate, only laid out again when the text changes
+		fps_text_.SetTextf("FPS: %.1f", fps_);
+		fps_text_.Render(sprite_renderer_, gef::Vector4(850.0f, 510.0f, -0.9f), 0xffffffff);
 	}
 }
 
@@ -336,8 +358,8 @@ void SceneApp::UpdateSimulation(float frame_time)
 
 void SceneApp::FrontendInit()
 {
-	button_icon_ = CreateTextureFromPNG("playstation-cross-dark-icon.png", platform_);
-	Scroller_Bkgrd_ = CreateTextureFromPNG("clouds@2x.png", platform_);
+	button_icon_ = resource_cache_->LoadTexture("playstation-cross-dark-icon.png");
+	Scroller_Bkgrd_ = resource_cache_->LoadTexture("clouds@2x.png");
 
 	// initialise the difficulty and score variables
 	difficulty = 1;
@@ -346,8 +368,8 @@ void SceneApp::FrontendInit()
 
 void SceneApp::FrontendRelease()
 {
-	delete button_icon_;
-	button_icon_ = NULL;
+	button_icon_.Release();
+	Scroller_Bkgrd_.Release();
 }
 
 void SceneApp::FrontendUpdate(float frame_time)
@@ -381,12 +403,20 @@ void SceneApp::FrontendRender()
 	
 	// Render wall texture
 	gef::Sprite wall;
-	wall.set_texture(Scroller_Bkgrd_);
+	wall.set_texture(Scroller_Bkgrd_.get());
 	wall.set_position(gef::Vector4(platform_.width()*0.5f, platform_.height()*0.5f, -0.99f));
 	wall.set_height(640.0f);
 	wall.set_width(1136.0f);
 	sprite_renderer_->DrawSprite(wall);
-	
+
+	// Render button icon
+	// drawn before the text, which it doesn't overlap, so all the text shares one batched draw
+	gef::Sprite button;
+	button.set_texture(button_icon_.get());
+	button.set_position(gef::Vector4(platform_.width()*0.5f, platform_.height()*0.5f, -0.99f));
+	button.set_height(32.0f);
+	button.set_width(32.0f);
+	sprite_renderer_->DrawSprite(button);
 
 	// render "PRESS" text
 	font_->RenderText(
@@ -397,14 +427,6 @@ void SceneApp::FrontendRender()
 		gef::TJ_CENTRE,
 		"PRESS");
 
-	// Render button icon
-	gef::Sprite button;
-	button.set_texture(button_icon_);
-	button.set_position(gef::Vector4(platform_.width()*0.5f, platform_.height()*0.5f, -0.99f));
-	button.set_height(32.0f);
-	button.set_width(32.0f);
-	sprite_renderer_->DrawSprite(button);
-
 	// render "TO START" text
 	font_->RenderText(
 		sprite_renderer_,
@@ -440,9 +462,8 @@ void SceneApp::JumperInit()
 	// initialise primitive builder to make create some 3D geometry easier
 	primitive_builder_ = new PrimitiveBuilder(platform_);
 
-	//Scroller_Bkgrd_ = CreateTextureFromPNG("Side_Scroller_Bkgrd.png", platform_);
-	Scroller_Bkgrd_ = CreateTextureFromPNG("clouds@2x.png", platform_);
-	//ground_texture_ = CreateTextureFromPNG("cartoon-stone-texture_1110-576.png", platform_);
+	//Scroller_Bkgrd_ = resource_cache_->LoadTexture("Side_Scroller_Bkgrd.png");
+	Scroller_Bkgrd_ = resource_cache_->LoadTexture("clouds@2x.png");
 	
 	SetupLights();
 
@@ -461,7 +482,7 @@ void SceneApp::JumperInit()
 	if (audio_manager_)
 	{
 		// load a sound effect
-		sfx_id_ = audio_manager_->LoadSample("box_collected.wav", platform_);
+		sfx_ = resource_cache_->LoadSample("box_collected.wav");
 
 		// load in music
 		audio_manager_->LoadMusic("music.wav", platform_);
@@ -477,8 +498,7 @@ void SceneApp::JumperRelease()
 	if (audio_manager_)
 	{
 		audio_manager_->StopMusic();
-		audio_manager_->UnloadAllSamples();
-		sfx_id_ = -1;
+		sfx_.Release();
 		sfx_voice_id_ = -1;
 	}
 
@@ -495,8 +515,7 @@ void SceneApp::JumperRelease()
 	delete renderer_3d_;
 	renderer_3d_ = NULL;
 
-	delete Scroller_Bkgrd_;
-	Scroller_Bkgrd_ = NULL;
+	Scroller_Bkgrd_.Release();
 
 	delete timer_;
 	timer_ = NULL;
@@ -526,9 +545,9 @@ void SceneApp::JumperUpdate(float frame_time)
 	// trigger a sound effect
 	if (audio_manager_)
 	{
-		if (controller->buttons_pressed() & gef_SONY_CTRL_CROSS)
+		if (sfx_.valid() && (controller->buttons_pressed() & gef_SONY_CTRL_CROSS))
 		{
-			sfx_voice_id_ = audio_manager_->PlaySample(sfx_id_, true);
+			sfx_voice_id_ = audio_manager_->PlaySample(*sfx_, true);
 
 			gef::VolumeInfo volume_info;
 			volume_info.volume = 0.5f;
@@ -647,7 +666,7 @@ void SceneApp::JumperRender()
 
 	// Render wall texture
 	gef::Sprite wall;
-	wall.set_texture(Scroller_Bkgrd_);
+	wall.set_texture(Scroller_Bkgrd_.get());
 	wall.set_position(gef::Vector4(platform_.width()*0.5f, platform_.height()*0.5f, -0.99f));
 	wall.set_height(640.0f);
 	wall.set_width(1136.0f);
@@ -655,22 +674,18 @@ void SceneApp::JumperRender()
 	
 
 	// render "Score" text
-	font_->RenderText(
+	score_text_.SetTextf("SCORE: %i", score);
+	score_text_.Render(
 		sprite_renderer_,
 		gef::Vector4(platform_.width()*0.75f, platform_.height()*0.15f, -0.99f),
-		1.0f,
-		0xff595959,
-		gef::TJ_CENTRE,
-		"SCORE: %i", score);
+		0xff595959);
 
 	// render "Difficulty" text
-	font_->RenderText(
+	difficulty_text_.SetTextf("DIFFICULTY: %i", (int)difficulty);
+	difficulty_text_.Render(
 		sprite_renderer_,
 		gef::Vector4(platform_.width()*0.25f, platform_.height()*0.15f, -0.99f),
-		1.0f,
-		0xff595959,
-		gef::TJ_CENTRE,
-		"DIFFICULTY: %i", (int)difficulty);
+		0xff595959);
 	sprite_renderer_->End();
 
 	// Setup camera
@@ -728,13 +743,12 @@ void SceneApp::JumperRender()
 
 void SceneApp::GameOverInit()
 {
-	gameOverScreen = CreateTextureFromPNG("CloudGameOver.png", platform_);
+	gameOverScreen = resource_cache_->LoadTexture("CloudGameOver.png");
 }
 
 void SceneApp::GameOverRelease()
 {
-	delete gameOverScreen;
-	gameOverScreen = NULL;
+	gameOverScreen.Release();
 }
 
 void SceneApp::GameOverUpdate(float frame_time)
@@ -758,7 +772,7 @@ void SceneApp::GameOverRender()
 
 	// Render wall texture
 	gef::Sprite gameOverBkgrd;
-	gameOverBkgrd.set_texture(gameOverScreen);
+	gameOverBkgrd.set_texture(gameOverScreen.get());
 	gameOverBkgrd.set_position(gef::Vector4(platform_.width()*0.5f, platform_.height()*0.5f, -0.99f));
 	gameOverBkgrd.set_height(640.0f);
 	gameOverBkgrd.set_width(1136.0f);
@@ -7,6 +7,8 @@
 #include <graphics/mesh_instance.h>
 #include <audio/audio_manager.h>
 #include <input/input_manager.h>
+#include <assets/resource_cache.h>
+#include <graphics/text_layout.h>
 #include <box2d/Box2D.h>
 #include "game_object.h"
 #include <vector>
@@ -51,9 +53,18 @@ private:
     
 	gef::SpriteRenderer* sprite_renderer_;
 	gef::Font* font_;
+
+	// hud strings that only change when their values do
+	gef::TextLayout fps_text_;
+	gef::TextLayout score_text_;
+	gef::TextLayout difficulty_text_;
+
 	gef::InputManager* input_manager_;
 	gef::AudioManager* audio_manager_;
 
+	// textures and samples are shared between states and only decoded once
+	gef::ResourceCache* resource_cache_;
+
 	//
 	// GAME STATE VARIABLES
 	//
@@ -62,19 +73,18 @@ private:
 	//
 	// FRONTEND DECLARATIONS
 	//
-	gef::Texture* button_icon_;
+	gef::TextureHandle button_icon_;
 
 	//
 	// GAMEOVER DECLARATIONS
 	//
-	gef::Texture* gameOverScreen;
+	gef::TextureHandle gameOverScreen;
 
 	//
 	// JUMPER DECLARATIONS
 	//
 
-	gef::Texture* Scroller_Bkgrd_;
-	gef::Texture* ground_texture_;
+	gef::TextureHandle Scroller_Bkgrd_;
 
 	gef::Renderer3D* renderer_3d_;
 	PrimitiveBuilder* primitive_builder_;
@@ -100,7 +110,7 @@ private:
 	b2Body* ground_body_;
 
 	// audio variables
-	int sfx_id_;
+	gef::SampleHandle sfx_;
 	int sfx_voice_id_;
 
 	// difficulty variable
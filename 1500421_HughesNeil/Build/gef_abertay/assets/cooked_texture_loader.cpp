@@ -0,0 +1,129 @@
+#include <assets/cooked_texture_loader.h>
+#include <graphics/image_data.h>
+#include <system/file.h>
+#include <ostream>
+#include <cstdlib>
+#include <cstring>
+
+namespace gef
+{
+	static bool ReadHeader(File* file, CookedTextureHeader& header)
+	{
+		Int32 bytes_read = 0;
+		bool success = file->Read(&header, sizeof(header), bytes_read) && (bytes_read == sizeof(header));
+
+		if(success)
+			success = (header.file_id == kCookedTextureFileId) && (header.version == kCookedTextureFileVersion) && (header.format < IF_NUM_FORMATS) && (header.num_mips > 0);
+
+		if(success)
+		{
+			ImageData texture_data;
+			texture_data.set_width(header.width);
+			texture_data.set_height(header.height);
+			texture_data.set_format((ImageFormat)header.format);
+			texture_data.set_num_mips(header.num_mips);
+			success = (texture_data.GetDataSize() == header.data_size) && (header.num_mips <= ImageData::CalculateMaxMips(header.width, header.height));
+		}
+
+		return success;
+	}
+
+	bool CookedTextureLoader::Load(const char* filename, const Platform& platform, ImageData& image_data, const UInt32 first_mip)
+	{
+		File* file = File::Create();
+		bool success = file->Open(filename);
+		if(success)
+		{
+			CookedTextureHeader header;
+			success = ReadHeader(file, header) && (first_mip < header.num_mips);
+
+			// the mips are stored largest first so the ones wanted are all at the end of the data
+			ImageData texture_data;
+			UInt32 mips_offset = 0;
+			if(success)
+			{
+				texture_data.set_width(header.width);
+				texture_data.set_height(header.height);
+				texture_data.set_format((ImageFormat)header.format);
+				texture_data.set_num_mips(header.num_mips);
+				mips_offset = texture_data.GetMipOffset(first_mip);
+			}
+			const UInt32 mips_size = header.data_size - mips_offset;
+
+			if(success)
+				success = file->Seek(SF_Start, (Int32)(header.data_offset + mips_offset));
+
+			UInt8* data = NULL;
+			if(success)
+			{
+				data = static_cast<UInt8*>(malloc(mips_size));
+				success = data != NULL;
+			}
+
+			Int32 bytes_read = 0;
+			if(success)
+				success = file->Read(data, (Int32)mips_size, bytes_read) && (bytes_read == (Int32)mips_size);
+
+			if(success)
+			{
+				image_data.set_image(data);
+				image_data.set_width(texture_data.GetMipWidth(first_mip));
+				image_data.set_height(texture_data.GetMipHeight(first_mip));
+				image_data.set_format((ImageFormat)header.format);
+				image_data.set_num_mips(header.num_mips - first_mip);
+			}
+			else
+				free(data);
+
+			file->Close();
+		}
+		delete file;
+
+		return success;
+	}
+
+	bool CookedTextureLoader::LoadHeader(const char* filename, CookedTextureHeader& header)
+	{
+		File* file = File::Create();
+		bool success = file->Open(filename);
+		if(success)
+		{
+			success = ReadHeader(file, header);
+			file->Close();
+		}
+		delete file;
+
+		return success;
+	}
+
+	bool WriteCookedTexture(std::ostream& stream, const ImageData& image_data)
+	{
+		if((image_data.image() == NULL) || (image_data.num_mips() == 0))
+			return false;
+
+		CookedTextureHeader header;
+		header.file_id = kCookedTextureFileId;
+		header.version = kCookedTextureFileVersion;
+		header.format = (UInt32)image_data.format();
+		header.width = image_data.width();
+		header.height = image_data.height();
+		header.num_mips = image_data.num_mips();
+		header.data_offset = (sizeof(header) + kCookedTextureDataAlignment - 1) & ~(kCookedTextureDataAlignment - 1);
+		header.data_size = image_data.GetDataSize();
+
+		char padding[kCookedTextureDataAlignment];
+		memset(padding, 0, sizeof(padding));
+
+		stream.write((char*)&header, sizeof(header));
+		stream.write(padding, header.data_offset - sizeof(header));
+		stream.write((char*)image_data.image(), header.data_size);
+
+		return stream.good();
+	}
+
+	bool IsCookedTextureFilename(const char* filename)
+	{
+		const size_t length = strlen(filename);
+		return (length >= 4) && (strcmp(filename + length - 4, ".tex") == 0);
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef _GEF_COOKED_TEXTURE_LOADER_H
+#define _GEF_COOKED_TEXTURE_LOADER_H
+
+#include <gef.h>
+#include <iosfwd>
+
+namespace gef
+{
+	class Platform;
+	class ImageData;
+
+	const UInt32 kCookedTextureFileId = 0x58455447; // 'GTEX'
+	const Int32 kCookedTextureFileVersion = 1;
+
+	// pixel data starts on this boundary so it can be read straight into memory for upload
+	const UInt32 kCookedTextureDataAlignment = 128;
+
+	// a .tex file is this header followed by the pixel data of every mip level, largest first,
+	// in the layout described by ImageData
+	struct CookedTextureHeader
+	{
+		UInt32 file_id;
+		Int32 version;
+		UInt32 format;
+		UInt32 width;
+		UInt32 height;
+		UInt32 num_mips;
+		UInt32 data_offset;
+		UInt32 data_size;
+	};
+
+	// loads textures written by WriteCookedTexture
+	// the pixel data is read directly into the image, there is nothing to decode
+	class CookedTextureLoader
+	{
+	public:
+		// mips larger than first_mip aren't read, image_data is the size of first_mip
+		bool Load(const char* filename, const Platform& platform, ImageData& image_data, const UInt32 first_mip = 0);
+
+		// reads and checks the header without loading any pixel data
+		bool LoadHeader(const char* filename, CookedTextureHeader& header);
+	};
+
+	bool WriteCookedTexture(std::ostream& stream, const ImageData& image_data);
+
+	// true if filename has the .tex extension of cooked textures
+	bool IsCookedTextureFilename(const char* filename);
+}
+
+#endif // _GEF_COOKED_TEXTURE_LOADER_H
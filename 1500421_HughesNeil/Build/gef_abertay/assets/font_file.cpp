@@ -0,0 +1,242 @@
+#include <assets/font_file.h>
+#include <algorithm>
+#include <cstring>
+
+namespace gef
+{
+	static bool IsSpace(const char c)
+	{
+		return (c == ' ') || (c == '\t') || (c == '\r');
+	}
+
+	static bool KeyIs(const char* key, const size_t key_length, const char* name)
+	{
+		return (strlen(name) == key_length) && (memcmp(key, name, key_length) == 0);
+	}
+
+	// the text isn't null terminated so the end of the value is passed in
+	static Int32 ParseInt(const char* value, const char* value_end)
+	{
+		bool negative = false;
+		if((value < value_end) && ((*value == '-') || (*value == '+')))
+			negative = *value++ == '-';
+
+		Int32 result = 0;
+		while((value < value_end) && (*value >= '0') && (*value <= '9'))
+			result = result*10 + (*value++ - '0');
+
+		return negative ? -result : result;
+	}
+
+	static bool GlyphLess(const FontGlyph& a, const FontGlyph& b)
+	{
+		return a.id < b.id;
+	}
+
+	static bool KerningPairLess(const FontKerningPair& a, const FontKerningPair& b)
+	{
+		return (a.first < b.first) || ((a.first == b.first) && (a.second < b.second));
+	}
+
+	bool CompileFont(const char* text, const Int32 text_size, std::vector<UInt8>& font_data)
+	{
+		FontFileHeader header;
+		memset(&header, 0, sizeof(header));
+		header.file_id = kFontFileId;
+		header.version = kFontFileVersion;
+
+		bool found_common = false;
+		std::vector<FontGlyph> glyphs;
+		std::vector<FontKerningPair> kerning_pairs;
+
+		const char* text_end = text + text_size;
+		const char* line = text;
+		while(line < text_end)
+		{
+			const char* line_end = static_cast<const char*>(memchr(line, '\n', text_end - line));
+			if(line_end == NULL)
+				line_end = text_end;
+
+			// the first word of a line says what it describes
+			const char* tag = line;
+			while((tag < line_end) && IsSpace(*tag))
+				++tag;
+			const char* tag_end = tag;
+			while((tag_end < line_end) && !IsSpace(*tag_end))
+				++tag_end;
+
+			const bool is_common = KeyIs(tag, tag_end - tag, "common");
+			const bool is_char = KeyIs(tag, tag_end - tag, "char");
+			const bool is_kerning = KeyIs(tag, tag_end - tag, "kerning");
+
+			if(is_common || is_char || is_kerning)
+			{
+				FontGlyph glyph;
+				memset(&glyph, 0, sizeof(glyph));
+				FontKerningPair kerning_pair;
+				memset(&kerning_pair, 0, sizeof(kerning_pair));
+
+				// the rest of the line is key=value pairs
+				const char* token = tag_end;
+				while(token < line_end)
+				{
+					while((token < line_end) && IsSpace(*token))
+						++token;
+					const char* key = token;
+					while((token < line_end) && !IsSpace(*token) && (*token != '='))
+						++token;
+					const size_t key_length = token - key;
+					if((token == line_end) || (*token != '='))
+						continue;
+
+					const char* value = ++token;
+					if((token < line_end) && (*token == '"'))
+					{
+						// quoted values can have spaces in them
+						++token;
+						while((token < line_end) && (*token != '"'))
+							++token;
+						if(token < line_end)
+							++token;
+					}
+					else
+					{
+						while((token < line_end) && !IsSpace(*token))
+							++token;
+					}
+
+					const Int32 number = ParseInt(value, token);
+					if(is_common)
+					{
+						if(KeyIs(key, key_length, "lineHeight"))
+							header.line_height = (UInt16)number;
+						else if(KeyIs(key, key_length, "base"))
+							header.base = (UInt16)number;
+						else if(KeyIs(key, key_length, "scaleW"))
+							header.width = (UInt16)number;
+						else if(KeyIs(key, key_length, "scaleH"))
+							header.height = (UInt16)number;
+						else if(KeyIs(key, key_length, "pages"))
+							header.pages = (UInt16)number;
+					}
+					else if(is_char)
+					{
+						if(KeyIs(key, key_length, "id"))
+							glyph.id = (UInt32)number;
+						else if(KeyIs(key, key_length, "x"))
+							glyph.x = (Int16)number;
+						else if(KeyIs(key, key_length, "y"))
+							glyph.y = (Int16)number;
+						else if(KeyIs(key, key_length, "width"))
+							glyph.width = (Int16)number;
+						else if(KeyIs(key, key_length, "height"))
+							glyph.height = (Int16)number;
+						else if(KeyIs(key, key_length, "xoffset"))
+							glyph.x_offset = (Int16)number;
+						else if(KeyIs(key, key_length, "yoffset"))
+							glyph.y_offset = (Int16)number;
+						else if(KeyIs(key, key_length, "xadvance"))
+							glyph.x_advance = (Int16)number;
+						else if(KeyIs(key, key_length, "page"))
+							glyph.page = (UInt8)number;
+					}
+					else
+					{
+						if(KeyIs(key, key_length, "first"))
+							kerning_pair.first = (UInt32)number;
+						else if(KeyIs(key, key_length, "second"))
+							kerning_pair.second = (UInt32)number;
+						else if(KeyIs(key, key_length, "amount"))
+							kerning_pair.amount = number;
+					}
+				}
+
+				if(is_common)
+					found_common = true;
+				else if(is_char)
+					glyphs.push_back(glyph);
+				else if(kerning_pair.amount != 0)
+					kerning_pairs.push_back(kerning_pair);
+			}
+
+			line = line_end + (line_end < text_end ? 1 : 0);
+		}
+
+		if(!found_common)
+			return false;
+
+		// when a character is described more than once the last one is used
+		std::stable_sort(glyphs.begin(), glyphs.end(), GlyphLess);
+		size_t num_glyphs = 0;
+		for(size_t glyph_num = 0; glyph_num < glyphs.size(); ++glyph_num)
+		{
+			if((num_glyphs > 0) && (glyphs[num_glyphs-1].id == glyphs[glyph_num].id))
+				glyphs[num_glyphs-1] = glyphs[glyph_num];
+			else
+				glyphs[num_glyphs++] = glyphs[glyph_num];
+		}
+		glyphs.resize(num_glyphs);
+
+		std::stable_sort(kerning_pairs.begin(), kerning_pairs.end(), KerningPairLess);
+		size_t num_kerning_pairs = 0;
+		for(size_t pair_num = 0; pair_num < kerning_pairs.size(); ++pair_num)
+		{
+			if((num_kerning_pairs > 0) && !KerningPairLess(kerning_pairs[num_kerning_pairs-1], kerning_pairs[pair_num]))
+				kerning_pairs[num_kerning_pairs-1] = kerning_pairs[pair_num];
+			else
+				kerning_pairs[num_kerning_pairs++] = kerning_pairs[pair_num];
+		}
+		kerning_pairs.resize(num_kerning_pairs);
+
+		header.num_glyphs = (UInt32)glyphs.size();
+		header.glyphs_offset = sizeof(FontFileHeader);
+		header.num_kerning_pairs = (UInt32)kerning_pairs.size();
+		header.kerning_pairs_offset = header.glyphs_offset + header.num_glyphs*sizeof(FontGlyph);
+
+		font_data.resize(header.kerning_pairs_offset + header.num_kerning_pairs*sizeof(FontKerningPair));
+		memcpy(&font_data[0], &header, sizeof(header));
+		if(!glyphs.empty())
+			memcpy(&font_data[header.glyphs_offset], &glyphs[0], header.num_glyphs*sizeof(FontGlyph));
+		if(!kerning_pairs.empty())
+			memcpy(&font_data[header.kerning_pairs_offset], &kerning_pairs[0], header.num_kerning_pairs*sizeof(FontKerningPair));
+
+		return true;
+	}
+
+	bool ValidateFontData(const UInt8* font_data, const UInt32 font_data_size)
+	{
+		if((font_data == NULL) || (font_data_size < sizeof(FontFileHeader)))
+			return false;
+
+		const FontFileHeader* header = reinterpret_cast<const FontFileHeader*>(font_data);
+		if((header->file_id != kFontFileId) || (header->version != kFontFileVersion))
+			return false;
+
+		// the tables are used in place so they have to be aligned
+		if(((header->glyphs_offset % 4) != 0) || ((header->kerning_pairs_offset % 4) != 0))
+			return false;
+
+		if((header->glyphs_offset > font_data_size) || (header->num_glyphs > (font_data_size - header->glyphs_offset) / sizeof(FontGlyph)))
+			return false;
+
+		if((header->kerning_pairs_offset > font_data_size) || (header->num_kerning_pairs > (font_data_size - header->kerning_pairs_offset) / sizeof(FontKerningPair)))
+			return false;
+
+		// lookups are binary searches
+		const FontGlyph* glyphs = reinterpret_cast<const FontGlyph*>(font_data + header->glyphs_offset);
+		for(UInt32 glyph_num = 1; glyph_num < header->num_glyphs; ++glyph_num)
+		{
+			if(!GlyphLess(glyphs[glyph_num-1], glyphs[glyph_num]))
+				return false;
+		}
+
+		const FontKerningPair* kerning_pairs = reinterpret_cast<const FontKerningPair*>(font_data + header->kerning_pairs_offset);
+		for(UInt32 pair_num = 1; pair_num < header->num_kerning_pairs; ++pair_num)
+		{
+			if(!KerningPairLess(kerning_pairs[pair_num-1], kerning_pairs[pair_num]))
+				return false;
+		}
+
+		return true;
+	}
+}
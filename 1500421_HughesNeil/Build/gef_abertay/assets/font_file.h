@@ -0,0 +1,59 @@
+#ifndef _GEF_FONT_FILE_H
+#define _GEF_FONT_FILE_H
+
+#include <gef.h>
+#include <vector>
+
+namespace gef
+{
+	const UInt32 kFontFileId = 0x544e4647; // 'GFNT'
+	const Int32 kFontFileVersion = 1;
+
+	// compiled fonts are loaded in preference to the text .fnt files they are made from
+	const char* const kCompiledFontExtension = ".fnb";
+
+	// a compiled font is this header followed by the glyphs sorted by id then the kerning pairs
+	// sorted by first then second character, so it can be used straight from the file data
+	struct FontFileHeader
+	{
+		UInt32 file_id;
+		Int32 version;
+		UInt16 line_height;
+		UInt16 base;
+		UInt16 width;
+		UInt16 height;
+		UInt16 pages;
+		UInt16 padding;
+		UInt32 num_glyphs;
+		UInt32 glyphs_offset;
+		UInt32 num_kerning_pairs;
+		UInt32 kerning_pairs_offset;
+	};
+
+	struct FontGlyph
+	{
+		UInt32 id;
+		Int16 x, y;
+		Int16 width, height;
+		Int16 x_offset, y_offset;
+		Int16 x_advance;
+		UInt8 page;
+		UInt8 padding;
+	};
+
+	struct FontKerningPair
+	{
+		UInt32 first;
+		UInt32 second;
+		Int32 amount;
+	};
+
+	// builds a compiled font from the text of an AngelCode BMFont .fnt file
+	// only the common, char and kerning lines are used
+	bool CompileFont(const char* text, const Int32 text_size, std::vector<UInt8>& font_data);
+
+	// checks a compiled font's header and that its tables fit in the data and are sorted
+	bool ValidateFontData(const UInt8* font_data, const UInt32 font_data_size);
+}
+
+#endif // _GEF_FONT_FILE_H
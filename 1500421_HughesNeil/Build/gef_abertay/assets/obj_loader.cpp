@@ -10,182 +10,580 @@
 #include <graphics/texture.h>
 #include <graphics/image_data.h>
 #include <system/file.h>
-#include <system/memory_stream_buffer.h>
+#include <system/thread_pool.h>
 #include <graphics/material.h>
 
 #include <cstdio>
+#include <cfloat>
+#include <cmath>
 #include <cstring>
-#include <istream>
+#include <cstdlib>
 
 namespace gef
 {
+	// files are only split across threads when each thread gets at least this much to parse
+	static const Int32 kMinOBJChunkSize = 256*1024;
 
+	// the index of each attribute of a face vertex is -1 when it's missing
+	// negative indices in the file count back from the end of the chunk's attributes
+	// so they are stored relative to the start of the chunk until the chunks are joined
+	struct OBJFaceVertex
+	{
+		enum Attribute
+		{
+			kPosition = 0,
+			kUV,
+			kNormal,
+			kNumAttributes
+		};
 
-bool OBJLoader::Load(const char* filename, Platform& platform, Model& model)
-{
-	bool success = true;
-
-	std::vector<Texture*> textures;
-	std::vector<gef::Vector4> positions;
-	std::vector<gef::Vector4> normals;
-	std::vector<gef::Vector2> uvs;
-	std::vector<Int32> face_indices;
-	std::vector<Int32> primitive_indices;
-	std::vector<Int32> texture_indices;
-
-	std::map<std::string, Int32> materials;
+		Int32 indices[kNumAttributes];
+		UInt32 relative_flags;
+	};
 
-	std::string obj_filename(filename);
-	void* obj_file_data = NULL;
-	Int32 file_size = 0;
-	gef::File* file = gef::File::Create();
+	struct OBJMaterialChange
+	{
+		Int32 face_vertex_num;
+		std::string material_name;
+	};
 
-	success = file->Open(obj_filename.c_str());
-	if(success)
+	// everything parsed from one part of the file
+	struct OBJChunk
+	{
+		const char* start;
+		const char* end;
+		std::vector<Vector4> positions;
+		std::vector<Vector2> uvs;
+		std::vector<Vector4> normals;
+		std::vector<OBJFaceVertex> face_vertices;
+		std::vector<OBJMaterialChange> material_changes;
+		std::vector<std::string> material_libraries;
+	};
+
+	static bool ReadFileData(const char* filename, void** file_data, Int32& file_size)
 	{
-		success = file->GetSize(file_size);
+		*file_data = NULL;
+		file_size = 0;
+
+		File* file = File::Create();
+		bool success = file->Open(filename);
 		if(success)
 		{
-			obj_file_data = malloc(file_size);
-			success = obj_file_data != NULL;
+			success = file->GetSize(file_size);
 			if(success)
 			{
-				Int32 bytes_read;
-				success = file->Read(obj_file_data, file_size, bytes_read);
+				*file_data = malloc(file_size);
+				success = *file_data != NULL;
 				if(success)
-					success = bytes_read == file_size;
+				{
+					Int32 bytes_read;
+					success = file->Read(*file_data, file_size, bytes_read);
+					if(success)
+						success = bytes_read == file_size;
+				}
 			}
+			file->Close();
 		}
+		delete file;
+
+		if(!success)
+		{
+			free(*file_data);
+			*file_data = NULL;
+		}
+
+		return success;
 	}
 
-	if(!success)
+	static inline bool IsSpace(const char character)
 	{
-		free(obj_file_data);
-		obj_file_data = NULL;
+		return (character == ' ') || (character == '\t') || (character == '\r');
+	}
 
-		delete file;
-		file = NULL;
-		return false;
+	static inline const char* SkipSpaces(const char* text, const char* end)
+	{
+		while((text < end) && IsSpace(*text))
+			++text;
+		return text;
+	}
+
+	static inline const char* SkipLine(const char* text, const char* end)
+	{
+		while((text < end) && (*text != '\n'))
+			++text;
+		return text < end ? text+1 : end;
+	}
+
+	// true if the text starts with keyword followed by a space
+	static inline bool MatchKeyword(const char* text, const char* end, const char* keyword, const Int32 keyword_length)
+	{
+		return (end - text > keyword_length) && (memcmp(text, keyword, keyword_length) == 0) && IsSpace(text[keyword_length]);
+	}
+
+	// the rest of the line without leading or trailing spaces
+	static const char* ParseName(const char* text, const char* end, std::string& name)
+	{
+		text = SkipSpaces(text, end);
+		const char* name_end = text;
+		while((name_end < end) && (*name_end != '\n'))
+			++name_end;
+
+		const char* line_end = name_end;
+		while((name_end > text) && IsSpace(name_end[-1]))
+			--name_end;
+
+		name.assign(text, name_end - text);
+		return line_end;
 	}
-	gef::MemoryStreamBuffer buffer((char*)obj_file_data, file_size);
-	std::istream stream(&buffer);
 
+	static const double kPowersOfTen[] =
 	{
-		while( !stream.eof() )
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	// decimal and exponent notation only, which is all OBJ exporters write
+	// anything else is left to strtod
+	static const char* ParseFloat(const char* text, const char* end, float& value)
+	{
+		text = SkipSpaces(text, end);
+		const char* start = text;
+
+		bool negative = false;
+		if((text < end) && ((*text == '-') || (*text == '+')))
+			negative = *text++ == '-';
+
+		UInt64 mantissa = 0;
+		Int32 exponent = 0;
+		Int32 num_digits = 0;
+		while((text < end) && (*text >= '0') && (*text <= '9'))
 		{
-		    char line[128];
-			stream >> line;
-			if ( strcmp( line, "mtllib" ) == 0 )
-			{
-				char material_filename[256];
-				stream >> material_filename;
+			// digits that don't fit in the mantissa only change the exponent
+			if(mantissa < 1000000000000000000ull)
+				mantissa = mantissa*10 + (*text - '0');
+			else
+				++exponent;
+			++text;
+			++num_digits;
+		}
 
-				LoadMaterials(platform, material_filename, materials, textures);
+		if((text < end) && (*text == '.'))
+		{
+			++text;
+			while((text < end) && (*text >= '0') && (*text <= '9'))
+			{
+				if(mantissa < 1000000000000000000ull)
+				{
+					mantissa = mantissa*10 + (*text - '0');
+					--exponent;
+				}
+				++text;
+				++num_digits;
 			}
+		}
 
-			// vertices
-			else if ( strcmp( line, "v" ) == 0 )
+		if(num_digits == 0)
+		{
+			// nan, inf and other oddities
+			char buffer[64];
+			Int32 length = 0;
+			while((start+length < end) && !IsSpace(start[length]) && (start[length] != '\n') && (length < 63))
 			{
-				float x, y, z;
-				stream >> x;
-				stream >> y;
-				stream >> z;
-				positions.push_back(gef::Vector4(x, y, z));
+				buffer[length] = start[length];
+				++length;
 			}
+			buffer[length] = 0;
+
+			char* parse_end = buffer;
+			value = (float)strtod(buffer, &parse_end);
+			return start + (parse_end - buffer);
+		}
 
-			// normals
-			else if ( strcmp( line, "vn" ) == 0 )
+		if((text < end) && ((*text == 'e') || (*text == 'E')))
+		{
+			const char* exponent_start = text++;
+			bool negative_exponent = false;
+			if((text < end) && ((*text == '-') || (*text == '+')))
+				negative_exponent = *text++ == '-';
+
+			if((text < end) && (*text >= '0') && (*text <= '9'))
 			{
-				float nx, ny, nz;
-				stream >> nx;
-				stream >> ny;
-				stream >> nz;
-				normals.push_back(gef::Vector4(nx, ny, nz));
+				Int32 explicit_exponent = 0;
+				while((text < end) && (*text >= '0') && (*text <= '9'))
+				{
+					if(explicit_exponent < 10000)
+						explicit_exponent = explicit_exponent*10 + (*text - '0');
+					++text;
+				}
+				exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
 			}
+			else
+				text = exponent_start;
+		}
+
+		double result = (double)mantissa;
+		if((exponent >= -22) && (exponent <= 22))
+			result = exponent < 0 ? result / kPowersOfTen[-exponent] : result * kPowersOfTen[exponent];
+		else
+			result *= pow(10.0, (double)exponent);
+
+		value = (float)(negative ? -result : result);
+		return text;
+	}
+
+	// returns text unchanged if there is no number
+	static inline const char* ParseInt(const char* text, const char* end, Int32& value)
+	{
+		const char* start = text;
+		bool negative = false;
+		if((text < end) && ((*text == '-') || (*text == '+')))
+			negative = *text++ == '-';
+
+		if((text == end) || (*text < '0') || (*text > '9'))
+			return start;
+
+		Int32 result = 0;
+		while((text < end) && (*text >= '0') && (*text <= '9'))
+			result = result*10 + (*text++ - '0');
+
+		value = negative ? -result : result;
+		return text;
+	}
+
+	// v, v/vt, v//vn or v/vt/vn
+	static const char* ParseFaceVertex(const char* text, const char* end, OBJChunk& chunk, OBJFaceVertex& face_vertex)
+	{
+		const Int32 attribute_counts[OBJFaceVertex::kNumAttributes] = { (Int32)chunk.positions.size(), (Int32)chunk.uvs.size(), (Int32)chunk.normals.size() };
+
+		face_vertex.relative_flags = 0;
+		for(Int32 attribute = 0; attribute < OBJFaceVertex::kNumAttributes; ++attribute)
+		{
+			face_vertex.indices[attribute] = -1;
 
-			// uvs
-			else if ( strcmp( line, "vt" ) == 0 )
+			if(attribute > 0)
 			{
-				float u, v;
-				stream >> u;
-				stream >> v;
-				uvs.push_back(gef::Vector2(u, v));
+				if((text == end) || (*text != '/'))
+					continue;
+				++text;
 			}
 
-			else if(strcmp( line, "usemtl" ) == 0)
+			Int32 index = 0;
+			text = ParseInt(text, end, index);
+			if(index > 0)
+				face_vertex.indices[attribute] = index-1;
+			else if(index < 0)
 			{
+				face_vertex.indices[attribute] = attribute_counts[attribute] + index;
+				face_vertex.relative_flags |= 1 << attribute;
+			}
+		}
 
-				char material_name[256];
-				stream >> material_name;
+		return text;
+	}
+
+	static void ParseOBJChunk(OBJChunk& chunk)
+	{
+		const char* text = chunk.start;
+		const char* end = chunk.end;
+		std::vector<OBJFaceVertex> polygon;
 
-				// any time the material is changed
-				// a new primitive is created
-				primitive_indices.push_back((Int32)face_indices.size());
+		while(text < end)
+		{
+			text = SkipSpaces(text, end);
+			if(text == end)
+				break;
 
-				texture_indices.push_back(materials[material_name]);
+			const char character = *text;
+			if((character == 'v') && (end - text > 1))
+			{
+				if(IsSpace(text[1]))
+				{
+					Vector4 position(0.0f, 0.0f, 0.0f);
+					float x, y, z;
+					text = ParseFloat(text+1, end, x);
+					text = ParseFloat(text, end, y);
+					text = ParseFloat(text, end, z);
+					position.set_value(x, y, z);
+					chunk.positions.push_back(position);
+				}
+				else if(MatchKeyword(text, end, "vt", 2))
+				{
+					Vector2 uv;
+					text = ParseFloat(text+2, end, uv.x);
+					text = ParseFloat(text, end, uv.y);
+					chunk.uvs.push_back(uv);
+				}
+				else if(MatchKeyword(text, end, "vn", 2))
+				{
+					Vector4 normal(0.0f, 0.0f, 0.0f);
+					float x, y, z;
+					text = ParseFloat(text+2, end, x);
+					text = ParseFloat(text, end, y);
+					text = ParseFloat(text, end, z);
+					normal.set_value(x, y, z);
+					chunk.normals.push_back(normal);
+				}
 			}
-			else if ( strcmp( line, "f" ) == 0 )
+			else if(MatchKeyword(text, end, "f", 1))
 			{
-				Int32 vertexIndex[3], uvIndex[3], normalIndex[3];
-/*
-    //std::string vertex1, vertex2, vertex3;
-				Int32 matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &vertexIndex[0], &uvIndex[0], &normalIndex[0], &vertexIndex[1], &uvIndex[1], &normalIndex[1], &vertexIndex[2], &uvIndex[2], &normalIndex[2] );
-				if (matches != 9)
+				text += 1;
+				polygon.clear();
+				for(;;)
+				{
+					text = SkipSpaces(text, end);
+					if((text == end) || (*text == '\n'))
+						break;
+
+					OBJFaceVertex face_vertex;
+					const char* vertex_end = ParseFaceVertex(text, end, chunk, face_vertex);
+					if(vertex_end == text)
+						break;
+					text = vertex_end;
+					polygon.push_back(face_vertex);
+				}
+
+				// polygons are split into a fan of triangles
+				// the winding is reversed to match the rest of the framework
+				for(size_t corner = 1; corner+1 < polygon.size(); ++corner)
 				{
-//					printf("File can't be read by our simple parser : ( Try exporting with other options\n");
-					success = false;
+					chunk.face_vertices.push_back(polygon[corner+1]);
+					chunk.face_vertices.push_back(polygon[corner]);
+					chunk.face_vertices.push_back(polygon[0]);
 				}
-*/
+			}
+			else if(MatchKeyword(text, end, "usemtl", 6))
+			{
+				OBJMaterialChange material_change;
+				material_change.face_vertex_num = (Int32)chunk.face_vertices.size();
+				text = ParseName(text+6, end, material_change.material_name);
+				chunk.material_changes.push_back(material_change);
+			}
+			else if(MatchKeyword(text, end, "mtllib", 6))
+			{
+				std::string material_library;
+				text = ParseName(text+6, end, material_library);
+				chunk.material_libraries.push_back(material_library);
+			}
+
+			// comments, groups, smoothing groups and anything left on the line
+			text = SkipLine(text, end);
+		}
+	}
 
-				stream >> vertexIndex[0]; stream.ignore(); stream >> uvIndex[0]; stream.ignore(); stream >> normalIndex[0];
-				stream >> vertexIndex[1]; stream.ignore(); stream >> uvIndex[1]; stream.ignore(); stream >> normalIndex[1];
-				stream >> vertexIndex[2]; stream.ignore(); stream >> uvIndex[2]; stream.ignore(); stream >> normalIndex[2];
+	static void ParseOBJChunkJob(void* user_data, Int32 job_index)
+	{
+		ParseOBJChunk(static_cast<OBJChunk*>(user_data)[job_index]);
+	}
 
-				face_indices.push_back(vertexIndex[2]);
-				face_indices.push_back(uvIndex[2]);
-				face_indices.push_back(normalIndex[2]);
+OBJLoader::OBJLoader() :
+	weld_epsilon_(0.0f)
+{
+}
 
-				face_indices.push_back(vertexIndex[1]);
-				face_indices.push_back(uvIndex[1]);
-				face_indices.push_back(normalIndex[1]);
+bool OBJLoader::Load(const char* filename, Platform& platform, Model& model, ThreadPool* thread_pool)
+{
+	bool success = true;
 
-				face_indices.push_back(vertexIndex[0]);
-				face_indices.push_back(uvIndex[0]);
-				face_indices.push_back(normalIndex[0]);
+	std::vector<Texture*> textures;
+	std::map<std::string, Int32> materials;
+
+	void* obj_file_data = NULL;
+	Int32 file_size = 0;
+	if(!ReadFileData(filename, &obj_file_data, file_size))
+		return false;
+
+	// split the file into chunks at line breaks so they can be parsed in parallel
+	// without a thread pool the file is parsed as one chunk on this thread
+	Int32 num_chunks = thread_pool ? file_size / kMinOBJChunkSize : 1;
+	if(num_chunks > 1)
+	{
+		const Int32 max_chunks = (thread_pool->num_threads()+1)*4;
+		if(num_chunks > max_chunks)
+			num_chunks = max_chunks;
+	}
+	else
+		num_chunks = 1;
+
+	std::vector<OBJChunk> chunks(num_chunks);
+	const char* file_start = static_cast<const char*>(obj_file_data);
+	const char* file_end = file_start + file_size;
+	const char* chunk_start = file_start;
+	for(Int32 chunk_num = 0; chunk_num < num_chunks; ++chunk_num)
+	{
+		const char* chunk_end = chunk_num == num_chunks-1 ? file_end : file_start + (Int64)file_size*(chunk_num+1)/num_chunks;
+		if(chunk_end < chunk_start)
+			chunk_end = chunk_start;
+		if(chunk_end < file_end)
+			chunk_end = SkipLine(chunk_end, file_end);
+
+		chunks[chunk_num].start = chunk_start;
+		chunks[chunk_num].end = chunk_end;
+		chunk_start = chunk_end;
+	}
+
+	if(num_chunks > 1)
+		thread_pool->ParallelFor(num_chunks, ParseOBJChunkJob, &chunks[0]);
+	else
+		ParseOBJChunk(chunks[0]);
+
+	// don't need the file data any more
+	free(obj_file_data);
+	obj_file_data = NULL;
+
+	// join the chunks together
+	Int32 num_positions = 0, num_uvs = 0, num_normals = 0, num_face_vertices = 0;
+	for(std::vector<OBJChunk>::const_iterator chunk_iter = chunks.begin(); chunk_iter != chunks.end(); ++chunk_iter)
+	{
+		num_positions += (Int32)chunk_iter->positions.size();
+		num_uvs += (Int32)chunk_iter->uvs.size();
+		num_normals += (Int32)chunk_iter->normals.size();
+		num_face_vertices += (Int32)chunk_iter->face_vertices.size();
+	}
+
+	std::vector<gef::Vector4> positions;
+	std::vector<gef::Vector2> uvs;
+	std::vector<gef::Vector4> normals;
+	std::vector<OBJFaceVertex> face_vertices;
+	std::vector<OBJMaterialChange> material_changes;
+	positions.reserve(num_positions);
+	uvs.reserve(num_uvs);
+	normals.reserve(num_normals);
+	face_vertices.reserve(num_face_vertices);
+
+	for(std::vector<OBJChunk>::iterator chunk_iter = chunks.begin(); chunk_iter != chunks.end(); ++chunk_iter)
+	{
+		const Int32 attribute_bases[OBJFaceVertex::kNumAttributes] = { (Int32)positions.size(), (Int32)uvs.size(), (Int32)normals.size() };
+		for(std::vector<OBJFaceVertex>::iterator face_vertex_iter = chunk_iter->face_vertices.begin(); face_vertex_iter != chunk_iter->face_vertices.end(); ++face_vertex_iter)
+		{
+			for(Int32 attribute = 0; attribute < OBJFaceVertex::kNumAttributes; ++attribute)
+			{
+				if(face_vertex_iter->relative_flags & (1 << attribute))
+					face_vertex_iter->indices[attribute] += attribute_bases[attribute];
 			}
 		}
 
-		// don't need the font file data any more
-		free(obj_file_data);
-		obj_file_data = NULL;
+		for(std::vector<OBJMaterialChange>::iterator material_change_iter = chunk_iter->material_changes.begin(); material_change_iter != chunk_iter->material_changes.end(); ++material_change_iter)
+		{
+			material_changes.push_back(*material_change_iter);
+			material_changes.back().face_vertex_num += (Int32)face_vertices.size();
+		}
+
+		for(std::vector<std::string>::const_iterator library_iter = chunk_iter->material_libraries.begin(); library_iter != chunk_iter->material_libraries.end(); ++library_iter)
+			LoadMaterials(platform, library_iter->c_str(), materials, textures);
+
+		positions.insert(positions.end(), chunk_iter->positions.begin(), chunk_iter->positions.end());
+		uvs.insert(uvs.end(), chunk_iter->uvs.begin(), chunk_iter->uvs.end());
+		normals.insert(normals.end(), chunk_iter->normals.begin(), chunk_iter->normals.end());
+		face_vertices.insert(face_vertices.end(), chunk_iter->face_vertices.begin(), chunk_iter->face_vertices.end());
 
-		// finished reading the file
-//		fclose(file);
-		// start building the mesh
-		Int32 num_faces = (Int32)face_indices.size() / 9;
-		Int32 num_vertices = num_faces*3;
+		// free each chunk as soon as it's been copied
+		std::vector<gef::Vector4>().swap(chunk_iter->positions);
+		std::vector<gef::Vector2>().swap(chunk_iter->uvs);
+		std::vector<gef::Vector4>().swap(chunk_iter->normals);
+		std::vector<OBJFaceVertex>().swap(chunk_iter->face_vertices);
+	}
+	chunks.clear();
 
-		// create vertex buffer
-		gef::Mesh::Vertex* vertices = new gef::Mesh::Vertex[num_vertices];
+	// a new primitive is started any time the material is changed
+	// faces before the first material change don't have a material
+	std::vector<Int32> primitive_starts;
+	std::vector<Int32> texture_indices;
+	if(material_changes.empty() || (material_changes[0].face_vertex_num > 0))
+	{
+		primitive_starts.push_back(0);
+		texture_indices.push_back(-1);
+	}
+	for(std::vector<OBJMaterialChange>::const_iterator material_change_iter = material_changes.begin(); material_change_iter != material_changes.end(); ++material_change_iter)
+	{
+		// primitives with no faces are replaced
+		if(!primitive_starts.empty() && (primitive_starts.back() == material_change_iter->face_vertex_num))
+		{
+			primitive_starts.pop_back();
+			texture_indices.pop_back();
+		}
 
-		// need to record min and max position values for mesh bounds
-		gef::Vector4 pos_min(FLT_MAX, FLT_MAX, FLT_MAX), pos_max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		std::map<std::string, Int32>::const_iterator material_iter = materials.find(material_change_iter->material_name);
+		primitive_starts.push_back(material_change_iter->face_vertex_num);
+		texture_indices.push_back(material_iter != materials.end() ? material_iter->second : -1);
+	}
+	if(!primitive_starts.empty() && (primitive_starts.back() == num_face_vertices) && (num_face_vertices > 0))
+	{
+		primitive_starts.pop_back();
+		texture_indices.pop_back();
+	}
 
-		for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+	// start building the mesh
+	// face vertices that use the same position, uv and normal share a vertex
+	// with a weld epsilon face vertices are also shared when all their values round to the same multiples of it
+	std::vector<gef::Mesh::Vertex> vertices;
+	std::vector<UInt32> vertex_indices(num_face_vertices > 0 ? num_face_vertices : 1);
+	vertices.reserve(num_face_vertices);
+
+	const bool weld_by_value = weld_epsilon_ > 0.0f;
+	const float weld_scale = weld_by_value ? 1.0f / weld_epsilon_ : 0.0f;
+	float quantised_values[8];
+	const size_t key_byte_size = weld_by_value ? sizeof(quantised_values) : sizeof(Int32)*OBJFaceVertex::kNumAttributes;
+	std::vector<UInt8> vertex_keys;
+
+	// hash table of unique vertex indices, linear probing
+	UInt32 table_size = 1;
+	while(table_size < (UInt32)num_face_vertices*2)
+		table_size <<= 1;
+	std::vector<Int32> table(table_size, -1);
+
+	// need to record min and max position values for mesh bounds
+	gef::Vector4 pos_min(FLT_MAX, FLT_MAX, FLT_MAX), pos_max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	const gef::Vector4 zero(0.0f, 0.0f, 0.0f);
+	const gef::Vector2 zero_uv(0.0f, 0.0f);
+	for(Int32 face_vertex_num = 0; face_vertex_num < num_face_vertices; ++face_vertex_num)
+	{
+		const OBJFaceVertex& face_vertex = face_vertices[face_vertex_num];
+		const Int32 position_index = face_vertex.indices[OBJFaceVertex::kPosition];
+		const Int32 uv_index = face_vertex.indices[OBJFaceVertex::kUV];
+		const Int32 normal_index = face_vertex.indices[OBJFaceVertex::kNormal];
+
+		success = (position_index >= 0) && (position_index < num_positions) && (uv_index < num_uvs) && (normal_index < num_normals);
+		if(!success)
+			break;
+
+		gef::Mesh::Vertex vertex;
+		const gef::Vector4& position = positions[position_index];
+		const gef::Vector2& uv = uv_index >= 0 ? uvs[uv_index] : zero_uv;
+		const gef::Vector4& normal = normal_index >= 0 ? normals[normal_index] : zero;
+
+		vertex.px = position.x();
+		vertex.py = position.y();
+		vertex.pz = position.z();
+		vertex.nx = normal.x();
+		vertex.ny = normal.y();
+		vertex.nz = normal.z();
+		vertex.u = uv.x;
+		vertex.v = -uv.y;
+
+		const UInt8* key = reinterpret_cast<const UInt8*>(face_vertex.indices);
+		if(weld_by_value)
 		{
-			gef::Mesh::Vertex* vertex = &vertices[vertex_num];
-			gef::Vector4 position = positions[face_indices[vertex_num*3]-1];
-			gef::Vector2 uv = uvs[face_indices[vertex_num*3+1]-1];
-			gef::Vector4 normal = normals[face_indices[vertex_num*3+2]-1];
-
-			vertex->px = position.x();
-			vertex->py = position.y();
-			vertex->pz = position.z();
-			vertex->nx = normal.x();
-			vertex->ny = normal.y();
-			vertex->nz = normal.z();
-			vertex->u = uv.x;
-			vertex->v = -uv.y;
+			const float* values = &vertex.px;
+			for(Int32 value_num = 0; value_num < 8; ++value_num)
+				quantised_values[value_num] = floorf(values[value_num]*weld_scale + 0.5f);
+			key = reinterpret_cast<const UInt8*>(quantised_values);
+		}
+
+		// FNV-1a
+		UInt32 hash = 2166136261u;
+		for(size_t byte_num = 0; byte_num < key_byte_size; ++byte_num)
+			hash = (hash ^ key[byte_num]) * 16777619u;
+
+		UInt32 slot = hash & (table_size-1);
+		while((table[slot] != -1) && (memcmp(&vertex_keys[table[slot]*key_byte_size], key, key_byte_size) != 0))
+			slot = (slot+1) & (table_size-1);
+
+		if(table[slot] == -1)
+		{
+			table[slot] = (Int32)vertices.size();
+			vertex_keys.insert(vertex_keys.end(), key, key+key_byte_size);
+			vertices.push_back(vertex);
 
 			// update min and max positions for bounds
 			if (position.x() < pos_min.x())
@@ -201,71 +599,65 @@ bool OBJLoader::Load(const char* filename, Platform& platform, Model& model)
 			if (position.z() > pos_max.z())
 				pos_max.set_z(position.z());
 		}
+		vertex_indices[face_vertex_num] = (UInt32)table[slot];
+	}
 
-
-		Mesh* mesh = new Mesh(platform);
-		model.set_mesh(mesh);
-		model.set_textures(textures);
-
-		// set bounds
-		gef::Aabb aabb(pos_min, pos_max);
-		gef::Sphere sphere(aabb);
-		mesh->set_aabb(aabb);
-		mesh->set_bounding_sphere(sphere);
-
-
-		// create materials for each texture
+	if(!success)
+	{
 		for(std::vector<Texture*>::iterator texture=textures.begin(); texture != textures.end(); ++texture)
-		{
-			Material* material = new Material();
-			material->set_texture(*texture);
-			model.AddMaterial(material);
-		}
-
-		mesh->InitVertexBuffer(platform, vertices, num_vertices, sizeof(gef::Mesh::Vertex));
-
-		// create primitives
-		mesh->AllocatePrimitives((UInt32)primitive_indices.size());
-
-		std::vector<UInt32*> indices;
-		indices.resize(primitive_indices.size());
-		for(UInt32 primitive_num=0;primitive_num<primitive_indices.size();++primitive_num)
-		{
-			Int32 index_count = 0;
-
-			if(primitive_num == primitive_indices.size()-1)
-				index_count = (Int32)face_indices.size() - primitive_indices[primitive_num];
-			else
-				index_count = primitive_indices[primitive_num+1] - primitive_indices[primitive_num];
+			delete *texture;
+		return false;
+	}
 
-			// 9 indices per triangle, index count is the number of vertices in this primitive
-			index_count /= 3;
+	// don't need the welding data any more
+	std::vector<Int32>().swap(table);
+	std::vector<UInt8>().swap(vertex_keys);
+	std::vector<OBJFaceVertex>().swap(face_vertices);
 
-			indices[primitive_num] = new UInt32[index_count];
+	Mesh* mesh = new Mesh(platform);
+	model.set_mesh(mesh);
+	model.set_textures(textures);
 
-			for(Int32 index=0;index<index_count;++index)
-				indices[primitive_num][index] = primitive_indices[primitive_num]+index;
+	// set bounds
+	gef::Aabb aabb(pos_min, pos_max);
+	gef::Sphere sphere(aabb);
+	mesh->set_aabb(aabb);
+	mesh->set_bounding_sphere(sphere);
 
-			mesh->GetPrimitive(primitive_num)->set_type(gef::TRIANGLE_LIST);
-			mesh->GetPrimitive(primitive_num)->InitIndexBuffer(platform, indices[primitive_num], index_count, sizeof(UInt32));
-//			mesh->GetPrimitive(primitive_num)->InitIndexBuffer(platform, indices[primitive_num], 3, sizeof(UInt32));
 
+	// create materials for each texture
+	for(std::vector<Texture*>::iterator texture=textures.begin(); texture != textures.end(); ++texture)
+	{
+		Material* material = new Material();
+		material->set_texture(*texture);
+		model.AddMaterial(material);
+	}
 
-			Int32 texture_index = texture_indices[primitive_num];
-			if(texture_index == -1)
-				mesh->GetPrimitive(primitive_num)->set_material(NULL);
-			else
-				mesh->GetPrimitive(primitive_num)->set_material(model.material(texture_index));
-			//mesh->GetPrimitive(primitive_num)->set_texture(textures_[0]);
-		}
+	const UInt32 num_vertices = (UInt32)vertices.size();
+	if(num_vertices > 0)
+		mesh->InitVertexBuffer(platform, &vertices[0], num_vertices, sizeof(gef::Mesh::Vertex));
 
-		// mesh construction complete
-		// clean up
-		DeleteArrayNull(vertices);
-		for(UInt32 primitive_num=0;primitive_num<indices.size();++primitive_num)
-			DeleteArrayNull(indices[primitive_num]);
+	// create primitives
+	// each primitive is a range of the welded face vertex indices
+	mesh->AllocatePrimitives((UInt32)primitive_starts.size());
 
+	for(UInt32 primitive_num=0;primitive_num<primitive_starts.size();++primitive_num)
+	{
+		const Int32 primitive_end = primitive_num == primitive_starts.size()-1 ? num_face_vertices : primitive_starts[primitive_num+1];
+		const Int32 index_count = primitive_end - primitive_starts[primitive_num];
+
+		mesh->GetPrimitive(primitive_num)->set_type(gef::TRIANGLE_LIST);
+		// stored as 16 bit indices when the mesh is small enough
+		mesh->GetPrimitive(primitive_num)->InitCompactIndexBuffer(platform, &vertex_indices[primitive_starts[primitive_num]], index_count, sizeof(UInt32), num_vertices);
+
+		Int32 texture_index = texture_indices[primitive_num];
+		if(texture_index == -1)
+			mesh->GetPrimitive(primitive_num)->set_material(NULL);
+		else
+			mesh->GetPrimitive(primitive_num)->set_material(model.material(texture_index));
 	}
+
+	// mesh construction complete
 	return success;
 }
 
@@ -273,63 +665,34 @@ bool OBJLoader::LoadMaterials(Platform& platform, const char* filename, std::map
 {
 	PNGLoader png_loader;
 
-	bool success = true;
-
-
-	std::string mtl_filename(filename);
 	void* mtl_file_data = NULL;
 	Int32 file_size = 0;
-	gef::File* file = gef::File::Create();
-	success = file->Open(mtl_filename.c_str());
-	if(success)
-	{
-		success = file->GetSize(file_size);
-		if(success)
-		{
-			mtl_file_data = malloc(file_size);
-			success = mtl_file_data != NULL;
-			if(success)
-			{
-				Int32 bytes_read;
-				success = file->Read(mtl_file_data, file_size, bytes_read);
-				if(success)
-					success = bytes_read == file_size;
-			}
-		}
-	}
-
-	if(!success)
-	{
-		free(mtl_file_data);
-		mtl_file_data = NULL;
-
-		delete file;
-		file = NULL;
+	if(!ReadFileData(filename, &mtl_file_data, file_size))
 		return false;
-	}
-	gef::MemoryStreamBuffer buffer((char*)mtl_file_data, file_size);
-	std::istream stream(&buffer);
-
 
 	{
+		const char* text = static_cast<const char*>(mtl_file_data);
+		const char* end = text + file_size;
+
 		std::map<std::string, std::string> material_name_mappings;
-		char material_name[256];
-		while( !stream.eof() )
+		std::string material_name;
+		while(text < end)
 		{
-		    char line[128];
-			stream >> line;
+			text = SkipSpaces(text, end);
 
-			if ( strcmp( line, "newmtl" ) == 0 )
+			if(MatchKeyword(text, end, "newmtl", 6))
 			{
-				stream >> material_name;
+				text = ParseName(text+6, end, material_name);
 				material_name_mappings[material_name] = "";
 			}
-			else if(strcmp( line, "map_Kd" ) == 0)
+			else if(MatchKeyword(text, end, "map_Kd", 6))
 			{
-				char texture_name[256];
-				stream >> texture_name;
+				std::string texture_name;
+				text = ParseName(text+6, end, texture_name);
 				material_name_mappings[material_name] = texture_name;
 			}
+
+			text = SkipLine(text, end);
 		}
 
 		free(mtl_file_data);
@@ -352,7 +715,7 @@ bool OBJLoader::LoadMaterials(Platform& platform, const char* filename, std::map
 		}
 	}
 
-	return success;
+	return true;
 
 }
 
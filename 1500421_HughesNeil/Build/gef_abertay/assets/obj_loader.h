@@ -11,13 +11,27 @@ namespace gef
 	class Platform;
 	class Model;
 	class Texture;
+	class ThreadPool;
 
 	class OBJLoader
 	{
 	public:
-		bool Load(const char* filename, Platform& platform, Model& model);
+		OBJLoader();
+
+		// large files are split into chunks at line breaks and parsed in parallel
+		// using thread_pool, or on this thread if it is NULL
+		bool Load(const char* filename, Platform& platform, Model& model, ThreadPool* thread_pool = NULL);
+
+		// face vertices with the same position, uv and normal indices always share a vertex
+		// when the weld epsilon is greater than zero, vertices whose values all round to the
+		// same multiples of it are shared too
+		inline void set_weld_epsilon(const float weld_epsilon) { weld_epsilon_ = weld_epsilon; }
+		inline float weld_epsilon() const { return weld_epsilon_; }
+
 	private:
 		bool LoadMaterials(Platform& platform, const char* filename, std::map<std::string, Int32>& materials, std::vector<Texture*>& textures);
+
+		float weld_epsilon_;
 	};
 }
 
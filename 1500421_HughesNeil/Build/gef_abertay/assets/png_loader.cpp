@@ -45,6 +45,11 @@ namespace gef
 
 
     void PNGLoader::Load(const char* filename, const Platform& platform, ImageData& image_data)
+    {
+        Load(filename, image_data);
+    }
+
+    bool PNGLoader::Load(const char* filename, ImageData& image_data)
     {
         File* png_file   = gef::File::Create();
 
@@ -73,6 +78,8 @@ namespace gef
                     png_uint_32 height = 0;
                     int bitDepth = 0;
                     int colorType = -1;
+                    // libpng reads through this until the image is parsed
+                    PNGData data;
 
 
                     /* Create and initialize the png_struct
@@ -135,7 +142,6 @@ namespace gef
 
                     if(success)
                     {
-						PNGData data;
 						data.p = buffer;
 						data.len = file_size;
 
@@ -221,6 +227,11 @@ namespace gef
                 buffer = NULL;
             }
         }
+
+        delete png_file;
+        png_file = NULL;
+
+        return success && (image_data.image() != NULL);
     }
 
     void PNGLoader::ParseRGBA(UInt8* out_image_buffer, void* the_png_ptr,
@@ -247,20 +258,4 @@ namespace gef
 
     }  // end ParseRGBA()
 
-    UInt32 PNGLoader::NextPowerOfTwo(const UInt32 value)
-    {
-        // http://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2
-        UInt32 result = value;
-
-        result--;
-        result |= result >> 1;
-        result |= result >> 2;
-        result |= result >> 4;
-        result |= result >> 8;
-        result |= result >> 16;
-        result++;
-
-        return result;
-    }
-
 }
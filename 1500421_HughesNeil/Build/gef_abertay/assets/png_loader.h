@@ -17,9 +17,11 @@ namespace gef
 		~PNGLoader();
 
 		void Load(const char* filename, const Platform& platform, ImageData& image_data);
+
+		// the platform isn't needed to decode a png so tools can load them without one
+		bool Load(const char* filename, ImageData& image_data);
 	private:
 		void ParseRGBA(UInt8* out_image_buffer, void* png_ptr, const void* info_ptr, UInt32 width, UInt32 height);
-		UInt32 NextPowerOfTwo(const UInt32 value);
 	};
 
 }
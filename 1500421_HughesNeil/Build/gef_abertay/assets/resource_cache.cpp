@@ -0,0 +1,332 @@
+#include <assets/resource_cache.h>
+#include <assets/png_loader.h>
+#include <assets/cooked_texture_loader.h>
+#include <assets/obj_loader.h>
+#include <audio/audio_manager.h>
+#include <graphics/image_data.h>
+#include <graphics/texture.h>
+#include <graphics/model.h>
+#include <graphics/mesh.h>
+#include <graphics/primitive.h>
+#include <graphics/vertex_buffer.h>
+#include <graphics/index_buffer.h>
+#include <graphics/font.h>
+#include <graphics/scene.h>
+#include <system/file.h>
+#include <system/platform.h>
+#include <system/debug_log.h>
+#include <string>
+
+namespace gef
+{
+	static UInt32 GetMeshSize(const Mesh* mesh)
+	{
+		if(mesh == NULL)
+			return 0;
+
+		UInt32 size = 0;
+		if(mesh->vertex_buffer())
+			size += mesh->vertex_buffer()->num_vertices()*mesh->vertex_buffer()->vertex_byte_size();
+		for(UInt32 primitive_num = 0; primitive_num < mesh->num_primitives(); ++primitive_num)
+		{
+			const IndexBuffer* index_buffer = mesh->GetPrimitive(primitive_num)->index_buffer();
+			if(index_buffer)
+				size += index_buffer->num_indices()*index_buffer->index_byte_size();
+		}
+		return size;
+	}
+
+	static UInt32 GetSceneSize(const Scene& scene)
+	{
+		UInt32 size = 0;
+		for(std::vector<MeshData*>::const_iterator mesh_iter = scene.meshes.begin(); mesh_iter != scene.meshes.end(); ++mesh_iter)
+		{
+			size += (*mesh_iter)->vertex_data.num_vertices*(*mesh_iter)->vertex_data.vertex_byte_size;
+			for(std::vector<PrimitiveData*>::const_iterator prim_iter = (*mesh_iter)->primitives.begin(); prim_iter != (*mesh_iter)->primitives.end(); ++prim_iter)
+				size += (*prim_iter)->num_indices*(*prim_iter)->index_byte_size;
+		}
+		for(std::vector<Texture*>::const_iterator texture_iter = scene.textures.begin(); texture_iter != scene.textures.end(); ++texture_iter)
+			size += *texture_iter ? (*texture_iter)->data_size() : 0;
+		return size;
+	}
+
+	ResourceCache::ResourceCache(Platform& platform, const UInt32 memory_budget) :
+		platform_(platform),
+		audio_manager_(NULL),
+		memory_budget_(memory_budget),
+		memory_used_(0),
+		lru_head_(NULL),
+		lru_tail_(NULL)
+	{
+	}
+
+	ResourceCache::~ResourceCache()
+	{
+		for(Int32 type = 0; type < RT_NUM_TYPES; ++type)
+		{
+			for(StringIdMap<ResourceEntry*>::iterator entry_iter = entries_[type].begin(); entry_iter != entries_[type].end(); ++entry_iter)
+			{
+				ResourceEntry* entry = entry_iter->second;
+				if(entry->ref_count > 0)
+					DebugOut("ResourceCache: resource 0x%08x still has %d references\n", entry->name_id, entry->ref_count);
+				DestroyResource(entry);
+				delete entry;
+			}
+			entries_[type].clear();
+		}
+	}
+
+	ResourceEntry* ResourceCache::Acquire(const StringId name_id, const ResourceType type)
+	{
+		StringIdMap<ResourceEntry*>::iterator entry_iter = entries_[type].find(name_id);
+		if(entry_iter == entries_[type].end())
+			return NULL;
+
+		AddReference(entry_iter->second);
+		return entry_iter->second;
+	}
+
+	ResourceEntry* ResourceCache::AddEntry(const StringId name_id, const ResourceType type, void* resource, const UInt32 size)
+	{
+		ResourceEntry* entry = new ResourceEntry();
+		entry->name_id = name_id;
+		entry->type = type;
+		entry->resource = resource;
+		entry->sample_id = -1;
+		entry->size = size;
+		entry->ref_count = 1;
+		entry->cache = this;
+		entry->lru_prev = NULL;
+		entry->lru_next = NULL;
+		entries_[type][name_id] = entry;
+
+		memory_used_ += size;
+		Trim();
+		return entry;
+	}
+
+	void ResourceCache::AddReference(ResourceEntry* entry)
+	{
+		if(entry->ref_count++ > 0)
+			return;
+
+		// back in use, so off the least recently used list
+		if(entry->lru_prev)
+			entry->lru_prev->lru_next = entry->lru_next;
+		else
+			lru_head_ = entry->lru_next;
+		if(entry->lru_next)
+			entry->lru_next->lru_prev = entry->lru_prev;
+		else
+			lru_tail_ = entry->lru_prev;
+		entry->lru_prev = NULL;
+		entry->lru_next = NULL;
+	}
+
+	void ResourceCache::RemoveReference(ResourceEntry* entry)
+	{
+		if(--entry->ref_count > 0)
+			return;
+
+		entry->lru_prev = lru_tail_;
+		entry->lru_next = NULL;
+		if(lru_tail_)
+			lru_tail_->lru_next = entry;
+		else
+			lru_head_ = entry;
+		lru_tail_ = entry;
+
+		Trim();
+	}
+
+	void ResourceCache::Trim()
+	{
+		if(memory_budget_ == 0)
+			return;
+
+		while((memory_used_ > memory_budget_) && lru_head_)
+			Evict(lru_head_);
+	}
+
+	void ResourceCache::Purge()
+	{
+		while(lru_head_)
+			Evict(lru_head_);
+	}
+
+	void ResourceCache::set_memory_budget(const UInt32 memory_budget)
+	{
+		memory_budget_ = memory_budget;
+		Trim();
+	}
+
+	UInt32 ResourceCache::num_resources() const
+	{
+		UInt32 num_resources = 0;
+		for(Int32 type = 0; type < RT_NUM_TYPES; ++type)
+			num_resources += (UInt32)entries_[type].size();
+		return num_resources;
+	}
+
+	void ResourceCache::Evict(ResourceEntry* entry)
+	{
+		// only unreferenced entries are evicted and they are always on the list
+		ResourceEntry* lru_next = entry->lru_next;
+		ResourceEntry* lru_prev = entry->lru_prev;
+		if(lru_prev)
+			lru_prev->lru_next = lru_next;
+		else
+			lru_head_ = lru_next;
+		if(lru_next)
+			lru_next->lru_prev = lru_prev;
+		else
+			lru_tail_ = lru_prev;
+
+		entries_[entry->type].erase(entry->name_id);
+		memory_used_ -= entry->size;
+		DestroyResource(entry);
+		delete entry;
+	}
+
+	void ResourceCache::DestroyResource(ResourceEntry* entry)
+	{
+		switch(entry->type)
+		{
+		case RT_TEXTURE:
+			delete static_cast<Texture*>(entry->resource);
+			break;
+		case RT_MODEL:
+			delete static_cast<Model*>(entry->resource);
+			break;
+		case RT_FONT:
+			delete static_cast<Font*>(entry->resource);
+			break;
+		case RT_SCENE:
+			delete static_cast<Scene*>(entry->resource);
+			break;
+		case RT_SAMPLE:
+			if(audio_manager_)
+				audio_manager_->UnloadSample(entry->sample_id);
+			break;
+		default:
+			break;
+		}
+		entry->resource = NULL;
+	}
+
+	TextureHandle ResourceCache::LoadTexture(const char* filename)
+	{
+		const StringId name_id = GetStringId(filename);
+		ResourceEntry* entry = Acquire(name_id, RT_TEXTURE);
+		if(entry)
+			return TextureHandle(entry);
+
+		ImageData image_data;
+		if(IsCookedTextureFilename(filename))
+		{
+			CookedTextureLoader cooked_texture_loader;
+			cooked_texture_loader.Load(filename, platform_, image_data);
+		}
+		else
+		{
+			PNGLoader png_loader;
+			png_loader.Load(filename, platform_, image_data);
+		}
+
+		if(image_data.image() == NULL)
+			return TextureHandle();
+
+		Texture* texture = Texture::Create(platform_, image_data);
+		if(texture == NULL)
+			return TextureHandle();
+
+		return TextureHandle(AddEntry(name_id, RT_TEXTURE, texture, texture->data_size()));
+	}
+
+	ModelHandle ResourceCache::LoadModel(const char* filename)
+	{
+		const StringId name_id = GetStringId(filename);
+		ResourceEntry* entry = Acquire(name_id, RT_MODEL);
+		if(entry)
+			return ModelHandle(entry);
+
+		Model* model = new Model();
+		OBJLoader obj_loader;
+		if(!obj_loader.Load(filename, platform_, *model))
+		{
+			delete model;
+			return ModelHandle();
+		}
+
+		UInt32 size = GetMeshSize(model->mesh());
+		for(std::vector<Texture*>::const_iterator texture_iter = model->textures().begin(); texture_iter != model->textures().end(); ++texture_iter)
+			size += *texture_iter ? (*texture_iter)->data_size() : 0;
+
+		return ModelHandle(AddEntry(name_id, RT_MODEL, model, size));
+	}
+
+	FontHandle ResourceCache::LoadFont(const char* font_name)
+	{
+		const StringId name_id = GetStringId(font_name);
+		ResourceEntry* entry = Acquire(name_id, RT_FONT);
+		if(entry)
+			return FontHandle(entry);
+
+		Font* font = new Font(platform_);
+		if(!font->Load(font_name))
+		{
+			delete font;
+			return FontHandle();
+		}
+
+		const UInt32 size = font->font_texture() ? font->font_texture()->data_size() : 0;
+		return FontHandle(AddEntry(name_id, RT_FONT, font, size));
+	}
+
+	SceneHandle ResourceCache::LoadScene(const char* filename)
+	{
+		const StringId name_id = GetStringId(filename);
+		ResourceEntry* entry = Acquire(name_id, RT_SCENE);
+		if(entry)
+			return SceneHandle(entry);
+
+		Scene* scene = new Scene();
+		if(!scene->ReadSceneFromFile(platform_, filename))
+		{
+			delete scene;
+			return SceneHandle();
+		}
+		scene->CreateMaterials(platform_);
+
+		return SceneHandle(AddEntry(name_id, RT_SCENE, scene, GetSceneSize(*scene)));
+	}
+
+	SampleHandle ResourceCache::LoadSample(const char* filename)
+	{
+		const StringId name_id = GetStringId(filename);
+		ResourceEntry* entry = Acquire(name_id, RT_SAMPLE);
+		if(entry)
+			return SampleHandle(entry);
+
+		if(audio_manager_ == NULL)
+			return SampleHandle();
+
+		const Int32 sample_id = audio_manager_->LoadSample(filename, platform_);
+		if(sample_id < 0)
+			return SampleHandle();
+
+		Int32 size = 0;
+		File* file = File::Create();
+		if(file->Open(filename))
+		{
+			file->GetSize(size);
+			file->Close();
+		}
+		delete file;
+
+		entry = AddEntry(name_id, RT_SAMPLE, NULL, (UInt32)size);
+		entry->sample_id = sample_id;
+		entry->resource = &entry->sample_id;
+		return SampleHandle(entry);
+	}
+}
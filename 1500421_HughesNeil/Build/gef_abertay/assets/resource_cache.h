@@ -0,0 +1,172 @@
+#ifndef _GEF_RESOURCE_CACHE_H
+#define _GEF_RESOURCE_CACHE_H
+
+#include <gef.h>
+#include <system/string_id.h>
+#include <system/string_id_map.h>
+#include <cstddef>
+
+namespace gef
+{
+	class Platform;
+	class AudioManager;
+	class Texture;
+	class Model;
+	class Font;
+	class Scene;
+	class ResourceCache;
+
+	enum ResourceType
+	{
+		RT_TEXTURE = 0,
+		RT_MODEL,
+		RT_FONT,
+		RT_SCENE,
+		RT_SAMPLE,
+		RT_NUM_TYPES
+	};
+
+	// one resident resource, shared by every handle to it
+	// entries with no handles are kept on a least recently used list until they are evicted
+	struct ResourceEntry
+	{
+		StringId name_id;
+		ResourceType type;
+		void* resource;
+		Int32 sample_id;
+		UInt32 size;
+		Int32 ref_count;
+		ResourceCache* cache;
+		ResourceEntry* lru_prev;
+		ResourceEntry* lru_next;
+	};
+
+	// a counted reference to a cached resource
+	// the resource stays loaded while any handle to it exists
+	// handles must be released before the cache they came from is deleted
+	template <class T>
+	class ResourceHandle
+	{
+	public:
+		ResourceHandle() : entry_(NULL) {}
+		ResourceHandle(const ResourceHandle& handle);
+		~ResourceHandle() { Release(); }
+		ResourceHandle& operator=(const ResourceHandle& handle);
+
+		void Release();
+
+		inline T* get() const { return entry_ ? static_cast<T*>(entry_->resource) : NULL; }
+		inline T* operator->() const { return get(); }
+		inline T& operator*() const { return *get(); }
+		inline bool valid() const { return entry_ != NULL; }
+		inline StringId name_id() const { return entry_ ? entry_->name_id : 0; }
+
+	private:
+		friend class ResourceCache;
+		explicit ResourceHandle(ResourceEntry* entry);
+
+		ResourceEntry* entry_;
+	};
+
+	typedef ResourceHandle<Texture> TextureHandle;
+	typedef ResourceHandle<Model> ModelHandle;
+	typedef ResourceHandle<Font> FontHandle;
+	typedef ResourceHandle<Scene> SceneHandle;
+	// dereferences to the sample number to pass to the AudioManager
+	typedef ResourceHandle<const Int32> SampleHandle;
+
+	// loads each resource once, keyed by the StringId of its filename and its type
+	// loading something that is already resident returns another handle to it, even if nothing else is using it
+	// resources nothing references are only freed when the cache is over its memory budget,
+	// least recently released first, or when Purge is called
+	// sizes are estimates of the memory the loaded resources use, samples are counted by their file size
+	class ResourceCache
+	{
+	public:
+		// a memory_budget of 0 keeps every unreferenced resource until Purge is called
+		ResourceCache(Platform& platform, const UInt32 memory_budget = 0);
+		~ResourceCache();
+
+		// png files are decoded, .tex files are read as cooked textures
+		TextureHandle LoadTexture(const char* filename);
+		// obj files
+		ModelHandle LoadModel(const char* filename);
+		// font_name is passed to Font::Load
+		FontHandle LoadFont(const char* font_name);
+		// scn files, with their materials created
+		SceneHandle LoadScene(const char* filename);
+		// samples are loaded by the audio manager set with set_audio_manager
+		SampleHandle LoadSample(const char* filename);
+
+		// frees every resource nothing references
+		void Purge();
+
+		void set_memory_budget(const UInt32 memory_budget);
+		inline UInt32 memory_budget() const { return memory_budget_; }
+		inline UInt32 memory_used() const { return memory_used_; }
+		UInt32 num_resources() const;
+
+		inline void set_audio_manager(AudioManager* audio_manager) { audio_manager_ = audio_manager; }
+		inline AudioManager* audio_manager() const { return audio_manager_; }
+
+	private:
+		template <class T> friend class ResourceHandle;
+
+		// returns the resident entry for name_id with a reference added, or NULL
+		ResourceEntry* Acquire(const StringId name_id, const ResourceType type);
+		ResourceEntry* AddEntry(const StringId name_id, const ResourceType type, void* resource, const UInt32 size);
+		void AddReference(ResourceEntry* entry);
+		void RemoveReference(ResourceEntry* entry);
+		void Trim();
+		void Evict(ResourceEntry* entry);
+		void DestroyResource(ResourceEntry* entry);
+
+		Platform& platform_;
+		AudioManager* audio_manager_;
+		// a map for each type as the same filename can be loaded as different types of resource
+		StringIdMap<ResourceEntry*> entries_[RT_NUM_TYPES];
+		UInt32 memory_budget_;
+		UInt32 memory_used_;
+
+		// unreferenced entries, oldest first
+		ResourceEntry* lru_head_;
+		ResourceEntry* lru_tail_;
+	};
+
+	template <class T>
+	ResourceHandle<T>::ResourceHandle(ResourceEntry* entry) :
+		entry_(entry)
+	{
+	}
+
+	template <class T>
+	ResourceHandle<T>::ResourceHandle(const ResourceHandle& handle) :
+		entry_(handle.entry_)
+	{
+		if(entry_)
+			entry_->cache->AddReference(entry_);
+	}
+
+	template <class T>
+	ResourceHandle<T>& ResourceHandle<T>::operator=(const ResourceHandle& handle)
+	{
+		if(handle.entry_)
+			handle.entry_->cache->AddReference(handle.entry_);
+		Release();
+		entry_ = handle.entry_;
+		return *this;
+	}
+
+	template <class T>
+	void ResourceHandle<T>::Release()
+	{
+		if(entry_)
+		{
+			ResourceEntry* entry = entry_;
+			entry_ = NULL;
+			entry->cache->RemoveReference(entry);
+		}
+	}
+}
+
+#endif // _GEF_RESOURCE_CACHE_H
@@ -0,0 +1,62 @@
+#include <graphics/batched_sprite_shader.h>
+#include <graphics/shader_interface.h>
+#include <graphics/sprite_batch.h>
+#include <maths/matrix44.h>
+
+namespace gef
+{
+	BatchedSpriteShader::BatchedSpriteShader(const Platform& platform)
+		:Shader(platform)
+		,projection_matrix_variable_index_(-1)
+		,texture_sampler_index_(-1)
+		,created_(false)
+	{
+		bool success = true;
+
+		char* vs_shader_source = NULL;
+		Int32 vs_shader_source_length = 0;
+		success = LoadShader("batched_sprite_shader_vs", "shaders/gef", &vs_shader_source, vs_shader_source_length, platform);
+
+		char* ps_shader_source = NULL;
+		Int32 ps_shader_source_length = 0;
+		success = LoadShader("batched_sprite_shader_ps", "shaders/gef", &ps_shader_source, ps_shader_source_length, platform) && success;
+
+		device_interface_->SetVertexShaderSource(vs_shader_source, vs_shader_source_length);
+		device_interface_->SetPixelShaderSource(ps_shader_source, ps_shader_source_length);
+
+		delete[] vs_shader_source;
+		vs_shader_source = NULL;
+		delete[] ps_shader_source;
+		ps_shader_source = NULL;
+
+		projection_matrix_variable_index_ = device_interface_->AddVertexShaderVariable("proj_matrix", ShaderInterface::kMatrix44);
+		texture_sampler_index_ = device_interface_->AddTextureSampler("texture_sampler");
+
+		device_interface_->AddVertexParameter("position", ShaderInterface::kVector3, 0, "POSITION", 0);
+		device_interface_->AddVertexParameter("uv", ShaderInterface::kVector2, 12, "TEXCOORD", 0);
+		device_interface_->AddVertexParameter("colour", ShaderInterface::kUByte4Norm, 20, "COLOR", 0);
+		device_interface_->set_vertex_size(sizeof(SpriteBatchVertex));
+
+		device_interface_->CreateVertexFormat();
+
+		if(success)
+			success = device_interface_->CreateProgram();
+		created_ = success;
+	}
+
+	BatchedSpriteShader::~BatchedSpriteShader()
+	{
+	}
+
+	void BatchedSpriteShader::SetSceneData(const Matrix44& projection_matrix)
+	{
+		Matrix44 projectionT;
+		projectionT.Transpose(projection_matrix);
+		device_interface_->SetVertexShaderVariable(projection_matrix_variable_index_, &projectionT);
+	}
+
+	void BatchedSpriteShader::SetTexture(const Texture* texture)
+	{
+		device_interface_->SetTextureSampler(texture_sampler_index_, texture);
+	}
+}
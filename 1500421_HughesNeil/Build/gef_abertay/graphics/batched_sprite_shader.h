@@ -0,0 +1,32 @@
+#ifndef _GEF_BATCHED_SPRITE_SHADER_H
+#define _GEF_BATCHED_SPRITE_SHADER_H
+
+#include <graphics/shader.h>
+#include <gef.h>
+
+namespace gef
+{
+	class Matrix44;
+	class Texture;
+
+	// draws sprites whose corners have already been transformed into SpriteBatchVertex data
+	// so only the projection and texture change between draws
+	class BatchedSpriteShader : public Shader
+	{
+	public:
+		BatchedSpriteShader(const Platform& platform);
+		~BatchedSpriteShader();
+
+		void SetSceneData(const Matrix44& projection_matrix);
+		void SetTexture(const Texture* texture);
+
+		// false if the shaders couldn't be loaded or the program couldn't be created
+		inline bool created() const { return created_; }
+	protected:
+		Int32 projection_matrix_variable_index_;
+		Int32 texture_sampler_index_;
+		bool created_;
+	};
+}
+
+#endif // _GEF_BATCHED_SPRITE_SHADER_H
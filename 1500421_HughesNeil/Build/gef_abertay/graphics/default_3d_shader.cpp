@@ -17,7 +17,7 @@
 
 namespace gef
 {
-	Default3DShader::Default3DShader(const Platform& platform)
+	Default3DShader::Default3DShader(const Platform& platform, const bool packed_vertices)
 	:Shader(platform)
 	,wvp_matrix_variable_index_(-1)
 	,world_matrix_variable_index_(-1)
@@ -60,10 +60,20 @@ namespace gef
 
 		texture_sampler_index_ = device_interface_->AddTextureSampler("texture_sampler");
 
-		device_interface_->AddVertexParameter("position", ShaderInterface::kVector3, 0, "POSITION", 0);
-		device_interface_->AddVertexParameter("normal", ShaderInterface::kVector3, 12, "NORMAL", 0);
-		device_interface_->AddVertexParameter("uv", ShaderInterface::kVector2, 24, "TEXCOORD", 0);
-		device_interface_->set_vertex_size(sizeof(Mesh::Vertex));
+		if(packed_vertices)
+		{
+			device_interface_->AddVertexParameter("position", ShaderInterface::kShort4Norm, 0, "POSITION", 0);
+			device_interface_->AddVertexParameter("normal", ShaderInterface::kByte4Norm, 8, "NORMAL", 0);
+			device_interface_->AddVertexParameter("uv", ShaderInterface::kHalf2, 12, "TEXCOORD", 0);
+			device_interface_->set_vertex_size(sizeof(Mesh::PackedVertex));
+		}
+		else
+		{
+			device_interface_->AddVertexParameter("position", ShaderInterface::kVector3, 0, "POSITION", 0);
+			device_interface_->AddVertexParameter("normal", ShaderInterface::kVector3, 12, "NORMAL", 0);
+			device_interface_->AddVertexParameter("uv", ShaderInterface::kVector2, 24, "TEXCOORD", 0);
+			device_interface_->set_vertex_size(sizeof(Mesh::Vertex));
+		}
 		device_interface_->CreateVertexFormat();
 
 		success = device_interface_->CreateProgram();
@@ -126,19 +136,24 @@ namespace gef
 
 	void Default3DShader::SetMeshData(const gef::MeshInstance& mesh_instance)
 	{
+		// packed vertex positions need scaling back into mesh space first
+		gef::Matrix44 world = mesh_instance.transform();
+		if(mesh_instance.mesh() && mesh_instance.mesh()->has_position_transform())
+			world = mesh_instance.mesh()->position_transform() * mesh_instance.transform();
+
 		// calculate world view projection matrix
-		gef::Matrix44 wvp = mesh_instance.transform() * view_projection_matrix_;
+		gef::Matrix44 wvp = world * view_projection_matrix_;
 
 		// calculate the transpose of inverse world matrix to transform normals in shader
 		Matrix44 inv_world;
-		inv_world.Inverse(mesh_instance.transform());
+		inv_world.Inverse(world);
 		//inv_world_transpose_matrix.Transpose(inv_world);
 
 		// take transpose of matrices for the shaders
 		gef::Matrix44 wvpT, worldT;
 
 		wvpT.Transpose(wvp);
-		worldT.Transpose(mesh_instance.transform());
+		worldT.Transpose(world);
 		// taking the transpose of the inverse world transpose matrix, just give use the inverse world matrix
 		// no need to waste calculating that here
 
@@ -43,7 +43,8 @@ namespace gef
 			const gef::Texture* material_texture;
 		};
 
-		Default3DShader(const Platform& platform);
+		// packed_vertices uses the Mesh::PackedVertex format instead of Mesh::Vertex
+		Default3DShader(const Platform& platform, const bool packed_vertices = false);
 		virtual ~Default3DShader();
 		//void SetSceneData(const Matrix44& wvp_matrix);
 		//void SetSpriteData(const Sprite& sprite, const Texture* texture);
@@ -17,7 +17,7 @@
 
 namespace gef
 {
-	Default3DSkinningShader::Default3DSkinningShader(const Platform& platform)
+	Default3DSkinningShader::Default3DSkinningShader(const Platform& platform, const bool packed_vertices)
 	:Shader(platform)
 	,wvp_matrix_variable_index_(-1)
 	,world_matrix_variable_index_(-1)
@@ -28,6 +28,7 @@ namespace gef
 	,light_colour_variable_index_(-1)
 	,texture_sampler_index_(-1)
 	,bone_matrices_variable_index_(-1)
+	,num_bone_matrices_(0)
 	{
 		bool success = true;
 
@@ -62,12 +63,24 @@ namespace gef
 
 		texture_sampler_index_ = device_interface_->AddTextureSampler("texture_sampler");
 
-		device_interface_->AddVertexParameter("position", ShaderInterface::kVector3, 0, "POSITION", 0);
-		device_interface_->AddVertexParameter("normal", ShaderInterface::kVector3, 12, "NORMAL", 0);
-		device_interface_->AddVertexParameter("bone_indices", ShaderInterface::kUByte4, 24, "BLENDINDICES", 0);
-		device_interface_->AddVertexParameter("bone_weights", ShaderInterface::kVector4, 28, "BLENDWEIGHT", 0);
-		device_interface_->AddVertexParameter("uv", ShaderInterface::kVector2, 44, "TEXCOORD", 0);
-		device_interface_->set_vertex_size(sizeof(Mesh::SkinnedVertex));
+		if(packed_vertices)
+		{
+			device_interface_->AddVertexParameter("position", ShaderInterface::kShort4Norm, 0, "POSITION", 0);
+			device_interface_->AddVertexParameter("normal", ShaderInterface::kByte4Norm, 8, "NORMAL", 0);
+			device_interface_->AddVertexParameter("bone_indices", ShaderInterface::kUByte4, 12, "BLENDINDICES", 0);
+			device_interface_->AddVertexParameter("bone_weights", ShaderInterface::kUByte4Norm, 16, "BLENDWEIGHT", 0);
+			device_interface_->AddVertexParameter("uv", ShaderInterface::kHalf2, 20, "TEXCOORD", 0);
+			device_interface_->set_vertex_size(sizeof(Mesh::PackedSkinnedVertex));
+		}
+		else
+		{
+			device_interface_->AddVertexParameter("position", ShaderInterface::kVector3, 0, "POSITION", 0);
+			device_interface_->AddVertexParameter("normal", ShaderInterface::kVector3, 12, "NORMAL", 0);
+			device_interface_->AddVertexParameter("bone_indices", ShaderInterface::kUByte4, 24, "BLENDINDICES", 0);
+			device_interface_->AddVertexParameter("bone_weights", ShaderInterface::kVector4, 28, "BLENDWEIGHT", 0);
+			device_interface_->AddVertexParameter("uv", ShaderInterface::kVector2, 44, "TEXCOORD", 0);
+			device_interface_->set_vertex_size(sizeof(Mesh::SkinnedVertex));
+		}
 		device_interface_->CreateVertexFormat();
 
 		success = device_interface_->CreateProgram();
@@ -82,6 +95,7 @@ namespace gef
 		, ambient_light_colour_variable_index_(-1)
 		, light_colour_variable_index_(-1)
 		, texture_sampler_index_(-1)
+		, num_bone_matrices_(0)
 	{
 	}
 
@@ -131,7 +145,8 @@ namespace gef
 			for (std::vector<gef::Matrix44>::const_iterator matrix_iter = shader_data.bone_matrices()->begin(); matrix_iter != shader_data.bone_matrices()->end(); ++matrix_iter, ++matrix_index)
 				mesh_data_.bones_matrices[matrix_index].Transpose((*matrix_iter));
 
-			device_interface_->SetVertexShaderVariable(bone_matrices_variable_index_, (float*)&mesh_data_.bones_matrices[0], (Int32)shader_data.bone_matrices()->size());
+			num_bone_matrices_ = (Int32)shader_data.bone_matrices()->size();
+			device_interface_->SetVertexShaderVariable(bone_matrices_variable_index_, (float*)&mesh_data_.bones_matrices[0], num_bone_matrices_);
 		}
 
 		device_interface_->SetPixelShaderVariable(ambient_light_colour_variable_index_, (float*)&ambient_light_colour);
@@ -140,6 +155,20 @@ namespace gef
 
 	void Default3DSkinningShader::SetMeshData(const gef::MeshInstance& mesh_instance)
 	{
+		// packed vertex positions are scaled back into mesh space before skinning
+		// the bone matrices are transposed so the position transform goes on the right
+		if((bone_matrices_variable_index_ != -1) && mesh_instance.mesh() && mesh_instance.mesh()->has_position_transform())
+		{
+			Matrix44 position_transformT;
+			position_transformT.Transpose(mesh_instance.mesh()->position_transform());
+
+			Matrix44 bone_matrices[MAX_NUM_BONE_MATRICES];
+			for(Int32 matrix_index = 0; matrix_index < num_bone_matrices_; ++matrix_index)
+				bone_matrices[matrix_index] = mesh_data_.bones_matrices[matrix_index] * position_transformT;
+
+			device_interface_->SetVertexShaderVariable(bone_matrices_variable_index_, (float*)&bone_matrices[0], num_bone_matrices_);
+		}
+
 		// calculate world view projection matrix
 		gef::Matrix44 wvp = mesh_instance.transform() * view_projection_matrix_;
 
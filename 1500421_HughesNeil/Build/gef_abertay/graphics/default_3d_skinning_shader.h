@@ -45,7 +45,8 @@ namespace gef
 			const gef::Texture* material_texture;
 		};
 
-		Default3DSkinningShader(const Platform& platform);
+		// packed_vertices uses the Mesh::PackedSkinnedVertex format instead of Mesh::SkinnedVertex
+		Default3DSkinningShader(const Platform& platform, const bool packed_vertices = false);
 		virtual ~Default3DSkinningShader();
 		//void SetSceneData(const Matrix44& wvp_matrix);
 		//void SetSpriteData(const Sprite& sprite, const Texture* texture);
@@ -70,6 +71,7 @@ namespace gef
 		Int32 texture_sampler_index_;
 
 		MeshData mesh_data_;
+		Int32 num_bone_matrices_;
 		PrimitiveData primitive_data_;
 
 		gef::Matrix44 view_projection_matrix_;
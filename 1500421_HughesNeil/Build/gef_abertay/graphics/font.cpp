@@ -7,9 +7,8 @@
 #include <graphics/image_data.h>
 #include <system/platform.h>
 #include <system/file.h>
-#include <system/memory_stream_buffer.h>
 //#include <fstream>
-#include <sstream>
+#include <algorithm>
 #include <cstdarg>
 #include <string>
 #include <cstdio>
@@ -22,6 +21,9 @@ namespace gef
 {
 
 Font::Font(Platform& platform) :
+	header_(NULL),
+	glyphs_(NULL),
+	kerning_pairs_(NULL),
 font_texture_(NULL),
 	platform_(platform)
 {
@@ -37,51 +39,49 @@ Font::~Font()
 	}
 }
 
-bool Font::Load(const char* font_name)
+bool Font::LoadFile(const char* filename, std::vector<UInt8>& file_data)
 {
-	std::string font_config_filename(font_name);
-	font_config_filename += ".fnt";
-	void* font_file_data = NULL;
-	Int32 file_size = 0;
 	gef::File* file = gef::File::Create();
-	
-	bool success = true;
-	success = file->Open(font_config_filename.c_str());
+
+	bool success = file->Open(filename);
 	if(success)
 	{
-		success = file->GetSize(file_size);
+		Int32 file_size = 0;
+		success = file->GetSize(file_size) && (file_size > 0);
 		if(success)
 		{
-			font_file_data = malloc(file_size);
-			success = font_file_data != NULL;
+			file_data.resize(file_size);
+			Int32 bytes_read;
+			success = file->Read(&file_data[0], file_size, bytes_read);
 			if(success)
-			{
-				Int32 bytes_read;
-				success = file->Read(font_file_data, file_size, bytes_read);
-				if(success)
-					success = bytes_read == file_size;
-			}
+				success = bytes_read == file_size;
 		}
 		file->Close();
-		delete file;
-		file = NULL;
 	}
+	delete file;
 
+	return success;
+}
 
+bool Font::Load(const char* font_name)
+{
+	// compiled fonts are read straight into the font data
+	std::string font_config_filename(font_name);
+	font_config_filename += kCompiledFontExtension;
+	bool config_initialised = LoadFile(font_config_filename.c_str(), font_data_) && SetFontData();
 
-	bool config_initialised = false;
-
-	if(success)
+	if(!config_initialised)
 	{
-		gef::MemoryStreamBuffer font_buffer((char*)font_file_data, file_size);
-
-		std::istream font_config_stream(&font_buffer);
-		config_initialised = ParseFont(font_config_stream, character_set);
+		font_config_filename = font_name;
+		font_config_filename += ".fnt";
 
-		// don't need the font file data any more
-		free(font_file_data);
-		font_file_data = NULL;
+		std::vector<UInt8> font_file_data;
+		if(LoadFile(font_config_filename.c_str(), font_file_data))
+			config_initialised = CompileFont((const char*)&font_file_data[0], (Int32)font_file_data.size(), font_data_) && SetFontData();
+	}
 
+	if(config_initialised)
+	{
 		std::string font_texture_filename(font_name);
 		font_texture_filename += "_0.png";
 		PNGLoader png_loader;
@@ -94,83 +94,103 @@ bool Font::Load(const char* font_name)
 	return config_initialised;
 }
 
+bool Font::SetFontData()
+{
+	header_ = NULL;
+	glyphs_ = NULL;
+	kerning_pairs_ = NULL;
+
+	if(font_data_.empty() || !ValidateFontData(&font_data_[0], (UInt32)font_data_.size()))
+		return false;
+
+	header_ = reinterpret_cast<const FontFileHeader*>(&font_data_[0]);
+	glyphs_ = reinterpret_cast<const FontGlyph*>(&font_data_[header_->glyphs_offset]);
+	kerning_pairs_ = reinterpret_cast<const FontKerningPair*>(&font_data_[header_->kerning_pairs_offset]);
+
+	// the glyphs are sorted so the ones in the table come first
+	for(UInt32 character = 0; character < kFontTableGlyphs; ++character)
+		table_glyphs_[character] = -1;
+	for(UInt32 glyph_num = 0; (glyph_num < header_->num_glyphs) && (glyphs_[glyph_num].id < kFontTableGlyphs); ++glyph_num)
+		table_glyphs_[glyphs_[glyph_num].id] = (Int16)glyph_num;
+
+	return true;
+}
+
+static bool GlyphIdLess(const FontGlyph& glyph, const UInt32 id)
+{
+	return glyph.id < id;
+}
+
+const FontGlyph* Font::GetGlyph(const UInt32 character) const
+{
+	if(header_ == NULL)
+		return NULL;
+
+	if(character < kFontTableGlyphs)
+		return table_glyphs_[character] >= 0 ? &glyphs_[table_glyphs_[character]] : NULL;
+
+	const FontGlyph* glyphs_end = glyphs_ + header_->num_glyphs;
+	const FontGlyph* glyph = std::lower_bound(glyphs_, glyphs_end, character, GlyphIdLess);
+	return ((glyph != glyphs_end) && (glyph->id == character)) ? glyph : NULL;
+}
+
+static bool KerningPairLess(const FontKerningPair& kerning_pair, const FontKerningPair& key)
+{
+	return (kerning_pair.first < key.first) || ((kerning_pair.first == key.first) && (kerning_pair.second < key.second));
+}
 
-bool Font::ParseFont( std::istream& Stream, Font::Charset& CharsetDesc )
+Int32 Font::GetKerning(const UInt32 first, const UInt32 second) const
 {
-	std::string Line;
-	std::string Read, Key, Value;
-	std::size_t i;
-	while( !Stream.eof() )
+	if((header_ == NULL) || (header_->num_kerning_pairs == 0))
+		return 0;
+
+	FontKerningPair key;
+	key.first = first;
+	key.second = second;
+	key.amount = 0;
+
+	const FontKerningPair* kerning_pairs_end = kerning_pairs_ + header_->num_kerning_pairs;
+	const FontKerningPair* kerning_pair = std::lower_bound(kerning_pairs_, kerning_pairs_end, key, KerningPairLess);
+	return ((kerning_pair != kerning_pairs_end) && (kerning_pair->first == first) && (kerning_pair->second == second)) ? kerning_pair->amount : 0;
+}
+
+UInt32 ReadUTF8Character(const char*& text)
+{
+	const UInt8* bytes = reinterpret_cast<const UInt8*>(text);
+	const UInt8 lead_byte = bytes[0];
+
+	Int32 num_continuation_bytes = 0;
+	UInt32 character = lead_byte;
+	if((lead_byte & 0xe0) == 0xc0)
+	{
+		num_continuation_bytes = 1;
+		character = lead_byte & 0x1f;
+	}
+	else if((lead_byte & 0xf0) == 0xe0)
 	{
-		std::stringstream LineStream;
-		std::getline( Stream, Line );
-		LineStream << Line;
+		num_continuation_bytes = 2;
+		character = lead_byte & 0x0f;
+	}
+	else if((lead_byte & 0xf8) == 0xf0)
+	{
+		num_continuation_bytes = 3;
+		character = lead_byte & 0x07;
+	}
 
-		//read the line's type
-		LineStream >> Read;
-		if( Read == "common" )
-		{
-			//this holds common data
-			while( !LineStream.eof() )
-			{
-				std::stringstream Converter;
-				LineStream >> Read;
-				i = Read.find( '=' );
-				Key = Read.substr( 0, i );
-				Value = Read.substr( i + 1 );
-
-				//assign the correct value
-				Converter << Value;
-				if( Key == "lineHeight" )
-					Converter >> CharsetDesc.LineHeight;
-				else if( Key == "base" )
-					Converter >> CharsetDesc.Base;
-				else if( Key == "scaleW" )
-					Converter >> CharsetDesc.Width;
-				else if( Key == "scaleH" )
-					Converter >> CharsetDesc.Height;
-				else if( Key == "pages" )
-					Converter >> CharsetDesc.Pages;
-			}
-		}
-		else if( Read == "char" )
+	// stops at the terminator as it isn't a continuation byte
+	for(Int32 byte_num = 1; byte_num <= num_continuation_bytes; ++byte_num)
+	{
+		if((bytes[byte_num] & 0xc0) != 0x80)
 		{
-			//this is data for a specific char
-			unsigned short CharID = 0;
-
-			while( !LineStream.eof() )
-			{
-				std::stringstream Converter;
-				LineStream >> Read;
-				i = Read.find( '=' );
-				Key = Read.substr( 0, i );
-				Value = Read.substr( i + 1 );
-
-				//assign the correct value
-				Converter << Value;
-				if( Key == "id" )
-					Converter >> CharID;
-				else if( Key == "x" )
-					Converter >> CharsetDesc.Chars[CharID].x;
-				else if( Key == "y" )
-					Converter >> CharsetDesc.Chars[CharID].y;
-				else if( Key == "width" )
-					Converter >> CharsetDesc.Chars[CharID].Width;
-				else if( Key == "height" )
-					Converter >> CharsetDesc.Chars[CharID].Height;
-				else if( Key == "xoffset" )
-					Converter >> CharsetDesc.Chars[CharID].XOffset;
-				else if( Key == "yoffset" )
-					Converter >> CharsetDesc.Chars[CharID].YOffset;
-				else if( Key == "xadvance" )
-					Converter >> CharsetDesc.Chars[CharID].XAdvance;
-				else if( Key == "page" )
-					Converter >> CharsetDesc.Chars[CharID].Page;
-			}
+			num_continuation_bytes = 0;
+			character = lead_byte;
+			break;
 		}
+		character = (character << 6) | (bytes[byte_num] & 0x3f);
 	}
 
-	return true;
+	text += 1 + num_continuation_bytes;
+	return character;
 }
 
 void Font::RenderText(SpriteRenderer* renderer, const class Vector4& pos, const float scale, const UInt32 colour, const TextJustification justification, const char* text, ...) const
@@ -182,9 +202,9 @@ void Font::RenderText(SpriteRenderer* renderer, const class Vector4& pos, const
 	char text_buffer[256];
 
 	va_start(args, text);
-	std::vsprintf(text_buffer, text, args);
+	std::vsnprintf(text_buffer, sizeof(text_buffer), text, args);
+	va_end(args);
 
-	UInt32 character_count = (UInt32)strlen(text_buffer);
 	float string_length = GetStringLength(text_buffer);
 
 	Vector2 cursor = Vector2(pos.x(), pos.y());
@@ -203,19 +223,21 @@ void Font::RenderText(SpriteRenderer* renderer, const class Vector4& pos, const
 
 	Sprite sprite;
 	sprite.set_texture(font_texture_);
-	for (UInt32 character_index = 0; character_index < character_count; ++character_index)
+	UInt32 previous_character = 0;
+	for(const char* character_text = text_buffer; *character_text; )
 	{
-		Int32 CharX = character_set.Chars[static_cast<UInt32>(text_buffer[character_index])].x;
-		Int32 CharY = character_set.Chars[static_cast<UInt32>(text_buffer[character_index])].y;
-		Int32 Width = character_set.Chars[static_cast<UInt32>(text_buffer[character_index])].Width;
-		Int32 Height = character_set.Chars[static_cast<UInt32>(text_buffer[character_index])].Height;
-		Int32 OffsetX = character_set.Chars[static_cast<UInt32>(text_buffer[character_index])].XOffset;
-		Int32 OffsetY = character_set.Chars[static_cast<UInt32>(text_buffer[character_index])].YOffset;
-
-		Vector2 uv_pos((float) CharX / (float) character_set.Width,  ((float) (CharY) / (float) character_set.Height));
-		Vector2 uv_size((float) (Width) / (float) character_set.Width, (float)(Height) / (float) character_set.Height);
-		Vector2 size(((float)Width)*scale, ((float)Height)*scale);
-		Vector4 sprite_position = Vector4(cursor.x+((float)OffsetX*scale)+size.x*0.5f, cursor.y + scale*((float)Height*0.5f +  (float)OffsetY), pos.z());
+		const UInt32 character = ReadUTF8Character(character_text);
+		cursor.x += ((float)GetKerning(previous_character, character))*scale;
+		previous_character = character;
+
+		const FontGlyph* glyph = GetGlyph(character);
+		if(glyph == NULL)
+			continue;
+
+		Vector2 uv_pos((float) glyph->x / (float) header_->width,  ((float) (glyph->y) / (float) header_->height));
+		Vector2 uv_size((float) (glyph->width) / (float) header_->width, (float)(glyph->height) / (float) header_->height);
+		Vector2 size(((float)glyph->width)*scale, ((float)glyph->height)*scale);
+		Vector4 sprite_position = Vector4(cursor.x+((float)glyph->x_offset*scale)+size.x*0.5f, cursor.y + scale*((float)glyph->height*0.5f +  (float)glyph->y_offset), pos.z());
 
 		sprite.set_position(sprite_position);
 		sprite.set_width(size.x);
@@ -225,7 +247,7 @@ void Font::RenderText(SpriteRenderer* renderer, const class Vector4& pos, const
 		sprite.set_uv_height(uv_size.y);
 		sprite.set_colour(colour);
 		renderer->DrawSprite(sprite);
-		cursor.x += ((float)character_set.Chars[static_cast<UInt32>(text_buffer[character_index])].XAdvance)*scale;
+		cursor.x += ((float)glyph->x_advance)*scale;
 	}
 }
 
@@ -234,11 +256,17 @@ float Font::GetStringLength(const char * text) const
 	float length = 0.0f;
 	if(text)
 	{
-		UInt32 string_length = (UInt32)strlen(text);
-
+		UInt32 previous_character = 0;
+		while(*text)
+		{
+			const UInt32 character = ReadUTF8Character(text);
+			length += (float)GetKerning(previous_character, character);
+			previous_character = character;
 
-		for( UInt32 character_index = 0; character_index < string_length; ++character_index )
-			length += ((float)character_set.Chars[static_cast<UInt32>(text[character_index])].XAdvance);
+			const FontGlyph* glyph = GetGlyph(character);
+			if(glyph)
+				length += (float)glyph->x_advance;
+		}
 	}
 
 	return length;
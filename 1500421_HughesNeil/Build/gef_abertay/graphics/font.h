@@ -2,7 +2,8 @@
 #define _GEF_FONT_H
 
 #include <gef.h>
-#include <istream>
+#include <assets/font_file.h>
+#include <vector>
 
 namespace gef
 {
@@ -19,43 +20,48 @@ namespace gef
 		TJ_RIGHT,
 	};
 
+	// returns the unicode character at text and moves text past it
+	// bytes that aren't part of valid utf-8 are returned as they are so latin-1 text still works
+	UInt32 ReadUTF8Character(const char*& text);
+
+	// glyphs for characters below this are found with a table rather than a search
+	const UInt32 kFontTableGlyphs = 256;
+
 	class Font
 	{
 	public:
 		Font(Platform& platform);
 		~Font();
+
+		// loads font_name.fnb if there is one, otherwise parses font_name.fnt
 		bool Load(const char* font_name);
 		void RenderText(SpriteRenderer* renderer, const Vector4& pos, const float scale, const UInt32 colour, const TextJustification justification, const char * text, ...) const;
 		float GetStringLength(const char * text) const;
 
-		inline Texture* font_texture() { return font_texture_; }
-	private:
-		struct CharDescriptor
-		{
-			//clean 16 bytes
-			Int32 x, y;
-			Int32 Width, Height;
-			Int32 XOffset, YOffset;
-			Int32 XAdvance;
-			Int32 Page;
+		// returns NULL if the font doesn't have the character
+		const FontGlyph* GetGlyph(const UInt32 character) const;
+
+		// extra space between two characters, usually negative to tuck them closer together
+		Int32 GetKerning(const UInt32 first, const UInt32 second) const;
 
-			CharDescriptor() : x( 0 ), y( 0 ), Width( 0 ), Height( 0 ), XOffset( 0 ), YOffset( 0 ),
-				XAdvance( 0 ), Page( 0 )
-			{ }
-		};
+		inline Texture* font_texture() const { return font_texture_; }
+		inline UInt32 num_glyphs() const { return header_ ? header_->num_glyphs : 0; }
+		inline UInt32 line_height() const { return header_ ? header_->line_height : 0; }
+		inline UInt32 base() const { return header_ ? header_->base : 0; }
+		inline UInt32 texture_width() const { return header_ ? header_->width : 0; }
+		inline UInt32 texture_height() const { return header_ ? header_->height : 0; }
 
-		struct Charset
-		{
-			UInt16 LineHeight;
-			UInt16 Base;
-			UInt16 Width, Height;
-			UInt16 Pages;
-			CharDescriptor Chars[256];
-		};
+	private:
+		bool LoadFile(const char* filename, std::vector<UInt8>& file_data);
+		bool SetFontData();
 
-		bool ParseFont( std::istream& Stream, Font::Charset& CharsetDesc );
+		// the compiled font, the glyph and kerning tables are used in place
+		std::vector<UInt8> font_data_;
+		const FontFileHeader* header_;
+		const FontGlyph* glyphs_;
+		const FontKerningPair* kerning_pairs_;
+		Int16 table_glyphs_[kFontTableGlyphs];
 
-		Charset character_set;
 		class Texture* font_texture_;
 
 		Platform& platform_;
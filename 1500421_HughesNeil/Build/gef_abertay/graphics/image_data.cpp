@@ -5,7 +5,11 @@ namespace gef
 {
 	ImageData::ImageData() :
 		image_(NULL),
-		clut_(NULL)
+		clut_(NULL),
+		width_(0),
+		height_(0),
+		format_(IF_RGBA8),
+		num_mips_(1)
 	{
 	}
 
@@ -14,4 +18,97 @@ namespace gef
 		delete image_;
 		delete clut_;
 	}
-}
\ No newline at end of file
+
+	UInt32 ImageData::GetMipWidth(const UInt32 mip_level) const
+	{
+		const UInt32 mip_width = width_ >> mip_level;
+		return mip_width > 0 ? mip_width : 1;
+	}
+
+	UInt32 ImageData::GetMipHeight(const UInt32 mip_level) const
+	{
+		const UInt32 mip_height = height_ >> mip_level;
+		return mip_height > 0 ? mip_height : 1;
+	}
+
+	UInt32 ImageData::GetMipPitch(const UInt32 mip_level) const
+	{
+		return GetFormatPitch(format_, GetMipWidth(mip_level));
+	}
+
+	UInt32 ImageData::GetMipDataSize(const UInt32 mip_level) const
+	{
+		return GetFormatDataSize(format_, GetMipWidth(mip_level), GetMipHeight(mip_level));
+	}
+
+	UInt32 ImageData::GetMipOffset(const UInt32 mip_level) const
+	{
+		UInt32 offset = 0;
+		for(UInt32 level = 0; level < mip_level; ++level)
+			offset += GetMipDataSize(level);
+		return offset;
+	}
+
+	UInt32 ImageData::GetDataSize() const
+	{
+		return GetMipOffset(num_mips_);
+	}
+
+	UInt32 ImageData::GetFormatPitch(const ImageFormat format, const UInt32 width)
+	{
+		switch(format)
+		{
+		case IF_BC1:
+			return ((width+3)/4)*8;
+		case IF_BC3:
+			return ((width+3)/4)*16;
+		case IF_RGBA8:
+		default:
+			return width*4;
+		}
+	}
+
+	UInt32 ImageData::GetFormatDataSize(const ImageFormat format, const UInt32 width, const UInt32 height)
+	{
+		const UInt32 num_rows = IsCompressedFormat(format) ? (height+3)/4 : height;
+		return GetFormatPitch(format, width)*num_rows;
+	}
+
+	bool ImageData::IsCompressedFormat(const ImageFormat format)
+	{
+		return (format == IF_BC1) || (format == IF_BC3);
+	}
+
+	UInt32 ImageData::CalculateMaxMips(const UInt32 width, const UInt32 height)
+	{
+		UInt32 num_mips = 1;
+		UInt32 size = width > height ? width : height;
+		while(size > 1)
+		{
+			size >>= 1;
+			++num_mips;
+		}
+		return num_mips;
+	}
+
+	bool ImageData::IsPowerOfTwo(const UInt32 value)
+	{
+		return (value != 0) && ((value & (value-1)) == 0);
+	}
+
+	UInt32 ImageData::NextPowerOfTwo(const UInt32 value)
+	{
+		// http://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2
+		UInt32 result = value;
+
+		result--;
+		result |= result >> 1;
+		result |= result >> 2;
+		result |= result >> 4;
+		result |= result >> 8;
+		result |= result >> 16;
+		result++;
+
+		return result;
+	}
+}
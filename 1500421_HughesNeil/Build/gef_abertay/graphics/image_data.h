@@ -5,6 +5,15 @@
 
 namespace gef
 {
+	enum ImageFormat
+	{
+		IF_RGBA8 = 0,
+		IF_BC1,			// 4x4 blocks of 8 bytes, opaque or 1 bit alpha
+		IF_BC3,			// 4x4 blocks of 16 bytes, BC1 colour with 8 bit alpha
+		IF_NUM_FORMATS
+	};
+
+	// the image holds every mip level one after the other, largest first
 	class ImageData
 	{
 	public:
@@ -19,12 +28,38 @@ namespace gef
 		void set_width(const UInt32 width) { width_ = width; }
 		const UInt32 height() const { return height_; }
 		void set_height(const UInt32 height) { height_ = height; }
+		const ImageFormat format() const { return format_; }
+		void set_format(const ImageFormat format) { format_ = format; }
+		const UInt32 num_mips() const { return num_mips_; }
+		void set_num_mips(const UInt32 num_mips) { num_mips_ = num_mips; }
+
+		UInt32 GetMipWidth(const UInt32 mip_level) const;
+		UInt32 GetMipHeight(const UInt32 mip_level) const;
+		UInt32 GetMipPitch(const UInt32 mip_level) const;
+		UInt32 GetMipDataSize(const UInt32 mip_level) const;
+		UInt32 GetMipOffset(const UInt32 mip_level) const;
+
+		// size of all the mip levels
+		UInt32 GetDataSize() const;
+
+		// the pitch of block compressed formats is the size of a row of blocks
+		static UInt32 GetFormatPitch(const ImageFormat format, const UInt32 width);
+		static UInt32 GetFormatDataSize(const ImageFormat format, const UInt32 width, const UInt32 height);
+		static bool IsCompressedFormat(const ImageFormat format);
+
+		// number of mip levels down to 1x1
+		static UInt32 CalculateMaxMips(const UInt32 width, const UInt32 height);
+
+		static bool IsPowerOfTwo(const UInt32 value);
+		static UInt32 NextPowerOfTwo(const UInt32 value);
 
 	private:
 		UInt8* image_;
 		UInt8* clut_;
 		UInt32 width_;
 		UInt32 height_;
+		ImageFormat format_;
+		UInt32 num_mips_;
 	};
 }
 
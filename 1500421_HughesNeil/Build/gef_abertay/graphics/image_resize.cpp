@@ -0,0 +1,202 @@
+#include <graphics/image_resize.h>
+#include <graphics/image_data.h>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+namespace gef
+{
+	static const float kPi = 3.14159265358979f;
+
+	static const float kBoxRadius = 0.5f;
+	static const float kLanczosRadius = 3.0f;
+
+	// kaiser window settings from the nvidia texture tools
+	static const float kKaiserRadius = 3.0f;
+	static const float kKaiserAlpha = 4.0f;
+
+	static float Sinc(const float x)
+	{
+		if(fabsf(x) < 0.0001f)
+			return 1.0f;
+
+		const float pi_x = kPi*x;
+		return sinf(pi_x) / pi_x;
+	}
+
+	static float Box(const float x)
+	{
+		const float abs_x = fabsf(x);
+		if(abs_x < kBoxRadius)
+			return 1.0f;
+		if(abs_x == kBoxRadius)
+			return 0.5f;
+		return 0.0f;
+	}
+
+	static float Lanczos3(const float x)
+	{
+		if((x <= -kLanczosRadius) || (x >= kLanczosRadius))
+			return 0.0f;
+
+		return Sinc(x)*Sinc(x/kLanczosRadius);
+	}
+
+	// zeroth order modified bessel function of the first kind
+	static float BesselI0(const float x)
+	{
+		float sum = 1.0f;
+		float term = 1.0f;
+		for(Int32 k = 1; term > sum*1e-8f; ++k)
+		{
+			const float half_x_over_k = x / (2.0f*(float)k);
+			term *= half_x_over_k*half_x_over_k;
+			sum += term;
+		}
+		return sum;
+	}
+
+	static float Kaiser(const float x)
+	{
+		if((x <= -kKaiserRadius) || (x >= kKaiserRadius))
+			return 0.0f;
+
+		const float t = x / kKaiserRadius;
+		return Sinc(x) * BesselI0(kKaiserAlpha*sqrtf(1.0f - t*t)) / BesselI0(kKaiserAlpha);
+	}
+
+	typedef float (*FilterFunction)(const float x);
+
+	static const FilterFunction kFilterFunctions[RF_NUM_FILTERS] = { Box, Kaiser, Lanczos3 };
+	static const float kFilterRadii[RF_NUM_FILTERS] = { kBoxRadius, kKaiserRadius, kLanczosRadius };
+
+	void CalculateResizeContributions(const UInt32 source_size, const UInt32 dest_size, const ResizeFilter filter, ResizeContributions& contributions)
+	{
+		const FilterFunction filter_function = kFilterFunctions[filter];
+		const float scale = (float)dest_size / (float)source_size;
+		const float filter_scale = scale < 1.0f ? scale : 1.0f;
+		const float support = kFilterRadii[filter] / filter_scale;
+
+		contributions.first.resize(dest_size);
+		contributions.count.resize(dest_size);
+		contributions.pixels.clear();
+		contributions.weights.clear();
+
+		for(UInt32 dest_pixel = 0; dest_pixel < dest_size; ++dest_pixel)
+		{
+			const float centre = ((float)dest_pixel + 0.5f) / scale;
+			const Int32 start = (Int32)floorf(centre - support);
+			const Int32 end = (Int32)ceilf(centre + support);
+
+			contributions.first[dest_pixel] = (Int32)contributions.pixels.size();
+
+			float total_weight = 0.0f;
+			for(Int32 source_pixel = start; source_pixel <= end; ++source_pixel)
+			{
+				const float weight = filter_function(((float)source_pixel + 0.5f - centre) * filter_scale);
+				if(weight == 0.0f)
+					continue;
+
+				Int32 clamped_pixel = source_pixel < 0 ? 0 : source_pixel;
+				if(clamped_pixel >= (Int32)source_size)
+					clamped_pixel = (Int32)source_size-1;
+
+				contributions.pixels.push_back(clamped_pixel);
+				contributions.weights.push_back(weight);
+				total_weight += weight;
+			}
+
+			const Int32 first = contributions.first[dest_pixel];
+			contributions.count[dest_pixel] = (Int32)contributions.pixels.size() - first;
+			for(size_t weight_num = first; weight_num < contributions.weights.size(); ++weight_num)
+				contributions.weights[weight_num] /= total_weight;
+		}
+	}
+
+	static inline UInt8 ToUInt8(const float value)
+	{
+		if(value <= 0.0f)
+			return 0;
+		if(value >= 255.0f)
+			return 255;
+		return (UInt8)(value + 0.5f);
+	}
+
+	bool ResizeImage(const ImageData& source, ImageData& dest, const UInt32 width, const UInt32 height, const ResizeFilter filter)
+	{
+		if((source.image() == NULL) || (source.format() != IF_RGBA8) || (width == 0) || (height == 0) || (filter >= RF_NUM_FILTERS))
+			return false;
+
+		const UInt32 source_width = source.width();
+		const UInt32 source_height = source.height();
+		const UInt8* source_pixels = source.image();
+
+		ResizeContributions horizontal, vertical;
+		CalculateResizeContributions(source_width, width, filter, horizontal);
+		CalculateResizeContributions(source_height, height, filter, vertical);
+
+		// premultiplied alpha from the horizontal pass
+		std::vector<float> rows(width*source_height*4);
+		for(UInt32 y = 0; y < source_height; ++y)
+		{
+			const UInt8* source_row = source_pixels + y*source_width*4;
+			float* row = &rows[y*width*4];
+			for(UInt32 x = 0; x < width; ++x)
+			{
+				float red = 0.0f, green = 0.0f, blue = 0.0f, alpha = 0.0f;
+				const Int32 first = horizontal.first[x];
+				for(Int32 contribution = first; contribution < first+horizontal.count[x]; ++contribution)
+				{
+					const UInt8* pixel = source_row + horizontal.pixels[contribution]*4;
+					const float weighted_alpha = horizontal.weights[contribution] * (float)pixel[3];
+					red += weighted_alpha * (float)pixel[0];
+					green += weighted_alpha * (float)pixel[1];
+					blue += weighted_alpha * (float)pixel[2];
+					alpha += weighted_alpha;
+				}
+				row[x*4] = red;
+				row[x*4+1] = green;
+				row[x*4+2] = blue;
+				row[x*4+3] = alpha;
+			}
+		}
+
+		UInt8* dest_pixels = static_cast<UInt8*>(malloc(width*height*4));
+		if(dest_pixels == NULL)
+			return false;
+
+		for(UInt32 y = 0; y < height; ++y)
+		{
+			UInt8* dest_row = dest_pixels + y*width*4;
+			const Int32 first = vertical.first[y];
+			for(UInt32 x = 0; x < width; ++x)
+			{
+				float red = 0.0f, green = 0.0f, blue = 0.0f, alpha = 0.0f;
+				for(Int32 contribution = first; contribution < first+vertical.count[y]; ++contribution)
+				{
+					const float* pixel = &rows[(vertical.pixels[contribution]*width + x)*4];
+					const float weight = vertical.weights[contribution];
+					red += weight * pixel[0];
+					green += weight * pixel[1];
+					blue += weight * pixel[2];
+					alpha += weight * pixel[3];
+				}
+
+				// back to straight alpha
+				const float inverse_alpha = alpha > 0.0f ? 1.0f / alpha : 0.0f;
+				dest_row[x*4] = ToUInt8(red * inverse_alpha);
+				dest_row[x*4+1] = ToUInt8(green * inverse_alpha);
+				dest_row[x*4+2] = ToUInt8(blue * inverse_alpha);
+				dest_row[x*4+3] = ToUInt8(alpha);
+			}
+		}
+
+		free(dest.image());
+		dest.set_image(dest_pixels);
+		dest.set_width(width);
+		dest.set_height(height);
+		dest.set_format(IF_RGBA8);
+		dest.set_num_mips(1);
+		return true;
+	}
+}
@@ -0,0 +1,40 @@
+#ifndef _GEF_IMAGE_RESIZE_H
+#define _GEF_IMAGE_RESIZE_H
+
+#include <gef.h>
+#include <vector>
+
+namespace gef
+{
+	class ImageData;
+
+	enum ResizeFilter
+	{
+		RF_BOX = 0,
+		RF_KAISER,
+		RF_LANCZOS3,
+		RF_NUM_FILTERS
+	};
+
+	// the source pixels and weights that make up each destination pixel along one axis
+	// the weights for each destination pixel add up to one
+	struct ResizeContributions
+	{
+		std::vector<Int32> first;
+		std::vector<Int32> count;
+		std::vector<Int32> pixels;
+		std::vector<float> weights;
+	};
+
+	// the filter is stretched when shrinking so every source pixel contributes
+	// source pixels outside 0 to source_size-1 are clamped to the edges
+	void CalculateResizeContributions(const UInt32 source_size, const UInt32 dest_size, const ResizeFilter filter, ResizeContributions& contributions);
+
+	// resamples the top mip level of an RGBA8 image to width x height, with a lanczos3 filter by default
+	// colours are weighted by alpha so transparent pixels don't bleed into their neighbours
+	// pixels outside the image are clamped to the edges
+	// dest gets a single mip level
+	bool ResizeImage(const ImageData& source, ImageData& dest, const UInt32 width, const UInt32 height, const ResizeFilter filter = RF_LANCZOS3);
+}
+
+#endif // _GEF_IMAGE_RESIZE_H
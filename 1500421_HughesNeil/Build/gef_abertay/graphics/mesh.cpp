@@ -9,8 +9,10 @@ namespace gef
 	num_primitives_(0),
 	primitives_(NULL),
 	vertex_buffer_(NULL),
+	has_position_transform_(false),
 	platform_(platform)
 	{
+		position_transform_.SetIdentity();
 	}
 
 	Mesh::~Mesh()
@@ -32,6 +34,13 @@ namespace gef
 		return success;
 	}
 
+	void Mesh::set_position_scale_bias(const float scale, const Vector4& bias)
+	{
+		position_transform_.Scale(Vector4(scale, scale, scale));
+		position_transform_.SetTranslation(bias);
+		has_position_transform_ = (scale != 1.0f) || (bias.x() != 0.0f) || (bias.y() != 0.0f) || (bias.z() != 0.0f);
+	}
+
 	void Mesh::AllocatePrimitives(const UInt32 num_primitives)
 	{
 		if(primitives_)
@@ -45,6 +54,26 @@ namespace gef
 		}
 	}
 
+	void Mesh::AllocateLods(const UInt32 num_lods)
+	{
+		for(std::vector<Primitive*>::iterator prim_iter = lod_primitives_.begin(); prim_iter != lod_primitives_.end(); ++prim_iter)
+			delete *prim_iter;
+
+		lod_primitives_.resize(num_lods*num_primitives_);
+		for(std::vector<Primitive*>::iterator prim_iter = lod_primitives_.begin(); prim_iter != lod_primitives_.end(); ++prim_iter)
+			*prim_iter = new Primitive(platform_);
+		lod_screen_sizes_.assign(num_lods, 0.0f);
+	}
+
+	UInt32 Mesh::SelectLod(const float screen_size) const
+	{
+		// screen sizes get smaller with each lod
+		UInt32 lod = 0;
+		while((lod < num_lods()) && (screen_size < lod_screen_sizes_[lod]))
+			++lod;
+		return lod;
+	}
+
 	Primitive* Mesh::AllocatePrimitive()
 	{
 		return new Primitive(platform_);
@@ -63,5 +92,10 @@ namespace gef
 			primitives_ = NULL;
 		}
 		num_primitives_ = 0;
+
+		for(std::vector<Primitive*>::iterator prim_iter = lod_primitives_.begin(); prim_iter != lod_primitives_.end(); ++prim_iter)
+			delete *prim_iter;
+		lod_primitives_.clear();
+		lod_screen_sizes_.clear();
 	}
 }
\ No newline at end of file
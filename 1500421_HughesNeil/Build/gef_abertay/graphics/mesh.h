@@ -8,6 +8,7 @@
 #include <maths/vector2.h>
 #include <maths/aabb.h>
 #include <maths/sphere.h>
+#include <maths/matrix44.h>
 
 namespace gef
 {
@@ -46,6 +47,45 @@ namespace gef
 			float v;
 		};
 
+		// 16 byte version of Vertex
+		// positions are signed normalised and scaled back into mesh space by position_transform
+		// pw is always 32767 so the shader reads a w of 1
+		// normals are signed normalised, uvs are half floats
+		struct PackedVertex
+		{
+			Int16 px;
+			Int16 py;
+			Int16 pz;
+			Int16 pw;
+			Int8 nx;
+			Int8 ny;
+			Int8 nz;
+			Int8 nw;
+			UInt16 u;
+			UInt16 v;
+		};
+
+		// 24 byte version of SkinnedVertex
+		// bone weights are unsigned normalised
+		struct PackedSkinnedVertex
+		{
+			Int16 px;
+			Int16 py;
+			Int16 pz;
+			Int16 pw;
+			Int8 nx;
+			Int8 ny;
+			Int8 nz;
+			Int8 nw;
+			UInt8 bone_indices[4];
+			UInt8 bone_weights[4];
+			UInt16 u;
+			UInt16 v;
+		};
+
+		static inline bool IsPackedVertexSize(const UInt32 vertex_byte_size) { return (vertex_byte_size == sizeof(PackedVertex)) || (vertex_byte_size == sizeof(PackedSkinnedVertex)); }
+		static inline bool IsSkinnedVertexSize(const UInt32 vertex_byte_size) { return (vertex_byte_size == sizeof(SkinnedVertex)) || (vertex_byte_size == sizeof(PackedSkinnedVertex)); }
+
 		Mesh(Platform& platform);
 		virtual ~Mesh();
 		virtual bool InitVertexBuffer(Platform& platform, const void* vertices, const UInt32 num_vertices, const UInt32 vertex_byte_size, const bool read_only = true);
@@ -56,6 +96,25 @@ namespace gef
 		inline class Primitive* GetPrimitive(UInt32 index)				{ return const_cast<class Primitive*>(static_cast<const Mesh&>(*this).GetPrimitive(index));	}
 		inline UInt32 num_primitives() const {return num_primitives_;}
 
+		// lower detail versions of the mesh, each with one primitive for every primitive of the mesh
+		// lod primitives share the mesh's vertex buffer
+		// call after AllocatePrimitives
+		void AllocateLods(const UInt32 num_lods);
+
+		// lod 0 is the full detail mesh
+		inline const class Primitive* GetLodPrimitive(UInt32 lod, UInt32 index) const	{ return lod == 0 ? primitives_[index] : lod_primitives_[(lod-1)*num_primitives_ + index];	}
+		inline class Primitive* GetLodPrimitive(UInt32 lod, UInt32 index)				{ return const_cast<class Primitive*>(static_cast<const Mesh&>(*this).GetLodPrimitive(lod, index));	}
+
+		// number of lods not including the full detail mesh
+		inline UInt32 num_lods() const { return (UInt32)lod_screen_sizes_.size(); }
+
+		// lod is used when the projected diameter of the bounding sphere is less than screen_size * screen height
+		inline void set_lod_screen_size(UInt32 lod, float screen_size) { lod_screen_sizes_[lod-1] = screen_size; }
+		inline float lod_screen_size(UInt32 lod) const { return lod_screen_sizes_[lod-1]; }
+
+		// returns the least detailed lod that can be used at this screen size
+		UInt32 SelectLod(const float screen_size) const;
+
 //		inline UInt32 num_vertices() const { return num_vertices_; }
 //		inline UInt32 vertex_byte_size() const { return vertex_byte_size_; }
 
@@ -68,6 +127,11 @@ namespace gef
 		inline const VertexBuffer* vertex_buffer() const { return vertex_buffer_; }
 		inline VertexBuffer* vertex_buffer() { return vertex_buffer_; }
 
+		// packed vertex positions are transformed by this before the world transform
+		void set_position_scale_bias(const float scale, const Vector4& bias);
+		inline const Matrix44& position_transform() const { return position_transform_; }
+		inline bool has_position_transform() const { return has_position_transform_; }
+
 	protected:
 		virtual class Primitive* AllocatePrimitive(); // move to platform class?
 		void ReleasePrimitives();
@@ -75,11 +139,15 @@ namespace gef
 
 		UInt32 num_primitives_;
 		class Primitive ** primitives_;
+		std::vector<class Primitive*> lod_primitives_;
+		std::vector<float> lod_screen_sizes_;
 //		UInt32 num_vertices_;
 //		UInt32 vertex_byte_size_;
 		Aabb aabb_;
 		Sphere bounding_sphere_;
 		VertexBuffer* vertex_buffer_;
+		Matrix44 position_transform_;
+		bool has_position_transform_;
 		Platform& platform_;
 	};
 }
@@ -1,18 +1,49 @@
 #include <graphics/mesh_data.h>
+#include <graphics/mesh.h>
+#include <maths/math_utils.h>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <map>
 
 namespace gef
 {
-	MeshData::MeshData()
+	MeshData::MeshData() :
+		name_id(0)
 	{
 	}
 
+	MeshData::MeshData(const MeshData& mesh_data)
+	{
+		*this = mesh_data;
+	}
+
 	MeshData::~MeshData()
 	{
 		for(std::vector<PrimitiveData*>::iterator prim_iter = primitives.begin(); prim_iter != primitives.end(); ++prim_iter)
 			delete (*prim_iter);
 	}
 
+	MeshData& MeshData::operator=(const MeshData& mesh_data)
+	{
+		if(this != &mesh_data)
+		{
+			for(std::vector<PrimitiveData*>::iterator prim_iter = primitives.begin(); prim_iter != primitives.end(); ++prim_iter)
+				delete (*prim_iter);
+			primitives.clear();
+
+			vertex_data = mesh_data.vertex_data;
+			primitives.reserve(mesh_data.primitives.size());
+			for(std::vector<PrimitiveData*>::const_iterator prim_iter = mesh_data.primitives.begin(); prim_iter != mesh_data.primitives.end(); ++prim_iter)
+				primitives.push_back(new PrimitiveData(**prim_iter));
+			name_id = mesh_data.name_id;
+			aabb = mesh_data.aabb;
+			lods = mesh_data.lods;
+		}
+
+		return *this;
+	}
+
 	bool MeshData::Read(std::istream& stream)
 	{
 		bool success = true;
@@ -31,7 +62,8 @@ namespace gef
 		for(Int32 prim_num=0;prim_num<primitive_count;++prim_num)
 		{
 			PrimitiveData* primitive_data = new PrimitiveData();
-			primitive_data->Read(stream);
+			if(!primitive_data->Read(stream))
+				success = false;
 			primitives.push_back(primitive_data);
 
 		}
@@ -61,11 +93,706 @@ namespace gef
 		return success;
 	}
 
+	bool MeshData::ReadLods(std::istream& stream)
+	{
+		Int32 lod_count = 0;
+		stream.read((char*)&lod_count, sizeof(Int32));
+
+		lods.clear();
+		lods.resize(lod_count);
+
+		bool success = true;
+		for(std::vector<MeshLodData>::iterator lod_iter = lods.begin(); success && (lod_iter != lods.end()); ++lod_iter)
+			success = lod_iter->Read(stream);
+
+		return success && !stream.fail();
+	}
+
+	bool MeshData::WriteLods(std::ostream& stream) const
+	{
+		Int32 lod_count = (Int32)lods.size();
+		stream.write((char*)&lod_count, sizeof(Int32));
+
+		bool success = true;
+		for(std::vector<MeshLodData>::const_iterator lod_iter = lods.begin(); success && (lod_iter != lods.end()); ++lod_iter)
+			success = lod_iter->Write(stream);
+
+		return success;
+	}
+
+	bool MeshData::ReadClusters(std::istream& stream)
+	{
+		Int32 primitive_count = 0;
+		stream.read((char*)&primitive_count, sizeof(Int32));
+
+		bool success = primitive_count == (Int32)primitives.size();
+		for(std::vector<PrimitiveData*>::iterator prim_iter = primitives.begin(); success && (prim_iter != primitives.end()); ++prim_iter)
+		{
+			Int32 cluster_count = 0;
+			stream.read((char*)&cluster_count, sizeof(Int32));
+
+			std::vector<PrimitiveCluster>& clusters = (*prim_iter)->clusters;
+			clusters.resize(cluster_count);
+			for(std::vector<PrimitiveCluster>::iterator cluster_iter = clusters.begin(); cluster_iter != clusters.end(); ++cluster_iter)
+			{
+				float values[8];
+				stream.read((char*)&cluster_iter->start_index, sizeof(UInt32));
+				stream.read((char*)&cluster_iter->num_indices, sizeof(UInt32));
+				stream.read((char*)values, sizeof(values));
+				cluster_iter->bounds = Sphere(Vector4(values[0], values[1], values[2]), values[3]);
+				cluster_iter->cone_axis = Vector4(values[4], values[5], values[6]);
+				cluster_iter->cone_cutoff = values[7];
+			}
+
+			success = !stream.fail();
+		}
+
+		return success;
+	}
+
+	bool MeshData::WriteClusters(std::ostream& stream) const
+	{
+		Int32 primitive_count = (Int32)primitives.size();
+		stream.write((char*)&primitive_count, sizeof(Int32));
+
+		for(std::vector<PrimitiveData*>::const_iterator prim_iter = primitives.begin(); prim_iter != primitives.end(); ++prim_iter)
+		{
+			const std::vector<PrimitiveCluster>& clusters = (*prim_iter)->clusters;
+			Int32 cluster_count = (Int32)clusters.size();
+			stream.write((char*)&cluster_count, sizeof(Int32));
+
+			for(std::vector<PrimitiveCluster>::const_iterator cluster_iter = clusters.begin(); cluster_iter != clusters.end(); ++cluster_iter)
+			{
+				const Vector4& centre = cluster_iter->bounds.position();
+				const float values[8] = { centre.x(), centre.y(), centre.z(), cluster_iter->bounds.radius(),
+					cluster_iter->cone_axis.x(), cluster_iter->cone_axis.y(), cluster_iter->cone_axis.z(), cluster_iter->cone_cutoff };
+				stream.write((char*)&cluster_iter->start_index, sizeof(UInt32));
+				stream.write((char*)&cluster_iter->num_indices, sizeof(UInt32));
+				stream.write((char*)values, sizeof(values));
+			}
+		}
+
+		return true;
+	}
+
+	bool MeshData::HasClusters() const
+	{
+		for(std::vector<PrimitiveData*>::const_iterator prim_iter = primitives.begin(); prim_iter != primitives.end(); ++prim_iter)
+		{
+			if(!(*prim_iter)->clusters.empty())
+				return true;
+		}
+
+		return false;
+	}
+
+	MeshLodData::MeshLodData() :
+		error(0.0f),
+		screen_size(0.0f)
+	{
+	}
+
+	bool MeshLodData::Read(std::istream& stream)
+	{
+		Int32 primitive_count = 0;
+		stream.read((char*)&error, sizeof(float));
+		stream.read((char*)&screen_size, sizeof(float));
+		stream.read((char*)&primitive_count, sizeof(Int32));
+
+		primitives.clear();
+		primitives.resize(primitive_count);
+
+		bool success = !stream.fail();
+		for(std::vector<PrimitiveData>::iterator prim_iter = primitives.begin(); success && (prim_iter != primitives.end()); ++prim_iter)
+			success = prim_iter->Read(stream);
+
+		return success;
+	}
+
+	bool MeshLodData::Write(std::ostream& stream) const
+	{
+		Int32 primitive_count = (Int32)primitives.size();
+		stream.write((char*)&error, sizeof(float));
+		stream.write((char*)&screen_size, sizeof(float));
+		stream.write((char*)&primitive_count, sizeof(Int32));
+
+		bool success = true;
+		for(std::vector<PrimitiveData>::const_iterator prim_iter = primitives.begin(); success && (prim_iter != primitives.end()); ++prim_iter)
+			success = prim_iter->Write(stream);
+
+		return success;
+	}
+
+
+
+	Int32 MeshData::RemoveDuplicateVertices()
+	{
+		const Int32 num_vertices = vertex_data.num_vertices;
+		const Int32 vertex_byte_size = vertex_data.vertex_byte_size;
+		if((num_vertices == 0) || (vertex_data.vertices == NULL))
+			return 0;
+
+		const UInt8* vertices = static_cast<const UInt8*>(vertex_data.vertices);
+
+		// hash table of unique vertex indices, linear probing
+		UInt32 table_size = 1;
+		while(table_size < (UInt32)num_vertices*2)
+			table_size <<= 1;
+		std::vector<Int32> table(table_size, -1);
+
+		std::vector<UInt32> remap(num_vertices);
+		UInt8* unique_vertices = static_cast<UInt8*>(malloc(num_vertices*vertex_byte_size));
+		Int32 num_unique_vertices = 0;
+
+		for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+		{
+			const UInt8* vertex = vertices + vertex_num*vertex_byte_size;
+
+			// FNV-1a
+			UInt32 hash = 2166136261u;
+			for(Int32 byte_num = 0; byte_num < vertex_byte_size; ++byte_num)
+				hash = (hash ^ vertex[byte_num]) * 16777619u;
+
+			UInt32 slot = hash & (table_size-1);
+			while((table[slot] != -1) && (memcmp(unique_vertices + table[slot]*vertex_byte_size, vertex, vertex_byte_size) != 0))
+				slot = (slot+1) & (table_size-1);
+
+			if(table[slot] == -1)
+			{
+				table[slot] = num_unique_vertices;
+				memcpy(unique_vertices + num_unique_vertices*vertex_byte_size, vertex, vertex_byte_size);
+				++num_unique_vertices;
+			}
+			remap[vertex_num] = table[slot];
+		}
+
+		for(std::vector<PrimitiveData*>::iterator prim_iter = primitives.begin(); prim_iter != primitives.end(); ++prim_iter)
+		{
+			PrimitiveData* primitive = *prim_iter;
+			for(Int32 index_num = 0; index_num < primitive->num_indices; ++index_num)
+				primitive->SetIndex(index_num, remap[primitive->GetIndex(index_num)]);
+		}
+
+		for(std::vector<MeshLodData>::iterator lod_iter = lods.begin(); lod_iter != lods.end(); ++lod_iter)
+		{
+			for(std::vector<PrimitiveData>::iterator prim_iter = lod_iter->primitives.begin(); prim_iter != lod_iter->primitives.end(); ++prim_iter)
+			{
+				for(Int32 index_num = 0; index_num < prim_iter->num_indices; ++index_num)
+					prim_iter->SetIndex(index_num, remap[prim_iter->GetIndex(index_num)]);
+			}
+		}
+
+		free(vertex_data.vertices);
+		vertex_data.vertices = realloc(unique_vertices, num_unique_vertices*vertex_byte_size);
+		vertex_data.num_vertices = num_unique_vertices;
+
+		return num_vertices - num_unique_vertices;
+	}
+
+	void MeshData::CompactIndices()
+	{
+		// there's no 8 bit index format on D3D11 or Vita so 16 bit is the smallest
+		const Int32 index_byte_size = (Int32)Primitive::GetIndexByteSize(vertex_data.num_vertices);
+
+		for(std::vector<PrimitiveData*>::iterator prim_iter = primitives.begin(); prim_iter != primitives.end(); ++prim_iter)
+			(*prim_iter)->SetIndexByteSize(index_byte_size);
+
+		for(std::vector<MeshLodData>::iterator lod_iter = lods.begin(); lod_iter != lods.end(); ++lod_iter)
+		{
+			for(std::vector<PrimitiveData>::iterator prim_iter = lod_iter->primitives.begin(); prim_iter != lod_iter->primitives.end(); ++prim_iter)
+				prim_iter->SetIndexByteSize(index_byte_size);
+		}
+	}
+
+	struct ShortIndexMeshBuilder
+	{
+		ShortIndexMeshBuilder(const MeshData& source, std::vector<MeshData*>& split_meshes) :
+			source_(source),
+			split_meshes_(split_meshes),
+			vertex_remap_(source.vertex_data.num_vertices, -1),
+			vertex_remap_mesh_(source.vertex_data.num_vertices, -1),
+			mesh_index_(-1),
+			primitive_(NULL)
+		{
+		}
+
+		void BeginPrimitive(const PrimitiveData& source_primitive)
+		{
+			source_primitive_ = &source_primitive;
+			primitive_ = NULL;
+		}
+
+		void AddElement(const UInt32* element_indices, const Int32 element_size)
+		{
+			Int32 new_vertex_count = 0;
+			for(Int32 index_num = 0; index_num < element_size; ++index_num)
+			{
+				if((mesh_index_ == -1) || (vertex_remap_mesh_[element_indices[index_num]] != mesh_index_))
+					++new_vertex_count;
+			}
+
+			if((mesh_index_ == -1) || (mesh_vertices_.size() + new_vertex_count > 0x10000))
+				BeginMesh();
+
+			if(!primitive_)
+			{
+				primitive_ = new PrimitiveData();
+				primitive_->type = source_primitive_->type == LINE_LIST ? LINE_LIST : TRIANGLE_LIST;
+				primitive_->material_name_id = source_primitive_->material_name_id;
+				split_meshes_[mesh_index_]->primitives.push_back(primitive_);
+			}
+
+			for(Int32 index_num = 0; index_num < element_size; ++index_num)
+			{
+				const UInt32 source_index = element_indices[index_num];
+				if(vertex_remap_mesh_[source_index] != mesh_index_)
+				{
+					vertex_remap_mesh_[source_index] = mesh_index_;
+					vertex_remap_[source_index] = (Int32)mesh_vertices_.size();
+					mesh_vertices_.push_back(source_index);
+				}
+				primitive_indices_[primitive_].push_back((UInt16)vertex_remap_[source_index]);
+			}
+		}
+
+		void BeginMesh()
+		{
+			EndMesh();
+
+			// split meshes share the source mesh name and bounds
+			mesh_index_ = (Int32)split_meshes_.size();
+			split_meshes_.push_back(new MeshData());
+			MeshData& mesh = *split_meshes_[mesh_index_];
+			mesh.name_id = source_.name_id;
+			mesh.aabb = source_.aabb;
+			mesh.vertex_data.vertex_byte_size = source_.vertex_data.vertex_byte_size;
+			mesh.vertex_data.position_scale = source_.vertex_data.position_scale;
+			mesh.vertex_data.position_bias = source_.vertex_data.position_bias;
+			primitive_ = NULL;
+		}
+
+		void EndMesh()
+		{
+			if(mesh_index_ == -1)
+				return;
+
+			MeshData& mesh = *split_meshes_[mesh_index_];
+			const Int32 vertex_byte_size = source_.vertex_data.vertex_byte_size;
+			mesh.vertex_data.num_vertices = (Int32)mesh_vertices_.size();
+			mesh.vertex_data.vertices = malloc(mesh_vertices_.size()*vertex_byte_size);
+			for(size_t vertex_num = 0; vertex_num < mesh_vertices_.size(); ++vertex_num)
+				memcpy(static_cast<UInt8*>(mesh.vertex_data.vertices) + vertex_num*vertex_byte_size, static_cast<const UInt8*>(source_.vertex_data.vertices) + mesh_vertices_[vertex_num]*vertex_byte_size, vertex_byte_size);
+
+			for(std::vector<PrimitiveData*>::iterator prim_iter = mesh.primitives.begin(); prim_iter != mesh.primitives.end(); ++prim_iter)
+			{
+				std::vector<UInt16>& indices = primitive_indices_[*prim_iter];
+				(*prim_iter)->index_byte_size = 2;
+				(*prim_iter)->num_indices = (Int32)indices.size();
+				(*prim_iter)->indices = malloc(indices.size()*sizeof(UInt16));
+				if(indices.size() > 0)
+					memcpy((*prim_iter)->indices, &indices[0], indices.size()*sizeof(UInt16));
+			}
+
+			primitive_indices_.clear();
+			mesh_vertices_.clear();
+			mesh_index_ = -1;
+		}
+
+		const MeshData& source_;
+		std::vector<MeshData*>& split_meshes_;
+		std::vector<Int32> vertex_remap_;
+		std::vector<Int32> vertex_remap_mesh_;
+		std::vector<UInt32> mesh_vertices_;
+		std::map<PrimitiveData*, std::vector<UInt16> > primitive_indices_;
+		Int32 mesh_index_;
+		PrimitiveData* primitive_;
+		const PrimitiveData* source_primitive_;
+	};
+
+	void MeshData::SplitForShortIndices(std::vector<MeshData*>& split_meshes) const
+	{
+		if(vertex_data.num_vertices <= 0x10000)
+		{
+			split_meshes.push_back(new MeshData(*this));
+			split_meshes.back()->CompactIndices();
+			return;
+		}
+
+		ShortIndexMeshBuilder builder(*this, split_meshes);
+		for(std::vector<PrimitiveData*>::const_iterator prim_iter = primitives.begin(); prim_iter != primitives.end(); ++prim_iter)
+		{
+			const PrimitiveData& primitive = **prim_iter;
+			builder.BeginPrimitive(primitive);
+
+			UInt32 element[3];
+			switch(primitive.type)
+			{
+			case TRIANGLE_LIST:
+				for(Int32 index_num = 0; index_num+2 < primitive.num_indices; index_num += 3)
+				{
+					element[0] = primitive.GetIndex(index_num);
+					element[1] = primitive.GetIndex(index_num+1);
+					element[2] = primitive.GetIndex(index_num+2);
+					builder.AddElement(element, 3);
+				}
+				break;
+
+			case TRIANGLE_STRIP:
+				for(Int32 index_num = 0; index_num+2 < primitive.num_indices; ++index_num)
+				{
+					// every other triangle in a strip has reversed winding
+					element[0] = primitive.GetIndex(index_num);
+					element[1] = primitive.GetIndex(index_num + ((index_num & 1) ? 2 : 1));
+					element[2] = primitive.GetIndex(index_num + ((index_num & 1) ? 1 : 2));
+
+					// skip degenerate triangles used to join strips
+					if((element[0] == element[1]) || (element[1] == element[2]) || (element[0] == element[2]))
+						continue;
+					builder.AddElement(element, 3);
+				}
+				break;
+
+			case LINE_LIST:
+				for(Int32 index_num = 0; index_num+1 < primitive.num_indices; index_num += 2)
+				{
+					element[0] = primitive.GetIndex(index_num);
+					element[1] = primitive.GetIndex(index_num+1);
+					builder.AddElement(element, 2);
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+		builder.EndMesh();
+	}
+
+	struct PrimitiveMaterialOrder
+	{
+		PrimitiveMaterialOrder(const std::vector<PrimitiveData*>& primitives) : primitives_(primitives) {}
+
+		bool operator()(const Int32 lhs, const Int32 rhs) const
+		{
+			return primitives_[lhs]->material_name_id < primitives_[rhs]->material_name_id;
+		}
+
+		const std::vector<PrimitiveData*>& primitives_;
+	};
+
+	static void AppendPrimitiveIndices(PrimitiveData& last, PrimitiveData& primitive)
+	{
+		const Int32 index_byte_size = last.index_byte_size > primitive.index_byte_size ? last.index_byte_size : primitive.index_byte_size;
+		last.SetIndexByteSize(index_byte_size);
+		primitive.SetIndexByteSize(index_byte_size);
+
+		last.indices = realloc(last.indices, (last.num_indices+primitive.num_indices)*index_byte_size);
+		memcpy(static_cast<UInt8*>(last.indices) + last.num_indices*index_byte_size, primitive.indices, primitive.num_indices*index_byte_size);
+
+		// clusters only cover part of the merged primitive unless both primitives had them
+		if(!last.clusters.empty() && !primitive.clusters.empty())
+		{
+			for(std::vector<PrimitiveCluster>::const_iterator cluster_iter = primitive.clusters.begin(); cluster_iter != primitive.clusters.end(); ++cluster_iter)
+			{
+				last.clusters.push_back(*cluster_iter);
+				last.clusters.back().start_index += last.num_indices;
+			}
+		}
+		else
+			last.clusters.clear();
+
+		last.num_indices += primitive.num_indices;
+	}
+
+	void MeshData::SortPrimitivesByMaterial(const bool merge)
+	{
+		// lods that don't match the primitives can't be kept in step with them
+		for(std::vector<MeshLodData>::iterator lod_iter = lods.begin(); lod_iter != lods.end(); ++lod_iter)
+		{
+			if(lod_iter->primitives.size() != primitives.size())
+			{
+				lods.clear();
+				break;
+			}
+		}
+
+		// the order is sorted rather than the primitives so lod primitives can be moved the same way
+		std::vector<Int32> order(primitives.size());
+		for(size_t prim_num = 0; prim_num < primitives.size(); ++prim_num)
+			order[prim_num] = (Int32)prim_num;
+		std::stable_sort(order.begin(), order.end(), PrimitiveMaterialOrder(primitives));
+
+		std::vector<PrimitiveData*> sorted_primitives(primitives.size());
+		for(size_t prim_num = 0; prim_num < primitives.size(); ++prim_num)
+			sorted_primitives[prim_num] = primitives[order[prim_num]];
+		primitives.swap(sorted_primitives);
+
+		for(std::vector<MeshLodData>::iterator lod_iter = lods.begin(); lod_iter != lods.end(); ++lod_iter)
+		{
+			std::vector<PrimitiveData> sorted_lod_primitives(primitives.size());
+			for(size_t prim_num = 0; prim_num < primitives.size(); ++prim_num)
+				sorted_lod_primitives[prim_num] = lod_iter->primitives[order[prim_num]];
+			lod_iter->primitives.swap(sorted_lod_primitives);
+		}
+
+		if(!merge || primitives.size() < 2)
+			return;
+
+		std::vector<PrimitiveData*> merged_primitives;
+		std::vector<Int32> merged_prim_nums;
+		merged_primitives.push_back(primitives[0]);
+		merged_prim_nums.push_back(0);
+		for(size_t prim_num = 1; prim_num < primitives.size(); ++prim_num)
+		{
+			PrimitiveData* last = merged_primitives.back();
+			PrimitiveData* primitive = primitives[prim_num];
+
+			// strips can't be joined without degenerate triangles so only merge lists
+			if((last->material_name_id == primitive->material_name_id) && (last->type == primitive->type) &&
+				((primitive->type == TRIANGLE_LIST) || (primitive->type == LINE_LIST)))
+			{
+				AppendPrimitiveIndices(*last, *primitive);
+				for(std::vector<MeshLodData>::iterator lod_iter = lods.begin(); lod_iter != lods.end(); ++lod_iter)
+					AppendPrimitiveIndices(lod_iter->primitives[merged_prim_nums.back()], lod_iter->primitives[prim_num]);
+
+				delete primitive;
+			}
+			else
+			{
+				merged_primitives.push_back(primitive);
+				merged_prim_nums.push_back((Int32)prim_num);
+			}
+		}
+
+		primitives.swap(merged_primitives);
+
+		for(std::vector<MeshLodData>::iterator lod_iter = lods.begin(); lod_iter != lods.end(); ++lod_iter)
+		{
+			std::vector<PrimitiveData> merged_lod_primitives(merged_prim_nums.size());
+			for(size_t prim_num = 0; prim_num < merged_prim_nums.size(); ++prim_num)
+				merged_lod_primitives[prim_num] = lod_iter->primitives[merged_prim_nums[prim_num]];
+			lod_iter->primitives.swap(merged_lod_primitives);
+		}
+	}
+
+	static inline Int16 PackSignedNormalised16(const float value)
+	{
+		float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+		return (Int16)(clamped*32767.0f + (clamped < 0.0f ? -0.5f : 0.5f));
+	}
+
+	static inline Int8 PackSignedNormalised8(const float value)
+	{
+		float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+		return (Int8)(signed char)(clamped*127.0f + (clamped < 0.0f ? -0.5f : 0.5f));
+	}
+
+	static inline float UnpackSignedNormalised16(const Int16 value)
+	{
+		float result = (float)value / 32767.0f;
+		return result < -1.0f ? -1.0f : result;
+	}
+
+	static inline float UnpackSignedNormalised8(const Int8 value)
+	{
+		// Int8 is a plain char so may be unsigned on some compilers
+		float result = (float)(signed char)value / 127.0f;
+		return result < -1.0f ? -1.0f : result;
+	}
+
+	template <class PackedVertexType>
+	static void PackVertexAttributes(PackedVertexType& packed, const float* position, const float* normal, const float* uv, const float scale_rcp, const Vector4& bias)
+	{
+		packed.px = PackSignedNormalised16((position[0] - bias.x())*scale_rcp);
+		packed.py = PackSignedNormalised16((position[1] - bias.y())*scale_rcp);
+		packed.pz = PackSignedNormalised16((position[2] - bias.z())*scale_rcp);
+		packed.pw = 32767;
+		packed.nx = PackSignedNormalised8(normal[0]);
+		packed.ny = PackSignedNormalised8(normal[1]);
+		packed.nz = PackSignedNormalised8(normal[2]);
+		packed.nw = 0;
+		packed.u = FloatToHalf(uv[0]);
+		packed.v = FloatToHalf(uv[1]);
+	}
+
+	template <class PackedVertexType>
+	static void UnpackVertexAttributes(const PackedVertexType& packed, float* position, float* normal, float* uv, const float scale, const Vector4& bias)
+	{
+		position[0] = UnpackSignedNormalised16(packed.px)*scale + bias.x();
+		position[1] = UnpackSignedNormalised16(packed.py)*scale + bias.y();
+		position[2] = UnpackSignedNormalised16(packed.pz)*scale + bias.z();
+		normal[0] = UnpackSignedNormalised8(packed.nx);
+		normal[1] = UnpackSignedNormalised8(packed.ny);
+		normal[2] = UnpackSignedNormalised8(packed.nz);
+		uv[0] = HalfToFloat(packed.u);
+		uv[1] = HalfToFloat(packed.v);
+	}
+
+	bool MeshData::PackVertices()
+	{
+		const bool skinned = vertex_data.vertex_byte_size == sizeof(Mesh::SkinnedVertex);
+		if(!skinned && (vertex_data.vertex_byte_size != sizeof(Mesh::Vertex)))
+			return false;
+
+		const Int32 num_vertices = vertex_data.num_vertices;
+
+		// positions are stored relative to the centre of the mesh
+		// a single scale is used for all axes so normals are only scaled uniformly by the position transform
+		Vector4 position_min(0.0f, 0.0f, 0.0f), position_max(0.0f, 0.0f, 0.0f);
+		for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+		{
+			const float* position = skinned ? &static_cast<const Mesh::SkinnedVertex*>(vertex_data.vertices)[vertex_num].px : &static_cast<const Mesh::Vertex*>(vertex_data.vertices)[vertex_num].px;
+			Vector4 vertex_position(position[0], position[1], position[2]);
+			if(vertex_num == 0)
+			{
+				position_min = vertex_position;
+				position_max = vertex_position;
+			}
+			else
+			{
+				position_min = Vector4(std::min(position_min.x(), vertex_position.x()), std::min(position_min.y(), vertex_position.y()), std::min(position_min.z(), vertex_position.z()));
+				position_max = Vector4(std::max(position_max.x(), vertex_position.x()), std::max(position_max.y(), vertex_position.y()), std::max(position_max.z(), vertex_position.z()));
+			}
+		}
+
+		const Vector4 bias = (position_min + position_max) * 0.5f;
+		const Vector4 half_extents = (position_max - position_min) * 0.5f;
+		float scale = std::max(half_extents.x(), std::max(half_extents.y(), half_extents.z()));
+		if(scale <= 0.0f)
+			scale = 1.0f;
+		const float scale_rcp = 1.0f / scale;
+
+		void* packed_vertices = NULL;
+		Int32 packed_vertex_byte_size;
+		if(skinned)
+		{
+			packed_vertex_byte_size = sizeof(Mesh::PackedSkinnedVertex);
+			Mesh::PackedSkinnedVertex* packed = static_cast<Mesh::PackedSkinnedVertex*>(malloc(num_vertices*packed_vertex_byte_size));
+			const Mesh::SkinnedVertex* vertices = static_cast<const Mesh::SkinnedVertex*>(vertex_data.vertices);
+			for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+			{
+				const Mesh::SkinnedVertex& vertex = vertices[vertex_num];
+				Mesh::PackedSkinnedVertex& packed_vertex = packed[vertex_num];
+				PackVertexAttributes(packed_vertex, &vertex.px, &vertex.nx, &vertex.u, scale_rcp, bias);
+
+				// make sure the quantised weights still add up to one
+				Int32 weight_total = 0;
+				Int32 largest_influence = 0;
+				for(Int32 influence_index = 0; influence_index < 4; ++influence_index)
+				{
+					float weight = vertex.bone_weights[influence_index];
+					weight = weight < 0.0f ? 0.0f : (weight > 1.0f ? 1.0f : weight);
+					packed_vertex.bone_indices[influence_index] = vertex.bone_indices[influence_index];
+					packed_vertex.bone_weights[influence_index] = (UInt8)(weight*255.0f + 0.5f);
+					weight_total += packed_vertex.bone_weights[influence_index];
+					if(packed_vertex.bone_weights[influence_index] > packed_vertex.bone_weights[largest_influence])
+						largest_influence = influence_index;
+				}
+				if(weight_total > 0)
+					packed_vertex.bone_weights[largest_influence] = (UInt8)(packed_vertex.bone_weights[largest_influence] + 255 - weight_total);
+			}
+			packed_vertices = packed;
+		}
+		else
+		{
+			packed_vertex_byte_size = sizeof(Mesh::PackedVertex);
+			Mesh::PackedVertex* packed = static_cast<Mesh::PackedVertex*>(malloc(num_vertices*packed_vertex_byte_size));
+			const Mesh::Vertex* vertices = static_cast<const Mesh::Vertex*>(vertex_data.vertices);
+			for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+				PackVertexAttributes(packed[vertex_num], &vertices[vertex_num].px, &vertices[vertex_num].nx, &vertices[vertex_num].u, scale_rcp, bias);
+			packed_vertices = packed;
+		}
+
+		free(vertex_data.vertices);
+		vertex_data.vertices = packed_vertices;
+		vertex_data.vertex_byte_size = packed_vertex_byte_size;
+		vertex_data.position_scale = scale;
+		vertex_data.position_bias = bias;
+
+		return true;
+	}
+
+	bool MeshData::UnpackVertices()
+	{
+		const bool skinned = vertex_data.vertex_byte_size == sizeof(Mesh::PackedSkinnedVertex);
+		if(!skinned && (vertex_data.vertex_byte_size != sizeof(Mesh::PackedVertex)))
+			return false;
+
+		const Int32 num_vertices = vertex_data.num_vertices;
+		const float scale = vertex_data.position_scale;
+		const Vector4& bias = vertex_data.position_bias;
+
+		void* vertices = NULL;
+		Int32 vertex_byte_size;
+		if(skinned)
+		{
+			vertex_byte_size = sizeof(Mesh::SkinnedVertex);
+			Mesh::SkinnedVertex* unpacked = static_cast<Mesh::SkinnedVertex*>(malloc(num_vertices*vertex_byte_size));
+			const Mesh::PackedSkinnedVertex* packed = static_cast<const Mesh::PackedSkinnedVertex*>(vertex_data.vertices);
+			for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+			{
+				Mesh::SkinnedVertex& vertex = unpacked[vertex_num];
+				UnpackVertexAttributes(packed[vertex_num], &vertex.px, &vertex.nx, &vertex.u, scale, bias);
+				for(Int32 influence_index = 0; influence_index < 4; ++influence_index)
+				{
+					vertex.bone_indices[influence_index] = packed[vertex_num].bone_indices[influence_index];
+					vertex.bone_weights[influence_index] = (float)packed[vertex_num].bone_weights[influence_index] / 255.0f;
+				}
+			}
+			vertices = unpacked;
+		}
+		else
+		{
+			vertex_byte_size = sizeof(Mesh::Vertex);
+			Mesh::Vertex* unpacked = static_cast<Mesh::Vertex*>(malloc(num_vertices*vertex_byte_size));
+			const Mesh::PackedVertex* packed = static_cast<const Mesh::PackedVertex*>(vertex_data.vertices);
+			for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+				UnpackVertexAttributes(packed[vertex_num], &unpacked[vertex_num].px, &unpacked[vertex_num].nx, &unpacked[vertex_num].u, scale, bias);
+			vertices = unpacked;
+		}
+
+		free(vertex_data.vertices);
+		vertex_data.vertices = vertices;
+		vertex_data.vertex_byte_size = vertex_byte_size;
+		vertex_data.position_scale = 1.0f;
+		vertex_data.position_bias = Vector4(0.0f, 0.0f, 0.0f);
 
+		return true;
+	}
+
+	Int32 MeshData::GetIndexCount() const
+	{
+		Int32 index_count = 0;
+		for(std::vector<PrimitiveData*>::const_iterator prim_iter = primitives.begin(); prim_iter != primitives.end(); ++prim_iter)
+			index_count += (*prim_iter)->num_indices;
+		return index_count;
+	}
+
+	Int32 MeshData::GetIndexDataSize() const
+	{
+		Int32 index_data_size = 0;
+		for(std::vector<PrimitiveData*>::const_iterator prim_iter = primitives.begin(); prim_iter != primitives.end(); ++prim_iter)
+			index_data_size += (*prim_iter)->num_indices*(*prim_iter)->index_byte_size;
+		return index_data_size;
+	}
 
 	VertexData::VertexData() :
-		vertices(NULL)
+		vertices(NULL),
+		num_vertices(0),
+		vertex_byte_size(0),
+		position_scale(1.0f),
+		position_bias(0.0f, 0.0f, 0.0f)
+	{
+	}
+
+	VertexData::VertexData(const VertexData& vertex_data) :
+		vertices(NULL),
+		num_vertices(0),
+		vertex_byte_size(0),
+		position_scale(1.0f),
+		position_bias(0.0f, 0.0f, 0.0f)
 	{
+		*this = vertex_data;
 	}
 
 	VertexData::~VertexData()
@@ -74,6 +801,44 @@ namespace gef
 		vertices = NULL;
 	}
 
+	VertexData& VertexData::operator=(const VertexData& vertex_data)
+	{
+		if(this != &vertex_data)
+		{
+			free(vertices);
+			vertices = NULL;
+
+			num_vertices = vertex_data.num_vertices;
+			vertex_byte_size = vertex_data.vertex_byte_size;
+			position_scale = vertex_data.position_scale;
+			position_bias = vertex_data.position_bias;
+			if(vertex_data.vertices)
+			{
+				vertices = malloc(num_vertices*vertex_byte_size);
+				memcpy(vertices, vertex_data.vertices, num_vertices*vertex_byte_size);
+			}
+		}
+
+		return *this;
+	}
+
+	Vector4 VertexData::GetPosition(const Int32 vertex_num) const
+	{
+		const UInt8* vertex = static_cast<const UInt8*>(vertices) + vertex_num*vertex_byte_size;
+
+		// every vertex format starts with the position
+		if(Mesh::IsPackedVertexSize(vertex_byte_size))
+		{
+			const Int16* position = reinterpret_cast<const Int16*>(vertex);
+			return Vector4(UnpackSignedNormalised16(position[0])*position_scale + position_bias.x(),
+				UnpackSignedNormalised16(position[1])*position_scale + position_bias.y(),
+				UnpackSignedNormalised16(position[2])*position_scale + position_bias.z());
+		}
+
+		const float* position = reinterpret_cast<const float*>(vertex);
+		return Vector4(position[0], position[1], position[2]);
+	}
+
 	bool VertexData::Read(std::istream& stream)
 	{
 		bool success = true;
@@ -87,6 +852,14 @@ namespace gef
 		else
 			success = false;
 
+		if(Mesh::IsPackedVertexSize(vertex_byte_size))
+		{
+			float bias[3];
+			stream.read((char*)&position_scale, sizeof(float));
+			stream.read((char*)bias, sizeof(bias));
+			position_bias = Vector4(bias[0], bias[1], bias[2]);
+		}
+
 		return success;
 	}
 
@@ -98,14 +871,30 @@ namespace gef
 		stream.write((char*)&vertex_byte_size, sizeof(Int32));
 		stream.write((char*)vertices, num_vertices*vertex_byte_size);
 
+		if(Mesh::IsPackedVertexSize(vertex_byte_size))
+		{
+			float bias[3] = { position_bias.x(), position_bias.y(), position_bias.z() };
+			stream.write((char*)&position_scale, sizeof(float));
+			stream.write((char*)bias, sizeof(bias));
+		}
+
 		return success;
 	}
 
 
 	PrimitiveData::PrimitiveData() :
 		indices(NULL),
-		material_name_id(0)
+		material_name_id(0),
+		num_indices(0),
+		index_byte_size(0),
+		type(UNDEFINED)
+	{
+	}
+
+	PrimitiveData::PrimitiveData(const PrimitiveData& primitive_data) :
+		indices(NULL)
 	{
+		*this = primitive_data;
 	}
 
 	PrimitiveData::~PrimitiveData()
@@ -114,6 +903,28 @@ namespace gef
 		indices = NULL;
 	}
 
+	PrimitiveData& PrimitiveData::operator=(const PrimitiveData& primitive_data)
+	{
+		if(this != &primitive_data)
+		{
+			free(indices);
+			indices = NULL;
+
+			material_name_id = primitive_data.material_name_id;
+			num_indices = primitive_data.num_indices;
+			index_byte_size = primitive_data.index_byte_size;
+			type = primitive_data.type;
+			clusters = primitive_data.clusters;
+			if(primitive_data.indices)
+			{
+				indices = malloc(num_indices*index_byte_size);
+				memcpy(indices, primitive_data.indices, num_indices*index_byte_size);
+			}
+		}
+
+		return *this;
+	}
+
 	bool PrimitiveData::Read(std::istream& stream)
 	{
 		bool success = true;
@@ -125,6 +936,10 @@ namespace gef
 		stream.read((char*)&index_byte_size, sizeof(Int32));
 		stream.read((char*)&type, sizeof(PrimitiveType));
 
+		// no renderer can draw 8 bit indices
+		if(index_byte_size == 1)
+			return false;
+
 		indices = malloc(num_indices*index_byte_size);
 		if(indices)
 			stream.read((char*)indices, num_indices*index_byte_size);
@@ -152,6 +967,52 @@ namespace gef
 	}
 
 
+	UInt32 PrimitiveData::GetIndex(const Int32 index_num) const
+	{
+		switch(index_byte_size)
+		{
+		case 1:
+			return static_cast<const UInt8*>(indices)[index_num];
+		case 2:
+			return static_cast<const UInt16*>(indices)[index_num];
+		default:
+			return static_cast<const UInt32*>(indices)[index_num];
+		}
+	}
+
+	void PrimitiveData::SetIndex(const Int32 index_num, const UInt32 index)
+	{
+		switch(index_byte_size)
+		{
+		case 1:
+			static_cast<UInt8*>(indices)[index_num] = static_cast<UInt8>(index);
+			break;
+		case 2:
+			static_cast<UInt16*>(indices)[index_num] = static_cast<UInt16>(index);
+			break;
+		default:
+			static_cast<UInt32*>(indices)[index_num] = index;
+			break;
+		}
+	}
+
+	void PrimitiveData::SetIndexByteSize(const Int32 new_index_byte_size)
+	{
+		if(new_index_byte_size == index_byte_size)
+			return;
+
+		PrimitiveData converted;
+		converted.index_byte_size = new_index_byte_size;
+		converted.indices = malloc(num_indices*new_index_byte_size);
+		for(Int32 index_num = 0; index_num < num_indices; ++index_num)
+			converted.SetIndex(index_num, GetIndex(index_num));
+
+		free(indices);
+		indices = converted.indices;
+		index_byte_size = new_index_byte_size;
+		converted.indices = NULL;
+	}
+
 	bool MaterialData::Read(std::istream& stream)
 	{
 		bool success = true;
@@ -25,45 +25,131 @@ namespace gef
 	struct PrimitiveData
 	{
 		PrimitiveData();
+		PrimitiveData(const PrimitiveData& primitive_data);
 		~PrimitiveData();
+		PrimitiveData& operator=(const PrimitiveData& primitive_data);
 
 		bool Read(std::istream& stream);
 		bool Write(std::ostream& stream) const;
 
+		UInt32 GetIndex(const Int32 index_num) const;
+		void SetIndex(const Int32 index_num, const UInt32 index);
+
+		// converts the index data to 1, 2 or 4 byte indices
+		void SetIndexByteSize(const Int32 new_index_byte_size);
+
 		void* indices;
 		//MaterialData* material;
 		gef::StringId material_name_id;
 		Int32 num_indices;
 		Int32 index_byte_size;
 		PrimitiveType type;
+
+		// culling data for runs of triangles, see BuildMeshClusters
+		// empty when the triangles haven't been clustered
+		std::vector<PrimitiveCluster> clusters;
 	};
 
 	struct VertexData
 	{
 		VertexData();
+		VertexData(const VertexData& vertex_data);
 		~VertexData();
+		VertexData& operator=(const VertexData& vertex_data);
 
 		bool Read(std::istream& stream);
 		bool Write(std::ostream& stream) const;
 
+		// mesh space position of a vertex in any of the Mesh vertex formats
+		Vector4 GetPosition(const Int32 vertex_num) const;
+
 		void* vertices;
 		Int32 num_vertices;
 		Int32 vertex_byte_size;
+
+		// only used by packed vertex formats
+		// mesh space position = packed position * position_scale + position_bias
+		float position_scale;
+		Vector4 position_bias;
 	};
 
 
+	// lower detail version of a mesh
+	// lods use the vertices of the full detail mesh so only the indices are stored
+	struct MeshLodData
+	{
+		MeshLodData();
+
+		bool Read(std::istream& stream);
+		bool Write(std::ostream& stream) const;
+
+		// largest distance of the simplified surface from the original, relative to the radius of the mesh
+		float error;
+
+		// the lod is drawn when the projected diameter of the mesh's bounding sphere
+		// is less than this fraction of the screen height
+		float screen_size;
+
+		// one for each primitive of the mesh, in the same order
+		std::vector<PrimitiveData> primitives;
+	};
+
+	// copies are deep so mesh data can be stored in contiguous containers
 	struct MeshData
 	{
 		MeshData();
+		MeshData(const MeshData& mesh_data);
 		~MeshData();
+		MeshData& operator=(const MeshData& mesh_data);
 
 		bool Read(std::istream& stream);
 		bool Write(std::ostream& stream) const;
 
+		// lods are stored in a separate scene chunk from the rest of the mesh
+		bool ReadLods(std::istream& stream);
+		bool WriteLods(std::ostream& stream) const;
+
+		// so are the clusters of the primitives
+		bool ReadClusters(std::istream& stream);
+		bool WriteClusters(std::ostream& stream) const;
+		bool HasClusters() const;
+
+		// removes vertices that are identical to an earlier vertex and remaps the indices
+		// returns the number of vertices removed
+		Int32 RemoveDuplicateVertices();
+
+		// converts the indices of each primitive to the smallest size that can address every vertex
+		// never smaller than 16 bit
+		void CompactIndices();
+
+		// splits the mesh into meshes with no more than 65536 vertices so they can all use 16 bit indices
+		// vertices are rebased so each mesh only contains the vertices its primitives use
+		// triangle strips are converted to triangle lists
+		// lods and clusters are not copied to the split meshes
+		// the split meshes are allocated with new and owned by the caller
+		void SplitForShortIndices(std::vector<MeshData*>& split_meshes) const;
+
+		// sorts primitives by material so draws with the same material are adjacent
+		// list primitives that share a material and type are merged when merge is true
+		// lod primitives are sorted and merged along with them, as are clusters
+		void SortPrimitivesByMaterial(const bool merge = true);
+
+		// converts Mesh::Vertex and Mesh::SkinnedVertex data to Mesh::PackedVertex and Mesh::PackedSkinnedVertex
+		// and back again
+		// returns false if the vertex data isn't in a format that can be converted
+		bool PackVertices();
+		bool UnpackVertices();
+
+		Int32 GetIndexCount() const;
+		Int32 GetIndexDataSize() const;
+
 		VertexData vertex_data;
 		std::vector<PrimitiveData*> primitives;
 		gef::StringId name_id;
 
+		// ordered from most to least detailed
+		std::vector<MeshLodData> lods;
+
 		Aabb aabb;
 	};
 }
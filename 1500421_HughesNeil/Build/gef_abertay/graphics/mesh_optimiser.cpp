@@ -0,0 +1,725 @@
+#include <graphics/mesh_optimiser.h>
+#include <graphics/mesh_data.h>
+#include <maths/vector4.h>
+#include <maths/aabb.h>
+#include <maths/sphere.h>
+#include <cfloat>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+
+namespace gef
+{
+	static const Int32 kMaxVertexCacheSize = 64;
+	static const Int32 kMaxValenceScore = 32;
+
+	// clusters don't take triangles facing more than 90 degrees from their average direction
+	static const float kMinClusterConeDot = 0.0f;
+
+	// vertex scoring constants from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+	static const float kCacheDecayPower = 1.5f;
+	static const float kLastTriangleScore = 0.75f;
+	static const float kValenceBoostScale = 2.0f;
+	static const float kValenceBoostPower = 0.5f;
+
+	// any indices after the last whole triangle are left where they are
+	static void GetTriangleListIndices(const PrimitiveData& primitive, std::vector<UInt32>& indices)
+	{
+		indices.resize(primitive.num_indices - primitive.num_indices%3);
+		for(size_t index_num = 0; index_num < indices.size(); ++index_num)
+			indices[index_num] = primitive.GetIndex((Int32)index_num);
+	}
+
+	static void SetTriangleListIndices(PrimitiveData& primitive, const std::vector<UInt32>& indices)
+	{
+		for(size_t index_num = 0; index_num < indices.size(); ++index_num)
+			primitive.SetIndex((Int32)index_num, indices[index_num]);
+	}
+
+	static Int32 GetVertexCount(const std::vector<UInt32>& indices)
+	{
+		UInt32 max_index = 0;
+		for(std::vector<UInt32>::const_iterator index_iter = indices.begin(); index_iter != indices.end(); ++index_iter)
+			max_index = *index_iter > max_index ? *index_iter : max_index;
+		return indices.empty() ? 0 : (Int32)max_index+1;
+	}
+
+	static inline Int32 ClampCacheSize(const Int32 cache_size)
+	{
+		return cache_size < 4 ? 4 : (cache_size > kMaxVertexCacheSize ? kMaxVertexCacheSize : cache_size);
+	}
+
+	struct VertexScoreTable
+	{
+		VertexScoreTable(const Int32 cache_size)
+		{
+			for(Int32 cache_position = 0; cache_position < cache_size; ++cache_position)
+			{
+				// the vertices of the last triangle get a fixed score so the next triangle doesn't just reuse the same edge
+				if(cache_position < 3)
+					cache_scores[cache_position] = kLastTriangleScore;
+				else
+					cache_scores[cache_position] = powf(1.0f - (float)(cache_position-3) / (float)(cache_size-3), kCacheDecayPower);
+			}
+
+			valence_scores[0] = 0.0f;
+			for(Int32 valence = 1; valence <= kMaxValenceScore; ++valence)
+				valence_scores[valence] = kValenceBoostScale * powf((float)valence, -kValenceBoostPower);
+		}
+
+		inline float VertexScore(const Int32 cache_position, const Int32 remaining_triangles) const
+		{
+			// vertices with no triangles left are never picked
+			if(remaining_triangles == 0)
+				return -1.0f;
+
+			float score = cache_position >= 0 ? cache_scores[cache_position] : 0.0f;
+
+			// boost vertices with few triangles left so they are finished off rather than left as lone triangles
+			if(remaining_triangles <= kMaxValenceScore)
+				score += valence_scores[remaining_triangles];
+			else
+				score += kValenceBoostScale * powf((float)remaining_triangles, -kValenceBoostPower);
+			return score;
+		}
+
+		float cache_scores[kMaxVertexCacheSize];
+		float valence_scores[kMaxValenceScore+1];
+	};
+
+	static void OptimiseTrianglesForVertexCache(std::vector<UInt32>& indices, const Int32 cache_size)
+	{
+		const Int32 num_triangles = (Int32)indices.size()/3;
+		if(num_triangles < 2)
+			return;
+
+		const Int32 num_vertices = GetVertexCount(indices);
+		const VertexScoreTable score_table(cache_size);
+
+		// list of the triangles that use each vertex
+		// triangles are removed from the lists as they are output
+		std::vector<Int32> remaining_triangles(num_vertices, 0);
+		for(size_t index_num = 0; index_num < indices.size(); ++index_num)
+			++remaining_triangles[indices[index_num]];
+
+		std::vector<Int32> vertex_triangles_offsets(num_vertices+1, 0);
+		for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+			vertex_triangles_offsets[vertex_num+1] = vertex_triangles_offsets[vertex_num] + remaining_triangles[vertex_num];
+
+		std::vector<Int32> vertex_triangles(indices.size());
+		{
+			std::vector<Int32> write_offsets(vertex_triangles_offsets.begin(), vertex_triangles_offsets.end()-1);
+			for(size_t index_num = 0; index_num < indices.size(); ++index_num)
+				vertex_triangles[write_offsets[indices[index_num]]++] = (Int32)(index_num/3);
+		}
+
+		std::vector<Int32> cache_positions(num_vertices, -1);
+		std::vector<float> vertex_scores(num_vertices);
+		for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+			vertex_scores[vertex_num] = score_table.VertexScore(-1, remaining_triangles[vertex_num]);
+
+		Int32 best_triangle = -1;
+		float best_score = -1.0f;
+		for(Int32 triangle_num = 0; triangle_num < num_triangles; ++triangle_num)
+		{
+			const UInt32* triangle = &indices[triangle_num*3];
+			const float score = vertex_scores[triangle[0]] + vertex_scores[triangle[1]] + vertex_scores[triangle[2]];
+			if(score > best_score)
+			{
+				best_score = score;
+				best_triangle = triangle_num;
+			}
+		}
+
+		std::vector<UInt8> triangle_output(num_triangles, 0);
+		std::vector<UInt32> optimised_indices;
+		optimised_indices.reserve(indices.size());
+
+		Int32 cache[kMaxVertexCacheSize+3];
+		Int32 new_cache[kMaxVertexCacheSize+3];
+		Int32 cache_count = 0;
+		Int32 next_triangle = 0;
+
+		for(Int32 output_count = 0; output_count < num_triangles; ++output_count)
+		{
+			if(best_triangle == -1)
+			{
+				// nothing in the cache has triangles left so carry on from the next triangle in the original order
+				while(triangle_output[next_triangle])
+					++next_triangle;
+				best_triangle = next_triangle;
+			}
+
+			const UInt32* triangle = &indices[best_triangle*3];
+			triangle_output[best_triangle] = 1;
+			optimised_indices.insert(optimised_indices.end(), triangle, triangle+3);
+
+			// the triangle's vertices move to the front of the cache
+			Int32 new_cache_count = 0;
+			for(Int32 corner = 0; corner < 3; ++corner)
+			{
+				const Int32 vertex = (Int32)triangle[corner];
+
+				Int32* triangles_begin = &vertex_triangles[vertex_triangles_offsets[vertex]];
+				Int32* triangles_end = triangles_begin + remaining_triangles[vertex];
+				Int32* found = std::find(triangles_begin, triangles_end, best_triangle);
+				if(found != triangles_end)
+				{
+					*found = *(triangles_end-1);
+					--remaining_triangles[vertex];
+				}
+
+				if(std::find(new_cache, new_cache+new_cache_count, vertex) == new_cache+new_cache_count)
+					new_cache[new_cache_count++] = vertex;
+			}
+
+			for(Int32 cache_num = 0; cache_num < cache_count; ++cache_num)
+			{
+				const Int32 vertex = cache[cache_num];
+				if((vertex != (Int32)triangle[0]) && (vertex != (Int32)triangle[1]) && (vertex != (Int32)triangle[2]))
+					new_cache[new_cache_count++] = vertex;
+			}
+
+			// vertices pushed out of the end of the cache
+			for(Int32 cache_num = cache_size; cache_num < new_cache_count; ++cache_num)
+			{
+				const Int32 vertex = new_cache[cache_num];
+				cache_positions[vertex] = -1;
+				vertex_scores[vertex] = score_table.VertexScore(-1, remaining_triangles[vertex]);
+			}
+
+			cache_count = new_cache_count < cache_size ? new_cache_count : cache_size;
+			for(Int32 cache_num = 0; cache_num < cache_count; ++cache_num)
+			{
+				const Int32 vertex = new_cache[cache_num];
+				cache[cache_num] = vertex;
+				cache_positions[vertex] = cache_num;
+				vertex_scores[vertex] = score_table.VertexScore(cache_num, remaining_triangles[vertex]);
+			}
+
+			// only triangles using vertices in the cache have changed score
+			best_triangle = -1;
+			best_score = -1.0f;
+			for(Int32 cache_num = 0; cache_num < cache_count; ++cache_num)
+			{
+				const Int32 vertex = cache[cache_num];
+				const Int32* triangles_begin = &vertex_triangles[vertex_triangles_offsets[vertex]];
+				for(Int32 triangle_num = 0; triangle_num < remaining_triangles[vertex]; ++triangle_num)
+				{
+					const Int32 candidate = triangles_begin[triangle_num];
+					const UInt32* candidate_triangle = &indices[candidate*3];
+					const float score = vertex_scores[candidate_triangle[0]] + vertex_scores[candidate_triangle[1]] + vertex_scores[candidate_triangle[2]];
+					if(score > best_score)
+					{
+						best_score = score;
+						best_triangle = candidate;
+					}
+				}
+			}
+		}
+
+		indices.swap(optimised_indices);
+	}
+
+	// FIFO cache simulation using timestamps
+	// a vertex is in the cache if it was added less than cache_size misses ago
+	// adding cache_size+1 to the timestamp flushes the cache
+	static Int32 UpdateFifoCache(const UInt32* triangle, std::vector<UInt32>& cache_timestamps, UInt32& timestamp, const Int32 cache_size)
+	{
+		Int32 misses = 0;
+		for(Int32 corner = 0; corner < 3; ++corner)
+		{
+			if(timestamp - cache_timestamps[triangle[corner]] > (UInt32)cache_size)
+			{
+				cache_timestamps[triangle[corner]] = timestamp++;
+				++misses;
+			}
+		}
+		return misses;
+	}
+
+	struct TriangleCluster
+	{
+		Int32 start;
+		Int32 end;
+		Vector4 centroid;
+		Vector4 normal;
+		float area;
+		float sort_key;
+	};
+
+	static bool CompareClusterSortKeys(const TriangleCluster& lhs, const TriangleCluster& rhs)
+	{
+		return lhs.sort_key > rhs.sort_key;
+	}
+
+	static void OptimiseTrianglesForOverdraw(std::vector<UInt32>& indices, const VertexData& vertex_data, const float threshold, const Int32 cache_size)
+	{
+		const Int32 num_triangles = (Int32)indices.size()/3;
+		if(num_triangles < 2)
+			return;
+
+		const Int32 num_vertices = GetVertexCount(indices);
+		if(num_vertices > vertex_data.num_vertices)
+			return;
+
+		std::vector<UInt32> cache_timestamps(num_vertices, 0);
+		UInt32 timestamp = cache_size+1;
+
+		// a triangle where all three vertices miss is usually the start of a new patch of the mesh
+		std::vector<Int32> patch_starts;
+		for(Int32 triangle_num = 0; triangle_num < num_triangles; ++triangle_num)
+		{
+			if((UpdateFifoCache(&indices[triangle_num*3], cache_timestamps, timestamp, cache_size) == 3) || (triangle_num == 0))
+				patch_starts.push_back(triangle_num);
+		}
+		patch_starts.push_back(num_triangles);
+
+		// split patches into smaller clusters as long as the clusters stay within the threshold of the patch's miss ratio
+		// the cache is flushed at the start of each cluster because clusters can be drawn in any order
+		std::vector<Int32> cluster_starts;
+		for(size_t patch_num = 0; patch_num+1 < patch_starts.size(); ++patch_num)
+		{
+			const Int32 patch_start = patch_starts[patch_num];
+			const Int32 patch_end = patch_starts[patch_num+1];
+
+			timestamp += cache_size+1;
+			Int32 patch_misses = 0;
+			for(Int32 triangle_num = patch_start; triangle_num < patch_end; ++triangle_num)
+				patch_misses += UpdateFifoCache(&indices[triangle_num*3], cache_timestamps, timestamp, cache_size);
+			const float target_miss_ratio = threshold * (float)patch_misses / (float)(patch_end-patch_start);
+
+			timestamp += cache_size+1;
+			cluster_starts.push_back(patch_start);
+			Int32 cluster_misses = 0;
+			Int32 cluster_triangles = 0;
+			for(Int32 triangle_num = patch_start; triangle_num < patch_end; ++triangle_num)
+			{
+				cluster_misses += UpdateFifoCache(&indices[triangle_num*3], cache_timestamps, timestamp, cache_size);
+				++cluster_triangles;
+				if((float)cluster_misses <= target_miss_ratio*(float)cluster_triangles)
+				{
+					if(triangle_num+1 < patch_end)
+						cluster_starts.push_back(triangle_num+1);
+					timestamp += cache_size+1;
+					cluster_misses = 0;
+					cluster_triangles = 0;
+				}
+			}
+
+			// the last cluster didn't reach the target so join it on to the one before
+			if((cluster_triangles > 0) && (cluster_starts.back() != patch_start))
+				cluster_starts.pop_back();
+		}
+
+		if(cluster_starts.size() < 2)
+			return;
+
+		std::vector<Vector4> positions(num_vertices);
+		for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+			positions[vertex_num] = vertex_data.GetPosition(vertex_num);
+
+		// area weighted centroid and normal of each cluster
+		std::vector<TriangleCluster> clusters(cluster_starts.size());
+		Vector4 mesh_centroid(0.0f, 0.0f, 0.0f);
+		float mesh_area = 0.0f;
+		float mesh_volume = 0.0f;
+		for(size_t cluster_num = 0; cluster_num < clusters.size(); ++cluster_num)
+		{
+			TriangleCluster& cluster = clusters[cluster_num];
+			cluster.start = cluster_starts[cluster_num];
+			cluster.end = cluster_num+1 < cluster_starts.size() ? cluster_starts[cluster_num+1] : num_triangles;
+			cluster.centroid = Vector4(0.0f, 0.0f, 0.0f);
+			cluster.normal = Vector4(0.0f, 0.0f, 0.0f);
+			cluster.area = 0.0f;
+
+			for(Int32 triangle_num = cluster.start; triangle_num < cluster.end; ++triangle_num)
+			{
+				const Vector4& p0 = positions[indices[triangle_num*3]];
+				const Vector4& p1 = positions[indices[triangle_num*3+1]];
+				const Vector4& p2 = positions[indices[triangle_num*3+2]];
+				const Vector4 normal = (p1 - p0).CrossProduct(p2 - p0);
+				const float area = normal.Length();
+
+				cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+				cluster.normal += normal;
+				cluster.area += area;
+				mesh_volume += p0.DotProduct(normal);
+			}
+
+			mesh_centroid += cluster.centroid;
+			mesh_area += cluster.area;
+		}
+
+		if(mesh_area > 0.0f)
+			mesh_centroid /= mesh_area;
+
+		// a closed mesh has positive volume when its triangle normals point outwards
+		// use the sign to cope with either winding order
+		const float winding = mesh_volume < 0.0f ? -1.0f : 1.0f;
+
+		// clusters further out along their normal are drawn first as they are most likely to occlude the others
+		for(std::vector<TriangleCluster>::iterator cluster_iter = clusters.begin(); cluster_iter != clusters.end(); ++cluster_iter)
+		{
+			cluster_iter->sort_key = 0.0f;
+			const float normal_length = cluster_iter->normal.Length();
+			if((cluster_iter->area > 0.0f) && (normal_length > 0.0f))
+			{
+				const Vector4 centroid = cluster_iter->centroid / cluster_iter->area;
+				cluster_iter->sort_key = (centroid - mesh_centroid).DotProduct(cluster_iter->normal) * winding / normal_length;
+			}
+		}
+
+		std::stable_sort(clusters.begin(), clusters.end(), CompareClusterSortKeys);
+
+		std::vector<UInt32> sorted_indices;
+		sorted_indices.reserve(indices.size());
+		for(std::vector<TriangleCluster>::const_iterator cluster_iter = clusters.begin(); cluster_iter != clusters.end(); ++cluster_iter)
+			sorted_indices.insert(sorted_indices.end(), indices.begin() + cluster_iter->start*3, indices.begin() + cluster_iter->end*3);
+		indices.swap(sorted_indices);
+	}
+
+	// lod primitives are optimised along with the full detail ones
+	static void GetTriangleListPrimitives(MeshData& mesh, std::vector<PrimitiveData*>& primitives)
+	{
+		primitives.clear();
+		for(std::vector<PrimitiveData*>::iterator prim_iter = mesh.primitives.begin(); prim_iter != mesh.primitives.end(); ++prim_iter)
+		{
+			if((*prim_iter)->type == TRIANGLE_LIST)
+				primitives.push_back(*prim_iter);
+		}
+
+		for(std::vector<MeshLodData>::iterator lod_iter = mesh.lods.begin(); lod_iter != mesh.lods.end(); ++lod_iter)
+		{
+			for(std::vector<PrimitiveData>::iterator prim_iter = lod_iter->primitives.begin(); prim_iter != lod_iter->primitives.end(); ++prim_iter)
+			{
+				if(prim_iter->type == TRIANGLE_LIST)
+					primitives.push_back(&*prim_iter);
+			}
+		}
+	}
+
+	void OptimiseVertexCache(MeshData& mesh, const Int32 cache_size)
+	{
+		std::vector<PrimitiveData*> primitives;
+		GetTriangleListPrimitives(mesh, primitives);
+
+		std::vector<UInt32> indices;
+		for(std::vector<PrimitiveData*>::iterator prim_iter = primitives.begin(); prim_iter != primitives.end(); ++prim_iter)
+		{
+			GetTriangleListIndices(**prim_iter, indices);
+			OptimiseTrianglesForVertexCache(indices, ClampCacheSize(cache_size));
+			SetTriangleListIndices(**prim_iter, indices);
+			(*prim_iter)->clusters.clear();
+		}
+	}
+
+	void OptimiseOverdraw(MeshData& mesh, const float threshold, const Int32 cache_size)
+	{
+		if(mesh.vertex_data.vertices == NULL)
+			return;
+
+		std::vector<PrimitiveData*> primitives;
+		GetTriangleListPrimitives(mesh, primitives);
+
+		std::vector<UInt32> indices;
+		for(std::vector<PrimitiveData*>::iterator prim_iter = primitives.begin(); prim_iter != primitives.end(); ++prim_iter)
+		{
+			GetTriangleListIndices(**prim_iter, indices);
+			OptimiseTrianglesForOverdraw(indices, mesh.vertex_data, threshold, ClampCacheSize(cache_size));
+			SetTriangleListIndices(**prim_iter, indices);
+			(*prim_iter)->clusters.clear();
+		}
+	}
+
+	Int32 OptimiseVertexFetch(MeshData& mesh)
+	{
+		const Int32 num_vertices = mesh.vertex_data.num_vertices;
+		const Int32 vertex_byte_size = mesh.vertex_data.vertex_byte_size;
+		if((num_vertices == 0) || (mesh.vertex_data.vertices == NULL))
+			return 0;
+
+		// vertices are numbered in the order the primitives first use them
+		std::vector<Int32> remap(num_vertices, -1);
+		Int32 num_used_vertices = 0;
+		for(std::vector<PrimitiveData*>::iterator prim_iter = mesh.primitives.begin(); prim_iter != mesh.primitives.end(); ++prim_iter)
+		{
+			PrimitiveData* primitive = *prim_iter;
+			for(Int32 index_num = 0; index_num < primitive->num_indices; ++index_num)
+			{
+				const UInt32 index = primitive->GetIndex(index_num);
+				if(remap[index] == -1)
+					remap[index] = num_used_vertices++;
+				primitive->SetIndex(index_num, (UInt32)remap[index]);
+			}
+		}
+
+		// lods only use vertices of the full detail mesh but anything they use on their own is kept
+		for(std::vector<MeshLodData>::iterator lod_iter = mesh.lods.begin(); lod_iter != mesh.lods.end(); ++lod_iter)
+		{
+			for(std::vector<PrimitiveData>::iterator prim_iter = lod_iter->primitives.begin(); prim_iter != lod_iter->primitives.end(); ++prim_iter)
+			{
+				for(Int32 index_num = 0; index_num < prim_iter->num_indices; ++index_num)
+				{
+					const UInt32 index = prim_iter->GetIndex(index_num);
+					if(remap[index] == -1)
+						remap[index] = num_used_vertices++;
+					prim_iter->SetIndex(index_num, (UInt32)remap[index]);
+				}
+			}
+		}
+
+		const UInt8* vertices = static_cast<const UInt8*>(mesh.vertex_data.vertices);
+		UInt8* reordered_vertices = static_cast<UInt8*>(malloc(num_used_vertices*vertex_byte_size));
+		for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+		{
+			if(remap[vertex_num] != -1)
+				memcpy(reordered_vertices + remap[vertex_num]*vertex_byte_size, vertices + vertex_num*vertex_byte_size, vertex_byte_size);
+		}
+
+		free(mesh.vertex_data.vertices);
+		mesh.vertex_data.vertices = reordered_vertices;
+		mesh.vertex_data.num_vertices = num_used_vertices;
+
+		return num_vertices - num_used_vertices;
+	}
+
+	// front faces are clockwise so the outward normal is the opposite of the anticlockwise cross product
+	static inline Vector4 FrontFaceNormal(const Vector4& p0, const Vector4& p1, const Vector4& p2)
+	{
+		return (p2 - p0).CrossProduct(p1 - p0);
+	}
+
+	static void CalculateClusterCullingData(PrimitiveCluster& cluster, const std::vector<UInt32>& indices, const std::vector<Vector4>& positions)
+	{
+		const UInt32 end_index = cluster.start_index + cluster.num_indices;
+
+		Aabb aabb;
+		for(UInt32 index_num = cluster.start_index; index_num < end_index; ++index_num)
+			aabb.Update(positions[indices[index_num]]);
+
+		const Vector4 centre = (aabb.min_vtx() + aabb.max_vtx()) * 0.5f;
+		float radius_sqr = 0.0f;
+		for(UInt32 index_num = cluster.start_index; index_num < end_index; ++index_num)
+			radius_sqr = std::max(radius_sqr, (positions[indices[index_num]] - centre).LengthSqr());
+		cluster.bounds = Sphere(centre, sqrtf(radius_sqr));
+
+		// the cone axis is the average direction of the triangles
+		// and the cutoff is set by the triangle furthest from it
+		Vector4 axis(0.0f, 0.0f, 0.0f);
+		for(UInt32 index_num = cluster.start_index; index_num < end_index; index_num += 3)
+		{
+			Vector4 normal = FrontFaceNormal(positions[indices[index_num]], positions[indices[index_num+1]], positions[indices[index_num+2]]);
+			if(normal.LengthSqr() > 0.0f)
+			{
+				normal.Normalise();
+				axis += normal;
+			}
+		}
+
+		cluster.cone_axis = Vector4(0.0f, 0.0f, 0.0f);
+		cluster.cone_cutoff = 1.0f;
+		if(axis.LengthSqr() <= 0.0f)
+			return;
+		axis.Normalise();
+
+		float min_dot = 1.0f;
+		for(UInt32 index_num = cluster.start_index; index_num < end_index; index_num += 3)
+		{
+			Vector4 normal = FrontFaceNormal(positions[indices[index_num]], positions[indices[index_num+1]], positions[indices[index_num+2]]);
+			if(normal.LengthSqr() > 0.0f)
+			{
+				normal.Normalise();
+				min_dot = std::min(min_dot, normal.DotProduct(axis));
+			}
+		}
+
+		// wide cones would almost never cull anything
+		cluster.cone_axis = axis;
+		if(min_dot > kMinClusterConeDot)
+			cluster.cone_cutoff = sqrtf(1.0f - min_dot*min_dot);
+	}
+
+	static void BuildPrimitiveClusters(PrimitiveData& primitive, const std::vector<Vector4>& positions, const Int32 max_cluster_triangles, const Int32 cache_size)
+	{
+		std::vector<UInt32> indices;
+		GetTriangleListIndices(primitive, indices);
+		const Int32 num_triangles = (Int32)indices.size()/3;
+
+		primitive.clusters.clear();
+		if(num_triangles == 0)
+			return;
+
+		std::vector<Vector4> centroids(num_triangles);
+		std::vector<Vector4> normals(num_triangles);
+		for(Int32 triangle_num = 0; triangle_num < num_triangles; ++triangle_num)
+		{
+			const Vector4& p0 = positions[indices[triangle_num*3]];
+			const Vector4& p1 = positions[indices[triangle_num*3+1]];
+			const Vector4& p2 = positions[indices[triangle_num*3+2]];
+			centroids[triangle_num] = (p0 + p1 + p2) / 3.0f;
+			normals[triangle_num] = FrontFaceNormal(p0, p1, p2);
+			if(normals[triangle_num].LengthSqr() > 0.0f)
+				normals[triangle_num].Normalise();
+		}
+
+		// triangles around each vertex
+		const Int32 num_vertices = GetVertexCount(indices);
+		std::vector<Int32> vertex_triangle_starts(num_vertices+1, 0);
+		for(size_t index_num = 0; index_num < indices.size(); ++index_num)
+			++vertex_triangle_starts[indices[index_num]+1];
+		for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+			vertex_triangle_starts[vertex_num+1] += vertex_triangle_starts[vertex_num];
+		std::vector<Int32> vertex_triangles(indices.size());
+		{
+			std::vector<Int32> offsets(vertex_triangle_starts.begin(), vertex_triangle_starts.end()-1);
+			for(size_t index_num = 0; index_num < indices.size(); ++index_num)
+				vertex_triangles[offsets[indices[index_num]]++] = (Int32)index_num/3;
+		}
+
+		std::vector<UInt8> emitted(num_triangles, 0);
+		std::vector<Int32> candidate_cluster(num_triangles, -1);
+		std::vector<Int32> candidates;
+		std::vector<UInt32> cluster_indices;
+		std::vector<UInt32> clustered_indices;
+		clustered_indices.reserve(indices.size());
+
+		// grow each cluster from a seed triangle, adding the neighbour closest to the cluster
+		// that faces the same way until the cluster is full or there are no suitable neighbours
+		Int32 seed = 0;
+		for(Int32 cluster_num = 0; (Int32)clustered_indices.size() < num_triangles*3; ++cluster_num)
+		{
+			while(emitted[seed])
+				++seed;
+
+			Vector4 normal_sum(0.0f, 0.0f, 0.0f);
+			Vector4 centroid_sum(0.0f, 0.0f, 0.0f);
+			float radius = 0.0f;
+			Int32 cluster_triangles = 0;
+			cluster_indices.clear();
+			candidates.clear();
+
+			Int32 triangle_num = seed;
+			while(triangle_num != -1)
+			{
+				emitted[triangle_num] = 1;
+				++cluster_triangles;
+				normal_sum += normals[triangle_num];
+				centroid_sum += centroids[triangle_num];
+				for(Int32 corner = 0; corner < 3; ++corner)
+				{
+					const UInt32 vertex = indices[triangle_num*3+corner];
+					cluster_indices.push_back(vertex);
+
+					for(Int32 neighbour_num = vertex_triangle_starts[vertex]; neighbour_num < vertex_triangle_starts[vertex+1]; ++neighbour_num)
+					{
+						const Int32 neighbour = vertex_triangles[neighbour_num];
+						if(!emitted[neighbour] && (candidate_cluster[neighbour] != cluster_num))
+						{
+							candidate_cluster[neighbour] = cluster_num;
+							candidates.push_back(neighbour);
+						}
+					}
+				}
+
+				if(cluster_triangles >= max_cluster_triangles)
+					break;
+
+				const Vector4 centre = centroid_sum / (float)cluster_triangles;
+				radius = std::max(radius, (centroids[triangle_num] - centre).Length());
+				Vector4 axis = normal_sum;
+				if(axis.LengthSqr() > 0.0f)
+					axis.Normalise();
+
+				// lower scores are better
+				triangle_num = -1;
+				float best_score = FLT_MAX;
+				for(size_t candidate_num = 0; candidate_num < candidates.size();)
+				{
+					const Int32 candidate = candidates[candidate_num];
+					if(emitted[candidate])
+					{
+						candidates[candidate_num] = candidates.back();
+						candidates.pop_back();
+						continue;
+					}
+
+					const float facing = normals[candidate].DotProduct(axis);
+					if(facing >= kMinClusterConeDot)
+					{
+						const float distance = (centroids[candidate] - centre).Length();
+						const float score = distance / (radius + distance + FLT_MIN) + (1.0f - facing);
+						if(score < best_score)
+						{
+							best_score = score;
+							triangle_num = candidate;
+						}
+					}
+					++candidate_num;
+				}
+			}
+
+			OptimiseTrianglesForVertexCache(cluster_indices, cache_size);
+
+			PrimitiveCluster cluster;
+			cluster.start_index = (UInt32)clustered_indices.size();
+			cluster.num_indices = (UInt32)cluster_indices.size();
+			clustered_indices.insert(clustered_indices.end(), cluster_indices.begin(), cluster_indices.end());
+			primitive.clusters.push_back(cluster);
+		}
+
+		for(std::vector<PrimitiveCluster>::iterator cluster_iter = primitive.clusters.begin(); cluster_iter != primitive.clusters.end(); ++cluster_iter)
+			CalculateClusterCullingData(*cluster_iter, clustered_indices, positions);
+
+		SetTriangleListIndices(primitive, clustered_indices);
+	}
+
+	void BuildMeshClusters(MeshData& mesh, const Int32 max_cluster_triangles, const Int32 cache_size)
+	{
+		if(mesh.vertex_data.vertices == NULL)
+			return;
+
+		std::vector<Vector4> positions(mesh.vertex_data.num_vertices);
+		for(Int32 vertex_num = 0; vertex_num < mesh.vertex_data.num_vertices; ++vertex_num)
+			positions[vertex_num] = mesh.vertex_data.GetPosition(vertex_num);
+
+		const Int32 cluster_triangles = max_cluster_triangles < 1 ? 1 : max_cluster_triangles;
+		for(std::vector<PrimitiveData*>::iterator prim_iter = mesh.primitives.begin(); prim_iter != mesh.primitives.end(); ++prim_iter)
+		{
+			if((*prim_iter)->type == TRIANGLE_LIST)
+				BuildPrimitiveClusters(**prim_iter, positions, cluster_triangles, ClampCacheSize(cache_size));
+		}
+	}
+
+	void OptimiseMesh(MeshData& mesh)
+	{
+		OptimiseVertexCache(mesh);
+		OptimiseOverdraw(mesh);
+		OptimiseVertexFetch(mesh);
+	}
+
+	float CalculateVertexCacheMissRatio(const MeshData& mesh, const Int32 cache_size)
+	{
+		Int32 misses = 0;
+		Int32 num_triangles = 0;
+		std::vector<UInt32> indices;
+		std::vector<UInt32> cache_timestamps;
+		for(std::vector<PrimitiveData*>::const_iterator prim_iter = mesh.primitives.begin(); prim_iter != mesh.primitives.end(); ++prim_iter)
+		{
+			const PrimitiveData* primitive = *prim_iter;
+			if(primitive->type != TRIANGLE_LIST)
+				continue;
+
+			GetTriangleListIndices(*primitive, indices);
+			cache_timestamps.assign(GetVertexCount(indices), 0);
+			UInt32 timestamp = cache_size+1;
+			for(size_t index_num = 0; index_num < indices.size(); index_num += 3)
+				misses += UpdateFifoCache(&indices[index_num], cache_timestamps, timestamp, cache_size);
+			num_triangles += (Int32)indices.size()/3;
+		}
+
+		return num_triangles > 0 ? (float)misses / (float)num_triangles : 0.0f;
+	}
+}
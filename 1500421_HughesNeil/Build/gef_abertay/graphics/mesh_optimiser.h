@@ -0,0 +1,45 @@
+#ifndef _GEF_MESH_OPTIMISER_H
+#define _GEF_MESH_OPTIMISER_H
+
+#include <gef.h>
+
+namespace gef
+{
+	struct MeshData;
+
+	// mesh optimisations that reorder MeshData in place
+	// only triangle list primitives are reordered, other primitive types are left as they are
+	// lod primitives are reordered along with the full detail primitives
+	// the rendered result is unchanged apart from the order triangles are drawn in
+
+	// reorders triangles to reduce post transform vertex cache misses
+	// uses Tom Forsyth's linear speed vertex cache optimisation with an LRU cache of cache_size entries
+	void OptimiseVertexCache(MeshData& mesh, const Int32 cache_size = 32);
+
+	// reorders clusters of triangles so triangles facing outwards from the centre of the mesh are drawn first
+	// this reduces overdraw when the mesh occludes itself
+	// call after OptimiseVertexCache, threshold is how much the vertex cache miss ratio is allowed to rise
+	// i.e. 1.05 allows 5% more vertex transforms in exchange for less overdraw
+	void OptimiseOverdraw(MeshData& mesh, const float threshold = 1.05f, const Int32 cache_size = 16);
+
+	// reorders vertices into the order the primitives first use them so vertex fetches are sequential
+	// vertices that aren't used by any primitive are removed
+	// returns the number of vertices removed
+	Int32 OptimiseVertexFetch(MeshData& mesh);
+
+	// reorders the triangles of each triangle list primitive into clusters of up to max_cluster_triangles
+	// neighbouring triangles that face the same way and fills in PrimitiveData::clusters
+	// triangles are reordered for the vertex cache within each cluster
+	// the other optimisations here throw away the clusters of any primitive they reorder so call this last
+	void BuildMeshClusters(MeshData& mesh, const Int32 max_cluster_triangles = 128, const Int32 cache_size = 32);
+
+	// runs all of the optimisations above with the default settings
+	// apart from BuildMeshClusters
+	void OptimiseMesh(MeshData& mesh);
+
+	// average number of vertices transformed per triangle with a FIFO vertex cache of cache_size entries
+	// 0.5 is ideal for a regular grid, 3.0 means no vertices are reused
+	float CalculateVertexCacheMissRatio(const MeshData& mesh, const Int32 cache_size = 16);
+}
+
+#endif // _GEF_MESH_OPTIMISER_H
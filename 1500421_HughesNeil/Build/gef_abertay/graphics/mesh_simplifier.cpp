@@ -0,0 +1,480 @@
+#include <graphics/mesh_simplifier.h>
+#include <graphics/mesh_data.h>
+#include <maths/vector4.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+
+namespace gef
+{
+	// the fraction of triangles a lod has to remove to be worth keeping
+	static const float kMinLodReduction = 0.1f;
+
+	// sum of squared distances to a set of planes, weighted by area
+	struct Quadric
+	{
+		Quadric()
+		{
+			for(Int32 element = 0; element < 10; ++element)
+				q[element] = 0.0;
+			weight = 0.0;
+		}
+
+		void AddPlane(const double a, const double b, const double c, const double d, const double plane_weight)
+		{
+			q[0] += a*a*plane_weight; q[1] += a*b*plane_weight; q[2] += a*c*plane_weight; q[3] += a*d*plane_weight;
+			q[4] += b*b*plane_weight; q[5] += b*c*plane_weight; q[6] += b*d*plane_weight;
+			q[7] += c*c*plane_weight; q[8] += c*d*plane_weight;
+			q[9] += d*d*plane_weight;
+			weight += plane_weight;
+		}
+
+		void Add(const Quadric& quadric)
+		{
+			for(Int32 element = 0; element < 10; ++element)
+				q[element] += quadric.q[element];
+			weight += quadric.weight;
+		}
+
+		double Evaluate(const Vector4& position) const
+		{
+			const double x = position.x(), y = position.y(), z = position.z();
+			const double error = x*x*q[0] + 2.0*x*y*q[1] + 2.0*x*z*q[2] + 2.0*x*q[3]
+				+ y*y*q[4] + 2.0*y*z*q[5] + 2.0*y*q[6]
+				+ z*z*q[7] + 2.0*z*q[8]
+				+ q[9];
+			return error > 0.0 ? error : 0.0;
+		}
+
+		double q[10];
+		double weight;
+	};
+
+	struct SimplifyTriangle
+	{
+		UInt32 vertices[3];
+		Int32 primitive_index;
+	};
+
+	struct CollapseCandidate
+	{
+		UInt32 from;
+		UInt32 to;
+		double cost;
+	};
+
+	static bool CompareCollapseCosts(const CollapseCandidate& lhs, const CollapseCandidate& rhs)
+	{
+		return lhs.cost < rhs.cost;
+	}
+
+	static inline UInt64 EdgeKey(UInt32 a, UInt32 b)
+	{
+		return a < b ? ((UInt64)a << 32) | b : ((UInt64)b << 32) | a;
+	}
+
+	struct PositionOrder
+	{
+		PositionOrder(const std::vector<Vector4>& positions) : positions_(positions) {}
+
+		bool operator()(const UInt32 lhs, const UInt32 rhs) const
+		{
+			const Vector4& l = positions_[lhs];
+			const Vector4& r = positions_[rhs];
+			if(l.x() != r.x())
+				return l.x() < r.x();
+			if(l.y() != r.y())
+				return l.y() < r.y();
+			return l.z() < r.z();
+		}
+
+		const std::vector<Vector4>& positions_;
+	};
+
+	// number of times each edge of the triangles is used, sorted by edge key
+	static void CountEdges(const std::vector<SimplifyTriangle>& triangles, std::vector<UInt64>& edge_keys, std::vector<Int32>& edge_counts)
+	{
+		std::vector<UInt64> all_edges;
+		all_edges.reserve(triangles.size()*3);
+		for(std::vector<SimplifyTriangle>::const_iterator triangle_iter = triangles.begin(); triangle_iter != triangles.end(); ++triangle_iter)
+		{
+			for(Int32 corner = 0; corner < 3; ++corner)
+				all_edges.push_back(EdgeKey(triangle_iter->vertices[corner], triangle_iter->vertices[(corner+1)%3]));
+		}
+		std::sort(all_edges.begin(), all_edges.end());
+
+		edge_keys.clear();
+		edge_counts.clear();
+		for(size_t edge_num = 0; edge_num < all_edges.size(); ++edge_num)
+		{
+			if(edge_keys.empty() || (edge_keys.back() != all_edges[edge_num]))
+			{
+				edge_keys.push_back(all_edges[edge_num]);
+				edge_counts.push_back(0);
+			}
+			++edge_counts.back();
+		}
+	}
+
+	static inline Int32 GetEdgeCount(const std::vector<UInt64>& edge_keys, const std::vector<Int32>& edge_counts, const UInt32 a, const UInt32 b)
+	{
+		std::vector<UInt64>::const_iterator key_iter = std::lower_bound(edge_keys.begin(), edge_keys.end(), EdgeKey(a, b));
+		if((key_iter == edge_keys.end()) || (*key_iter != EdgeKey(a, b)))
+			return 0;
+		return edge_counts[key_iter - edge_keys.begin()];
+	}
+
+	static inline Vector4 TriangleNormal(const Vector4& p0, const Vector4& p1, const Vector4& p2)
+	{
+		return (p1 - p0).CrossProduct(p2 - p0);
+	}
+
+	float SimplifyMesh(const MeshData& mesh, std::vector<PrimitiveData>& lod_primitives, const Int32 target_triangle_count, const float max_error)
+	{
+		const Int32 num_vertices = mesh.vertex_data.num_vertices;
+
+		lod_primitives.clear();
+		lod_primitives.resize(mesh.primitives.size());
+
+		std::vector<Vector4> positions(num_vertices);
+		for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+			positions[vertex_num] = mesh.vertex_data.GetPosition(vertex_num);
+
+		// vertices that must stay where they are
+		std::vector<UInt8> locked(num_vertices, 0);
+		std::vector<Int32> vertex_primitive(num_vertices, -1);
+
+		std::vector<SimplifyTriangle> triangles;
+		std::vector<Int32> primitive_triangle_counts(mesh.primitives.size(), 0);
+		for(size_t prim_num = 0; prim_num < mesh.primitives.size(); ++prim_num)
+		{
+			const PrimitiveData* primitive = mesh.primitives[prim_num];
+			const bool simplify = primitive->type == TRIANGLE_LIST;
+			for(Int32 index_num = 0; index_num < primitive->num_indices; ++index_num)
+			{
+				const UInt32 index = primitive->GetIndex(index_num);
+				if(!simplify || ((vertex_primitive[index] != -1) && (vertex_primitive[index] != (Int32)prim_num)))
+					locked[index] = 1;
+				vertex_primitive[index] = (Int32)prim_num;
+			}
+
+			if(!simplify)
+			{
+				lod_primitives[prim_num] = *primitive;
+				continue;
+			}
+
+			for(Int32 index_num = 0; index_num+2 < primitive->num_indices; index_num += 3)
+			{
+				SimplifyTriangle triangle;
+				triangle.primitive_index = (Int32)prim_num;
+				for(Int32 corner = 0; corner < 3; ++corner)
+					triangle.vertices[corner] = primitive->GetIndex(index_num+corner);
+				if((triangle.vertices[0] != triangle.vertices[1]) && (triangle.vertices[1] != triangle.vertices[2]) && (triangle.vertices[2] != triangle.vertices[0]))
+				{
+					triangles.push_back(triangle);
+					++primitive_triangle_counts[prim_num];
+				}
+			}
+		}
+
+		// vertices that share a position with another vertex are on a uv or normal seam
+		// moving one side of the seam would open a crack
+		std::vector<UInt32> sorted_vertices(num_vertices);
+		for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+			sorted_vertices[vertex_num] = (UInt32)vertex_num;
+		std::sort(sorted_vertices.begin(), sorted_vertices.end(), PositionOrder(positions));
+		for(Int32 vertex_num = 1; vertex_num < num_vertices; ++vertex_num)
+		{
+			const Vector4& previous = positions[sorted_vertices[vertex_num-1]];
+			const Vector4& current = positions[sorted_vertices[vertex_num]];
+			if((previous.x() == current.x()) && (previous.y() == current.y()) && (previous.z() == current.z()))
+			{
+				locked[sorted_vertices[vertex_num-1]] = 1;
+				locked[sorted_vertices[vertex_num]] = 1;
+			}
+		}
+
+		// errors are measured relative to the size of the mesh
+		Vector4 min_position(FLT_MAX, FLT_MAX, FLT_MAX), max_position(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for(std::vector<Vector4>::const_iterator position_iter = positions.begin(); position_iter != positions.end(); ++position_iter)
+		{
+			min_position = Vector4(std::min(min_position.x(), position_iter->x()), std::min(min_position.y(), position_iter->y()), std::min(min_position.z(), position_iter->z()));
+			max_position = Vector4(std::max(max_position.x(), position_iter->x()), std::max(max_position.y(), position_iter->y()), std::max(max_position.z(), position_iter->z()));
+		}
+		const double radius = num_vertices > 0 ? 0.5*(max_position - min_position).Length() : 0.0;
+		const double max_cost = (double)max_error*radius * (double)max_error*radius;
+
+		std::vector<UInt64> edge_keys;
+		std::vector<Int32> edge_counts;
+		CountEdges(triangles, edge_keys, edge_counts);
+
+		// each vertex starts with the planes of the triangles around it
+		// border edges also get a plane at right angles to the surface so borders keep their shape
+		std::vector<Quadric> quadrics(num_vertices);
+		for(std::vector<SimplifyTriangle>::const_iterator triangle_iter = triangles.begin(); triangle_iter != triangles.end(); ++triangle_iter)
+		{
+			const UInt32* v = triangle_iter->vertices;
+			const Vector4 normal = TriangleNormal(positions[v[0]], positions[v[1]], positions[v[2]]);
+			const float length = normal.Length();
+			if(length <= 0.0f)
+				continue;
+
+			const Vector4 unit_normal = normal / length;
+			const double area = 0.5*length;
+			const double d = -unit_normal.DotProduct(positions[v[0]]);
+			for(Int32 corner = 0; corner < 3; ++corner)
+				quadrics[v[corner]].AddPlane(unit_normal.x(), unit_normal.y(), unit_normal.z(), d, area);
+
+			for(Int32 corner = 0; corner < 3; ++corner)
+			{
+				const UInt32 a = v[corner], b = v[(corner+1)%3];
+				if(GetEdgeCount(edge_keys, edge_counts, a, b) != 1)
+					continue;
+
+				const Vector4 edge = positions[b] - positions[a];
+				Vector4 border_normal = edge.CrossProduct(unit_normal);
+				const float border_length = border_normal.Length();
+				if(border_length <= 0.0f)
+					continue;
+				border_normal /= border_length;
+
+				const double border_d = -border_normal.DotProduct(positions[a]);
+				const double edge_length_sqr = edge.LengthSqr();
+				quadrics[a].AddPlane(border_normal.x(), border_normal.y(), border_normal.z(), border_d, edge_length_sqr);
+				quadrics[b].AddPlane(border_normal.x(), border_normal.y(), border_normal.z(), border_d, edge_length_sqr);
+			}
+		}
+
+		double lod_cost = 0.0;
+		Int32 num_triangles = (Int32)triangles.size();
+
+		std::vector<Int32> vertex_triangle_starts(num_vertices+1);
+		std::vector<Int32> vertex_triangles;
+		std::vector<Int32> border_edge_counts(num_vertices);
+		std::vector<UInt8> non_manifold(num_vertices);
+		std::vector<UInt8> touched(num_vertices);
+		std::vector<UInt32> remap(num_vertices);
+		std::vector<CollapseCandidate> candidates;
+
+		// each pass collapses as many edges as it can without any two collapses touching the same triangles
+		while(num_triangles > target_triangle_count)
+		{
+			// triangles around each vertex
+			std::fill(vertex_triangle_starts.begin(), vertex_triangle_starts.end(), 0);
+			for(std::vector<SimplifyTriangle>::const_iterator triangle_iter = triangles.begin(); triangle_iter != triangles.end(); ++triangle_iter)
+			{
+				for(Int32 corner = 0; corner < 3; ++corner)
+					++vertex_triangle_starts[triangle_iter->vertices[corner]+1];
+			}
+			for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+				vertex_triangle_starts[vertex_num+1] += vertex_triangle_starts[vertex_num];
+			vertex_triangles.resize(triangles.size()*3);
+			{
+				std::vector<Int32> offsets(vertex_triangle_starts.begin(), vertex_triangle_starts.end()-1);
+				for(size_t triangle_num = 0; triangle_num < triangles.size(); ++triangle_num)
+				{
+					for(Int32 corner = 0; corner < 3; ++corner)
+						vertex_triangles[offsets[triangles[triangle_num].vertices[corner]]++] = (Int32)triangle_num;
+				}
+			}
+
+			std::fill(border_edge_counts.begin(), border_edge_counts.end(), 0);
+			std::fill(non_manifold.begin(), non_manifold.end(), 0);
+			for(size_t edge_num = 0; edge_num < edge_keys.size(); ++edge_num)
+			{
+				const UInt32 a = (UInt32)(edge_keys[edge_num] >> 32), b = (UInt32)(edge_keys[edge_num] & 0xffffffff);
+				if(edge_counts[edge_num] == 1)
+				{
+					++border_edge_counts[a];
+					++border_edge_counts[b];
+				}
+				else if(edge_counts[edge_num] > 2)
+					non_manifold[a] = non_manifold[b] = 1;
+			}
+
+			// a vertex can be collapsed on to any of its neighbours
+			// border vertices can only move along the border
+			candidates.clear();
+			for(std::vector<SimplifyTriangle>::const_iterator triangle_iter = triangles.begin(); triangle_iter != triangles.end(); ++triangle_iter)
+			{
+				for(Int32 corner = 0; corner < 3; ++corner)
+				{
+					for(Int32 direction = 0; direction < 2; ++direction)
+					{
+						const UInt32 from = triangle_iter->vertices[direction == 0 ? corner : (corner+1)%3];
+						const UInt32 to = triangle_iter->vertices[direction == 0 ? (corner+1)%3 : corner];
+						if(locked[from] || non_manifold[from])
+							continue;
+						if(border_edge_counts[from] != 0)
+						{
+							if((border_edge_counts[from] != 2) || (GetEdgeCount(edge_keys, edge_counts, from, to) != 1))
+								continue;
+						}
+
+						Quadric quadric = quadrics[from];
+						quadric.Add(quadrics[to]);
+
+						CollapseCandidate candidate;
+						candidate.from = from;
+						candidate.to = to;
+						candidate.cost = quadric.weight > 0.0 ? quadric.Evaluate(positions[to]) / quadric.weight : 0.0;
+						candidates.push_back(candidate);
+					}
+				}
+			}
+			std::sort(candidates.begin(), candidates.end(), CompareCollapseCosts);
+
+			for(Int32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+				remap[vertex_num] = (UInt32)vertex_num;
+			std::fill(touched.begin(), touched.end(), 0);
+
+			Int32 triangles_to_remove = num_triangles - target_triangle_count;
+			Int32 num_collapses = 0;
+			for(std::vector<CollapseCandidate>::const_iterator candidate_iter = candidates.begin(); (candidate_iter != candidates.end()) && (triangles_to_remove > 0); ++candidate_iter)
+			{
+				const UInt32 from = candidate_iter->from;
+				const UInt32 to = candidate_iter->to;
+				if(candidate_iter->cost > max_cost)
+					break;
+				if(touched[from] || touched[to])
+					continue;
+
+				// reject collapses that would flip a triangle or remove the last triangles of a primitive
+				Int32 removed_triangles = 0;
+				bool flipped = false;
+				for(Int32 triangle_num = vertex_triangle_starts[from]; !flipped && (triangle_num < vertex_triangle_starts[from+1]); ++triangle_num)
+				{
+					const UInt32* v = triangles[vertex_triangles[triangle_num]].vertices;
+					if((v[0] == to) || (v[1] == to) || (v[2] == to))
+					{
+						++removed_triangles;
+						continue;
+					}
+
+					Vector4 moved[3];
+					for(Int32 corner = 0; corner < 3; ++corner)
+						moved[corner] = positions[v[corner] == from ? to : v[corner]];
+					const Vector4 normal_before = TriangleNormal(positions[v[0]], positions[v[1]], positions[v[2]]);
+					const Vector4 normal_after = TriangleNormal(moved[0], moved[1], moved[2]);
+					flipped = normal_before.DotProduct(normal_after) <= 0.0f;
+				}
+
+				const Int32 primitive_index = vertex_primitive[from];
+				if(flipped || (removed_triangles == 0) || (removed_triangles >= primitive_triangle_counts[primitive_index]))
+					continue;
+
+				remap[from] = to;
+				quadrics[to].Add(quadrics[from]);
+				primitive_triangle_counts[primitive_index] -= removed_triangles;
+				triangles_to_remove -= removed_triangles;
+				lod_cost = std::max(lod_cost, candidate_iter->cost);
+				++num_collapses;
+
+				// the shape of every triangle around from has changed
+				for(Int32 triangle_num = vertex_triangle_starts[from]; triangle_num < vertex_triangle_starts[from+1]; ++triangle_num)
+				{
+					const UInt32* v = triangles[vertex_triangles[triangle_num]].vertices;
+					touched[v[0]] = touched[v[1]] = touched[v[2]] = 1;
+				}
+			}
+
+			if(num_collapses == 0)
+				break;
+
+			// remove the triangles that collapsed
+			std::vector<SimplifyTriangle>::iterator write_iter = triangles.begin();
+			for(std::vector<SimplifyTriangle>::const_iterator triangle_iter = triangles.begin(); triangle_iter != triangles.end(); ++triangle_iter)
+			{
+				SimplifyTriangle triangle = *triangle_iter;
+				for(Int32 corner = 0; corner < 3; ++corner)
+					triangle.vertices[corner] = remap[triangle.vertices[corner]];
+				if((triangle.vertices[0] != triangle.vertices[1]) && (triangle.vertices[1] != triangle.vertices[2]) && (triangle.vertices[2] != triangle.vertices[0]))
+					*write_iter++ = triangle;
+			}
+			triangles.erase(write_iter, triangles.end());
+			num_triangles = (Int32)triangles.size();
+
+			CountEdges(triangles, edge_keys, edge_counts);
+		}
+
+		// triangles are still in primitive order
+		std::vector<Int32> primitive_index_counts(mesh.primitives.size(), 0);
+		for(std::vector<SimplifyTriangle>::const_iterator triangle_iter = triangles.begin(); triangle_iter != triangles.end(); ++triangle_iter)
+			primitive_index_counts[triangle_iter->primitive_index] += 3;
+
+		for(size_t prim_num = 0; prim_num < mesh.primitives.size(); ++prim_num)
+		{
+			const PrimitiveData* primitive = mesh.primitives[prim_num];
+			if(primitive->type != TRIANGLE_LIST)
+				continue;
+
+			PrimitiveData& lod_primitive = lod_primitives[prim_num];
+			lod_primitive.type = primitive->type;
+			lod_primitive.material_name_id = primitive->material_name_id;
+			lod_primitive.index_byte_size = primitive->index_byte_size;
+			lod_primitive.num_indices = 0;
+			lod_primitive.indices = malloc(primitive_index_counts[prim_num]*primitive->index_byte_size);
+		}
+
+		for(std::vector<SimplifyTriangle>::const_iterator triangle_iter = triangles.begin(); triangle_iter != triangles.end(); ++triangle_iter)
+		{
+			PrimitiveData& lod_primitive = lod_primitives[triangle_iter->primitive_index];
+			for(Int32 corner = 0; corner < 3; ++corner)
+				lod_primitive.SetIndex(lod_primitive.num_indices++, triangle_iter->vertices[corner]);
+		}
+
+		return radius > 0.0 ? (float)(sqrt(lod_cost) / radius) : 0.0f;
+	}
+
+	static Int32 GetLodTriangleCount(const std::vector<PrimitiveData>& primitives)
+	{
+		Int32 num_triangles = 0;
+		for(std::vector<PrimitiveData>::const_iterator prim_iter = primitives.begin(); prim_iter != primitives.end(); ++prim_iter)
+		{
+			if(prim_iter->type == TRIANGLE_LIST)
+				num_triangles += prim_iter->num_indices/3;
+		}
+		return num_triangles;
+	}
+
+	Int32 GenerateMeshLods(MeshData& mesh, const Int32 num_lods, const float triangle_ratio, const float max_error, const float screen_error)
+	{
+		mesh.lods.clear();
+
+		Int32 base_triangle_count = 0;
+		for(std::vector<PrimitiveData*>::const_iterator prim_iter = mesh.primitives.begin(); prim_iter != mesh.primitives.end(); ++prim_iter)
+		{
+			if((*prim_iter)->type == TRIANGLE_LIST)
+				base_triangle_count += (*prim_iter)->num_indices/3;
+		}
+
+		// every lod is simplified from the full detail mesh so errors don't build up
+		Int32 previous_triangle_count = base_triangle_count;
+		float previous_screen_size = FLT_MAX;
+		float target_ratio = 1.0f;
+		for(Int32 lod_num = 0; lod_num < num_lods; ++lod_num)
+		{
+			target_ratio *= triangle_ratio;
+
+			MeshLodData lod;
+			lod.error = SimplifyMesh(mesh, lod.primitives, (Int32)(base_triangle_count*target_ratio), max_error);
+
+			const Int32 triangle_count = GetLodTriangleCount(lod.primitives);
+			if((float)triangle_count > (1.0f - kMinLodReduction)*(float)previous_triangle_count)
+				break;
+
+			// the projected error of a lod is error * screen size / 2
+			lod.screen_size = lod.error > 0.0f ? 2.0f*screen_error / lod.error : FLT_MAX;
+			if(lod.screen_size > previous_screen_size)
+				lod.screen_size = previous_screen_size;
+
+			previous_triangle_count = triangle_count;
+			previous_screen_size = lod.screen_size;
+			mesh.lods.push_back(lod);
+		}
+
+		return (Int32)mesh.lods.size();
+	}
+}
@@ -0,0 +1,33 @@
+#ifndef _GEF_MESH_SIMPLIFIER_H
+#define _GEF_MESH_SIMPLIFIER_H
+
+#include <gef.h>
+#include <vector>
+
+namespace gef
+{
+	struct MeshData;
+	struct PrimitiveData;
+
+	// default for GenerateMeshLods, about two pixels at 1080p
+	const float kDefaultLodScreenError = 0.002f;
+
+	// reduces the triangle count of the triangle list primitives of a mesh by collapsing edges
+	// in order of quadric error, stopping at target_triangle_count or when the next collapse
+	// would move the surface by more than max_error
+	// vertices are only ever moved onto other existing vertices so the simplified primitives
+	// can use the mesh's vertices as they are
+	// vertices on uv or normal seams, shared between primitives or on non manifold edges aren't moved
+	// lod_primitives gets one primitive for each primitive of the mesh, other primitive types are copied
+	// errors are relative to the radius of the mesh's bounds
+	// returns the error of the simplified mesh
+	float SimplifyMesh(const MeshData& mesh, std::vector<PrimitiveData>& lod_primitives, const Int32 target_triangle_count, const float max_error);
+
+	// replaces the lods of a mesh with up to num_lods lods, each with triangle_ratio times the triangles of the one before
+	// fewer lods are generated when the mesh can't be simplified any further without exceeding max_error
+	// each lod is used once its error would be smaller than screen_error times the screen height
+	// returns the number of lods generated
+	Int32 GenerateMeshLods(MeshData& mesh, const Int32 num_lods, const float triangle_ratio = 0.5f, const float max_error = 0.1f, const float screen_error = kDefaultLodScreenError);
+}
+
+#endif // _GEF_MESH_SIMPLIFIER_H
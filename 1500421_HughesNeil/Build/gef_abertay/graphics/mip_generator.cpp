@@ -0,0 +1,308 @@
+#include <graphics/mip_generator.h>
+#include <graphics/image_data.h>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#define GEF_MIP_GENERATOR_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define GEF_MIP_GENERATOR_NEON
+#include <arm_neon.h>
+#endif
+
+namespace gef
+{
+	// levels are filtered as one float vector per pixel
+#if defined(GEF_MIP_GENERATOR_SSE)
+	typedef __m128 PixelVector;
+	static inline PixelVector ZeroPixel() { return _mm_setzero_ps(); }
+	static inline PixelVector LoadPixel(const float* pixel) { return _mm_loadu_ps(pixel); }
+	static inline void StorePixel(float* pixel, const PixelVector value) { _mm_storeu_ps(pixel, value); }
+	static inline PixelVector MultiplyAdd(const PixelVector sum, const PixelVector pixel, const float weight) { return _mm_add_ps(sum, _mm_mul_ps(pixel, _mm_set1_ps(weight))); }
+#elif defined(GEF_MIP_GENERATOR_NEON)
+	typedef float32x4_t PixelVector;
+	static inline PixelVector ZeroPixel() { return vdupq_n_f32(0.0f); }
+	static inline PixelVector LoadPixel(const float* pixel) { return vld1q_f32(pixel); }
+	static inline void StorePixel(float* pixel, const PixelVector value) { vst1q_f32(pixel, value); }
+	static inline PixelVector MultiplyAdd(const PixelVector sum, const PixelVector pixel, const float weight) { return vmlaq_n_f32(sum, pixel, weight); }
+#else
+	struct PixelVector
+	{
+		float values[4];
+	};
+	static inline PixelVector ZeroPixel() { PixelVector result = { { 0.0f, 0.0f, 0.0f, 0.0f } }; return result; }
+	static inline PixelVector LoadPixel(const float* pixel) { PixelVector result = { { pixel[0], pixel[1], pixel[2], pixel[3] } }; return result; }
+	static inline void StorePixel(float* pixel, const PixelVector value) { memcpy(pixel, value.values, sizeof(value.values)); }
+	static inline PixelVector MultiplyAdd(const PixelVector sum, const PixelVector pixel, const float weight)
+	{
+		PixelVector result = { { sum.values[0] + pixel.values[0]*weight, sum.values[1] + pixel.values[1]*weight, sum.values[2] + pixel.values[2]*weight, sum.values[3] + pixel.values[3]*weight } };
+		return result;
+	}
+#endif
+
+	// linear values are looked up in a table this big when they are converted back to srgb
+	static const Int32 kLinearToSRGBTableSize = 16384;
+
+	// the most alpha can be scaled up by to preserve coverage
+	static const float kMaxAlphaScale = 4.0f;
+	static const Int32 kAlphaScaleSearchSteps = 10;
+
+	MipGeneratorOptions::MipGeneratorOptions() :
+		filter(RF_BOX),
+		srgb(false),
+		premultiply_alpha(false),
+		preserve_alpha_coverage(false),
+		alpha_reference(0.5f)
+	{
+	}
+
+	static float SRGBToLinear(const float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	static float LinearToSRGB(const float value)
+	{
+		return value <= 0.0031308f ? value * 12.92f : 1.055f*powf(value, 1.0f/2.4f) - 0.055f;
+	}
+
+	static inline UInt8 ToUInt8(const float value)
+	{
+		if(value <= 0.0f)
+			return 0;
+		if(value >= 1.0f)
+			return 255;
+		return (UInt8)(value*255.0f + 0.5f);
+	}
+
+	// converts a row of the top level to linear colours, premultiplied by alpha if premultiply_alpha is set
+	static void ConvertRow(const UInt8* source, const UInt32 width, const float* to_linear, const bool premultiply_alpha, float* dest)
+	{
+		for(UInt32 x = 0; x < width; ++x)
+		{
+			const float alpha = (float)source[3] / 255.0f;
+			const float colour_scale = premultiply_alpha ? alpha : 1.0f;
+			dest[0] = to_linear[source[0]]*colour_scale;
+			dest[1] = to_linear[source[1]]*colour_scale;
+			dest[2] = to_linear[source[2]]*colour_scale;
+			dest[3] = alpha;
+			source += 4;
+			dest += 4;
+		}
+	}
+
+	static void FilterRow(const float* source, const ResizeContributions& contributions, const UInt32 dest_width, float* dest)
+	{
+		for(UInt32 x = 0; x < dest_width; ++x)
+		{
+			PixelVector sum = ZeroPixel();
+			const Int32 first = contributions.first[x];
+			const Int32 end = first + contributions.count[x];
+			for(Int32 contribution = first; contribution < end; ++contribution)
+				sum = MultiplyAdd(sum, LoadPixel(source + contributions.pixels[contribution]*4), contributions.weights[contribution]);
+			StorePixel(dest + x*4, sum);
+		}
+	}
+
+	static void FilterColumns(const float* source, const UInt32 width, const ResizeContributions& contributions, const UInt32 dest_y, float* dest)
+	{
+		const Int32 first = contributions.first[dest_y];
+		const Int32 end = first + contributions.count[dest_y];
+		for(UInt32 x = 0; x < width; ++x)
+		{
+			PixelVector sum = ZeroPixel();
+			for(Int32 contribution = first; contribution < end; ++contribution)
+				sum = MultiplyAdd(sum, LoadPixel(source + (contributions.pixels[contribution]*width + x)*4), contributions.weights[contribution]);
+			StorePixel(dest + x*4, sum);
+		}
+	}
+
+	// the common case of a box filter halving both sizes doesn't need the separate passes
+	static void BoxFilterRows(const float* row0, const float* row1, const UInt32 dest_width, float* dest)
+	{
+		for(UInt32 x = 0; x < dest_width; ++x)
+		{
+			PixelVector sum = MultiplyAdd(ZeroPixel(), LoadPixel(row0), 0.25f);
+			sum = MultiplyAdd(sum, LoadPixel(row0+4), 0.25f);
+			sum = MultiplyAdd(sum, LoadPixel(row1), 0.25f);
+			sum = MultiplyAdd(sum, LoadPixel(row1+4), 0.25f);
+			StorePixel(dest, sum);
+			row0 += 8;
+			row1 += 8;
+			dest += 4;
+		}
+	}
+
+	static float AlphaCoverage(const float* pixels, const UInt32 num_pixels, const float alpha_scale, const float alpha_reference)
+	{
+		UInt32 covered_pixels = 0;
+		for(UInt32 pixel_num = 0; pixel_num < num_pixels; ++pixel_num)
+		{
+			if(pixels[pixel_num*4+3]*alpha_scale > alpha_reference)
+				++covered_pixels;
+		}
+		return (float)covered_pixels / (float)num_pixels;
+	}
+
+	static float FindAlphaScale(const float* pixels, const UInt32 num_pixels, const float coverage, const float alpha_reference)
+	{
+		float min_scale = 0.0f;
+		float max_scale = kMaxAlphaScale;
+		float alpha_scale = 1.0f;
+		for(Int32 step = 0; step < kAlphaScaleSearchSteps; ++step)
+		{
+			const float level_coverage = AlphaCoverage(pixels, num_pixels, alpha_scale, alpha_reference);
+			if(level_coverage < coverage)
+				min_scale = alpha_scale;
+			else if(level_coverage > coverage)
+				max_scale = alpha_scale;
+			else
+				break;
+
+			alpha_scale = (min_scale + max_scale) * 0.5f;
+		}
+		return alpha_scale;
+	}
+
+	// converts a filtered level back to straight alpha RGBA8
+	static void StoreLevel(const float* pixels, const UInt32 num_pixels, const float alpha_scale, const UInt8* to_srgb, const bool premultiplied_alpha, UInt8* dest)
+	{
+		for(UInt32 pixel_num = 0; pixel_num < num_pixels; ++pixel_num)
+		{
+			const float alpha = pixels[3];
+			const float inverse_alpha = premultiplied_alpha ? (alpha > 0.0f ? 1.0f / alpha : 0.0f) : 1.0f;
+			for(Int32 channel = 0; channel < 3; ++channel)
+			{
+				const float value = pixels[channel]*inverse_alpha;
+				if(to_srgb)
+				{
+					const float clamped_value = value <= 0.0f ? 0.0f : (value >= 1.0f ? 1.0f : value);
+					dest[channel] = to_srgb[(Int32)(clamped_value*(float)(kLinearToSRGBTableSize-1) + 0.5f)];
+				}
+				else
+					dest[channel] = ToUInt8(value);
+			}
+			dest[3] = ToUInt8(alpha*alpha_scale);
+			pixels += 4;
+			dest += 4;
+		}
+	}
+
+	bool GenerateMips(ImageData& image_data, const MipGeneratorOptions& options)
+	{
+		if((image_data.image() == NULL) || (image_data.format() != IF_RGBA8) || (image_data.width() == 0) || (image_data.height() == 0) || (options.filter >= RF_NUM_FILTERS))
+			return false;
+
+		ImageData mips;
+		mips.set_width(image_data.width());
+		mips.set_height(image_data.height());
+		mips.set_format(image_data.format());
+		mips.set_num_mips(ImageData::CalculateMaxMips(image_data.width(), image_data.height()));
+
+		UInt8* data = static_cast<UInt8*>(malloc(mips.GetDataSize()));
+		if(data == NULL)
+			return false;
+
+		memcpy(data, image_data.image(), mips.GetMipDataSize(0));
+
+		float to_linear[256];
+		for(Int32 value = 0; value < 256; ++value)
+			to_linear[value] = options.srgb ? SRGBToLinear((float)value / 255.0f) : (float)value / 255.0f;
+
+		std::vector<UInt8> to_srgb;
+		if(options.srgb)
+		{
+			to_srgb.resize(kLinearToSRGBTableSize);
+			for(Int32 entry = 0; entry < kLinearToSRGBTableSize; ++entry)
+				to_srgb[entry] = ToUInt8(LinearToSRGB((float)entry / (float)(kLinearToSRGBTableSize-1)));
+		}
+
+		float coverage = 0.0f;
+		if(options.preserve_alpha_coverage)
+		{
+			UInt32 covered_pixels = 0;
+			const UInt32 num_pixels = mips.width()*mips.height();
+			for(UInt32 pixel_num = 0; pixel_num < num_pixels; ++pixel_num)
+			{
+				if((float)data[pixel_num*4+3] / 255.0f > options.alpha_reference)
+					++covered_pixels;
+			}
+			coverage = (float)covered_pixels / (float)num_pixels;
+		}
+
+		// the top level is converted a row at a time, the smaller levels are filtered from the float level above
+		std::vector<float> top_rows(mips.width()*8);
+		std::vector<float> source_level, dest_level, filtered_rows;
+		ResizeContributions horizontal, vertical;
+
+		for(UInt32 level = 1; level < mips.num_mips(); ++level)
+		{
+			const UInt32 source_width = mips.GetMipWidth(level-1);
+			const UInt32 source_height = mips.GetMipHeight(level-1);
+			const UInt32 dest_width = mips.GetMipWidth(level);
+			const UInt32 dest_height = mips.GetMipHeight(level);
+			dest_level.resize(dest_width*dest_height*4);
+
+			if((options.filter == RF_BOX) && (source_width == dest_width*2) && (source_height == dest_height*2))
+			{
+				for(UInt32 y = 0; y < dest_height; ++y)
+				{
+					const float* row0;
+					const float* row1;
+					if(level == 1)
+					{
+						ConvertRow(data + y*2*source_width*4, source_width, to_linear, options.premultiply_alpha, &top_rows[0]);
+						ConvertRow(data + (y*2+1)*source_width*4, source_width, to_linear, options.premultiply_alpha, &top_rows[source_width*4]);
+						row0 = &top_rows[0];
+						row1 = &top_rows[source_width*4];
+					}
+					else
+					{
+						row0 = &source_level[y*2*source_width*4];
+						row1 = row0 + source_width*4;
+					}
+
+					BoxFilterRows(row0, row1, dest_width, &dest_level[y*dest_width*4]);
+				}
+			}
+			else
+			{
+				CalculateResizeContributions(source_width, dest_width, options.filter, horizontal);
+				CalculateResizeContributions(source_height, dest_height, options.filter, vertical);
+
+				filtered_rows.resize(dest_width*source_height*4);
+				for(UInt32 y = 0; y < source_height; ++y)
+				{
+					const float* source_row;
+					if(level == 1)
+					{
+						ConvertRow(data + y*source_width*4, source_width, to_linear, options.premultiply_alpha, &top_rows[0]);
+						source_row = &top_rows[0];
+					}
+					else
+						source_row = &source_level[y*source_width*4];
+
+					FilterRow(source_row, horizontal, dest_width, &filtered_rows[y*dest_width*4]);
+				}
+
+				for(UInt32 y = 0; y < dest_height; ++y)
+					FilterColumns(&filtered_rows[0], dest_width, vertical, y, &dest_level[y*dest_width*4]);
+			}
+
+			// the scaled alpha only goes into the stored level so each level is still filtered from unscaled alpha
+			const UInt32 num_pixels = dest_width*dest_height;
+			const float alpha_scale = options.preserve_alpha_coverage ? FindAlphaScale(&dest_level[0], num_pixels, coverage, options.alpha_reference) : 1.0f;
+			StoreLevel(&dest_level[0], num_pixels, alpha_scale, options.srgb ? &to_srgb[0] : NULL, options.premultiply_alpha, data + mips.GetMipOffset(level));
+
+			source_level.swap(dest_level);
+		}
+
+		free(image_data.image());
+		image_data.set_image(data);
+		image_data.set_num_mips(mips.num_mips());
+		return true;
+	}
+}
@@ -0,0 +1,38 @@
+#ifndef _GEF_MIP_GENERATOR_H
+#define _GEF_MIP_GENERATOR_H
+
+#include <gef.h>
+#include <graphics/image_resize.h>
+
+namespace gef
+{
+	class ImageData;
+
+	struct MipGeneratorOptions
+	{
+		MipGeneratorOptions();
+
+		// box is fastest, kaiser and lanczos3 keep more detail in the smaller levels
+		ResizeFilter filter;
+
+		// colours are converted to linear before they are filtered and back to srgb afterwards
+		bool srgb;
+
+		// colours are weighted by alpha while they are filtered so transparent pixels don't bleed into their neighbours
+		// off by default as it changes the colour of partly transparent pixels and fully transparent pixels become black
+		bool premultiply_alpha;
+
+		// alpha in the smaller levels is scaled so the same fraction of pixels pass an alpha test
+		// against alpha_reference as in the top level, stopping alpha tested geometry thinning out in the distance
+		bool preserve_alpha_coverage;
+		float alpha_reference;
+	};
+
+	// replaces the image with its top level followed by a full mip chain down to 1x1
+	// each level is filtered from the one above, odd sizes are handled by stretching the filter
+	// levels are kept as floats until the chain is finished so rounding errors don't build up
+	// only RGBA8 images are supported
+	bool GenerateMips(ImageData& image_data, const MipGeneratorOptions& options = MipGeneratorOptions());
+}
+
+#endif // _GEF_MIP_GENERATOR_H
@@ -20,6 +20,7 @@ namespace gef
 		inline void set_mesh(Mesh* mesh) { mesh_ = mesh; }
 		inline Mesh* mesh() { return mesh_; }
 		inline void set_textures(const std::vector<Texture*>& textures) { textures_ = textures; }
+		inline const std::vector<Texture*>& textures() const { return textures_; }
 
 		inline void AddMaterial(Material* material) { materials_.push_back(material); }
 		inline const Material* material(Int32 material_num) const { return materials_[material_num]; }
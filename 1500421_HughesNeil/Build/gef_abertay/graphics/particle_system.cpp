@@ -0,0 +1,340 @@
+#include <graphics/particle_system.h>
+#include <graphics/sprite_batch.h>
+#include <graphics/sprite_renderer.h>
+#include <graphics/sprite.h>
+#include <system/thread_pool.h>
+#include <cstring>
+#include <math.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#define GEF_PARTICLE_SYSTEM_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define GEF_PARTICLE_SYSTEM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace gef
+{
+	// four particles' worth of one attribute
+#if defined(GEF_PARTICLE_SYSTEM_SSE)
+	typedef __m128 Float4;
+	static inline Float4 Load4(const float* values) { return _mm_loadu_ps(values); }
+	static inline void Store4(float* values, const Float4 value) { _mm_storeu_ps(values, value); }
+	static inline Float4 Splat4(const float value) { return _mm_set1_ps(value); }
+	static inline Float4 Add4(const Float4 a, const Float4 b) { return _mm_add_ps(a, b); }
+	static inline Float4 Mul4(const Float4 a, const Float4 b) { return _mm_mul_ps(a, b); }
+#elif defined(GEF_PARTICLE_SYSTEM_NEON)
+	typedef float32x4_t Float4;
+	static inline Float4 Load4(const float* values) { return vld1q_f32(values); }
+	static inline void Store4(float* values, const Float4 value) { vst1q_f32(values, value); }
+	static inline Float4 Splat4(const float value) { return vdupq_n_f32(value); }
+	static inline Float4 Add4(const Float4 a, const Float4 b) { return vaddq_f32(a, b); }
+	static inline Float4 Mul4(const Float4 a, const Float4 b) { return vmulq_f32(a, b); }
+#else
+	struct Float4
+	{
+		float values[4];
+	};
+	static inline Float4 Load4(const float* values) { Float4 result; memcpy(result.values, values, sizeof(result.values)); return result; }
+	static inline void Store4(float* values, const Float4 value) { memcpy(values, value.values, sizeof(value.values)); }
+	static inline Float4 Splat4(const float value) { Float4 result = { { value, value, value, value } }; return result; }
+	static inline Float4 Add4(const Float4 a, const Float4 b) { Float4 result = { { a.values[0]+b.values[0], a.values[1]+b.values[1], a.values[2]+b.values[2], a.values[3]+b.values[3] } }; return result; }
+	static inline Float4 Mul4(const Float4 a, const Float4 b) { Float4 result = { { a.values[0]*b.values[0], a.values[1]*b.values[1], a.values[2]*b.values[2], a.values[3]*b.values[3] } }; return result; }
+#endif
+
+	ParticleSettings::ParticleSettings() :
+		lifetime_min(1.0f),
+		lifetime_max(1.0f),
+		speed_min(50.0f),
+		speed_max(100.0f),
+		direction(0.0f),
+		spread(6.2831853f),
+		acceleration(0.0f, 0.0f),
+		drag(0.0f),
+		start_size(8.0f),
+		end_size(8.0f),
+		start_colour(0xffffffff),
+		end_colour(0x00ffffff),
+		depth(0.0f),
+		texture(NULL),
+		uv_position(0.0f, 0.0f),
+		uv_width(1.0f),
+		uv_height(1.0f)
+	{
+	}
+
+	ParticleSystem::ParticleSystem(const UInt32 capacity, const ParticleSettings& settings) :
+		settings_(settings),
+		capacity_(capacity),
+		num_particles_(0),
+		random_state_(0x9e3779b9)
+	{
+		// padded so the update can always work on whole groups of four
+		const UInt32 padded_capacity = (capacity_+3) & ~3u;
+		position_x_.resize(padded_capacity, 0.0f);
+		position_y_.resize(padded_capacity, 0.0f);
+		velocity_x_.resize(padded_capacity, 0.0f);
+		velocity_y_.resize(padded_capacity, 0.0f);
+		age_.resize(padded_capacity, 0.0f);
+		age_rate_.resize(padded_capacity, 0.0f);
+	}
+
+	Int32 ParticleSystem::AddEmitter(const Vector2& position, const float rate)
+	{
+		Emitter emitter;
+		emitter.position = position;
+		emitter.rate = rate;
+		emitter.emit_time = 0.0f;
+		emitter.active = true;
+
+		for(UInt32 emitter_num = 0; emitter_num < emitters_.size(); ++emitter_num)
+		{
+			if(!emitters_[emitter_num].active)
+			{
+				emitters_[emitter_num] = emitter;
+				return (Int32)emitter_num;
+			}
+		}
+
+		emitters_.push_back(emitter);
+		return (Int32)emitters_.size()-1;
+	}
+
+	void ParticleSystem::RemoveEmitter(const Int32 emitter_id)
+	{
+		if((emitter_id >= 0) && (emitter_id < (Int32)emitters_.size()))
+			emitters_[emitter_id].active = false;
+	}
+
+	void ParticleSystem::set_emitter_position(const Int32 emitter_id, const Vector2& position)
+	{
+		if((emitter_id >= 0) && (emitter_id < (Int32)emitters_.size()))
+			emitters_[emitter_id].position = position;
+	}
+
+	void ParticleSystem::set_emitter_rate(const Int32 emitter_id, const float rate)
+	{
+		if((emitter_id >= 0) && (emitter_id < (Int32)emitters_.size()))
+			emitters_[emitter_id].rate = rate;
+	}
+
+	float ParticleSystem::RandomFloat(const float min_value, const float max_value)
+	{
+		// xorshift, only needs to look random
+		random_state_ ^= random_state_ << 13;
+		random_state_ ^= random_state_ >> 17;
+		random_state_ ^= random_state_ << 5;
+		return min_value + (max_value - min_value)*((float)(random_state_ >> 8) * (1.0f/16777216.0f));
+	}
+
+	void ParticleSystem::Emit(const Vector2& position, const UInt32 count)
+	{
+		const UInt32 end_particle = (num_particles_ + count) < capacity_ ? (num_particles_ + count) : capacity_;
+		const float half_spread = settings_.spread*0.5f;
+		for(UInt32 particle = num_particles_; particle < end_particle; ++particle)
+		{
+			const float angle = settings_.direction + RandomFloat(-half_spread, half_spread);
+			const float speed = RandomFloat(settings_.speed_min, settings_.speed_max);
+			const float lifetime = RandomFloat(settings_.lifetime_min, settings_.lifetime_max);
+
+			position_x_[particle] = position.x;
+			position_y_[particle] = position.y;
+			velocity_x_[particle] = cosf(angle)*speed;
+			velocity_y_[particle] = sinf(angle)*speed;
+			age_[particle] = 0.0f;
+			age_rate_[particle] = lifetime > 0.0f ? 1.0f / lifetime : 1.0e30f;
+		}
+
+		num_particles_ = end_particle;
+	}
+
+	UInt32 ParticleSystem::Burst(const Vector2& position, const UInt32 count)
+	{
+		const UInt32 first_particle = num_particles_;
+		Emit(position, count);
+		return num_particles_ - first_particle;
+	}
+
+	void ParticleSystem::Integrate(const UInt32 first_particle, const UInt32 end_particle, const float frame_time, const float drag_scale)
+	{
+		const Float4 dt = Splat4(frame_time);
+		const Float4 acceleration_x = Splat4(settings_.acceleration.x*frame_time);
+		const Float4 acceleration_y = Splat4(settings_.acceleration.y*frame_time);
+		const Float4 drag = Splat4(drag_scale);
+
+		// the last group can run into the padding, which is never read as a live particle
+		for(UInt32 particle = first_particle; particle < end_particle; particle += 4)
+		{
+			const Float4 velocity_x = Mul4(Add4(Load4(&velocity_x_[particle]), acceleration_x), drag);
+			const Float4 velocity_y = Mul4(Add4(Load4(&velocity_y_[particle]), acceleration_y), drag);
+			Store4(&velocity_x_[particle], velocity_x);
+			Store4(&velocity_y_[particle], velocity_y);
+			Store4(&position_x_[particle], Add4(Load4(&position_x_[particle]), Mul4(velocity_x, dt)));
+			Store4(&position_y_[particle], Add4(Load4(&position_y_[particle]), Mul4(velocity_y, dt)));
+			Store4(&age_[particle], Add4(Load4(&age_[particle]), Mul4(Load4(&age_rate_[particle]), dt)));
+		}
+	}
+
+	void ParticleSystem::UpdateJob(void* user_data, Int32 job_index)
+	{
+		UpdateJobData* job_data = static_cast<UpdateJobData*>(user_data);
+		ParticleSystem* particle_system = job_data->particle_system;
+		const UInt32 first_particle = (UInt32)job_index*kParticleJobSize;
+		const UInt32 end_particle = (first_particle + kParticleJobSize) < particle_system->num_particles_ ? (first_particle + kParticleJobSize) : particle_system->num_particles_;
+		particle_system->Integrate(first_particle, end_particle, job_data->frame_time, job_data->drag_scale);
+	}
+
+	void ParticleSystem::RemoveDeadParticles()
+	{
+		UInt32 particle = 0;
+		while(particle < num_particles_)
+		{
+			if(age_[particle] < 1.0f)
+			{
+				++particle;
+				continue;
+			}
+
+			// the last particle hasn't been checked yet so stay on this slot
+			const UInt32 last_particle = --num_particles_;
+			position_x_[particle] = position_x_[last_particle];
+			position_y_[particle] = position_y_[last_particle];
+			velocity_x_[particle] = velocity_x_[last_particle];
+			velocity_y_[particle] = velocity_y_[last_particle];
+			age_[particle] = age_[last_particle];
+			age_rate_[particle] = age_rate_[last_particle];
+		}
+	}
+
+	void ParticleSystem::Update(const float frame_time, ThreadPool* thread_pool)
+	{
+		float drag_scale = 1.0f - settings_.drag*frame_time;
+		if(drag_scale < 0.0f)
+			drag_scale = 0.0f;
+
+		const Int32 job_count = (Int32)((num_particles_ + kParticleJobSize - 1) / kParticleJobSize);
+		if(thread_pool && (job_count > 1))
+		{
+			UpdateJobData job_data;
+			job_data.particle_system = this;
+			job_data.frame_time = frame_time;
+			job_data.drag_scale = drag_scale;
+			thread_pool->ParallelFor(job_count, UpdateJob, &job_data);
+		}
+		else
+			Integrate(0, num_particles_, frame_time, drag_scale);
+
+		RemoveDeadParticles();
+
+		// new particles start where their emitter is now, they are moved on from the next update
+		for(std::vector<Emitter>::iterator emitter = emitters_.begin(); emitter != emitters_.end(); ++emitter)
+		{
+			if(!emitter->active)
+				continue;
+
+			emitter->emit_time += emitter->rate*frame_time;
+			if(emitter->emit_time >= 1.0f)
+			{
+				const UInt32 count = (UInt32)emitter->emit_time;
+				emitter->emit_time -= (float)count;
+				Emit(emitter->position, count);
+			}
+		}
+	}
+
+	void ParticleSystem::Clear()
+	{
+		num_particles_ = 0;
+		for(std::vector<Emitter>::iterator emitter = emitters_.begin(); emitter != emitters_.end(); ++emitter)
+			emitter->emit_time = 0.0f;
+	}
+
+	void ParticleSystem::BuildVertices(SpriteBatchVertex* vertices, const UInt32 first_particle, const UInt32 num_particles) const
+	{
+		// the colour channels are blended as floats then packed back into ABGR
+		float start_colour[4], colour_range[4];
+		for(Int32 channel = 0; channel < 4; ++channel)
+		{
+			start_colour[channel] = (float)((settings_.start_colour >> (channel*8)) & 0xff);
+			colour_range[channel] = (float)((settings_.end_colour >> (channel*8)) & 0xff) - start_colour[channel];
+		}
+
+		const Float4 start_size = Splat4(settings_.start_size*0.5f);
+		const Float4 size_range = Splat4((settings_.end_size - settings_.start_size)*0.5f);
+		const float z = settings_.depth;
+		const float u0 = settings_.uv_position.x;
+		const float v0 = settings_.uv_position.y;
+		const float u1 = u0 + settings_.uv_width;
+		const float v1 = v0 + settings_.uv_height;
+
+		// groups start on a multiple of four so the loads stay inside the padded arrays
+		const UInt32 end_particle = first_particle + num_particles;
+		for(UInt32 group = first_particle & ~3u; group < end_particle; group += 4)
+		{
+			const Float4 age = Load4(&age_[group]);
+			float half_size[4], channels[4][4];
+			Store4(half_size, Add4(start_size, Mul4(size_range, age)));
+			for(Int32 channel = 0; channel < 4; ++channel)
+				Store4(channels[channel], Add4(Splat4(start_colour[channel]), Mul4(Splat4(colour_range[channel]), age)));
+
+			const UInt32 group_end = (group + 4) < end_particle ? (group + 4) : end_particle;
+			for(UInt32 particle = group < first_particle ? first_particle : group; particle < group_end; ++particle)
+			{
+				const UInt32 lane = particle - group;
+				const UInt32 colour = ((UInt32)(channels[0][lane] + 0.5f)) | ((UInt32)(channels[1][lane] + 0.5f) << 8) |
+					((UInt32)(channels[2][lane] + 0.5f) << 16) | ((UInt32)(channels[3][lane] + 0.5f) << 24);
+				const float x = position_x_[particle];
+				const float y = position_y_[particle];
+				const float extent = half_size[lane];
+
+				SpriteBatchVertex* quad = &vertices[(particle - first_particle)*4];
+				quad[0].x = x - extent; quad[0].y = y - extent; quad[0].u = u0; quad[0].v = v0;
+				quad[1].x = x + extent; quad[1].y = y - extent; quad[1].u = u1; quad[1].v = v0;
+				quad[2].x = x + extent; quad[2].y = y + extent; quad[2].u = u1; quad[2].v = v1;
+				quad[3].x = x - extent; quad[3].y = y + extent; quad[3].u = u0; quad[3].v = v1;
+				for(Int32 vertex_num = 0; vertex_num < 4; ++vertex_num)
+				{
+					quad[vertex_num].z = z;
+					quad[vertex_num].colour = colour;
+				}
+			}
+		}
+	}
+
+	void ParticleSystem::Render(SpriteRenderer* renderer) const
+	{
+		SpriteBatch* batch = renderer->batch();
+		if(batch)
+		{
+			UInt32 first_particle = 0;
+			while(first_particle < num_particles_)
+			{
+				UInt32 num_quads = num_particles_ - first_particle;
+				SpriteBatchVertex* vertices = batch->LockQuads(num_quads);
+				BuildVertices(vertices, first_particle, num_quads);
+				batch->DrawLockedQuads(settings_.texture, num_quads);
+				first_particle += num_quads;
+			}
+			return;
+		}
+
+		// without a batch every particle is its own sprite
+		SpriteBatchVertex quad[4];
+		Sprite sprite;
+		sprite.set_texture(settings_.texture);
+		sprite.set_uv_position(settings_.uv_position);
+		sprite.set_uv_width(settings_.uv_width);
+		sprite.set_uv_height(settings_.uv_height);
+		for(UInt32 particle = 0; particle < num_particles_; ++particle)
+		{
+			BuildVertices(quad, particle, 1);
+			const float size = quad[1].x - quad[0].x;
+			sprite.set_position(position_x_[particle], position_y_[particle], settings_.depth);
+			sprite.set_width(size);
+			sprite.set_height(size);
+			sprite.set_colour(quad[0].colour);
+			renderer->DrawSprite(sprite);
+		}
+	}
+}
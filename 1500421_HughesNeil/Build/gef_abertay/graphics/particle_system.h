@@ -0,0 +1,123 @@
+#ifndef _GEF_PARTICLE_SYSTEM_H
+#define _GEF_PARTICLE_SYSTEM_H
+
+#include <gef.h>
+#include <maths/vector2.h>
+#include <vector>
+#include <cstddef>
+
+namespace gef
+{
+	class SpriteRenderer;
+	class Texture;
+	class ThreadPool;
+	struct SpriteBatchVertex;
+
+	// updates are split into jobs of this many particles when a thread pool is used
+	const UInt32 kParticleJobSize = 16384;
+
+	// how every particle in a system moves and changes over its lifetime
+	// angles are in radians, 0 points along x and screen y points down
+	struct ParticleSettings
+	{
+		ParticleSettings();
+
+		float lifetime_min;
+		float lifetime_max;
+		float speed_min;
+		float speed_max;
+		float direction;
+		float spread;			// particles leave up to half of this either side of direction
+		Vector2 acceleration;	// in units per second per second, gravity for example
+		float drag;				// the fraction of its velocity a particle loses each second
+		float start_size;
+		float end_size;
+		UInt32 start_colour;	// ABGR, the same as Sprite
+		UInt32 end_colour;
+		float depth;
+
+		const Texture* texture;
+		Vector2 uv_position;
+		float uv_width;
+		float uv_height;
+	};
+
+	// a fixed size pool of particles stored as one array per attribute
+	// so the update works on four particles at a time with SSE or NEON where they are available
+	// dead particles are replaced by the last live one, so the live particles are always packed at the front
+	// size and colour are blended from start to end over each particle's lifetime
+	class ParticleSystem
+	{
+	public:
+		ParticleSystem(const UInt32 capacity, const ParticleSettings& settings = ParticleSettings());
+
+		// emitters add rate particles a second at their position until they are removed
+		Int32 AddEmitter(const Vector2& position, const float rate);
+		void RemoveEmitter(const Int32 emitter_id);
+		void set_emitter_position(const Int32 emitter_id, const Vector2& position);
+		void set_emitter_rate(const Int32 emitter_id, const float rate);
+
+		// emits count particles at once, fewer if the pool is full
+		UInt32 Burst(const Vector2& position, const UInt32 count);
+
+		// thread_pool is optional, it's only used when there's more than one job's worth of particles
+		void Update(const float frame_time, ThreadPool* thread_pool = NULL);
+
+		// draws the particles straight into the renderer's sprite batch after anything already drawn
+		// or one sprite each on platforms without batching, call between the renderer's Begin and End
+		void Render(SpriteRenderer* renderer) const;
+
+		// writes four vertices for each particle from first_particle, in SpriteBatch's winding
+		void BuildVertices(SpriteBatchVertex* vertices, const UInt32 first_particle, const UInt32 num_particles) const;
+
+		void Clear();
+
+		inline const ParticleSettings& settings() const { return settings_; }
+		inline void set_settings(const ParticleSettings& settings) { settings_ = settings; }
+		inline UInt32 num_particles() const { return num_particles_; }
+		inline UInt32 capacity() const { return capacity_; }
+
+		inline float position_x(const UInt32 particle) const { return position_x_[particle]; }
+		inline float position_y(const UInt32 particle) const { return position_y_[particle]; }
+		inline float age(const UInt32 particle) const { return age_[particle]; }
+
+	private:
+		struct Emitter
+		{
+			Vector2 position;
+			float rate;
+			float emit_time;
+			bool active;
+		};
+
+		struct UpdateJobData
+		{
+			ParticleSystem* particle_system;
+			float frame_time;
+			float drag_scale;
+		};
+
+		static void UpdateJob(void* user_data, Int32 job_index);
+		void Integrate(const UInt32 first_particle, const UInt32 end_particle, const float frame_time, const float drag_scale);
+		void RemoveDeadParticles();
+		void Emit(const Vector2& position, const UInt32 count);
+		float RandomFloat(const float min_value, const float max_value);
+
+		ParticleSettings settings_;
+		UInt32 capacity_;
+		UInt32 num_particles_;
+
+		// age goes from 0 to 1 over a particle's lifetime
+		std::vector<float> position_x_;
+		std::vector<float> position_y_;
+		std::vector<float> velocity_x_;
+		std::vector<float> velocity_y_;
+		std::vector<float> age_;
+		std::vector<float> age_rate_;
+
+		std::vector<Emitter> emitters_;
+		UInt32 random_state_;
+	};
+}
+
+#endif // _GEF_PARTICLE_SYSTEM_H
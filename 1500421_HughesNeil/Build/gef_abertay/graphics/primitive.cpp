@@ -2,10 +2,24 @@
 #include <graphics/index_buffer.h>
 #include <system/platform.h>
 #include <cstdlib>
+#include <vector>
 #include <assert.h>
 
 namespace gef
 {
+	PrimitiveCluster::PrimitiveCluster() :
+		start_index(0),
+		num_indices(0),
+		cone_axis(0.0f, 0.0f, 0.0f),
+		cone_cutoff(1.0f)
+	{
+	}
+
+	bool PrimitiveCluster::IsBackFacing(const Vector4& camera_position) const
+	{
+		const Vector4 to_cluster = bounds.position() - camera_position;
+		return to_cluster.DotProduct(cone_axis) >= cone_cutoff*to_cluster.Length() + bounds.radius();
+	}
 
 	Primitive::Primitive(Platform& platform) :
 		material_(NULL),
@@ -23,6 +37,47 @@ namespace gef
 		return index_buffer_->Init(platform, indices, num_indices, index_byte_size, read_only);
 	}
 
+	bool Primitive::InitCompactIndexBuffer(Platform& platform, const void* indices, const UInt32 num_indices, const UInt32 index_byte_size, const UInt32 num_vertices, const bool read_only)
+	{
+		const UInt32 compact_index_byte_size = GetIndexByteSize(num_vertices);
+		if((compact_index_byte_size == index_byte_size) || (num_indices == 0))
+			return InitIndexBuffer(platform, indices, num_indices, index_byte_size, read_only);
+
+		std::vector<UInt16> short_indices;
+		std::vector<UInt32> long_indices;
+		if(compact_index_byte_size == 2)
+			short_indices.resize(num_indices);
+		else
+			long_indices.resize(num_indices);
+
+		for(UInt32 index_num = 0; index_num < num_indices; ++index_num)
+		{
+			UInt32 index;
+			switch(index_byte_size)
+			{
+			case 1:
+				index = static_cast<const UInt8*>(indices)[index_num];
+				break;
+			case 2:
+				index = static_cast<const UInt16*>(indices)[index_num];
+				break;
+			default:
+				index = static_cast<const UInt32*>(indices)[index_num];
+				break;
+			}
+
+			if(compact_index_byte_size == 2)
+				short_indices[index_num] = (UInt16)index;
+			else
+				long_indices[index_num] = index;
+		}
+
+		if(compact_index_byte_size == 2)
+			return InitIndexBuffer(platform, &short_indices[0], num_indices, 2, read_only);
+		else
+			return InitIndexBuffer(platform, &long_indices[0], num_indices, 4, read_only);
+	}
+
 	Primitive::~Primitive()
 	{
 		if(index_buffer_)
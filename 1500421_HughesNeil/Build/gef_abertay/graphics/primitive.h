@@ -2,6 +2,8 @@
 #define _GEF_PRIMITIVE_H
 
 #include <gef.h>
+#include <maths/sphere.h>
+#include <vector>
 
 namespace gef
 {
@@ -18,6 +20,26 @@ namespace gef
 		NUM_PRIMITIVE_TYPES
 	};
 
+	// a run of triangles in a triangle list primitive with the data needed to cull them
+	// bounds and the normal cone are in mesh space
+	// every triangle faces away from a point p when
+	// dot(bounds centre - p, cone_axis) >= cone_cutoff * |bounds centre - p| + bounds radius
+	struct PrimitiveCluster
+	{
+		PrimitiveCluster();
+
+		// true if every triangle in the cluster faces away from the mesh space camera position
+		bool IsBackFacing(const Vector4& camera_position) const;
+
+		UInt32 start_index;
+		UInt32 num_indices;
+		Sphere bounds;
+		Vector4 cone_axis;
+
+		// 1 when the triangles face too many ways for the cluster to ever be back facing
+		float cone_cutoff;
+	};
+
 	class Primitive
 	{
 	public:
@@ -27,6 +49,12 @@ namespace gef
 		virtual  ~Primitive();
 		virtual bool InitIndexBuffer(Platform& platform, const void* indices, const UInt32 num_indices, const UInt32 index_byte_size,const bool read_only = true);
 
+		// converts the indices to 16 bit if num_vertices can be addressed with them, otherwise 32 bit
+		bool InitCompactIndexBuffer(Platform& platform, const void* indices, const UInt32 num_indices, const UInt32 index_byte_size, const UInt32 num_vertices, const bool read_only = true);
+
+		// smallest index size every platform can draw with for a vertex buffer of this size
+		static inline UInt32 GetIndexByteSize(const UInt32 num_vertices) { return num_vertices <= 0x10000 ? 2 : 4; }
+
 
 		inline const IndexBuffer* index_buffer() const { return index_buffer_; }
 		inline IndexBuffer* index_buffer() { return index_buffer_; }
@@ -36,11 +64,15 @@ namespace gef
 		inline void set_type(PrimitiveType type) { type_ = type; }
 		inline PrimitiveType type() const { return type_; }
 
+		inline void set_clusters(const std::vector<PrimitiveCluster>& clusters) { clusters_ = clusters; }
+		inline const std::vector<PrimitiveCluster>& clusters() const { return clusters_; }
+
 	protected:
 
 		const Material* material_;
 		PrimitiveType type_;
 		IndexBuffer* index_buffer_;
+		std::vector<PrimitiveCluster> clusters_;
 		Platform& platform_;
 
 	};
@@ -2,15 +2,27 @@
 #include <graphics/shader.h>
 #include <system/platform.h>
 #include <graphics/texture.h>
+#include <graphics/mesh.h>
+#include <graphics/mesh_instance.h>
+#include <graphics/vertex_buffer.h>
+#include <graphics/primitive.h>
+#include <maths/sphere.h>
+#include <maths/frustum.h>
+#include <cfloat>
+#include <cmath>
 
 namespace gef
 {
 	Renderer3D::Renderer3D(Platform& platform) :
 		shader_(NULL),
 		override_material_(NULL),
+		lod_scale_(1.0f),
+		forced_lod_(-1),
 		platform_(platform),
 		default_shader_(platform),
-		default_skinned_mesh_shader_(platform)
+		default_skinned_mesh_shader_(platform),
+		default_packed_shader_(platform, true),
+		default_packed_skinned_mesh_shader_(platform, true)
 	{
 		projection_matrix_.SetIdentity();
 		view_matrix_.SetIdentity();
@@ -47,9 +59,13 @@ namespace gef
 
 			default_skinned_mesh_shader_data_.set_bone_matrices(&bone_matrices);
 
-			SetShader(&default_skinned_mesh_shader_);
+			Default3DSkinningShader* skinned_mesh_shader = &default_skinned_mesh_shader_;
+			if(mesh_instance.mesh() && mesh_instance.mesh()->vertex_buffer() && (mesh_instance.mesh()->vertex_buffer()->vertex_byte_size() == sizeof(Mesh::PackedSkinnedVertex)))
+				skinned_mesh_shader = &default_packed_skinned_mesh_shader_;
 
-			default_skinned_mesh_shader_.SetSceneData(default_skinned_mesh_shader_data_, view_matrix_, projection_matrix_);
+			SetShader(skinned_mesh_shader);
+
+			skinned_mesh_shader->SetSceneData(default_skinned_mesh_shader_data_, view_matrix_, projection_matrix_);
 		}
 
 		DrawMesh(mesh_instance);
@@ -58,6 +74,107 @@ namespace gef
 			SetShader(previous_shader);
 	}
 
+	Shader* Renderer3D::GetMeshShader(const Mesh& mesh)
+	{
+		if((shader_ == &default_shader_) && mesh.vertex_buffer() && (mesh.vertex_buffer()->vertex_byte_size() == sizeof(Mesh::PackedVertex)))
+			return &default_packed_shader_;
+
+		return shader_;
+	}
+
+	float Renderer3D::CalculateScreenSize(const MeshInstance& mesh_instance) const
+	{
+		const Mesh* mesh = mesh_instance.mesh();
+		if(mesh == NULL)
+			return 0.0f;
+
+		const Sphere view_sphere = mesh->bounding_sphere().Transform(mesh_instance.transform()).Transform(view_matrix_);
+		const float radius = view_sphere.radius();
+		const float projection_scale = fabsf(projection_matrix_.m(1,1));
+
+		// orthographic projections don't divide by depth
+		if(projection_matrix_.m(2,3) == 0.0f)
+			return radius*projection_scale;
+
+		// the camera is inside the sphere
+		const float depth = fabsf(view_sphere.position().z());
+		if(depth <= radius)
+			return FLT_MAX;
+
+		return radius*projection_scale / depth;
+	}
+
+	Int32 Renderer3D::DrawMeshClusters(const MeshInstance& mesh_instance, const Frustum* frustum, const Vector4& camera_position)
+	{
+		const Mesh* mesh = mesh_instance.mesh();
+		if(mesh == NULL)
+			return 0;
+
+		// which side of a plane a point is on doesn't change with the transform
+		// so back facing tests can be done in mesh space
+		Matrix44 world_to_mesh;
+		world_to_mesh.Inverse(mesh_instance.transform());
+		const Vector4 mesh_camera_position = camera_position.Transform(world_to_mesh);
+
+		Int32 num_culled = 0;
+		for(UInt32 primitive_index = 0; primitive_index < mesh->num_primitives(); ++primitive_index)
+		{
+			const std::vector<PrimitiveCluster>& clusters = mesh->GetPrimitive(primitive_index)->clusters();
+			if(clusters.empty())
+			{
+				DrawPrimitive(mesh_instance, primitive_index);
+				continue;
+			}
+
+			Int32 run_start = -1;
+			UInt32 run_end = 0;
+			for(std::vector<PrimitiveCluster>::const_iterator cluster_iter = clusters.begin(); cluster_iter != clusters.end(); ++cluster_iter)
+			{
+				bool visible = !cluster_iter->IsBackFacing(mesh_camera_position);
+				if(visible && frustum)
+					visible = frustum->Intersects(cluster_iter->bounds.Transform(mesh_instance.transform())) != FI_OUT;
+
+				if(!visible)
+					++num_culled;
+
+				if(visible && (run_start != -1) && (cluster_iter->start_index == run_end))
+				{
+					run_end += cluster_iter->num_indices;
+					continue;
+				}
+
+				if(run_start != -1)
+				{
+					DrawPrimitive(mesh_instance, primitive_index, run_end - run_start, run_start);
+					run_start = -1;
+				}
+
+				if(visible)
+				{
+					run_start = (Int32)cluster_iter->start_index;
+					run_end = cluster_iter->start_index + cluster_iter->num_indices;
+				}
+			}
+
+			if(run_start != -1)
+				DrawPrimitive(mesh_instance, primitive_index, run_end - run_start, run_start);
+		}
+
+		return num_culled;
+	}
+
+	UInt32 Renderer3D::SelectMeshLod(const MeshInstance& mesh_instance) const
+	{
+		const Mesh* mesh = mesh_instance.mesh();
+		if((mesh == NULL) || (mesh->num_lods() == 0))
+			return 0;
+
+		if(forced_lod_ >= 0)
+			return (UInt32)forced_lod_ < mesh->num_lods() ? (UInt32)forced_lod_ : mesh->num_lods();
+
+		return mesh->SelectLod(CalculateScreenSize(mesh_instance)*lod_scale_);
+	}
+
 	void Renderer3D::CalculateInverseWorldTransposeMatrix()
 	{
 		Matrix44 inv_world;
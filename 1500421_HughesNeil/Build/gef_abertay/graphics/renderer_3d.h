@@ -13,9 +13,12 @@ namespace gef
 {
 	class Platform;
 	class MeshInstance;
+	class Mesh;
 	class Shader;
 	class Material;
 	class Texture;
+	class Frustum;
+	class Vector4;
 
 	class Skeleton;
 
@@ -40,8 +43,18 @@ namespace gef
 	//	virtual void ClearZBuffer() = 0;
 		virtual void Begin(bool clear = true) = 0;
 		virtual void End() = 0;
+		// meshes with lods are drawn with the lod that matches their size on screen
 		virtual void DrawMesh(const  MeshInstance& mesh_instance) = 0;
-		virtual void DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices = -1) = 0;
+		// draws num_indices indices of a single primitive starting from start_index
+		// a num_indices of -1 draws to the end of the primitive
+		// always draws the full detail primitive
+		virtual void DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices = -1, Int32 start_index = 0) = 0;
+		// draws only the clusters of each primitive that face the camera and aren't outside frustum
+		// frustum and camera_position are in world space, frustum can be NULL to only cull back facing clusters
+		// neighbouring visible clusters are drawn together, primitives without clusters are drawn in full
+		// for full detail, unskinned meshes only
+		// returns the number of clusters culled
+		Int32 DrawMeshClusters(const MeshInstance& mesh_instance, const Frustum* frustum, const Vector4& camera_position);
 		virtual void SetFillMode(FillMode fill_mode) = 0;
 		virtual void SetDepthTest(DepthTest depth_test) = 0;
 		void DrawSkinnedMesh(const  MeshInstance& mesh_instance, const std::vector<Matrix44>& bone_matrices, bool use_default_shader = true);
@@ -63,12 +76,31 @@ namespace gef
 		inline void set_override_material(const Material* material) { override_material_ = material; }
 		inline const Material* override_material() const { return override_material_; }
 
+		// projected diameter of the mesh's bounding sphere as a fraction of the screen height
+		// using the current view and projection matrices
+		float CalculateScreenSize(const MeshInstance& mesh_instance) const;
+
+		// screen sizes are multiplied by this before choosing a lod
+		// greater than 1 keeps the detailed lods for longer
+		inline void set_lod_scale(const float lod_scale) { lod_scale_ = lod_scale; }
+		inline float lod_scale() const { return lod_scale_; }
+
+		// draws every mesh with this lod, or the least detailed one it has
+		// -1 chooses lods by screen size
+		inline void set_forced_lod(const Int32 lod) { forced_lod_ = lod; }
+		inline Int32 forced_lod() const { return forced_lod_; }
+
 		static Renderer3D* Create(Platform& platform);
 	protected:
 		Renderer3D(Platform& platform);
 		void CalculateInverseWorldTransposeMatrix();
 		inline void set_shader( Shader* shader) { shader_ = shader; }
 
+		// swaps the default shaders for their packed vertex versions when the mesh uses packed vertices
+		Shader* GetMeshShader(const Mesh& mesh);
+
+		UInt32 SelectMeshLod(const MeshInstance& mesh_instance) const;
+
 		Matrix44 projection_matrix_;
 		Matrix44 view_matrix_;
 		Matrix44 inv_world_transpose_matrix_;
@@ -76,9 +108,13 @@ namespace gef
 		Shader* shader_;
 		Default3DShader default_shader_;
 		Default3DSkinningShader default_skinned_mesh_shader_;
+		Default3DShader default_packed_shader_;
+		Default3DSkinningShader default_packed_skinned_mesh_shader_;
 		Default3DShaderData default_shader_data_;
 		SkinnedMeshShaderData default_skinned_mesh_shader_data_;
 		const Material* override_material_;
+		float lod_scale_;
+		Int32 forced_lod_;
 
 		Platform& platform_;
 	};
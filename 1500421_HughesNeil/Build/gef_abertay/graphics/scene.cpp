@@ -7,11 +7,14 @@
 #include <system/platform.h>
 #include <graphics/image_data.h>
 #include <assets/png_loader.h>
+#include <assets/cooked_texture_loader.h>
 #include <graphics/material.h>
+#include <system/thread_pool.h>
 
 #include <system/file.h>
 #include <system/memory_stream_buffer.h>
 #include <fstream>
+#include <sstream>
 #include <assert.h>
 
 namespace gef
@@ -19,23 +22,23 @@ namespace gef
 	Scene::~Scene()
 	{
 		// free up skeletons
-		for(std::list<Skeleton*>::iterator skeleton_iter = skeletons.begin(); skeleton_iter != skeletons.end(); ++skeleton_iter)
+		for(std::vector<Skeleton*>::iterator skeleton_iter = skeletons.begin(); skeleton_iter != skeletons.end(); ++skeleton_iter)
 			delete *skeleton_iter;
 
 		// free up meshes
-//		for(std::list<MeshData>::iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
-//			delete *mesh_iter;
+		for(std::vector<MeshData*>::iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
+			delete *mesh_iter;
 
 		// free up textures
-		for(std::list<Texture*>::iterator texture_iter = textures.begin(); texture_iter != textures.end(); ++texture_iter)
+		for(std::vector<Texture*>::iterator texture_iter = textures.begin(); texture_iter != textures.end(); ++texture_iter)
 			delete *texture_iter;
 
 		// free up materials
-		for(std::list<Material*>::iterator material_iter = materials.begin(); material_iter != materials.end(); ++material_iter)
+		for(std::vector<Material*>::iterator material_iter = materials.begin(); material_iter != materials.end(); ++material_iter)
 			delete *material_iter;
 
 		// free up animations
-		for(std::map<gef::StringId, Animation*>::iterator animation_iter = animations.begin(); animation_iter != animations.end(); ++animation_iter)
+		for(StringIdMap<Animation*>::iterator animation_iter = animations.begin(); animation_iter != animations.end(); ++animation_iter)
 			delete animation_iter->second;
 	}
 
@@ -46,6 +49,8 @@ namespace gef
 		mesh->set_bounding_sphere(gef::Sphere(mesh->aabb()));
 
 		mesh->InitVertexBuffer(platform, mesh_data.vertex_data.vertices, mesh_data.vertex_data.num_vertices, mesh_data.vertex_data.vertex_byte_size, read_only);
+		if(Mesh::IsPackedVertexSize(mesh_data.vertex_data.vertex_byte_size))
+			mesh->set_position_scale_bias(mesh_data.vertex_data.position_scale, mesh_data.vertex_data.position_bias);
 
 		mesh->AllocatePrimitives((Int32)mesh_data.primitives.size());
 
@@ -54,11 +59,14 @@ namespace gef
 		{
 			Primitive* primitive = mesh->GetPrimitive(prim_index);
 			primitive->set_type((*prim_iter)->type);
-			primitive->InitIndexBuffer(platform, (*prim_iter)->indices, (*prim_iter)->num_indices, (*prim_iter)->index_byte_size, read_only);
+			primitive->InitCompactIndexBuffer(platform, (*prim_iter)->indices, (*prim_iter)->num_indices, (*prim_iter)->index_byte_size, mesh_data.vertex_data.num_vertices, read_only);
+			primitive->set_clusters((*prim_iter)->clusters);
 
 			if ((*prim_iter)->material_name_id != 0)
 			{
-				primitive->set_material(materials_map[(*prim_iter)->material_name_id]);
+				StringIdMap<Material*>::const_iterator material_iter = materials_map.find((*prim_iter)->material_name_id);
+				if(material_iter != materials_map.end())
+					primitive->set_material(material_iter->second);
 			}
 
 			//if((*prim_iter)->material)
@@ -73,39 +81,115 @@ namespace gef
 			//}
 		}
 
+		// lods share the vertex buffer and materials of the full detail primitives
+		mesh->AllocateLods((UInt32)mesh_data.lods.size());
+		for(UInt32 lod = 1; lod <= mesh->num_lods(); ++lod)
+		{
+			const MeshLodData& lod_data = mesh_data.lods[lod-1];
+			mesh->set_lod_screen_size(lod, lod_data.screen_size);
+
+			for(UInt32 prim_index = 0; prim_index < mesh->num_primitives(); ++prim_index)
+			{
+				Primitive* primitive = mesh->GetLodPrimitive(lod, prim_index);
+				primitive->set_type(mesh->GetPrimitive(prim_index)->type());
+				primitive->set_material(mesh->GetPrimitive(prim_index)->material());
+				if(prim_index < lod_data.primitives.size())
+				{
+					const PrimitiveData& prim_data = lod_data.primitives[prim_index];
+					primitive->InitCompactIndexBuffer(platform, prim_data.indices, prim_data.num_indices, prim_data.index_byte_size, mesh_data.vertex_data.num_vertices, read_only);
+				}
+			}
+		}
+
 		return mesh;
 	}
 
-	void Scene::CreateMaterials(const Platform& platform)
+	struct TextureDecodeJobs
 	{
+		const Platform* platform;
+		std::vector<const std::string*> filenames;
+		ImageData* images;
+	};
 
-		// go through all the materials and create new textures for them
-//		for(std::map<std::string, std::string>::iterator materialIter = materials_.begin();materialIter!=materials_.end();++materialIter)
-		for(std::list<MaterialData>::iterator materialIter = material_data.begin();materialIter!=material_data.end();++materialIter)
+	static void DecodeTextureJob(void* user_data, Int32 job_index)
+	{
+		TextureDecodeJobs* jobs = static_cast<TextureDecodeJobs*>(user_data);
+
+		// cooked textures are read as they are, anything else is decoded as a png
+		const char* filename = jobs->filenames[job_index]->c_str();
+		if(IsCookedTextureFilename(filename))
+		{
+			CookedTextureLoader cooked_texture_loader;
+			cooked_texture_loader.Load(filename, *jobs->platform, jobs->images[job_index]);
+		}
+		else
+		{
+			PNGLoader png_loader;
+			png_loader.Load(filename, *jobs->platform, jobs->images[job_index]);
+		}
+	}
+
+	void Scene::CreateMaterials(const Platform& platform, ThreadPool* thread_pool)
+	{
+		// find all the textures that haven't been loaded yet
+		TextureDecodeJobs jobs;
+		jobs.platform = &platform;
+		std::vector<gef::StringId> texture_name_ids;
+		StringIdMap<Int32> pending_textures;
+		for(std::vector<MaterialData>::iterator materialIter = material_data.begin();materialIter!=material_data.end();++materialIter)
 		{
-			Material* material = new Material();
-			materials.push_back(material);
-			materials_map[materialIter->name_id] = material;
 			if(materialIter->diffuse_texture != "")
 			{
 				gef::StringId texture_name_id = gef::GetStringId(materialIter->diffuse_texture);
-				if(textures_map.find(texture_name_id) == textures_map.end())
+				if((textures_map.find(texture_name_id) == textures_map.end()) && (pending_textures.find(texture_name_id) == pending_textures.end()))
 				{
 					string_id_table.Add(materialIter->diffuse_texture);
-
-					ImageData image_data;
-					PNGLoader png_loader;
-					png_loader.Load(materialIter->diffuse_texture.c_str(), platform, image_data);
-					if(image_data.image() != NULL)
-					{
-						Texture* texture = Texture::Create(platform, image_data);
-						textures.push_back(texture);
-						textures_map[texture_name_id] = texture;
-						material->set_texture(texture);
-					}
+					pending_textures[texture_name_id] = (Int32)jobs.filenames.size();
+					jobs.filenames.push_back(&materialIter->diffuse_texture);
+					texture_name_ids.push_back(texture_name_id);
 				}
 			}
 		}
+
+		// decode the textures in parallel
+		const Int32 texture_count = (Int32)jobs.filenames.size();
+		jobs.images = texture_count > 0 ? new ImageData[texture_count] : NULL;
+		if(thread_pool && (texture_count > 1))
+			thread_pool->ParallelFor(texture_count, DecodeTextureJob, &jobs);
+		else
+		{
+			for(Int32 texture_num = 0; texture_num < texture_count; ++texture_num)
+				DecodeTextureJob(&jobs, texture_num);
+		}
+
+		// textures are created on this thread
+		textures.reserve(textures.size()+texture_count);
+		for(Int32 texture_num = 0; texture_num < texture_count; ++texture_num)
+		{
+			if(jobs.images[texture_num].image() != NULL)
+			{
+				Texture* texture = Texture::Create(platform, jobs.images[texture_num]);
+				textures.push_back(texture);
+				textures_map[texture_name_ids[texture_num]] = texture;
+			}
+		}
+		delete[] jobs.images;
+		jobs.images = NULL;
+
+		// go through all the materials and create new textures for them
+		materials.reserve(materials.size()+material_data.size());
+		for(std::vector<MaterialData>::iterator materialIter = material_data.begin();materialIter!=material_data.end();++materialIter)
+		{
+			Material* material = new Material();
+			materials.push_back(material);
+			materials_map[materialIter->name_id] = material;
+			if(materialIter->diffuse_texture != "")
+			{
+				StringIdMap<Texture*>::const_iterator texture_iter = textures_map.find(gef::GetStringId(materialIter->diffuse_texture));
+				if(texture_iter != textures_map.end())
+					material->set_texture(texture_iter->second);
+			}
+		}
 	}
 
 
@@ -170,22 +254,57 @@ namespace gef
 		return success;
 	}
 
-	bool Scene::ReadScene(std::istream& stream)
+	bool Scene::ReadHeader(std::istream& stream, Int32& mesh_count, Int32& skeleton_count, Int32& animation_count)
 	{
 		bool success = true;
 
-		Int32 mesh_count;
 		Int32 material_count;
-		Int32 skeleton_count;
-		Int32 animation_count;
 		Int32 string_count;
 
-		stream.read((char*)&mesh_count, sizeof(Int32));
+		// files written before the table of contents was added start with the mesh count
+		UInt32 file_id;
+		stream.read((char*)&file_id, sizeof(UInt32));
+		if(file_id == kSceneFileId)
+		{
+			Int32 version;
+			stream.read((char*)&version, sizeof(Int32));
+			success = version == kSceneFileVersion;
+			if(!success)
+				return false;
+
+			stream.read((char*)&mesh_count, sizeof(Int32));
+		}
+		else
+			mesh_count = (Int32)file_id;
+
 		stream.read((char*)&material_count, sizeof(Int32));
 		stream.read((char*)&skeleton_count, sizeof(Int32));
 		stream.read((char*)&animation_count, sizeof(Int32));
 		stream.read((char*)&string_count, sizeof(Int32));
 
+		// table of contents
+		table_of_contents.clear();
+		if(file_id == kSceneFileId)
+		{
+			Int32 chunk_count = -1;
+			stream.read((char*)&chunk_count, sizeof(Int32));
+			if(!stream.good() || (chunk_count < 0))
+				return false;
+
+			// read one at a time so a corrupt count fails at the end of the data rather than allocating it all up front
+			for(Int32 chunk_num = 0; chunk_num < chunk_count; ++chunk_num)
+			{
+				SceneChunk chunk;
+				stream.read((char*)&chunk, sizeof(SceneChunk));
+				if(!stream.good() || (chunk.offset < 0) || (chunk.size < 0))
+				{
+					table_of_contents.clear();
+					return false;
+				}
+				table_of_contents.push_back(chunk);
+			}
+		}
+
 		// string table
 		for(Int32 string_num=0;string_num<string_count;++string_num)
 		{
@@ -204,6 +323,8 @@ namespace gef
 		}
 
 		// materials
+		material_data.reserve(material_data.size()+material_count);
+		material_data_map.reserve(material_data.size()+material_count);
 		for(Int32 material_num=0;material_num<material_count;++material_num)
 		{
 			material_data.push_back(MaterialData());
@@ -212,17 +333,38 @@ namespace gef
 
 			material.Read(stream);
 
-			material_data_map[material.name_id] = &material;
+			material_data_map[material.name_id] = (Int32)material_data.size()-1;
 		}
 
+		meshes.reserve(meshes.size()+mesh_count);
+		skeletons.reserve(skeletons.size()+skeleton_count);
+		animations.reserve(animations.size()+animation_count);
+
+		return success && !stream.fail();
+	}
+
+	bool Scene::ReadScene(std::istream& stream)
+	{
+		bool success = true;
+
+		Int32 mesh_count;
+		Int32 skeleton_count;
+		Int32 animation_count;
+
+		success = ReadHeader(stream, mesh_count, skeleton_count, animation_count);
+		if(!success)
+			return false;
+
+		const size_t first_mesh = meshes.size();
+
 		// meshes
 		for(Int32 mesh_num=0;mesh_num<mesh_count;++mesh_num)
 		{
-			meshes.push_back(MeshData());
-
-			MeshData& mesh = meshes.back();
+			MeshData* mesh = new MeshData();
+			meshes.push_back(mesh);
 
-			mesh.Read(stream);
+			if(!mesh->Read(stream))
+				return false;
 
 			// go through all primitives and try and find material to use
 			//for(std::vector<PrimitiveData*>::iterator prim_iter =mesh.primitives.begin(); prim_iter != mesh.primitives.end(); ++prim_iter)
@@ -251,6 +393,28 @@ namespace gef
 			animations[animation->name_id()] = animation;
 		}
 
+		// mesh lods and clusters follow in table of contents order
+		for(std::vector<SceneChunk>::const_iterator chunk_iter = table_of_contents.begin(); chunk_iter != table_of_contents.end(); ++chunk_iter)
+		{
+			if((chunk_iter->type != kSceneChunkMeshLods) && (chunk_iter->type != kSceneChunkMeshClusters))
+				continue;
+
+			MeshData unused_mesh;
+			MeshData* mesh = &unused_mesh;
+			for(size_t mesh_num = first_mesh; mesh_num < meshes.size(); ++mesh_num)
+			{
+				if(meshes[mesh_num]->name_id == chunk_iter->name_id)
+				{
+					mesh = meshes[mesh_num];
+					break;
+				}
+			}
+
+			if(chunk_iter->type == kSceneChunkMeshLods)
+				success = mesh->ReadLods(stream) && success;
+			else
+				success = mesh->ReadClusters(stream) && success;
+		}
 
 		return success;
 	}
@@ -264,54 +428,417 @@ namespace gef
 		Int32 skeleton_count = (Int32)skeletons.size();
 		Int32 animation_count = (Int32)animations.size();
 		Int32 string_count = (Int32)string_id_table.table().size();
+		Int32 lods_count = 0;
+		Int32 clusters_count = 0;
+		for(std::vector<MeshData*>::const_iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
+		{
+			if(!(*mesh_iter)->lods.empty())
+				++lods_count;
+			if((*mesh_iter)->HasClusters())
+				++clusters_count;
+		}
+		Int32 chunk_count = mesh_count+skeleton_count+animation_count+lods_count+clusters_count;
 
-		stream.write((char*)&mesh_count, sizeof(Int32));
-		stream.write((char*)&material_count, sizeof(Int32));
-		stream.write((char*)&skeleton_count, sizeof(Int32));
-		stream.write((char*)&animation_count, sizeof(Int32));
-		stream.write((char*)&string_count, sizeof(Int32));
+		// string table and materials are always loaded so they are kept with the header
+		std::ostringstream header_stream(std::ios::out | std::ios::binary);
 
 		// string table
 		for(std::map<gef::StringId, std::string>::const_iterator string_iter = string_id_table.table().begin(); string_iter != string_id_table.table().end(); ++string_iter)
 		{
 			//Int32 string_length = string_iter->second.length();
-			stream.write(string_iter->second.c_str(), string_iter->second.length()+1);
+			header_stream.write(string_iter->second.c_str(), string_iter->second.length()+1);
 		}
 
 		// materials
-		for(std::list<MaterialData>::const_iterator material_iter = material_data.begin(); material_iter != material_data.end(); ++material_iter)
-			material_iter->Write(stream);
+		for(std::vector<MaterialData>::const_iterator material_iter = material_data.begin(); material_iter != material_data.end(); ++material_iter)
+			material_iter->Write(header_stream);
+
+		// write each mesh, skeleton and animation out separately
+		// so the table of contents can record where they are
+		std::vector<SceneChunk> chunks;
+		std::ostringstream chunk_stream(std::ios::out | std::ios::binary);
+		chunks.reserve(chunk_count);
 
 		// meshes
-		for(std::list<MeshData>::const_iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
-			mesh_iter->Write(stream);
+		for(std::vector<MeshData*>::const_iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
+		{
+			SceneChunk chunk;
+			chunk.name_id = (*mesh_iter)->name_id;
+			chunk.type = kSceneChunkMesh;
+			chunk.offset = (Int32)chunk_stream.tellp();
+			(*mesh_iter)->Write(chunk_stream);
+			chunk.size = (Int32)chunk_stream.tellp() - chunk.offset;
+			chunks.push_back(chunk);
+		}
 
 		// skeletons
-		for(std::list<Skeleton*>::const_iterator skeleton_iter = skeletons.begin();skeleton_iter != skeletons.end(); ++skeleton_iter)
-			(*skeleton_iter)->Write(stream);
+		// identified by the name of the root joint
+		for(std::vector<Skeleton*>::const_iterator skeleton_iter = skeletons.begin();skeleton_iter != skeletons.end(); ++skeleton_iter)
+		{
+			SceneChunk chunk;
+			chunk.name_id = (*skeleton_iter)->joint_count() > 0 ? (*skeleton_iter)->joint(0).name_id : 0;
+			chunk.type = kSceneChunkSkeleton;
+			chunk.offset = (Int32)chunk_stream.tellp();
+			(*skeleton_iter)->Write(chunk_stream);
+			chunk.size = (Int32)chunk_stream.tellp() - chunk.offset;
+			chunks.push_back(chunk);
+		}
 
 		// animations
-		for(std::map<gef::StringId, Animation*>::const_iterator animation_iter = animations.begin(); animation_iter != animations.end(); ++animation_iter)
-			animation_iter->second->Write(stream);
+		for(StringIdMap<Animation*>::const_iterator animation_iter = animations.begin(); animation_iter != animations.end(); ++animation_iter)
+		{
+			SceneChunk chunk;
+			chunk.name_id = animation_iter->first;
+			chunk.type = kSceneChunkAnimation;
+			chunk.offset = (Int32)chunk_stream.tellp();
+			animation_iter->second->Write(chunk_stream);
+			chunk.size = (Int32)chunk_stream.tellp() - chunk.offset;
+			chunks.push_back(chunk);
+		}
+
+		// mesh lods
+		for(std::vector<MeshData*>::const_iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
+		{
+			if((*mesh_iter)->lods.empty())
+				continue;
+
+			SceneChunk chunk;
+			chunk.name_id = (*mesh_iter)->name_id;
+			chunk.type = kSceneChunkMeshLods;
+			chunk.offset = (Int32)chunk_stream.tellp();
+			(*mesh_iter)->WriteLods(chunk_stream);
+			chunk.size = (Int32)chunk_stream.tellp() - chunk.offset;
+			chunks.push_back(chunk);
+		}
+
+		// mesh clusters
+		for(std::vector<MeshData*>::const_iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
+		{
+			if(!(*mesh_iter)->HasClusters())
+				continue;
+
+			SceneChunk chunk;
+			chunk.name_id = (*mesh_iter)->name_id;
+			chunk.type = kSceneChunkMeshClusters;
+			chunk.offset = (Int32)chunk_stream.tellp();
+			(*mesh_iter)->WriteClusters(chunk_stream);
+			chunk.size = (Int32)chunk_stream.tellp() - chunk.offset;
+			chunks.push_back(chunk);
+		}
+
+		// chunk offsets are from the start of the scene data
+		const std::string header_data = header_stream.str();
+		const Int32 chunk_data_offset = (Int32)(sizeof(UInt32) + sizeof(Int32)*7 + chunk_count*sizeof(SceneChunk) + header_data.size());
+		for(std::vector<SceneChunk>::iterator chunk_iter = chunks.begin(); chunk_iter != chunks.end(); ++chunk_iter)
+			chunk_iter->offset += chunk_data_offset;
+
+		stream.write((char*)&kSceneFileId, sizeof(UInt32));
+		stream.write((char*)&kSceneFileVersion, sizeof(Int32));
+		stream.write((char*)&mesh_count, sizeof(Int32));
+		stream.write((char*)&material_count, sizeof(Int32));
+		stream.write((char*)&skeleton_count, sizeof(Int32));
+		stream.write((char*)&animation_count, sizeof(Int32));
+		stream.write((char*)&string_count, sizeof(Int32));
+
+		// table of contents
+		stream.write((char*)&chunk_count, sizeof(Int32));
+		if(chunk_count > 0)
+			stream.write((char*)&chunks[0], chunk_count*sizeof(SceneChunk));
+
+		stream.write(header_data.c_str(), header_data.size());
+
+		const std::string chunk_data = chunk_stream.str();
+		stream.write(chunk_data.c_str(), chunk_data.size());
+
+		return success && !stream.fail();
+	}
+
+	MaterialData* Scene::FindMaterialData(const gef::StringId material_name_id)
+	{
+		StringIdMap<Int32>::const_iterator material_iter = material_data_map.find(material_name_id);
+		if(material_iter != material_data_map.end())
+			return &material_data[material_iter->second];
+
+		return NULL;
+	}
+
+	bool Scene::ReadTableOfContentsFromFile(const Platform& platform, const char* filename)
+	{
+		bool success = true;
+		File* file = gef::File::Create();
+		Int32 file_size = 0;
+		Int32 bytes_read = 0;
+
+		// file id, version, 5 counts and the chunk count
+		const Int32 kFixedHeaderSize = sizeof(UInt32) + sizeof(Int32)*7;
+		Int32 fixed_header[8];
+
+		success = file->Open(filename);
+		if(success)
+			success = file->GetSize(file_size);
+
+		bool has_toc = false;
+		if(success && (file_size >= kFixedHeaderSize))
+		{
+			has_toc = file->Read(fixed_header, kFixedHeaderSize, bytes_read) && (bytes_read == kFixedHeaderSize);
+			has_toc = has_toc && ((UInt32)fixed_header[0] == kSceneFileId);
+		}
+
+		// files without a table of contents have to be read in full
+		if(success && !has_toc)
+		{
+			file->Close();
+			delete file;
+			return ReadSceneFromFile(platform, filename);
+		}
+
+		// the header data runs up to the start of the first chunk
+		Int32 header_size = file_size;
+		if(success)
+		{
+			// a corrupt count or chunk fails the load rather than being used to size anything
+			const Int32 chunk_count = fixed_header[7];
+			success = (chunk_count >= 0) && (chunk_count <= (file_size - kFixedHeaderSize) / (Int32)sizeof(SceneChunk));
+
+			std::vector<SceneChunk> chunks;
+			if(success && (chunk_count > 0))
+			{
+				chunks.resize(chunk_count);
+				const Int32 toc_size = chunk_count*sizeof(SceneChunk);
+				success = file->Read(&chunks[0], toc_size, bytes_read) && (bytes_read == toc_size);
+			}
+
+			for(std::vector<SceneChunk>::const_iterator chunk_iter = chunks.begin(); success && (chunk_iter != chunks.end()); ++chunk_iter)
+			{
+				success = (chunk_iter->offset >= 0) && (chunk_iter->size >= 0) && (chunk_iter->offset <= file_size) && (chunk_iter->size <= file_size - chunk_iter->offset);
+				if(success && (chunk_iter->offset < header_size))
+					header_size = chunk_iter->offset;
+			}
+		}
+
+		char* header_data = NULL;
+		if(success)
+		{
+			header_data = (char*)malloc(header_size);
+			success = (header_data != NULL) && file->Seek(SF_Start, 0);
+		}
+		if(success)
+			success = file->Read(header_data, header_size, bytes_read) && (bytes_read == header_size);
+
+		file->Close();
+		delete file;
+		file = NULL;
+
+		if(success)
+		{
+			gef::MemoryStreamBuffer stream_buffer(header_data, header_size);
+			std::istream input_stream(&stream_buffer);
+
+			Int32 mesh_count, skeleton_count, animation_count;
+			success = ReadHeader(input_stream, mesh_count, skeleton_count, animation_count);
+		}
+
+		free(header_data);
+		header_data = NULL;
+
+		if(success)
+		{
+			toc_filename_ = filename;
+
+			// skeletons are small and needed by any skinned mesh so load them now
+			for(std::vector<SceneChunk>::const_iterator chunk_iter = table_of_contents.begin(); success && (chunk_iter != table_of_contents.end()); ++chunk_iter)
+			{
+				if(chunk_iter->type == kSceneChunkSkeleton)
+				{
+					char* chunk_data = NULL;
+					success = ReadChunk(*chunk_iter, &chunk_data);
+					if(success)
+					{
+						gef::MemoryStreamBuffer stream_buffer(chunk_data, chunk_iter->size);
+						std::istream input_stream(&stream_buffer);
+
+						Skeleton* skeleton = new Skeleton();
+						skeleton->Read(input_stream);
+						skeletons.push_back(skeleton);
+					}
+					free(chunk_data);
+				}
+			}
+		}
 
 		return success;
 	}
 
-	Skeleton* Scene::FindSkeleton(const MeshData& mesh_data)
+	bool Scene::ReadChunk(const SceneChunk& chunk, char** chunk_data)
 	{
-		Skeleton* result = NULL;
+		bool success = !toc_filename_.empty();
+		File* file = gef::File::Create();
+
+		*chunk_data = NULL;
+		if(success)
+			success = file->Open(toc_filename_.c_str());
+		if(success)
+		{
+			Int32 file_size = 0;
+			success = file->GetSize(file_size) && (chunk.offset >= 0) && (chunk.size >= 0) && (chunk.offset <= file_size) && (chunk.size <= file_size - chunk.offset);
+			if(success)
+				success = file->Seek(SF_Start, chunk.offset);
+			if(success)
+			{
+				*chunk_data = (char*)malloc(chunk.size);
+				success = *chunk_data != NULL;
+			}
+			if(success)
+			{
+				Int32 bytes_read;
+				success = file->Read(*chunk_data, chunk.size, bytes_read) && (bytes_read == chunk.size);
+			}
+
+			file->Close();
+		}
+		delete file;
 
-		if((mesh_data.vertex_data.num_vertices > 0) && (mesh_data.vertex_data.vertex_byte_size == sizeof(Mesh::SkinnedVertex)))
+		if(!success)
 		{
-			// get the first vertex
-			Mesh::SkinnedVertex* skinned_vertex = (Mesh::SkinnedVertex*)mesh_data.vertex_data.vertices;
+			free(*chunk_data);
+			*chunk_data = NULL;
+		}
+
+		return success;
+	}
+
+	const SceneChunk* Scene::FindChunk(const SceneChunkType type, const gef::StringId name_id) const
+	{
+		for(std::vector<SceneChunk>::const_iterator chunk_iter = table_of_contents.begin(); chunk_iter != table_of_contents.end(); ++chunk_iter)
+		{
+			if((chunk_iter->type == type) && (chunk_iter->name_id == name_id))
+				return &(*chunk_iter);
+		}
+
+		return NULL;
+	}
+
+	MeshData* Scene::LoadMesh(const gef::StringId mesh_name_id)
+	{
+		// a mesh that is already loaded is shared rather than read again
+		for(std::vector<MeshData*>::iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
+		{
+			if((*mesh_iter)->name_id == mesh_name_id)
+				return *mesh_iter;
+		}
+
+		const SceneChunk* chunk = FindChunk(kSceneChunkMesh, mesh_name_id);
+		if(!chunk)
+			return NULL;
+
+		char* chunk_data = NULL;
+		if(!ReadChunk(*chunk, &chunk_data))
+			return NULL;
+
+		gef::MemoryStreamBuffer stream_buffer(chunk_data, chunk->size);
+		std::istream input_stream(&stream_buffer);
+
+		MeshData* mesh = new MeshData();
+		const bool mesh_read = mesh->Read(input_stream);
+		free(chunk_data);
+		if(!mesh_read)
+		{
+			delete mesh;
+			return NULL;
+		}
+		meshes.push_back(mesh);
+
+		const SceneChunk* lods_chunk = FindChunk(kSceneChunkMeshLods, mesh_name_id);
+		if(lods_chunk && ReadChunk(*lods_chunk, &chunk_data))
+		{
+			gef::MemoryStreamBuffer lods_stream_buffer(chunk_data, lods_chunk->size);
+			std::istream lods_input_stream(&lods_stream_buffer);
+			mesh->ReadLods(lods_input_stream);
+
+			free(chunk_data);
+		}
+
+		const SceneChunk* clusters_chunk = FindChunk(kSceneChunkMeshClusters, mesh_name_id);
+		if(clusters_chunk && ReadChunk(*clusters_chunk, &chunk_data))
+		{
+			gef::MemoryStreamBuffer clusters_stream_buffer(chunk_data, clusters_chunk->size);
+			std::istream clusters_input_stream(&clusters_stream_buffer);
+			mesh->ReadClusters(clusters_input_stream);
+
+			free(chunk_data);
+		}
+
+		return mesh;
+	}
+
+	Animation* Scene::LoadAnimation(const gef::StringId anim_name_id)
+	{
+		const SceneChunk* chunk = FindChunk(kSceneChunkAnimation, anim_name_id);
+		if(!chunk)
+			return NULL;
+
+		char* chunk_data = NULL;
+		if(!ReadChunk(*chunk, &chunk_data))
+			return NULL;
+
+		gef::MemoryStreamBuffer stream_buffer(chunk_data, chunk->size);
+		std::istream input_stream(&stream_buffer);
+
+		Animation* animation = new Animation();
+		animation->Read(input_stream);
+
+		free(chunk_data);
 
-			// get string id of cluster link from first influence
+		// replace any previously loaded copy
+		StringIdMap<Animation*>::iterator animation_iter = animations.find(animation->name_id());
+		if(animation_iter != animations.end())
+			delete animation_iter->second;
+		animations[animation->name_id()] = animation;
+
+		return animation;
+	}
+
+	MeshData* Scene::FindMesh(const gef::StringId mesh_name_id)
+	{
+		return LoadMesh(mesh_name_id);
+	}
+
+	Animation* Scene::FindAnimation(const gef::StringId anim_name_id)
+	{
+		StringIdMap<Animation*>::iterator animation_iter = animations.find(anim_name_id);
+		if(animation_iter != animations.end())
+			return animation_iter->second;
+
+		return LoadAnimation(anim_name_id);
+	}
+
+	// skinned vertices are either SkinnedVertex or PackedSkinnedVertex
+	static UInt32 GetBoneIndex(const VertexData& vertex_data, const Int32 vertex_num, const Int32 influence_index)
+	{
+		if(vertex_data.vertex_byte_size == sizeof(Mesh::PackedSkinnedVertex))
+			return static_cast<const Mesh::PackedSkinnedVertex*>(vertex_data.vertices)[vertex_num].bone_indices[influence_index];
+		return static_cast<const Mesh::SkinnedVertex*>(vertex_data.vertices)[vertex_num].bone_indices[influence_index];
+	}
+
+	static void SetBoneIndex(VertexData& vertex_data, const Int32 vertex_num, const Int32 influence_index, const UInt32 bone_index)
+	{
+		if(vertex_data.vertex_byte_size == sizeof(Mesh::PackedSkinnedVertex))
+			static_cast<Mesh::PackedSkinnedVertex*>(vertex_data.vertices)[vertex_num].bone_indices[influence_index] = (UInt8)bone_index;
+		else
+			static_cast<Mesh::SkinnedVertex*>(vertex_data.vertices)[vertex_num].bone_indices[influence_index] = bone_index;
+	}
+
+	Skeleton* Scene::FindSkeleton(const MeshData& mesh_data)
+	{
+		Skeleton* result = NULL;
 
-			StringId joint_name_id = skin_cluster_name_ids[skinned_vertex->bone_indices[0]];
+		if((mesh_data.vertex_data.num_vertices > 0) && Mesh::IsSkinnedVertexSize(mesh_data.vertex_data.vertex_byte_size))
+		{
+			// get string id of cluster link from first influence of the first vertex
+			StringId joint_name_id = skin_cluster_name_ids[GetBoneIndex(mesh_data.vertex_data, 0, 0)];
 
 			// go through all skeletons looking a skeleton that contains the joint name
-			for(std::list<Skeleton*>::iterator skeleton_iter = skeletons.begin(); skeleton_iter != skeletons.end(); ++skeleton_iter)
+			for(std::vector<Skeleton*>::iterator skeleton_iter = skeletons.begin(); skeleton_iter != skeletons.end(); ++skeleton_iter)
 			{
 				if((*skeleton_iter)->FindJoint(joint_name_id))
 				{
@@ -326,33 +853,25 @@ namespace gef
 
 	void Scene::FixUpSkinWeights()
 	{
-		for(std::list<MeshData>::iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
+		for(std::vector<MeshData*>::iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
 		{
-			if((mesh_iter->vertex_data.num_vertices > 0) && (mesh_iter->vertex_data.vertex_byte_size == sizeof(Mesh::SkinnedVertex)))
+			if(((*mesh_iter)->vertex_data.num_vertices > 0) && Mesh::IsSkinnedVertexSize((*mesh_iter)->vertex_data.vertex_byte_size))
 			{
-				Skeleton* skeleton = FindSkeleton(*mesh_iter);
+				Skeleton* skeleton = FindSkeleton(**mesh_iter);
 				if(skeleton)
 				{
-					Mesh::SkinnedVertex* skinned_vertices = (Mesh::SkinnedVertex*)mesh_iter->vertex_data.vertices;
+					VertexData& vertex_data = (*mesh_iter)->vertex_data;
 
 					// go through all vertices and change cluster indices to joint indices
-					for(Int32 vertex_num=0;vertex_num<mesh_iter->vertex_data.num_vertices;++vertex_num)
+					for(Int32 vertex_num=0;vertex_num<vertex_data.num_vertices;++vertex_num)
 					{
-						Mesh::SkinnedVertex* skinned_vertex = skinned_vertices+vertex_num;
-
-						// calculate weight total to normalise weights
-						float weight_total = skinned_vertex->bone_weights[0]+skinned_vertex->bone_weights[1]+skinned_vertex->bone_weights[2]+skinned_vertex->bone_weights[3];
-
 						for(Int32 influence_index=0;influence_index < 4;++influence_index)
 						{
-							// normalise weight
-							skinned_vertex->bone_weights[influence_index] /= weight_total;
-
 							// fix up joint index
-							Int32 joint_index = skeleton->FindJointIndex(skin_cluster_name_ids[skinned_vertex->bone_indices[influence_index]]);
+							Int32 joint_index = skeleton->FindJointIndex(skin_cluster_name_ids[GetBoneIndex(vertex_data, vertex_num, influence_index)]);
 							if(joint_index >= 0)
 							{
-								skinned_vertex->bone_indices[influence_index] = joint_index;
+								SetBoneIndex(vertex_data, vertex_num, influence_index, joint_index);
 							}
 							assert(joint_index >= 0);
 						}
@@ -360,5 +879,135 @@ namespace gef
 				}
 			}
 		}
+
+		NormaliseSkinWeights();
+	}
+
+	void Scene::NormaliseSkinWeights()
+	{
+		for(std::vector<MeshData*>::iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
+		{
+			if(!Mesh::IsSkinnedVertexSize((*mesh_iter)->vertex_data.vertex_byte_size))
+				continue;
+
+			// packed weights add up to 255
+			if((*mesh_iter)->vertex_data.vertex_byte_size == sizeof(Mesh::PackedSkinnedVertex))
+			{
+				Mesh::PackedSkinnedVertex* packed_vertices = (Mesh::PackedSkinnedVertex*)(*mesh_iter)->vertex_data.vertices;
+				for(Int32 vertex_num=0;vertex_num<(*mesh_iter)->vertex_data.num_vertices;++vertex_num)
+				{
+					UInt8* bone_weights = packed_vertices[vertex_num].bone_weights;
+					Int32 weight_total = bone_weights[0]+bone_weights[1]+bone_weights[2]+bone_weights[3];
+					if(weight_total == 255)
+						continue;
+
+					if(weight_total == 0)
+					{
+						bone_weights[0] = 255;
+						continue;
+					}
+
+					// the rounding error goes on the largest influence
+					Int32 largest_influence = 0;
+					Int32 new_total = 0;
+					for(Int32 influence_index=0;influence_index < 4;++influence_index)
+					{
+						bone_weights[influence_index] = (UInt8)((bone_weights[influence_index]*255 + weight_total/2) / weight_total);
+						new_total += bone_weights[influence_index];
+						if(bone_weights[influence_index] > bone_weights[largest_influence])
+							largest_influence = influence_index;
+					}
+					bone_weights[largest_influence] = (UInt8)(bone_weights[largest_influence] + 255 - new_total);
+				}
+				continue;
+			}
+
+			Mesh::SkinnedVertex* skinned_vertices = (Mesh::SkinnedVertex*)(*mesh_iter)->vertex_data.vertices;
+			for(Int32 vertex_num=0;vertex_num<(*mesh_iter)->vertex_data.num_vertices;++vertex_num)
+			{
+				Mesh::SkinnedVertex* skinned_vertex = skinned_vertices+vertex_num;
+
+				float weight_total = skinned_vertex->bone_weights[0]+skinned_vertex->bone_weights[1]+skinned_vertex->bone_weights[2]+skinned_vertex->bone_weights[3];
+
+				// a vertex with no influences is bound entirely to the first joint
+				if(weight_total <= 0.0f)
+				{
+					skinned_vertex->bone_weights[0] = 1.0f;
+					for(Int32 influence_index=1;influence_index < 4;++influence_index)
+						skinned_vertex->bone_weights[influence_index] = 0.0f;
+					continue;
+				}
+
+				for(Int32 influence_index=0;influence_index < 4;++influence_index)
+					skinned_vertex->bone_weights[influence_index] /= weight_total;
+			}
+		}
+	}
+
+	void Scene::RemoveUnusedData()
+	{
+		// materials
+		StringIdMap<Int32> used_materials;
+		bool skinned = false;
+		for(std::vector<MeshData*>::const_iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
+		{
+			if(Mesh::IsSkinnedVertexSize((*mesh_iter)->vertex_data.vertex_byte_size))
+				skinned = true;
+
+			for(std::vector<PrimitiveData*>::const_iterator prim_iter = (*mesh_iter)->primitives.begin(); prim_iter != (*mesh_iter)->primitives.end(); ++prim_iter)
+				used_materials[(*prim_iter)->material_name_id] = 1;
+		}
+
+		std::vector<MaterialData> used_material_data;
+		material_data_map.clear();
+		for(std::vector<MaterialData>::const_iterator material_iter = material_data.begin(); material_iter != material_data.end(); ++material_iter)
+		{
+			if(used_materials.find(material_iter->name_id) != used_materials.end())
+			{
+				material_data_map[material_iter->name_id] = (Int32)used_material_data.size();
+				used_material_data.push_back(*material_iter);
+			}
+		}
+		material_data.swap(used_material_data);
+
+		// skeletons are only needed to skin meshes or play animations
+		if(!skinned && animations.empty())
+		{
+			for(std::vector<Skeleton*>::iterator skeleton_iter = skeletons.begin(); skeleton_iter != skeletons.end(); ++skeleton_iter)
+				delete *skeleton_iter;
+			skeletons.clear();
+		}
+
+		// strings
+		StringIdMap<Int32> used_strings;
+		for(std::vector<MeshData*>::const_iterator mesh_iter = meshes.begin(); mesh_iter != meshes.end(); ++mesh_iter)
+			used_strings[(*mesh_iter)->name_id] = 1;
+		for(std::vector<MaterialData>::const_iterator material_iter = material_data.begin(); material_iter != material_data.end(); ++material_iter)
+		{
+			used_strings[material_iter->name_id] = 1;
+			if(material_iter->diffuse_texture.size() > 0)
+				used_strings[GetStringId(material_iter->diffuse_texture)] = 1;
+		}
+		for(std::vector<Skeleton*>::const_iterator skeleton_iter = skeletons.begin(); skeleton_iter != skeletons.end(); ++skeleton_iter)
+		{
+			for(std::vector<Joint>::const_iterator joint_iter = (*skeleton_iter)->joints().begin(); joint_iter != (*skeleton_iter)->joints().end(); ++joint_iter)
+				used_strings[joint_iter->name_id] = 1;
+		}
+		for(StringIdMap<Animation*>::const_iterator animation_iter = animations.begin(); animation_iter != animations.end(); ++animation_iter)
+		{
+			used_strings[animation_iter->first] = 1;
+			const std::map<StringId, AnimNode*>& anim_nodes = animation_iter->second->anim_nodes();
+			for(std::map<StringId, AnimNode*>::const_iterator node_iter = anim_nodes.begin(); node_iter != anim_nodes.end(); ++node_iter)
+				used_strings[node_iter->first] = 1;
+		}
+
+		std::vector<StringId> unused_strings;
+		for(std::map<StringId, std::string>::const_iterator string_iter = string_id_table.table().begin(); string_iter != string_id_table.table().end(); ++string_iter)
+		{
+			if(used_strings.find(string_iter->first) == used_strings.end())
+				unused_strings.push_back(string_iter->first);
+		}
+		for(std::vector<StringId>::const_iterator string_iter = unused_strings.begin(); string_iter != unused_strings.end(); ++string_iter)
+			string_id_table.Remove(*string_iter);
 	}
 }
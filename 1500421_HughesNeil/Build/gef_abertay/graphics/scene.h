@@ -1,12 +1,13 @@
 #ifndef _SCENE_H
 #define _SCENE_H
 
-#include <list>
 #include <system/string_id.h>
+#include <system/string_id_map.h>
 #include <graphics/mesh_data.h>
 #include <ostream>
 #include <istream>
-#include <map>
+#include <vector>
+#include <string>
 
 namespace gef
 {
@@ -15,6 +16,32 @@ namespace gef
 	class Animation;
 	class Platform;
 	class Material;
+	class ThreadPool;
+
+	// .scn files start with this id followed by a version number
+	// older files start with the mesh count and have no table of contents
+	const UInt32 kSceneFileId = 0x4e435347; // 'GSCN'
+	const Int32 kSceneFileVersion = 2;
+
+	enum SceneChunkType
+	{
+		kSceneChunkMesh = 0,
+		kSceneChunkSkeleton,
+		kSceneChunkAnimation,
+		// named after the mesh they belong to, after all the other chunks so older readers can ignore them
+		kSceneChunkMeshLods,
+		kSceneChunkMeshClusters
+	};
+
+	// table of contents entry
+	// offset is in bytes from the start of the scene data
+	struct SceneChunk
+	{
+		gef::StringId name_id;
+		Int32 type;
+		Int32 offset;
+		Int32 size;
+	};
 
 	class Scene
 	{
@@ -22,34 +49,66 @@ namespace gef
 		~Scene();
 
 		Mesh* CreateMesh(Platform& platform, const MeshData& mesh_data, const bool read_only = true);
-		void CreateMaterials(const Platform& platform);
+		// textures are decoded in parallel on thread_pool, or one at a time if it's NULL
+		void CreateMaterials(const Platform& platform, ThreadPool* thread_pool = NULL);
 
 		bool WriteSceneToFile(const Platform& platform, const char* filename) const;
 		bool ReadSceneFromFile(const Platform& platform, const char* filename);
 
 		bool ReadScene(std::istream& Stream);
 		bool WriteScene(std::ostream& Stream) const;
+
+		// reads the table of contents, string table, materials and skeletons only
+		// meshes and animations are loaded on demand with LoadMesh and LoadAnimation
+		// LoadMesh returns the mesh already loaded if there is one
+		bool ReadTableOfContentsFromFile(const Platform& platform, const char* filename);
+		const SceneChunk* FindChunk(const SceneChunkType type, const gef::StringId name_id) const;
+		MeshData* LoadMesh(const gef::StringId mesh_name_id);
+		Animation* LoadAnimation(const gef::StringId anim_name_id);
 //		void WriteStringTable(std::istream& Stream) const;
 //		void ReadStringTable(std::istream& Stream);
 
 		class Skeleton* FindSkeleton(const MeshData& mesh_data);
 		void FixUpSkinWeights();
 
+		// scales the bone weights of skinned vertices so they add up to one
+		void NormaliseSkinWeights();
+
+		// removes materials that aren't used by any primitive, skeletons when there is
+		// nothing skinned or animated and strings that nothing in the scene refers to
+		void RemoveUnusedData();
+
+		// will load the mesh or animation from the file if it is in the table of contents
+		// and hasn't been loaded yet
+		MeshData* FindMesh(const gef::StringId mesh_name_id);
 		Animation* FindAnimation(const gef::StringId anim_name_id);
 
-		std::list<MeshData> meshes;
-		std::list<MaterialData> material_data;
-		std::list<Texture*> textures;
-		std::list<Material*> materials;
-		std::list<Skeleton*> skeletons;
-		std::map<gef::StringId, Animation*> animations;
+		MaterialData* FindMaterialData(const gef::StringId material_name_id);
+
+		// each mesh is allocated separately and owned by the scene
+		// so pointers returned by FindMesh stay valid as more meshes are loaded
+		std::vector<MeshData*> meshes;
+		std::vector<MaterialData> material_data;
+		std::vector<Texture*> textures;
+		std::vector<Material*> materials;
+		std::vector<Skeleton*> skeletons;
+		StringIdMap<Animation*> animations;
 		StringIdTable string_id_table;
 
-		std::map<gef::StringId, MaterialData*> material_data_map;
-		std::map<gef::StringId, Material*> materials_map;
-		std::map<gef::StringId, Texture*> textures_map;
+		// index into material_data
+		StringIdMap<Int32> material_data_map;
+		StringIdMap<Material*> materials_map;
+		StringIdMap<Texture*> textures_map;
 
 		std::vector<gef::StringId> skin_cluster_name_ids;
+
+		std::vector<SceneChunk> table_of_contents;
+	private:
+		bool ReadHeader(std::istream& stream, Int32& mesh_count, Int32& skeleton_count, Int32& animation_count);
+		bool ReadChunk(const SceneChunk& chunk, char** chunk_data);
+
+		// file the table of contents was read from
+		std::string toc_filename_;
 	};
 }
 
@@ -111,8 +111,14 @@ namespace gef
 		{
 		case kUByte4:
 		case kFloat:
+		case kByte4Norm:
+		case kUByte4Norm:
+		case kHalf2:
 			size = 4;
 			break;
+		case kShort4Norm:
+			size = 8;
+			break;
 		case kVector2:
 			size = 8;
 			break;
@@ -27,7 +27,12 @@ namespace gef
 			kVector2,
 			kVector3,
 			kVector4,
-			kUByte4
+			kUByte4,
+			// normalised vertex attribute formats, read by the shader as floats
+			kShort4Norm,	// signed 16 bit x 4, -1 to 1
+			kByte4Norm,		// signed 8 bit x 4, -1 to 1
+			kUByte4Norm,	// unsigned 8 bit x 4, 0 to 1
+			kHalf2			// 16 bit float x 2
 //			kNumParameterTypes
 		};
 
@@ -0,0 +1,308 @@
+#include <graphics/sprite_batch.h>
+#include <graphics/vertex_buffer.h>
+#include <graphics/index_buffer.h>
+#include <graphics/shader_interface.h>
+#include <system/platform.h>
+#include <algorithm>
+#include <cstring>
+#include <math.h>
+
+namespace gef
+{
+	SpriteBatch::SpriteBatch(Platform& platform, const UInt32 max_sprites) :
+		platform_(platform),
+		max_sprites_(max_sprites < kSpriteBatchMaxSprites ? max_sprites : kSpriteBatchMaxSprites),
+		sort_mode_(SSM_DEFERRED),
+		default_texture_(NULL),
+		vertex_buffer_(NULL),
+		index_buffer_(NULL),
+		shader_(NULL),
+		num_sprites_drawn_(0),
+		num_draws_(0),
+		num_flushes_(0)
+	{
+		if(max_sprites_ == 0)
+			max_sprites_ = 1;
+		projection_matrix_.SetIdentity();
+	}
+
+	SpriteBatch::~SpriteBatch()
+	{
+		CleanUp();
+	}
+
+	bool SpriteBatch::Init()
+	{
+		sprites_.reserve(max_sprites_);
+		sprite_order_.reserve(max_sprites_);
+
+		// the vertices are rewritten every flush, the buffer keeps its own copy to upload from
+		std::vector<SpriteBatchVertex> vertices(max_sprites_*4);
+		memset(&vertices[0], 0, vertices.size()*sizeof(SpriteBatchVertex));
+		vertex_buffer_ = VertexBuffer::Create(platform_);
+		if((vertex_buffer_ == NULL) || !vertex_buffer_->Init(platform_, &vertices[0], (UInt32)vertices.size(), sizeof(SpriteBatchVertex), false) || (vertex_buffer_->vertex_data() == NULL))
+			return false;
+		platform_.AddVertexBuffer(vertex_buffer_);
+
+		// every sprite is two triangles in the same winding as SpriteRenderer's quad
+		std::vector<UInt16> indices(max_sprites_*6);
+		for(UInt32 sprite_num = 0; sprite_num < max_sprites_; ++sprite_num)
+		{
+			const UInt16 first_vertex = (UInt16)(sprite_num*4);
+			UInt16* sprite_indices = &indices[sprite_num*6];
+			sprite_indices[0] = first_vertex;
+			sprite_indices[1] = first_vertex+1;
+			sprite_indices[2] = first_vertex+2;
+			sprite_indices[3] = first_vertex;
+			sprite_indices[4] = first_vertex+2;
+			sprite_indices[5] = first_vertex+3;
+		}
+		index_buffer_ = IndexBuffer::Create(platform_);
+		if((index_buffer_ == NULL) || !index_buffer_->Init(platform_, &indices[0], (UInt32)indices.size(), sizeof(UInt16)))
+			return false;
+		platform_.AddIndexBuffer(index_buffer_);
+
+		// without the shader SpriteBatch::Create returns NULL and the renderer draws sprites one at a time
+		shader_ = new BatchedSpriteShader(platform_);
+		if(!shader_->created())
+			return false;
+		platform_.AddShader(shader_);
+
+		return true;
+	}
+
+	void SpriteBatch::CleanUp()
+	{
+		if(shader_)
+		{
+			platform_.RemoveShader(shader_);
+			DeleteNull(shader_);
+		}
+
+		if(index_buffer_)
+		{
+			platform_.RemoveIndexBuffer(index_buffer_);
+			DeleteNull(index_buffer_);
+		}
+
+		if(vertex_buffer_)
+		{
+			platform_.RemoveVertexBuffer(vertex_buffer_);
+			DeleteNull(vertex_buffer_);
+		}
+
+		sprites_.clear();
+	}
+
+	void SpriteBatch::AddSprite(const Sprite& sprite)
+	{
+		if(sprites_.size() >= max_sprites_)
+			Flush();
+
+		sprites_.push_back(sprite);
+	}
+
+	void SpriteBatch::ResetStats()
+	{
+		num_sprites_drawn_ = 0;
+		num_draws_ = 0;
+		num_flushes_ = 0;
+	}
+
+	const Texture* SpriteBatch::SpriteTexture(const Sprite& sprite) const
+	{
+		return sprite.texture() ? sprite.texture() : default_texture_;
+	}
+
+	bool SpriteBatch::SortLess::operator()(const UInt32 a, const UInt32 b) const
+	{
+		const Sprite& sprite_a = batch_.sprites_[a];
+		const Sprite& sprite_b = batch_.sprites_[b];
+
+		// smaller z is nearer the camera
+		switch(batch_.sort_mode_)
+		{
+		case SSM_BACK_TO_FRONT:
+			if(sprite_a.position().z() != sprite_b.position().z())
+				return sprite_a.position().z() > sprite_b.position().z();
+			break;
+		case SSM_FRONT_TO_BACK:
+			if(sprite_a.position().z() != sprite_b.position().z())
+				return sprite_a.position().z() < sprite_b.position().z();
+			break;
+		default:
+			break;
+		}
+
+		return batch_.SpriteTexture(sprite_a) < batch_.SpriteTexture(sprite_b);
+	}
+
+	void SpriteBatch::BuildVertices(const Sprite& sprite, SpriteBatchVertex* vertices) const
+	{
+		// the same corners the sprite shader makes from the unit quad
+		const float half_width = sprite.width()*0.5f;
+		const float half_height = sprite.height()*0.5f;
+		float x_axis_x = half_width, x_axis_y = 0.0f;
+		float y_axis_x = 0.0f, y_axis_y = half_height;
+		if(sprite.rotation() != 0)
+		{
+			const float cos_rotation = cosf(sprite.rotation());
+			const float sin_rotation = sinf(sprite.rotation());
+			x_axis_x = cos_rotation*half_width;
+			x_axis_y = sin_rotation*half_width;
+			y_axis_x = -sin_rotation*half_height;
+			y_axis_y = cos_rotation*half_height;
+		}
+
+		const float x = sprite.position().x();
+		const float y = sprite.position().y();
+		const float z = sprite.position().z();
+		const float u0 = sprite.uv_position().x;
+		const float v0 = sprite.uv_position().y;
+		const float u1 = u0 + sprite.uv_width();
+		const float v1 = v0 + sprite.uv_height();
+
+		vertices[0].x = x - x_axis_x - y_axis_x;
+		vertices[0].y = y - x_axis_y - y_axis_y;
+		vertices[0].u = u0;
+		vertices[0].v = v0;
+
+		vertices[1].x = x + x_axis_x - y_axis_x;
+		vertices[1].y = y + x_axis_y - y_axis_y;
+		vertices[1].u = u1;
+		vertices[1].v = v0;
+
+		vertices[2].x = x + x_axis_x + y_axis_x;
+		vertices[2].y = y + x_axis_y + y_axis_y;
+		vertices[2].u = u1;
+		vertices[2].v = v1;
+
+		vertices[3].x = x - x_axis_x + y_axis_x;
+		vertices[3].y = y - x_axis_y + y_axis_y;
+		vertices[3].u = u0;
+		vertices[3].v = v1;
+
+		for(Int32 vertex_num = 0; vertex_num < 4; ++vertex_num)
+		{
+			vertices[vertex_num].z = z;
+			vertices[vertex_num].colour = sprite.colour();
+		}
+	}
+
+	void SpriteBatch::BeginDraws(const VertexBuffer* vertex_buffer)
+	{
+		vertex_buffer->Bind(platform_);
+		index_buffer_->Bind(platform_);
+
+		ShaderInterface* device_interface = shader_->device_interface();
+		device_interface->UseProgram();
+		shader_->SetSceneData(projection_matrix_);
+		device_interface->SetVertexFormat();
+	}
+
+	void SpriteBatch::DrawRun(const Texture* texture, const UInt32 first_sprite, const UInt32 num_sprites, const UInt32 base_vertex)
+	{
+		ShaderInterface* device_interface = shader_->device_interface();
+		shader_->SetTexture(texture);
+		device_interface->SetVariableData();
+		device_interface->BindTextureResources(platform_);
+
+		DrawTriangles(first_sprite*6, num_sprites*6, base_vertex);
+
+		device_interface->UnbindTextureResources(platform_);
+		++num_draws_;
+	}
+
+	void SpriteBatch::EndDraws(const VertexBuffer* vertex_buffer)
+	{
+		index_buffer_->Unbind(platform_);
+		vertex_buffer->Unbind(platform_);
+	}
+
+	void SpriteBatch::Flush()
+	{
+		if(sprites_.empty())
+			return;
+
+		const UInt32 num_sprites = (UInt32)sprites_.size();
+		sprite_order_.resize(num_sprites);
+		for(UInt32 sprite_num = 0; sprite_num < num_sprites; ++sprite_num)
+			sprite_order_[sprite_num] = sprite_num;
+
+		// stable so sprites that compare equal keep the order they were added in
+		if(sort_mode_ != SSM_DEFERRED)
+			std::stable_sort(sprite_order_.begin(), sprite_order_.end(), SortLess(*this));
+
+		SpriteBatchVertex* vertices = static_cast<SpriteBatchVertex*>(vertex_buffer_->vertex_data());
+		for(UInt32 sprite_num = 0; sprite_num < num_sprites; ++sprite_num)
+			BuildVertices(sprites_[sprite_order_[sprite_num]], &vertices[sprite_num*4]);
+
+		vertex_buffer_->Update(platform_);
+		BeginDraws(vertex_buffer_);
+
+		// one draw for each run of sprites with the same texture
+		UInt32 first_sprite = 0;
+		while(first_sprite < num_sprites)
+		{
+			const Texture* texture = SpriteTexture(sprites_[sprite_order_[first_sprite]]);
+			UInt32 end_sprite = first_sprite+1;
+			while((end_sprite < num_sprites) && (SpriteTexture(sprites_[sprite_order_[end_sprite]]) == texture))
+				++end_sprite;
+
+			DrawRun(texture, first_sprite, end_sprite-first_sprite);
+			first_sprite = end_sprite;
+		}
+
+		EndDraws(vertex_buffer_);
+
+		num_sprites_drawn_ += num_sprites;
+		++num_flushes_;
+		sprites_.clear();
+	}
+
+	SpriteBatchVertex* SpriteBatch::LockQuads(UInt32& num_quads)
+	{
+		Flush();
+
+		if(num_quads > max_sprites_)
+			num_quads = max_sprites_;
+		return static_cast<SpriteBatchVertex*>(vertex_buffer_->vertex_data());
+	}
+
+	void SpriteBatch::DrawLockedQuads(const Texture* texture, const UInt32 num_quads)
+	{
+		if(num_quads == 0)
+			return;
+
+		const UInt32 num_draw_quads = num_quads < max_sprites_ ? num_quads : max_sprites_;
+		vertex_buffer_->Update(platform_);
+		BeginDraws(vertex_buffer_);
+		DrawRun(texture ? texture : default_texture_, 0, num_draw_quads);
+		EndDraws(vertex_buffer_);
+
+		num_sprites_drawn_ += num_draw_quads;
+		++num_flushes_;
+	}
+
+	void SpriteBatch::DrawQuads(const VertexBuffer* vertex_buffer, const Texture* texture, const UInt32 num_quads)
+	{
+		Flush();
+
+		if((vertex_buffer == NULL) || (num_quads == 0))
+			return;
+
+		const UInt32 num_buffer_quads = vertex_buffer->num_vertices() / 4;
+		const UInt32 num_draw_quads = num_quads < num_buffer_quads ? num_quads : num_buffer_quads;
+
+		// the index buffer only covers max_sprites quads so longer buffers are drawn in runs that start further into the vertices
+		BeginDraws(vertex_buffer);
+		for(UInt32 first_quad = 0; first_quad < num_draw_quads; first_quad += max_sprites_)
+		{
+			const UInt32 num_run_quads = num_draw_quads - first_quad < max_sprites_ ? num_draw_quads - first_quad : max_sprites_;
+			DrawRun(texture ? texture : default_texture_, 0, num_run_quads, first_quad*4);
+		}
+		EndDraws(vertex_buffer);
+
+		num_sprites_drawn_ += num_draw_quads;
+	}
+}
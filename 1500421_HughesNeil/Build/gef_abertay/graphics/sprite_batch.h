@@ -0,0 +1,127 @@
+#ifndef _GEF_SPRITE_BATCH_H
+#define _GEF_SPRITE_BATCH_H
+
+#include <gef.h>
+#include <graphics/sprite.h>
+#include <graphics/batched_sprite_shader.h>
+#include <maths/matrix44.h>
+#include <vector>
+#include <cstddef>
+
+namespace gef
+{
+	class Platform;
+	class Texture;
+	class VertexBuffer;
+	class IndexBuffer;
+
+	// indices are 16 bit so a batch can't have more than 65536 / 4 sprites
+	const UInt32 kSpriteBatchMaxSprites = 16384;
+	const UInt32 kDefaultSpriteBatchSize = 1024;
+
+	// how sprites are ordered when a batch is flushed
+	// sprites next to each other in the order that use the same texture share a draw
+	enum SpriteSortMode
+	{
+		SSM_DEFERRED,		// the order they were added, always draws the same as drawing them one at a time
+		SSM_TEXTURE,		// grouped by texture, for sprites that don't overlap
+		SSM_BACK_TO_FRONT,	// furthest first then by texture, sprites at the same depth mustn't overlap
+		SSM_FRONT_TO_BACK	// nearest first then by texture, for opaque sprites so hidden pixels fail the depth test
+	};
+
+	struct SpriteBatchVertex
+	{
+		float x, y, z;
+		float u, v;
+		UInt32 colour;	// ABGR, the same as Sprite
+	};
+
+	// collects sprites into a dynamic vertex buffer and draws them in as few draws as the sort mode allows
+	// sorting and building the vertices is common code, each platform only has to issue the draws
+	// the render states are whatever the caller has set, SpriteRenderer uses this between its Begin and End
+	class SpriteBatch
+	{
+	public:
+		virtual ~SpriteBatch();
+
+		// the batch is flushed first if it is full
+		void AddSprite(const Sprite& sprite);
+
+		// draws every sprite added since the last flush
+		void Flush();
+
+		// for callers that build their own quads, such as particles
+		// draws the sprites already added then returns space for num_quads quads in the vertex buffer
+		// num_quads is clamped to max_sprites, DrawLockedQuads must be called before anything else is added
+		SpriteBatchVertex* LockQuads(UInt32& num_quads);
+		void DrawLockedQuads(const Texture* texture, const UInt32 num_quads);
+
+		// draws the sprites already added then quads from a vertex buffer the caller owns, such as static tile geometry
+		// the vertices must be SpriteBatchVertex in the same winding, every max_sprites quads take another draw
+		void DrawQuads(const VertexBuffer* vertex_buffer, const Texture* texture, const UInt32 num_quads);
+
+		void ResetStats();
+
+		inline void set_sort_mode(const SpriteSortMode sort_mode) { sort_mode_ = sort_mode; }
+		inline SpriteSortMode sort_mode() const { return sort_mode_; }
+		inline void set_projection_matrix(const Matrix44& projection_matrix) { projection_matrix_ = projection_matrix; }
+		inline const Matrix44& projection_matrix() const { return projection_matrix_; }
+
+		// used by sprites with no texture
+		inline void set_default_texture(const Texture* texture) { default_texture_ = texture; }
+
+		inline UInt32 max_sprites() const { return max_sprites_; }
+		inline UInt32 num_sprites() const { return (UInt32)sprites_.size(); }
+
+		// counts since the last call to ResetStats
+		inline UInt32 num_sprites_drawn() const { return num_sprites_drawn_; }
+		inline UInt32 num_draws() const { return num_draws_; }
+		inline UInt32 num_flushes() const { return num_flushes_; }
+
+		// returns NULL if the platform can't batch sprites or the batched sprite shader can't be created
+		static SpriteBatch* Create(Platform& platform, const UInt32 max_sprites = kDefaultSpriteBatchSize);
+
+	protected:
+		SpriteBatch(Platform& platform, const UInt32 max_sprites);
+		bool Init();
+		void CleanUp();
+
+		// draws num_indices indices from the bound index buffer as a triangle list
+		// base_vertex is added to each index
+		virtual void DrawTriangles(const UInt32 first_index, const UInt32 num_indices, const UInt32 base_vertex) = 0;
+
+		Platform& platform_;
+
+	private:
+		struct SortLess
+		{
+			SortLess(const SpriteBatch& batch) : batch_(batch) {}
+			bool operator()(const UInt32 a, const UInt32 b) const;
+			const SpriteBatch& batch_;
+		};
+
+		const Texture* SpriteTexture(const Sprite& sprite) const;
+		void BuildVertices(const Sprite& sprite, SpriteBatchVertex* vertices) const;
+		void BeginDraws(const VertexBuffer* vertex_buffer);
+		void DrawRun(const Texture* texture, const UInt32 first_sprite, const UInt32 num_sprites, const UInt32 base_vertex = 0);
+		void EndDraws(const VertexBuffer* vertex_buffer);
+
+		UInt32 max_sprites_;
+		SpriteSortMode sort_mode_;
+		Matrix44 projection_matrix_;
+		const Texture* default_texture_;
+
+		std::vector<Sprite> sprites_;
+		std::vector<UInt32> sprite_order_;
+
+		VertexBuffer* vertex_buffer_;
+		IndexBuffer* index_buffer_;
+		BatchedSpriteShader* shader_;
+
+		UInt32 num_sprites_drawn_;
+		UInt32 num_draws_;
+		UInt32 num_flushes_;
+	};
+}
+
+#endif // _GEF_SPRITE_BATCH_H
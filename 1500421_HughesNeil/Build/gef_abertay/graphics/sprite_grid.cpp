@@ -0,0 +1,249 @@
+#include <graphics/sprite_grid.h>
+#include <graphics/sprite_renderer.h>
+#include <algorithm>
+#include <math.h>
+
+namespace gef
+{
+	// keeps cell coordinates of far away or broken positions in range of an int
+	static const float kMaxCellCoord = 1.0e8f;
+
+	SpriteGrid::SpriteGrid(const float cell_size, const UInt32 num_buckets) :
+		cell_size_(cell_size > 0.0f ? cell_size : kDefaultSpriteGridCellSize),
+		num_sprites_(0),
+		query_stamp_(0)
+	{
+		inv_cell_size_ = 1.0f / cell_size_;
+
+		UInt32 bucket_count = 1;
+		while(bucket_count < num_buckets)
+			bucket_count <<= 1;
+		buckets_.resize(bucket_count);
+		bucket_mask_ = bucket_count-1;
+	}
+
+	Int32 SpriteGrid::CellCoord(const float position) const
+	{
+		float cell = floorf(position*inv_cell_size_);
+		if(cell < -kMaxCellCoord)
+			cell = -kMaxCellCoord;
+		else if(!(cell <= kMaxCellCoord))
+			cell = kMaxCellCoord;
+		return (Int32)cell;
+	}
+
+	UInt32 SpriteGrid::BucketIndex(const Int32 cell_x, const Int32 cell_y) const
+	{
+		return (((UInt32)cell_x*73856093u) ^ ((UInt32)cell_y*19349663u)) & bucket_mask_;
+	}
+
+	void SpriteGrid::CalculateBounds(const Sprite& sprite, Vector2& bounds_min, Vector2& bounds_max)
+	{
+		float half_width = fabsf(sprite.width())*0.5f;
+		float half_height = fabsf(sprite.height())*0.5f;
+		if(sprite.rotation() != 0)
+		{
+			const float cos_rotation = fabsf(cosf(sprite.rotation()));
+			const float sin_rotation = fabsf(sinf(sprite.rotation()));
+			const float rotated_half_width = cos_rotation*half_width + sin_rotation*half_height;
+			half_height = sin_rotation*half_width + cos_rotation*half_height;
+			half_width = rotated_half_width;
+		}
+
+		bounds_min = Vector2(sprite.position().x() - half_width, sprite.position().y() - half_height);
+		bounds_max = Vector2(sprite.position().x() + half_width, sprite.position().y() + half_height);
+	}
+
+	void SpriteGrid::SetBounds(GridSprite& grid_sprite)
+	{
+		CalculateBounds(grid_sprite.sprite, grid_sprite.bounds_min, grid_sprite.bounds_max);
+		grid_sprite.cell_min_x = CellCoord(grid_sprite.bounds_min.x);
+		grid_sprite.cell_min_y = CellCoord(grid_sprite.bounds_min.y);
+		grid_sprite.cell_max_x = CellCoord(grid_sprite.bounds_max.x);
+		grid_sprite.cell_max_y = CellCoord(grid_sprite.bounds_max.y);
+
+		const float num_cells = ((float)grid_sprite.cell_max_x - (float)grid_sprite.cell_min_x + 1.0f)*((float)grid_sprite.cell_max_y - (float)grid_sprite.cell_min_y + 1.0f);
+		grid_sprite.large = num_cells > (float)kSpriteGridMaxCellsPerSprite;
+	}
+
+	void SpriteGrid::Insert(const Int32 sprite_id)
+	{
+		const GridSprite& grid_sprite = sprites_[sprite_id];
+		if(grid_sprite.large)
+		{
+			large_sprites_.push_back(sprite_id);
+			return;
+		}
+
+		for(Int32 cell_y = grid_sprite.cell_min_y; cell_y <= grid_sprite.cell_max_y; ++cell_y)
+		{
+			for(Int32 cell_x = grid_sprite.cell_min_x; cell_x <= grid_sprite.cell_max_x; ++cell_x)
+				buckets_[BucketIndex(cell_x, cell_y)].push_back(sprite_id);
+		}
+	}
+
+	static void RemoveId(std::vector<Int32>& sprite_ids, const Int32 sprite_id)
+	{
+		std::vector<Int32>::iterator sprite_id_iter = std::find(sprite_ids.begin(), sprite_ids.end(), sprite_id);
+		if(sprite_id_iter != sprite_ids.end())
+		{
+			*sprite_id_iter = sprite_ids.back();
+			sprite_ids.pop_back();
+		}
+	}
+
+	void SpriteGrid::Remove(const Int32 sprite_id)
+	{
+		const GridSprite& grid_sprite = sprites_[sprite_id];
+		if(grid_sprite.large)
+		{
+			RemoveId(large_sprites_, sprite_id);
+			return;
+		}
+
+		// cells that share a bucket added the id to it more than once, so this removes it as many times
+		for(Int32 cell_y = grid_sprite.cell_min_y; cell_y <= grid_sprite.cell_max_y; ++cell_y)
+		{
+			for(Int32 cell_x = grid_sprite.cell_min_x; cell_x <= grid_sprite.cell_max_x; ++cell_x)
+				RemoveId(buckets_[BucketIndex(cell_x, cell_y)], sprite_id);
+		}
+	}
+
+	Int32 SpriteGrid::AddSprite(const Sprite& sprite)
+	{
+		Int32 sprite_id;
+		if(free_sprite_ids_.empty())
+		{
+			sprite_id = (Int32)sprites_.size();
+			sprites_.push_back(GridSprite());
+		}
+		else
+		{
+			sprite_id = free_sprite_ids_.back();
+			free_sprite_ids_.pop_back();
+		}
+
+		GridSprite& grid_sprite = sprites_[sprite_id];
+		grid_sprite.sprite = sprite;
+		grid_sprite.query_stamp = query_stamp_;
+		grid_sprite.active = true;
+		SetBounds(grid_sprite);
+		Insert(sprite_id);
+
+		++num_sprites_;
+		return sprite_id;
+	}
+
+	void SpriteGrid::UpdateSprite(const Int32 sprite_id, const Sprite& sprite)
+	{
+		if((sprite_id < 0) || (sprite_id >= (Int32)sprites_.size()) || !sprites_[sprite_id].active)
+			return;
+
+		GridSprite& grid_sprite = sprites_[sprite_id];
+		const Int32 cell_min_x = grid_sprite.cell_min_x, cell_min_y = grid_sprite.cell_min_y;
+		const Int32 cell_max_x = grid_sprite.cell_max_x, cell_max_y = grid_sprite.cell_max_y;
+
+		grid_sprite.sprite = sprite;
+		Vector2 bounds_min, bounds_max;
+		CalculateBounds(sprite, bounds_min, bounds_max);
+		if((CellCoord(bounds_min.x) == cell_min_x) && (CellCoord(bounds_min.y) == cell_min_y) && (CellCoord(bounds_max.x) == cell_max_x) && (CellCoord(bounds_max.y) == cell_max_y))
+		{
+			grid_sprite.bounds_min = bounds_min;
+			grid_sprite.bounds_max = bounds_max;
+			return;
+		}
+
+		// Remove uses the cells the sprite was inserted with, which SetBounds hasn't changed yet
+		Remove(sprite_id);
+		SetBounds(grid_sprite);
+		Insert(sprite_id);
+	}
+
+	void SpriteGrid::RemoveSprite(const Int32 sprite_id)
+	{
+		if((sprite_id < 0) || (sprite_id >= (Int32)sprites_.size()) || !sprites_[sprite_id].active)
+			return;
+
+		Remove(sprite_id);
+		sprites_[sprite_id].active = false;
+		free_sprite_ids_.push_back(sprite_id);
+		--num_sprites_;
+	}
+
+	void SpriteGrid::Clear()
+	{
+		for(std::vector< std::vector<Int32> >::iterator bucket = buckets_.begin(); bucket != buckets_.end(); ++bucket)
+			bucket->clear();
+		large_sprites_.clear();
+		sprites_.clear();
+		free_sprite_ids_.clear();
+		num_sprites_ = 0;
+	}
+
+	void SpriteGrid::TestSprite(const Int32 sprite_id, const Vector2& rect_min, const Vector2& rect_max, std::vector<Int32>& sprite_ids)
+	{
+		GridSprite& grid_sprite = sprites_[sprite_id];
+		if(grid_sprite.query_stamp == query_stamp_)
+			return;
+		grid_sprite.query_stamp = query_stamp_;
+
+		if((grid_sprite.bounds_max.x >= rect_min.x) && (grid_sprite.bounds_min.x <= rect_max.x) &&
+			(grid_sprite.bounds_max.y >= rect_min.y) && (grid_sprite.bounds_min.y <= rect_max.y))
+			sprite_ids.push_back(sprite_id);
+	}
+
+	void SpriteGrid::QueryRect(const Vector2& rect_min, const Vector2& rect_max, std::vector<Int32>& sprite_ids)
+	{
+		// the stamp marks sprites already tested by this query
+		if(++query_stamp_ == 0)
+		{
+			for(std::vector<GridSprite>::iterator grid_sprite = sprites_.begin(); grid_sprite != sprites_.end(); ++grid_sprite)
+				grid_sprite->query_stamp = 0;
+			query_stamp_ = 1;
+		}
+
+		const Int32 cell_min_x = CellCoord(rect_min.x);
+		const Int32 cell_min_y = CellCoord(rect_min.y);
+		const Int32 cell_max_x = CellCoord(rect_max.x);
+		const Int32 cell_max_y = CellCoord(rect_max.y);
+
+		const float num_cells = ((float)cell_max_x - (float)cell_min_x + 1.0f)*((float)cell_max_y - (float)cell_min_y + 1.0f);
+		if(num_cells > (float)buckets_.size())
+		{
+			// when zoomed out far enough it's quicker to look through every bucket once
+			for(std::vector< std::vector<Int32> >::const_iterator bucket = buckets_.begin(); bucket != buckets_.end(); ++bucket)
+			{
+				for(std::vector<Int32>::const_iterator sprite_id = bucket->begin(); sprite_id != bucket->end(); ++sprite_id)
+					TestSprite(*sprite_id, rect_min, rect_max, sprite_ids);
+			}
+		}
+		else
+		{
+			for(Int32 cell_y = cell_min_y; cell_y <= cell_max_y; ++cell_y)
+			{
+				for(Int32 cell_x = cell_min_x; cell_x <= cell_max_x; ++cell_x)
+				{
+					const std::vector<Int32>& bucket = buckets_[BucketIndex(cell_x, cell_y)];
+					for(std::vector<Int32>::const_iterator sprite_id = bucket.begin(); sprite_id != bucket.end(); ++sprite_id)
+						TestSprite(*sprite_id, rect_min, rect_max, sprite_ids);
+				}
+			}
+		}
+
+		for(std::vector<Int32>::const_iterator sprite_id = large_sprites_.begin(); sprite_id != large_sprites_.end(); ++sprite_id)
+			TestSprite(*sprite_id, rect_min, rect_max, sprite_ids);
+	}
+
+	UInt32 SpriteGrid::DrawVisible(SpriteRenderer* renderer, const Vector2& view_min, const Vector2& view_max)
+	{
+		visible_sprite_ids_.clear();
+		QueryRect(view_min, view_max, visible_sprite_ids_);
+
+		// buckets are in no useful order, ids at least keep sprites added together in the same order
+		std::sort(visible_sprite_ids_.begin(), visible_sprite_ids_.end());
+		for(std::vector<Int32>::const_iterator sprite_id = visible_sprite_ids_.begin(); sprite_id != visible_sprite_ids_.end(); ++sprite_id)
+			renderer->DrawSprite(sprites_[*sprite_id].sprite);
+
+		return (UInt32)visible_sprite_ids_.size();
+	}
+}
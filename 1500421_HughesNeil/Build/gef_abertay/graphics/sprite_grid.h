@@ -0,0 +1,90 @@
+#ifndef _GEF_SPRITE_GRID_H
+#define _GEF_SPRITE_GRID_H
+
+#include <gef.h>
+#include <graphics/sprite.h>
+#include <maths/vector2.h>
+#include <vector>
+
+namespace gef
+{
+	class SpriteRenderer;
+
+	const float kDefaultSpriteGridCellSize = 256.0f;
+	const UInt32 kDefaultSpriteGridBuckets = 4096;
+
+	// sprites covering more cells than this are kept in a list that every query checks
+	// rather than being added to lots of buckets
+	const UInt32 kSpriteGridMaxCellsPerSprite = 16;
+
+	// a spatial hash of world sprites so only the ones overlapping the view are drawn
+	// the world is split into square cells and each cell hashes to a bucket of sprite ids
+	// so the world has no fixed size, cells that hash to the same bucket only cost some extra bounds tests
+	// bounds are the axis aligned box around the sprite after its rotation
+	class SpriteGrid
+	{
+	public:
+		// num_buckets is rounded up to a power of two
+		SpriteGrid(const float cell_size = kDefaultSpriteGridCellSize, const UInt32 num_buckets = kDefaultSpriteGridBuckets);
+
+		// the grid keeps a copy of the sprite, returns its id
+		Int32 AddSprite(const Sprite& sprite);
+
+		// only touches the buckets if the sprite has moved into different cells
+		void UpdateSprite(const Int32 sprite_id, const Sprite& sprite);
+		void RemoveSprite(const Int32 sprite_id);
+		void Clear();
+
+		// appends the ids of the sprites whose bounds overlap the rectangle
+		// each sprite is only added once however many cells it covers
+		void QueryRect(const Vector2& rect_min, const Vector2& rect_max, std::vector<Int32>& sprite_ids);
+
+		// draws the sprites overlapping the view in id order and returns how many were drawn
+		// the sprites are drawn as they are stored, so the renderer's projection should be set to the view
+		UInt32 DrawVisible(SpriteRenderer* renderer, const Vector2& view_min, const Vector2& view_max);
+
+		inline const Sprite& sprite(const Int32 sprite_id) const { return sprites_[sprite_id].sprite; }
+		inline const Vector2& bounds_min(const Int32 sprite_id) const { return sprites_[sprite_id].bounds_min; }
+		inline const Vector2& bounds_max(const Int32 sprite_id) const { return sprites_[sprite_id].bounds_max; }
+		inline UInt32 num_sprites() const { return num_sprites_; }
+		inline float cell_size() const { return cell_size_; }
+
+		// the axis aligned box around a sprite after its rotation
+		static void CalculateBounds(const Sprite& sprite, Vector2& bounds_min, Vector2& bounds_max);
+
+	private:
+		struct GridSprite
+		{
+			Sprite sprite;
+			Vector2 bounds_min;
+			Vector2 bounds_max;
+			Int32 cell_min_x, cell_min_y;
+			Int32 cell_max_x, cell_max_y;
+			UInt32 query_stamp;
+			bool large;
+			bool active;
+		};
+
+		Int32 CellCoord(const float position) const;
+		UInt32 BucketIndex(const Int32 cell_x, const Int32 cell_y) const;
+		void SetBounds(GridSprite& grid_sprite);
+		void Insert(const Int32 sprite_id);
+		void Remove(const Int32 sprite_id);
+		void TestSprite(const Int32 sprite_id, const Vector2& rect_min, const Vector2& rect_max, std::vector<Int32>& sprite_ids);
+
+		float cell_size_;
+		float inv_cell_size_;
+		UInt32 bucket_mask_;
+		std::vector< std::vector<Int32> > buckets_;
+		std::vector<Int32> large_sprites_;
+
+		std::vector<GridSprite> sprites_;
+		std::vector<Int32> free_sprite_ids_;
+		UInt32 num_sprites_;
+
+		UInt32 query_stamp_;
+		std::vector<Int32> visible_sprite_ids_;
+	};
+}
+
+#endif // _GEF_SPRITE_GRID_H
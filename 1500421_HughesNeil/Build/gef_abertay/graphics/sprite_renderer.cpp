@@ -7,6 +7,7 @@
 #include <cstdlib>
 #include <math.h>
 #include <graphics/shader.h>
+#include <graphics/sprite_batch.h>
 
 namespace gef
 {
@@ -14,7 +15,8 @@ namespace gef
 SpriteRenderer::SpriteRenderer(Platform& platform) :
 platform_(platform),
 	shader_(NULL),
-	default_shader_(platform_)
+	default_shader_(platform_),
+	batch_(NULL)
 {
 	//SCE_DBG_ASSERT(platform_ != NULL);
 }
@@ -26,6 +28,10 @@ SpriteRenderer::~SpriteRenderer()
 
 void SpriteRenderer::SetShader( Shader* shader)
 {
+	// sprites already batched are drawn before another shader is bound
+	if(batch_)
+		batch_->Flush();
+
 	if(shader == NULL)
 		set_shader(&default_shader_);
 	else
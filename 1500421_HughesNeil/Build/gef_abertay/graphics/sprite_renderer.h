@@ -11,6 +11,7 @@ namespace gef
 	class Sprite;
 	class Platform;
 	class Shader;
+	class SpriteBatch;
 
 	class SpriteRenderer
 	{
@@ -25,6 +26,10 @@ namespace gef
 		inline const Matrix44& projection_matrix() const { return projection_matrix_; }
 		inline void set_projection_matrix(const  Matrix44& matrix) {projection_matrix_ = matrix;}
 
+		// sprites drawn with the default shader are batched when the platform supports it
+		// NULL if it doesn't, otherwise the batch's stats cover the last Begin
+		inline SpriteBatch* batch() { return batch_; }
+
 		static SpriteRenderer* Create(Platform& platform);
 	protected:
 		SpriteRenderer(Platform& platform);
@@ -37,6 +42,7 @@ namespace gef
 
 		Shader* shader_;
 		DefaultSpriteShader default_shader_;
+		SpriteBatch* batch_;
 	};
 }
 #endif // _GEF_SPRITE_RENDERER_H
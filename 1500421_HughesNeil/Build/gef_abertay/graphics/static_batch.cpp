@@ -0,0 +1,236 @@
+#include <graphics/static_batch.h>
+#include <graphics/mesh_data.h>
+#include <graphics/primitive.h>
+#include <graphics/renderer_3d.h>
+#include <maths/frustum.h>
+#include <maths/sphere.h>
+#include <algorithm>
+
+namespace gef
+{
+	StaticBatch::Batch::Batch() :
+		mesh(NULL),
+		material_name_id(0)
+	{
+	}
+
+	StaticBatch::StaticBatch() :
+		draw_call_count_(0)
+	{
+	}
+
+	StaticBatch::~StaticBatch()
+	{
+		Release();
+	}
+
+	void StaticBatch::Release()
+	{
+		for(std::vector<Batch>::iterator batch_iter = batches_.begin(); batch_iter != batches_.end(); ++batch_iter)
+			DeleteNull(batch_iter->mesh);
+		batches_.clear();
+		batch_data_.clear();
+		instance_visible_.clear();
+	}
+
+	Int32 StaticBatch::FindBatchForVertices(const gef::StringId material_name_id, const Int32 num_vertices)
+	{
+		// only the most recent batch for a material can have space left in it
+		for(Int32 batch_num = (Int32)batches_.size()-1; batch_num >= 0; --batch_num)
+		{
+			const Batch& batch = batches_[batch_num];
+			if((batch.material_name_id == material_name_id) && (batch.mesh == NULL))
+			{
+				if(batch_data_[batch_num].vertices.size() + num_vertices <= (size_t)kMaxBatchVertices)
+					return batch_num;
+				break;
+			}
+		}
+
+		batches_.push_back(Batch());
+		batches_.back().material_name_id = material_name_id;
+		batch_data_.resize(batches_.size());
+		return (Int32)batches_.size()-1;
+	}
+
+	Int32 StaticBatch::AddMesh(const MeshData& mesh_data, const Matrix44& transform)
+	{
+		// packed vertices are unpacked as they are transformed into world space
+		const MeshData* source = &mesh_data;
+		MeshData unpacked_mesh_data;
+		if(mesh_data.vertex_data.vertex_byte_size == sizeof(Mesh::PackedVertex))
+		{
+			unpacked_mesh_data = mesh_data;
+			unpacked_mesh_data.UnpackVertices();
+			source = &unpacked_mesh_data;
+		}
+
+		if((source->vertex_data.vertex_byte_size != sizeof(Mesh::Vertex)) || (source->vertex_data.vertices == NULL))
+			return -1;
+
+		const Int32 instance_index = (Int32)instance_visible_.size();
+		instance_visible_.push_back(1);
+
+		// normals are transformed by the inverse transpose so they stay perpendicular with non uniform scales
+		Matrix44 inverse_transform, normal_transform;
+		inverse_transform.Inverse(transform);
+		normal_transform.Transpose(inverse_transform);
+
+		const Mesh::Vertex* vertices = static_cast<const Mesh::Vertex*>(source->vertex_data.vertices);
+		std::vector<Int32> vertex_remap(source->vertex_data.num_vertices);
+		std::vector<Int32> primitive_vertices;
+
+		for(std::vector<PrimitiveData*>::const_iterator prim_iter = source->primitives.begin(); prim_iter != source->primitives.end(); ++prim_iter)
+		{
+			const PrimitiveData* primitive = *prim_iter;
+			if((primitive->type != TRIANGLE_LIST) || (primitive->num_indices < 3))
+				continue;
+
+			// only copy the vertices this primitive uses
+			std::fill(vertex_remap.begin(), vertex_remap.end(), -1);
+			primitive_vertices.clear();
+			for(Int32 index_num = 0; index_num < primitive->num_indices; ++index_num)
+			{
+				const UInt32 index = primitive->GetIndex(index_num);
+				if(vertex_remap[index] == -1)
+				{
+					vertex_remap[index] = (Int32)primitive_vertices.size();
+					primitive_vertices.push_back((Int32)index);
+				}
+			}
+
+			const Int32 batch_num = FindBatchForVertices(primitive->material_name_id, (Int32)primitive_vertices.size());
+			Batch& batch = batches_[batch_num];
+			BatchData& batch_data = batch_data_[batch_num];
+
+			InstanceRange range;
+			range.instance_index = instance_index;
+			range.start_index = (UInt32)batch_data.indices.size();
+			range.num_indices = (UInt32)(primitive->num_indices - primitive->num_indices%3);
+
+			const UInt32 base_vertex = (UInt32)batch_data.vertices.size();
+			for(std::vector<Int32>::const_iterator vertex_iter = primitive_vertices.begin(); vertex_iter != primitive_vertices.end(); ++vertex_iter)
+			{
+				const Mesh::Vertex& vertex = vertices[*vertex_iter];
+				const Vector4 position = Vector4(vertex.px, vertex.py, vertex.pz).Transform(transform);
+				Vector4 normal = Vector4(vertex.nx, vertex.ny, vertex.nz).TransformNoTranslation(normal_transform);
+				if(normal.LengthSqr() > 0.0f)
+					normal.Normalise();
+
+				Mesh::Vertex world_vertex = vertex;
+				world_vertex.px = position.x();
+				world_vertex.py = position.y();
+				world_vertex.pz = position.z();
+				world_vertex.nx = normal.x();
+				world_vertex.ny = normal.y();
+				world_vertex.nz = normal.z();
+				batch_data.vertices.push_back(world_vertex);
+
+				range.bounds.Update(position);
+			}
+
+			for(UInt32 index_num = 0; index_num < range.num_indices; ++index_num)
+				batch_data.indices.push_back(base_vertex + (UInt32)vertex_remap[primitive->GetIndex(index_num)]);
+
+			batch.bounds.Update(range.bounds.min_vtx());
+			batch.bounds.Update(range.bounds.max_vtx());
+			batch.ranges.push_back(range);
+		}
+
+		return instance_index;
+	}
+
+	bool StaticBatch::Build(Platform& platform, const StringIdMap<Material*>& materials)
+	{
+		bool success = true;
+
+		for(size_t batch_num = 0; batch_num < batches_.size(); ++batch_num)
+		{
+			Batch& batch = batches_[batch_num];
+			BatchData& batch_data = batch_data_[batch_num];
+			if(batch.mesh || batch_data.indices.empty())
+				continue;
+
+			batch.mesh = new Mesh(platform);
+			batch.mesh->set_aabb(batch.bounds);
+			batch.mesh->set_bounding_sphere(Sphere(batch.bounds));
+			success = batch.mesh->InitVertexBuffer(platform, &batch_data.vertices[0], (UInt32)batch_data.vertices.size(), sizeof(Mesh::Vertex)) && success;
+
+			batch.mesh->AllocatePrimitives(1);
+			Primitive* primitive = batch.mesh->GetPrimitive(0);
+			primitive->set_type(TRIANGLE_LIST);
+			success = primitive->InitCompactIndexBuffer(platform, &batch_data.indices[0], (UInt32)batch_data.indices.size(), sizeof(UInt32), (UInt32)batch_data.vertices.size()) && success;
+
+			StringIdMap<Material*>::const_iterator material_iter = materials.find(batch.material_name_id);
+			if(material_iter != materials.end())
+				primitive->set_material(material_iter->second);
+
+			batch.mesh_instance.set_mesh(batch.mesh);
+
+			// the cpu copies aren't needed once the buffers are created
+			std::vector<Mesh::Vertex>().swap(batch_data.vertices);
+			std::vector<UInt32>().swap(batch_data.indices);
+		}
+
+		return success;
+	}
+
+	void StaticBatch::set_instance_visible(const Int32 instance_index, const bool visible)
+	{
+		if((instance_index >= 0) && (instance_index < (Int32)instance_visible_.size()))
+			instance_visible_[instance_index] = visible ? 1 : 0;
+	}
+
+	void StaticBatch::Draw(Renderer3D& renderer, const Frustum* frustum)
+	{
+		draw_call_count_ = 0;
+
+		for(std::vector<Batch>::const_iterator batch_iter = batches_.begin(); batch_iter != batches_.end(); ++batch_iter)
+		{
+			const Batch& batch = *batch_iter;
+			if(batch.mesh == NULL)
+				continue;
+
+			const FrustumIntersect batch_intersect = frustum ? frustum->Intersects(batch.bounds) : FI_IN;
+			if(batch_intersect == FI_OUT)
+				continue;
+
+			// ranges are in index order so visible neighbours can be drawn together
+			Int32 run_start = -1;
+			UInt32 run_end = 0;
+			for(std::vector<InstanceRange>::const_iterator range_iter = batch.ranges.begin(); range_iter != batch.ranges.end(); ++range_iter)
+			{
+				const InstanceRange& range = *range_iter;
+
+				bool visible = instance_visible_[range.instance_index] != 0;
+				if(visible && (batch_intersect == FI_INTERSECTS))
+					visible = frustum->Intersects(range.bounds) != FI_OUT;
+
+				if(visible && (run_start != -1) && (range.start_index == run_end))
+				{
+					run_end += range.num_indices;
+					continue;
+				}
+
+				if(run_start != -1)
+				{
+					renderer.DrawPrimitive(batch.mesh_instance, 0, run_end - run_start, run_start);
+					++draw_call_count_;
+					run_start = -1;
+				}
+
+				if(visible)
+				{
+					run_start = (Int32)range.start_index;
+					run_end = range.start_index + range.num_indices;
+				}
+			}
+
+			if(run_start != -1)
+			{
+				renderer.DrawPrimitive(batch.mesh_instance, 0, run_end - run_start, run_start);
+				++draw_call_count_;
+			}
+		}
+	}
+}
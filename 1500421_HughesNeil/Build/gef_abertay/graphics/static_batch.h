@@ -0,0 +1,98 @@
+#ifndef _GEF_STATIC_BATCH_H
+#define _GEF_STATIC_BATCH_H
+
+#include <gef.h>
+#include <graphics/mesh.h>
+#include <graphics/mesh_instance.h>
+#include <maths/aabb.h>
+#include <maths/matrix44.h>
+#include <system/string_id.h>
+#include <system/string_id_map.h>
+#include <vector>
+
+namespace gef
+{
+	class Platform;
+	class Material;
+	class Renderer3D;
+	class Frustum;
+	struct MeshData;
+
+	// merges static meshes that share a material into combined vertex and index buffers
+	// vertices are transformed into world space when they are added so each batch is drawn with an identity transform
+	// every mesh added keeps its own range of indices and world space bounds so it can still be culled on its own
+	// only triangle list primitives of unskinned meshes are batched
+	class StaticBatch
+	{
+	public:
+		// the indices in a batch that came from one primitive of an added mesh
+		struct InstanceRange
+		{
+			Int32 instance_index;
+			UInt32 start_index;
+			UInt32 num_indices;
+			Aabb bounds;
+		};
+
+		struct Batch
+		{
+			Batch();
+
+			Mesh* mesh;
+			MeshInstance mesh_instance;
+			gef::StringId material_name_id;
+			Aabb bounds;
+			std::vector<InstanceRange> ranges;
+		};
+
+		StaticBatch();
+		~StaticBatch();
+
+		// adds a mesh in world space
+		// returns the instance index to use with set_instance_visible, or -1 if the mesh can't be batched
+		Int32 AddMesh(const MeshData& mesh_data, const Matrix44& transform);
+
+		// creates the vertex and index buffers for everything added so far
+		// materials are looked up by the material name ids of the added primitives
+		bool Build(Platform& platform, const StringIdMap<Material*>& materials);
+
+		// draws each batch with as few draw calls as possible
+		// when frustum isn't NULL batches and then the instances in them are culled against it
+		// consecutive visible instances in a batch are drawn with a single call
+		void Draw(Renderer3D& renderer, const Frustum* frustum = NULL);
+
+		void Release();
+
+		// hidden instances are skipped when drawing
+		void set_instance_visible(const Int32 instance_index, const bool visible);
+		inline bool instance_visible(const Int32 instance_index) const { return instance_visible_[instance_index] != 0; }
+
+		inline Int32 num_instances() const { return (Int32)instance_visible_.size(); }
+		inline const std::vector<Batch>& batches() const { return batches_; }
+
+		// number of draw calls made by the last call to Draw
+		inline Int32 draw_call_count() const { return draw_call_count_; }
+
+	private:
+		// a batch is limited to this many vertices so it can use 16 bit indices
+		// unless a single primitive needs more
+		static const Int32 kMaxBatchVertices = 0x10000;
+
+		struct BatchData
+		{
+			std::vector<Mesh::Vertex> vertices;
+			std::vector<UInt32> indices;
+		};
+
+		Int32 FindBatchForVertices(const gef::StringId material_name_id, const Int32 num_vertices);
+
+		std::vector<Batch> batches_;
+
+		// vertex and index data for each batch until it is built
+		std::vector<BatchData> batch_data_;
+		std::vector<UInt8> instance_visible_;
+		Int32 draw_call_count_;
+	};
+}
+
+#endif // _GEF_STATIC_BATCH_H
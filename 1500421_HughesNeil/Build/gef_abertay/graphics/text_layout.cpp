@@ -0,0 +1,234 @@
+#include <graphics/text_layout.h>
+#include <graphics/sprite_renderer.h>
+#include <maths/vector4.h>
+#include <cstdarg>
+#include <cstdio>
+
+namespace gef
+{
+	TextLayout::TextLayout(const Font* font, const float scale, const TextJustification justification, const float max_width) :
+		font_(font),
+		scale_(scale),
+		justification_(justification),
+		max_width_(max_width),
+		bounds_min_(0.0f, 0.0f),
+		bounds_max_(0.0f, 0.0f),
+		num_lines_(0)
+	{
+	}
+
+	bool TextLayout::SetText(const char* text)
+	{
+		if(text == NULL)
+			text = "";
+
+		if(text_ == text)
+			return false;
+
+		text_ = text;
+		Layout();
+		return true;
+	}
+
+	bool TextLayout::SetTextf(const char* format, ...)
+	{
+		// most strings fit without allocating
+		char text_buffer[256];
+
+		va_list args;
+		va_start(args, format);
+		const Int32 length = vsnprintf(text_buffer, sizeof(text_buffer), format, args);
+		va_end(args);
+
+		if(length < 0)
+			return false;
+
+		if(length < (Int32)sizeof(text_buffer))
+			return SetText(text_buffer);
+
+		std::vector<char> long_text_buffer(length+1);
+		va_start(args, format);
+		vsnprintf(&long_text_buffer[0], long_text_buffer.size(), format, args);
+		va_end(args);
+
+		return SetText(&long_text_buffer[0]);
+	}
+
+	void TextLayout::set_font(const Font* font)
+	{
+		if(font != font_)
+		{
+			font_ = font;
+			Layout();
+		}
+	}
+
+	void TextLayout::set_scale(const float scale)
+	{
+		if(scale != scale_)
+		{
+			scale_ = scale;
+			Layout();
+		}
+	}
+
+	void TextLayout::set_justification(const TextJustification justification)
+	{
+		if(justification != justification_)
+		{
+			justification_ = justification;
+			Layout();
+		}
+	}
+
+	void TextLayout::set_max_width(const float max_width)
+	{
+		if(max_width != max_width_)
+		{
+			max_width_ = max_width;
+			Layout();
+		}
+	}
+
+	const char* TextLayout::FindLineEnd(const char* text, const char*& next_line, float& line_width) const
+	{
+		// the line so far up to the last space, in font units
+		const char* break_end = NULL;
+		const char* break_next_line = NULL;
+		float break_width = 0.0f;
+
+		float width = 0.0f;
+		UInt32 previous_character = 0;
+		const char* character_text = text;
+		while(*character_text)
+		{
+			const char* character_start = character_text;
+			const UInt32 character = ReadUTF8Character(character_text);
+			if(character == '\n')
+			{
+				next_line = character_text;
+				line_width = width;
+				return character_start;
+			}
+
+			if(character == ' ')
+			{
+				break_end = character_start;
+				break_next_line = character_text;
+				break_width = width;
+			}
+
+			const FontGlyph* glyph = font_->GetGlyph(character);
+			const float advance = (float)(font_->GetKerning(previous_character, character) + (glyph ? glyph->x_advance : 0));
+
+			// every line gets at least one character even if it is too wide
+			if((max_width_ > 0.0f) && (character != ' ') && (character_start != text) && ((width + advance)*scale_ > max_width_))
+			{
+				if(break_end)
+				{
+					next_line = break_next_line;
+					line_width = break_width;
+					return break_end;
+				}
+
+				next_line = character_start;
+				line_width = width;
+				return character_start;
+			}
+
+			width += advance;
+			previous_character = character;
+		}
+
+		next_line = character_text;
+		line_width = width;
+		return character_text;
+	}
+
+	void TextLayout::Layout()
+	{
+		glyph_sprites_.clear();
+		bounds_min_ = Vector2(0.0f, 0.0f);
+		bounds_max_ = Vector2(0.0f, 0.0f);
+		num_lines_ = 0;
+
+		if((font_ == NULL) || (font_->num_glyphs() == 0) || text_.empty())
+			return;
+
+		const float texture_width = (float)font_->texture_width();
+		const float texture_height = (float)font_->texture_height();
+		const float line_height = (float)font_->line_height()*scale_;
+
+		Sprite sprite;
+		sprite.set_texture(font_->font_texture());
+
+		const char* line = text_.c_str();
+		while(*line)
+		{
+			const char* next_line;
+			float line_width;
+			const char* line_end = FindLineEnd(line, next_line, line_width);
+			line_width *= scale_;
+
+			Vector2 cursor(0.0f, line_height*(float)num_lines_);
+			switch(justification_)
+			{
+			case TJ_CENTRE:
+				cursor.x -= line_width*0.5f;
+				break;
+			case TJ_RIGHT:
+				cursor.x -= line_width;
+				break;
+			default:
+				break;
+			}
+
+			if((num_lines_ == 0) || (cursor.x < bounds_min_.x))
+				bounds_min_.x = cursor.x;
+			if((num_lines_ == 0) || (cursor.x + line_width > bounds_max_.x))
+				bounds_max_.x = cursor.x + line_width;
+
+			// the same placement as Font::RenderText
+			UInt32 previous_character = 0;
+			for(const char* character_text = line; character_text < line_end; )
+			{
+				const UInt32 character = ReadUTF8Character(character_text);
+				cursor.x += ((float)font_->GetKerning(previous_character, character))*scale_;
+				previous_character = character;
+
+				const FontGlyph* glyph = font_->GetGlyph(character);
+				if(glyph == NULL)
+					continue;
+
+				const float width = ((float)glyph->width)*scale_;
+				const float height = ((float)glyph->height)*scale_;
+				sprite.set_position(Vector4(cursor.x + ((float)glyph->x_offset)*scale_ + width*0.5f, cursor.y + scale_*((float)glyph->height*0.5f + (float)glyph->y_offset), 0.0f));
+				sprite.set_width(width);
+				sprite.set_height(height);
+				sprite.set_uv_position(Vector2((float)glyph->x / texture_width, (float)glyph->y / texture_height));
+				sprite.set_uv_width((float)glyph->width / texture_width);
+				sprite.set_uv_height((float)glyph->height / texture_height);
+				glyph_sprites_.push_back(sprite);
+
+				cursor.x += ((float)glyph->x_advance)*scale_;
+			}
+
+			++num_lines_;
+			line = next_line;
+		}
+
+		bounds_max_.y = line_height*(float)num_lines_;
+	}
+
+	void TextLayout::Render(SpriteRenderer* renderer, const Vector4& position, const UInt32 colour) const
+	{
+		Sprite sprite;
+		for(std::vector<Sprite>::const_iterator sprite_iter = glyph_sprites_.begin(); sprite_iter != glyph_sprites_.end(); ++sprite_iter)
+		{
+			sprite = *sprite_iter;
+			sprite.set_position(Vector4(position.x() + sprite.position().x(), position.y() + sprite.position().y(), position.z()));
+			sprite.set_colour(colour);
+			renderer->DrawSprite(sprite);
+		}
+	}
+}
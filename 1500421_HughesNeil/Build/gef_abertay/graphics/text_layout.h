@@ -0,0 +1,69 @@
+#ifndef _GEF_TEXT_LAYOUT_H
+#define _GEF_TEXT_LAYOUT_H
+
+#include <gef.h>
+#include <graphics/font.h>
+#include <graphics/sprite.h>
+#include <maths/vector2.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace gef
+{
+	class SpriteRenderer;
+	class Vector4;
+
+	// a string laid out once as a sprite for each glyph so it can be drawn every frame
+	// without measuring it or looking up its glyphs again
+	// the layout is only rebuilt when the text or one of the settings changes
+	// lines break at newlines and, when max_width is greater than zero, at the last space
+	// before a line would be wider than max_width
+	class TextLayout
+	{
+	public:
+		TextLayout(const Font* font = NULL, const float scale = 1.0f, const TextJustification justification = TJ_LEFT, const float max_width = 0.0f);
+
+		// returns true if the text was different and the layout was rebuilt
+		bool SetText(const char* text);
+		bool SetTextf(const char* format, ...);
+
+		// position is where RenderText would put the first line
+		void Render(SpriteRenderer* renderer, const Vector4& position, const UInt32 colour) const;
+
+		void set_font(const Font* font);
+		void set_scale(const float scale);
+		void set_justification(const TextJustification justification);
+		void set_max_width(const float max_width);
+
+		inline const Font* font() const { return font_; }
+		inline float scale() const { return scale_; }
+		inline TextJustification justification() const { return justification_; }
+		inline float max_width() const { return max_width_; }
+		inline const std::string& text() const { return text_; }
+
+		// extents of the laid out lines relative to the position passed to Render
+		inline const Vector2& bounds_min() const { return bounds_min_; }
+		inline const Vector2& bounds_max() const { return bounds_max_; }
+		inline Int32 num_lines() const { return num_lines_; }
+		inline Int32 num_glyphs() const { return (Int32)glyph_sprites_.size(); }
+
+	private:
+		void Layout();
+		const char* FindLineEnd(const char* text, const char*& next_line, float& line_width) const;
+
+		const Font* font_;
+		float scale_;
+		TextJustification justification_;
+		float max_width_;
+		std::string text_;
+
+		// positioned relative to the origin of the text
+		std::vector<Sprite> glyph_sprites_;
+		Vector2 bounds_min_;
+		Vector2 bounds_max_;
+		Int32 num_lines_;
+	};
+}
+
+#endif // _GEF_TEXT_LAYOUT_H
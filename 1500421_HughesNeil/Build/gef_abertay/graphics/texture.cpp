@@ -1,17 +1,72 @@
 #include <graphics/texture.h>
 #include <graphics/image_data.h>
+#include <graphics/image_resize.h>
+#include <graphics/mip_generator.h>
 #include <system/platform.h>
+#include <system/debug_log.h>
+#include <cstdlib>
+#include <cstring>
 
 namespace gef
 {
-	Texture::Texture()
+	Texture::Texture() :
+		width_(0),
+		height_(0),
+		data_size_(0),
+		wasted_bytes_(0)
 	{
 	}
 
-	Texture::Texture(const class Platform& platform, const ImageData& image_data)
+	Texture::Texture(const class Platform& platform, const ImageData& image_data) :
+		width_(image_data.width()),
+		height_(image_data.height()),
+		data_size_(image_data.GetDataSize()),
+		wasted_bytes_(0)
 	{
 	}
 
+	const ImageData& Texture::FitImageToPlatform(const Platform& platform, const ImageData& image_data, ImageData& fitted_image_data)
+	{
+		const NonPowerOfTwoSupport npot_support = platform.non_power_of_two_support();
+		if((npot_support == NPOT_FULL) || (image_data.image() == NULL))
+			return image_data;
+
+		const bool power_of_two = ImageData::IsPowerOfTwo(image_data.width()) && ImageData::IsPowerOfTwo(image_data.height());
+		if(power_of_two || ((npot_support == NPOT_NO_MIPS) && (image_data.num_mips() <= 1)))
+			return image_data;
+
+		if(npot_support == NPOT_NO_MIPS)
+		{
+			// dropping the mips uses less memory than resizing
+			UInt8* top_level = static_cast<UInt8*>(malloc(image_data.GetMipDataSize(0)));
+			memcpy(top_level, image_data.image(), image_data.GetMipDataSize(0));
+			fitted_image_data.set_image(top_level);
+			fitted_image_data.set_width(image_data.width());
+			fitted_image_data.set_height(image_data.height());
+			fitted_image_data.set_format(image_data.format());
+			fitted_image_data.set_num_mips(1);
+		}
+		else
+		{
+			const UInt32 width = ImageData::NextPowerOfTwo(image_data.width());
+			const UInt32 height = ImageData::NextPowerOfTwo(image_data.height());
+			// block compressed images can't be resized and are used as they are
+			if(!ResizeImage(image_data, fitted_image_data, width, height))
+				return image_data;
+
+			if(image_data.num_mips() > 1)
+				GenerateMips(fitted_image_data);
+
+			wasted_bytes_ = fitted_image_data.GetDataSize() - image_data.GetDataSize();
+			DebugOut("Texture: %dx%d resized to %dx%d, %d bytes wasted\n", image_data.width(), image_data.height(), width, height, wasted_bytes_);
+		}
+
+		width_ = fitted_image_data.width();
+		height_ = fitted_image_data.height();
+		data_size_ = fitted_image_data.GetDataSize();
+		return fitted_image_data;
+	}
+
 	Texture::~Texture()
 	{
 	}
@@ -18,10 +18,29 @@ public:
 	static Texture* Create(const Platform& platform, const ImageData& image_data);
 	static Texture* CreateCheckerTexture(const Int32 size, const Int32 num_checkers, const Platform& platform);
 
+	// size of the texture after any resizing for the platform
+	inline UInt32 width() const { return width_; }
+	inline UInt32 height() const { return height_; }
+
+	// bytes of texture memory used by every mip level
+	inline UInt32 data_size() const { return data_size_; }
+
+	// bytes of data_size spent on padding or resizing the image for the platform
+	inline UInt32 wasted_bytes() const { return wasted_bytes_; }
+
 protected:
 	Texture();
 	Texture(const Platform& platform, const ImageData& image_data);
 
+	// returns image_data if the platform can use it at its own size
+	// otherwise fitted_image_data is set to a copy of it without mips or resized up to powers of two
+	// and returned instead
+	const ImageData& FitImageToPlatform(const Platform& platform, const ImageData& image_data, ImageData& fitted_image_data);
+
+	UInt32 width_;
+	UInt32 height_;
+	UInt32 data_size_;
+	UInt32 wasted_bytes_;
 };
 
 }
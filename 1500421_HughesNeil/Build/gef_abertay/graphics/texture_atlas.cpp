@@ -0,0 +1,418 @@
+#include <graphics/texture_atlas.h>
+#include <graphics/image_data.h>
+#include <graphics/sprite.h>
+#include <graphics/texture.h>
+#include <assets/cooked_texture_loader.h>
+#include <system/file.h>
+#include <system/memory_stream_buffer.h>
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <cstdlib>
+#include <cstring>
+
+namespace gef
+{
+	// pages are trimmed to multiples of these so Vita linear textures don't need padding
+	static const UInt32 kPageWidthAlignment = 8;
+	static const UInt32 kPageHeightAlignment = 4;
+
+	// tallest images first, then widest
+	struct AtlasImageOrder
+	{
+		AtlasImageOrder(const std::vector<AtlasRegion>& regions) : regions_(regions) {}
+
+		bool operator()(const Int32 lhs, const Int32 rhs) const
+		{
+			if(regions_[lhs].height != regions_[rhs].height)
+				return regions_[lhs].height > regions_[rhs].height;
+			if(regions_[lhs].width != regions_[rhs].width)
+				return regions_[lhs].width > regions_[rhs].width;
+			return lhs < rhs;
+		}
+
+		const std::vector<AtlasRegion>& regions_;
+	};
+
+	TextureAtlas::TextureAtlas(const UInt32 max_page_size, const UInt32 padding) :
+		max_page_size_(max_page_size),
+		padding_(padding)
+	{
+	}
+
+	TextureAtlas::~TextureAtlas()
+	{
+		Release();
+	}
+
+	void TextureAtlas::Release()
+	{
+		for(std::vector<Texture*>::iterator texture_iter = page_textures_.begin(); texture_iter != page_textures_.end(); ++texture_iter)
+			DeleteNull(*texture_iter);
+		page_textures_.clear();
+		for(std::vector<ImageData*>::iterator image_iter = page_images_.begin(); image_iter != page_images_.end(); ++image_iter)
+			DeleteNull(*image_iter);
+		page_images_.clear();
+		images_.clear();
+		regions_.clear();
+		region_lookup_.clear();
+	}
+
+	Int32 TextureAtlas::AddImage(const StringId name_id, const ImageData& image_data)
+	{
+		if((image_data.image() == NULL) || (image_data.format() != IF_RGBA8) || (image_data.width() == 0) || (image_data.height() == 0))
+			return -1;
+		if((image_data.width() + padding_*2 > max_page_size_) || (image_data.height() + padding_*2 > max_page_size_))
+			return -1;
+		if(FindRegion(name_id) != -1)
+			return -1;
+
+		images_.push_back(SourceImage());
+		SourceImage& image = images_.back();
+		image.width = image_data.width();
+		image.height = image_data.height();
+		image.pixels.assign(image_data.image(), image_data.image() + image_data.GetMipDataSize(0));
+
+		AtlasRegion region;
+		region.name_id = name_id;
+		region.page = -1;
+		region.x = 0;
+		region.y = 0;
+		region.width = image.width;
+		region.height = image.height;
+		region.uv_position = Vector2(0.0f, 0.0f);
+		region.uv_width = 0.0f;
+		region.uv_height = 0.0f;
+		regions_.push_back(region);
+
+		const Int32 region_index = (Int32)regions_.size()-1;
+		region_lookup_[name_id] = region_index;
+		return region_index;
+	}
+
+	bool TextureAtlas::FindPosition(const Page& page, const UInt32 width, const UInt32 height, Int32& node_index, UInt32& x, UInt32& y) const
+	{
+		// bottom left, the position that leaves the top of the image lowest
+		UInt32 best_top = max_page_size_+1;
+		node_index = -1;
+		for(size_t node_num = 0; node_num < page.skyline.size(); ++node_num)
+		{
+			const UInt32 node_x = page.skyline[node_num].x;
+			if(node_x + width > max_page_size_)
+				break;
+
+			// the image rests on the highest node it spans
+			UInt32 node_y = 0;
+			UInt32 width_left = width;
+			for(size_t span_num = node_num; width_left > 0; ++span_num)
+			{
+				const SkylineNode& node = page.skyline[span_num];
+				node_y = node.y > node_y ? node.y : node_y;
+				width_left = node.width >= width_left ? 0 : width_left - node.width;
+			}
+
+			if((node_y + height <= max_page_size_) && (node_y + height < best_top))
+			{
+				best_top = node_y + height;
+				node_index = (Int32)node_num;
+				x = node_x;
+				y = node_y;
+			}
+		}
+		return node_index != -1;
+	}
+
+	void TextureAtlas::AddSkylineNode(Page& page, const Int32 node_index, const UInt32 x, const UInt32 y, const UInt32 width, const UInt32 height)
+	{
+		SkylineNode new_node;
+		new_node.x = x;
+		new_node.y = y + height;
+		new_node.width = width;
+		page.skyline.insert(page.skyline.begin() + node_index, new_node);
+
+		// the nodes under the new one are cut back or removed
+		for(size_t node_num = node_index+1; node_num < page.skyline.size(); )
+		{
+			SkylineNode& node = page.skyline[node_num];
+			const UInt32 new_node_end = x + width;
+			if(node.x >= new_node_end)
+				break;
+
+			const UInt32 overlap = new_node_end - node.x;
+			if(node.width <= overlap)
+				page.skyline.erase(page.skyline.begin() + node_num);
+			else
+			{
+				node.x += overlap;
+				node.width -= overlap;
+				break;
+			}
+		}
+
+		// neighbours at the same height are merged
+		for(size_t node_num = 0; node_num+1 < page.skyline.size(); )
+		{
+			if(page.skyline[node_num].y == page.skyline[node_num+1].y)
+			{
+				page.skyline[node_num].width += page.skyline[node_num+1].width;
+				page.skyline.erase(page.skyline.begin() + node_num+1);
+			}
+			else
+				++node_num;
+		}
+
+		page.used_width = x + width > page.used_width ? x + width : page.used_width;
+		page.used_height = y + height > page.used_height ? y + height : page.used_height;
+	}
+
+	void TextureAtlas::CopyImageToPage(const SourceImage& image, const AtlasRegion& region, ImageData& page_image) const
+	{
+		const UInt32 page_width = page_image.width();
+		const UInt32 row_size = image.width*4;
+
+		// padding rows repeat the top and bottom rows, padding columns repeat the first and last pixels
+		for(UInt32 row = 0; row < image.height + padding_*2; ++row)
+		{
+			const UInt32 source_row = row < padding_ ? 0 : (row - padding_ >= image.height ? image.height-1 : row - padding_);
+			const UInt8* source = &image.pixels[source_row*row_size];
+			UInt8* dest = page_image.image() + ((region.y - padding_ + row)*page_width + region.x - padding_)*4;
+
+			for(UInt32 column = 0; column < padding_; ++column)
+				memcpy(dest + column*4, source, 4);
+			memcpy(dest + padding_*4, source, row_size);
+			for(UInt32 column = 0; column < padding_; ++column)
+				memcpy(dest + padding_*4 + row_size + column*4, source + row_size - 4, 4);
+		}
+	}
+
+	bool TextureAtlas::Build()
+	{
+		if(images_.size() != regions_.size())
+			return false;
+
+		for(std::vector<Texture*>::iterator texture_iter = page_textures_.begin(); texture_iter != page_textures_.end(); ++texture_iter)
+			DeleteNull(*texture_iter);
+		page_textures_.clear();
+		for(std::vector<ImageData*>::iterator image_iter = page_images_.begin(); image_iter != page_images_.end(); ++image_iter)
+			DeleteNull(*image_iter);
+		page_images_.clear();
+
+		std::vector<Int32> order(regions_.size());
+		for(size_t region_num = 0; region_num < regions_.size(); ++region_num)
+			order[region_num] = (Int32)region_num;
+		std::sort(order.begin(), order.end(), AtlasImageOrder(regions_));
+
+		std::vector<Page> pages;
+		for(std::vector<Int32>::const_iterator order_iter = order.begin(); order_iter != order.end(); ++order_iter)
+		{
+			AtlasRegion& region = regions_[*order_iter];
+			const UInt32 padded_width = region.width + padding_*2;
+			const UInt32 padded_height = region.height + padding_*2;
+
+			Int32 node_index = -1;
+			UInt32 x = 0, y = 0;
+			size_t page_num = 0;
+			for(; page_num < pages.size(); ++page_num)
+			{
+				if(FindPosition(pages[page_num], padded_width, padded_height, node_index, x, y))
+					break;
+			}
+
+			if(page_num == pages.size())
+			{
+				pages.push_back(Page());
+				SkylineNode node;
+				node.x = 0;
+				node.y = 0;
+				node.width = max_page_size_;
+				pages.back().skyline.push_back(node);
+				pages.back().used_width = 0;
+				pages.back().used_height = 0;
+				if(!FindPosition(pages.back(), padded_width, padded_height, node_index, x, y))
+					return false;
+			}
+
+			AddSkylineNode(pages[page_num], node_index, x, y, padded_width, padded_height);
+			region.page = (Int32)page_num;
+			region.x = x + padding_;
+			region.y = y + padding_;
+		}
+
+		for(std::vector<Page>::const_iterator page_iter = pages.begin(); page_iter != pages.end(); ++page_iter)
+		{
+			UInt32 width = (page_iter->used_width + kPageWidthAlignment-1) & ~(kPageWidthAlignment-1);
+			UInt32 height = (page_iter->used_height + kPageHeightAlignment-1) & ~(kPageHeightAlignment-1);
+			width = width < max_page_size_ ? width : max_page_size_;
+			height = height < max_page_size_ ? height : max_page_size_;
+
+			ImageData* page_image = new ImageData();
+			page_image->set_width(width);
+			page_image->set_height(height);
+			page_image->set_image(static_cast<UInt8*>(calloc(page_image->GetDataSize(), 1)));
+			page_images_.push_back(page_image);
+			if(page_image->image() == NULL)
+				return false;
+		}
+
+		for(size_t region_num = 0; region_num < regions_.size(); ++region_num)
+		{
+			AtlasRegion& region = regions_[region_num];
+			ImageData& page_image = *page_images_[region.page];
+			CopyImageToPage(images_[region_num], region, page_image);
+
+			region.uv_position = Vector2((float)region.x / (float)page_image.width(), (float)region.y / (float)page_image.height());
+			region.uv_width = (float)region.width / (float)page_image.width();
+			region.uv_height = (float)region.height / (float)page_image.height();
+		}
+
+		return true;
+	}
+
+	bool TextureAtlas::Write(std::ostream& stream) const
+	{
+		AtlasFileHeader header;
+		header.file_id = kAtlasFileId;
+		header.version = kAtlasFileVersion;
+		header.num_pages = (Int32)page_images_.size();
+		header.num_regions = (Int32)regions_.size();
+		stream.write((char*)&header, sizeof(header));
+
+		for(std::vector<AtlasRegion>::const_iterator region_iter = regions_.begin(); region_iter != regions_.end(); ++region_iter)
+			stream.write((const char*)&(*region_iter), sizeof(AtlasRegion));
+
+		bool success = stream.good();
+		for(std::vector<ImageData*>::const_iterator image_iter = page_images_.begin(); success && (image_iter != page_images_.end()); ++image_iter)
+			success = (*image_iter != NULL) && WriteCookedTexture(stream, **image_iter);
+
+		return success;
+	}
+
+	bool TextureAtlas::WriteToFile(const char* filename) const
+	{
+		std::ofstream file_stream(filename, std::ios::out | std::ios::binary);
+		if(!file_stream.is_open())
+			return false;
+
+		return Write(file_stream);
+	}
+
+	bool TextureAtlas::Read(std::istream& stream)
+	{
+		Release();
+
+		AtlasFileHeader header;
+		stream.read((char*)&header, sizeof(header));
+		bool success = stream.good() && (header.file_id == kAtlasFileId) && (header.version == kAtlasFileVersion) && (header.num_pages >= 0) && (header.num_regions >= 0);
+
+		if(success)
+		{
+			regions_.resize(header.num_regions);
+			if(header.num_regions > 0)
+				stream.read((char*)&regions_[0], header.num_regions*sizeof(AtlasRegion));
+			success = stream.good();
+		}
+
+		for(Int32 region_num = 0; success && (region_num < header.num_regions); ++region_num)
+		{
+			const AtlasRegion& region = regions_[region_num];
+			success = (region.page >= 0) && (region.page < header.num_pages) && (region_lookup_.find(region.name_id) == region_lookup_.end());
+			region_lookup_[region.name_id] = region_num;
+		}
+
+		// each page is a cooked texture, its data offset is from the start of its own header
+		// the padding before the data is skipped rather than seeked over as memory streams can't seek
+		for(Int32 page_num = 0; success && (page_num < header.num_pages); ++page_num)
+		{
+			CookedTextureHeader page_header;
+			stream.read((char*)&page_header, sizeof(page_header));
+			success = stream.good() && (page_header.file_id == kCookedTextureFileId) && (page_header.version == kCookedTextureFileVersion)
+				&& (page_header.format == IF_RGBA8) && (page_header.num_mips == 1) && (page_header.data_offset >= sizeof(page_header));
+			if(!success)
+				break;
+
+			ImageData* page_image = new ImageData();
+			page_image->set_width(page_header.width);
+			page_image->set_height(page_header.height);
+			page_images_.push_back(page_image);
+			success = page_header.data_size == page_image->GetDataSize();
+			if(success)
+			{
+				page_image->set_image(static_cast<UInt8*>(malloc(page_header.data_size)));
+				success = page_image->image() != NULL;
+			}
+			if(success)
+			{
+				stream.ignore(page_header.data_offset - sizeof(page_header));
+				stream.read((char*)page_image->image(), page_header.data_size);
+				success = stream.good();
+			}
+		}
+
+		if(!success)
+			Release();
+
+		return success;
+	}
+
+	bool TextureAtlas::ReadFromFile(const char* filename)
+	{
+		File* file = File::Create();
+		Int32 file_size = 0;
+		bool success = file->Open(filename) && file->GetSize(file_size);
+
+		char* file_data = NULL;
+		if(success)
+		{
+			file_data = static_cast<char*>(malloc(file_size));
+			success = file_data != NULL;
+		}
+		if(success)
+		{
+			Int32 bytes_read = 0;
+			success = file->Read(file_data, file_size, bytes_read) && (bytes_read == file_size);
+		}
+		file->Close();
+		delete file;
+
+		if(success)
+		{
+			MemoryStreamBuffer stream_buffer(file_data, file_size);
+			std::istream input_stream(&stream_buffer);
+			success = Read(input_stream);
+		}
+		free(file_data);
+
+		return success;
+	}
+
+	bool TextureAtlas::CreateTextures(const Platform& platform)
+	{
+		bool success = true;
+		for(std::vector<ImageData*>::iterator image_iter = page_images_.begin(); image_iter != page_images_.end(); ++image_iter)
+		{
+			Texture* texture = *image_iter ? Texture::Create(platform, **image_iter) : NULL;
+			success = (texture != NULL) && success;
+			page_textures_.push_back(texture);
+
+			// the texture has its own copy of the pixels
+			DeleteNull(*image_iter);
+		}
+		images_.clear();
+		return success;
+	}
+
+	void TextureAtlas::SetSpriteRegion(Sprite& sprite, const Int32 region_index) const
+	{
+		const AtlasRegion& atlas_region = regions_[region_index];
+		sprite.set_texture(page_texture(atlas_region.page));
+		sprite.set_uv_position(atlas_region.uv_position);
+		sprite.set_uv_width(atlas_region.uv_width);
+		sprite.set_uv_height(atlas_region.uv_height);
+	}
+
+	Int32 TextureAtlas::FindRegion(const StringId name_id) const
+	{
+		StringIdMap<Int32>::const_iterator region_iter = region_lookup_.find(name_id);
+		return region_iter != region_lookup_.end() ? region_iter->second : -1;
+	}
+}
@@ -0,0 +1,135 @@
+#ifndef _GEF_TEXTURE_ATLAS_H
+#define _GEF_TEXTURE_ATLAS_H
+
+#include <gef.h>
+#include <maths/vector2.h>
+#include <system/string_id.h>
+#include <system/string_id_map.h>
+#include <vector>
+#include <iosfwd>
+
+namespace gef
+{
+	class ImageData;
+	class Platform;
+	class Sprite;
+	class Texture;
+
+	const UInt32 kDefaultAtlasPageSize = 2048;
+	const UInt32 kDefaultAtlasPadding = 2;
+
+	// .atl files start with this header, followed by the region table
+	// and then each page as a single mip cooked texture in the layout WriteCookedTexture writes
+	const UInt32 kAtlasFileId = 0x4c544147; // 'GATL'
+	const Int32 kAtlasFileVersion = 1;
+
+	struct AtlasFileHeader
+	{
+		UInt32 file_id;
+		Int32 version;
+		Int32 num_pages;
+		Int32 num_regions;
+	};
+
+	// where an image ended up in an atlas
+	// uvs are in the form Sprite uses, top left corner plus size
+	struct AtlasRegion
+	{
+		StringId name_id;
+		Int32 page;
+		UInt32 x;
+		UInt32 y;
+		UInt32 width;
+		UInt32 height;
+		Vector2 uv_position;
+		float uv_width;
+		float uv_height;
+	};
+
+	// packs many images into a few large pages so sprites using them can share a texture
+	// images are sorted by height and placed with a skyline bottom left packer
+	// each image is surrounded by padding made by repeating its edge pixels
+	// so filtering doesn't pick up its neighbours
+	// pages are trimmed to the space used, rounded up to a multiple of 8 pixels across and 4 down
+	// Build only works with ImageData so tools can use the atlas without a platform
+	class TextureAtlas
+	{
+	public:
+		TextureAtlas(const UInt32 max_page_size = kDefaultAtlasPageSize, const UInt32 padding = kDefaultAtlasPadding);
+		~TextureAtlas();
+
+		// copies the top level of an RGBA8 image to be packed by the next call to Build
+		// returns the index of the image's region, or -1 if it can't fit on a page
+		// or an image has already been added with name_id
+		Int32 AddImage(const StringId name_id, const ImageData& image_data);
+
+		// packs every image added so far into page images, replacing any previous pages
+		// an atlas that has been read from a file can't be built again as it has no copies of the added images
+		bool Build();
+
+		// writes the region table and page images, so a tool can build the atlas offline
+		// must be called before CreateTextures frees the page images
+		bool Write(std::ostream& stream) const;
+		bool WriteToFile(const char* filename) const;
+
+		// replaces the atlas with the regions and page images of a written atlas
+		// call CreateTextures afterwards to use it
+		bool Read(std::istream& stream);
+		bool ReadFromFile(const char* filename);
+
+		// creates a texture for each page image
+		// the page images and the copies of the added images are freed once the textures exist
+		// so the atlas can't be built again after this
+		bool CreateTextures(const Platform& platform);
+
+		// sets the texture and uvs of a sprite to show a region
+		void SetSpriteRegion(Sprite& sprite, const Int32 region_index) const;
+
+		// returns -1 if no image was added with name_id
+		Int32 FindRegion(const StringId name_id) const;
+
+		void Release();
+
+		inline Int32 num_regions() const { return (Int32)regions_.size(); }
+		inline const AtlasRegion& region(const Int32 region_index) const { return regions_[region_index]; }
+		inline Int32 num_pages() const { return (Int32)page_images_.size(); }
+		inline const ImageData* page_image(const Int32 page) const { return page_images_[page]; }
+		inline const Texture* page_texture(const Int32 page) const { return page < (Int32)page_textures_.size() ? page_textures_[page] : NULL; }
+
+	private:
+		struct SkylineNode
+		{
+			UInt32 x;
+			UInt32 y;
+			UInt32 width;
+		};
+
+		struct Page
+		{
+			std::vector<SkylineNode> skyline;
+			UInt32 used_width;
+			UInt32 used_height;
+		};
+
+		struct SourceImage
+		{
+			UInt32 width;
+			UInt32 height;
+			std::vector<UInt8> pixels;
+		};
+
+		bool FindPosition(const Page& page, const UInt32 width, const UInt32 height, Int32& node_index, UInt32& x, UInt32& y) const;
+		void AddSkylineNode(Page& page, const Int32 node_index, const UInt32 x, const UInt32 y, const UInt32 width, const UInt32 height);
+		void CopyImageToPage(const SourceImage& image, const AtlasRegion& region, ImageData& page_image) const;
+
+		UInt32 max_page_size_;
+		UInt32 padding_;
+		std::vector<SourceImage> images_;
+		std::vector<AtlasRegion> regions_;
+		StringIdMap<Int32> region_lookup_;
+		std::vector<ImageData*> page_images_;
+		std::vector<Texture*> page_textures_;
+	};
+}
+
+#endif // _GEF_TEXTURE_ATLAS_H
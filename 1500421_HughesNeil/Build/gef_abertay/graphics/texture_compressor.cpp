@@ -0,0 +1,631 @@
+#include <graphics/texture_compressor.h>
+#include <system/thread_pool.h>
+#include <vector>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#define GEF_TEXTURE_COMPRESSOR_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define GEF_TEXTURE_COMPRESSOR_NEON
+#include <arm_neon.h>
+#endif
+
+namespace gef
+{
+	// palette searches are done for four pixels at a time
+#if defined(GEF_TEXTURE_COMPRESSOR_SSE)
+	typedef __m128 Float4;
+	static inline Float4 Load4(const float* values) { return _mm_loadu_ps(values); }
+	static inline void Store4(float* values, const Float4 value) { _mm_storeu_ps(values, value); }
+	static inline Float4 Splat4(const float value) { return _mm_set1_ps(value); }
+	static inline Float4 Add4(const Float4 a, const Float4 b) { return _mm_add_ps(a, b); }
+	static inline Float4 Sub4(const Float4 a, const Float4 b) { return _mm_sub_ps(a, b); }
+	static inline Float4 Mul4(const Float4 a, const Float4 b) { return _mm_mul_ps(a, b); }
+	static inline Float4 SelectLess4(const Float4 a, const Float4 b, const Float4 if_less, const Float4 otherwise)
+	{
+		const Float4 mask = _mm_cmplt_ps(a, b);
+		return _mm_or_ps(_mm_and_ps(mask, if_less), _mm_andnot_ps(mask, otherwise));
+	}
+#elif defined(GEF_TEXTURE_COMPRESSOR_NEON)
+	typedef float32x4_t Float4;
+	static inline Float4 Load4(const float* values) { return vld1q_f32(values); }
+	static inline void Store4(float* values, const Float4 value) { vst1q_f32(values, value); }
+	static inline Float4 Splat4(const float value) { return vdupq_n_f32(value); }
+	static inline Float4 Add4(const Float4 a, const Float4 b) { return vaddq_f32(a, b); }
+	static inline Float4 Sub4(const Float4 a, const Float4 b) { return vsubq_f32(a, b); }
+	static inline Float4 Mul4(const Float4 a, const Float4 b) { return vmulq_f32(a, b); }
+	static inline Float4 SelectLess4(const Float4 a, const Float4 b, const Float4 if_less, const Float4 otherwise) { return vbslq_f32(vcltq_f32(a, b), if_less, otherwise); }
+#else
+	struct Float4
+	{
+		float values[4];
+	};
+	static inline Float4 Load4(const float* values) { Float4 result; memcpy(result.values, values, sizeof(result.values)); return result; }
+	static inline void Store4(float* values, const Float4 value) { memcpy(values, value.values, sizeof(value.values)); }
+	static inline Float4 Splat4(const float value) { Float4 result = { { value, value, value, value } }; return result; }
+	static inline Float4 Add4(const Float4 a, const Float4 b) { Float4 result = { { a.values[0]+b.values[0], a.values[1]+b.values[1], a.values[2]+b.values[2], a.values[3]+b.values[3] } }; return result; }
+	static inline Float4 Sub4(const Float4 a, const Float4 b) { Float4 result = { { a.values[0]-b.values[0], a.values[1]-b.values[1], a.values[2]-b.values[2], a.values[3]-b.values[3] } }; return result; }
+	static inline Float4 Mul4(const Float4 a, const Float4 b) { Float4 result = { { a.values[0]*b.values[0], a.values[1]*b.values[1], a.values[2]*b.values[2], a.values[3]*b.values[3] } }; return result; }
+	static inline Float4 SelectLess4(const Float4 a, const Float4 b, const Float4 if_less, const Float4 otherwise)
+	{
+		Float4 result;
+		for(Int32 lane = 0; lane < 4; ++lane)
+			result.values[lane] = a.values[lane] < b.values[lane] ? if_less.values[lane] : otherwise.values[lane];
+		return result;
+	}
+#endif
+
+	static const Int32 kBlockSize = 4;
+	static const Int32 kBlockPixels = kBlockSize*kBlockSize;
+	static const Int32 kNumRefineIterations = 2;
+	static const Int32 kNumPowerIterations = 8;
+
+	// BC1 pixels with alpha below this are transparent
+	static const UInt8 kBC1AlphaThreshold = 128;
+
+	// the pixels of one block as floats, one array per channel
+	struct ColourBlock
+	{
+		float channels[3][kBlockPixels];
+		UInt8 alpha[kBlockPixels];
+		bool transparent[kBlockPixels];
+		Int32 num_opaque;
+	};
+
+	struct ColourEndpoints
+	{
+		float colours[2][3];
+	};
+
+	static void ReadBlock(const UInt8* image, const UInt32 width, const UInt32 height, const UInt32 block_x, const UInt32 block_y, const bool allow_transparent, ColourBlock& block)
+	{
+		// pixels past the edge of the image repeat the last row or column
+		block.num_opaque = 0;
+		for(Int32 pixel_y = 0; pixel_y < kBlockSize; ++pixel_y)
+		{
+			UInt32 y = block_y*kBlockSize + pixel_y;
+			if(y >= height)
+				y = height-1;
+
+			for(Int32 pixel_x = 0; pixel_x < kBlockSize; ++pixel_x)
+			{
+				UInt32 x = block_x*kBlockSize + pixel_x;
+				if(x >= width)
+					x = width-1;
+
+				const UInt8* pixel = image + (y*width + x)*4;
+				const Int32 pixel_num = pixel_y*kBlockSize + pixel_x;
+				block.channels[0][pixel_num] = (float)pixel[0];
+				block.channels[1][pixel_num] = (float)pixel[1];
+				block.channels[2][pixel_num] = (float)pixel[2];
+				block.alpha[pixel_num] = pixel[3];
+				block.transparent[pixel_num] = allow_transparent && (pixel[3] < kBC1AlphaThreshold);
+				if(!block.transparent[pixel_num])
+					++block.num_opaque;
+			}
+		}
+	}
+
+	static inline UInt16 ToRGB565(const float* colour)
+	{
+		const UInt16 red = (UInt16)(colour[0]*31.0f/255.0f + 0.5f);
+		const UInt16 green = (UInt16)(colour[1]*63.0f/255.0f + 0.5f);
+		const UInt16 blue = (UInt16)(colour[2]*31.0f/255.0f + 0.5f);
+		return (red << 11) | (green << 5) | blue;
+	}
+
+	static inline void FromRGB565(const UInt16 value, float* colour)
+	{
+		const UInt32 red = (value >> 11) & 0x1f;
+		const UInt32 green = (value >> 5) & 0x3f;
+		const UInt32 blue = value & 0x1f;
+		colour[0] = (float)((red << 3) | (red >> 2));
+		colour[1] = (float)((green << 2) | (green >> 4));
+		colour[2] = (float)((blue << 3) | (blue >> 2));
+	}
+
+	static inline float Clamp255(const float value)
+	{
+		return value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value);
+	}
+
+	static void CalculateMean(const ColourBlock& block, float* mean)
+	{
+		mean[0] = mean[1] = mean[2] = 0.0f;
+		for(Int32 pixel_num = 0; pixel_num < kBlockPixels; ++pixel_num)
+		{
+			if(block.transparent[pixel_num])
+				continue;
+			for(Int32 channel = 0; channel < 3; ++channel)
+				mean[channel] += block.channels[channel][pixel_num];
+		}
+		for(Int32 channel = 0; channel < 3; ++channel)
+			mean[channel] /= (float)block.num_opaque;
+	}
+
+	// the corners of the colours' bounding box, pulled in slightly as the extremes are rarely worth hitting exactly
+	static void FitBoundingBox(const ColourBlock& block, ColourEndpoints& endpoints)
+	{
+		float mean[3];
+		CalculateMean(block, mean);
+
+		float min_colour[3] = { 255.0f, 255.0f, 255.0f };
+		float max_colour[3] = { 0.0f, 0.0f, 0.0f };
+		float covariance[3] = { 0.0f, 0.0f, 0.0f };
+		for(Int32 pixel_num = 0; pixel_num < kBlockPixels; ++pixel_num)
+		{
+			if(block.transparent[pixel_num])
+				continue;
+
+			const float red = block.channels[0][pixel_num] - mean[0];
+			for(Int32 channel = 0; channel < 3; ++channel)
+			{
+				const float value = block.channels[channel][pixel_num];
+				min_colour[channel] = value < min_colour[channel] ? value : min_colour[channel];
+				max_colour[channel] = value > max_colour[channel] ? value : max_colour[channel];
+				covariance[channel] += red * (value - mean[channel]);
+			}
+		}
+
+		for(Int32 channel = 0; channel < 3; ++channel)
+		{
+			const float inset = (max_colour[channel] - min_colour[channel]) / 16.0f;
+			endpoints.colours[0][channel] = max_colour[channel] - inset;
+			endpoints.colours[1][channel] = min_colour[channel] + inset;
+		}
+
+		// green and blue are swapped to the other diagonal of the box when they go against red
+		for(Int32 channel = 1; channel < 3; ++channel)
+		{
+			if(covariance[channel] < 0.0f)
+			{
+				const float value = endpoints.colours[0][channel];
+				endpoints.colours[0][channel] = endpoints.colours[1][channel];
+				endpoints.colours[1][channel] = value;
+			}
+		}
+	}
+
+	// the extremes of the colours projected onto the axis they vary most along
+	static void FitPrincipalAxis(const ColourBlock& block, ColourEndpoints& endpoints)
+	{
+		float mean[3];
+		CalculateMean(block, mean);
+
+		float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		for(Int32 pixel_num = 0; pixel_num < kBlockPixels; ++pixel_num)
+		{
+			if(block.transparent[pixel_num])
+				continue;
+
+			const float red = block.channels[0][pixel_num] - mean[0];
+			const float green = block.channels[1][pixel_num] - mean[1];
+			const float blue = block.channels[2][pixel_num] - mean[2];
+			covariance[0] += red*red;
+			covariance[1] += red*green;
+			covariance[2] += red*blue;
+			covariance[3] += green*green;
+			covariance[4] += green*blue;
+			covariance[5] += blue*blue;
+		}
+
+		// power iteration for the eigenvector with the largest eigenvalue
+		float axis[3] = { 1.0f, 1.0f, 1.0f };
+		for(Int32 iteration = 0; iteration < kNumPowerIterations; ++iteration)
+		{
+			const float x = axis[0]*covariance[0] + axis[1]*covariance[1] + axis[2]*covariance[2];
+			const float y = axis[0]*covariance[1] + axis[1]*covariance[3] + axis[2]*covariance[4];
+			const float z = axis[0]*covariance[2] + axis[1]*covariance[4] + axis[2]*covariance[5];
+			const float length = fabsf(x) > fabsf(y) ? (fabsf(x) > fabsf(z) ? fabsf(x) : fabsf(z)) : (fabsf(y) > fabsf(z) ? fabsf(y) : fabsf(z));
+			if(length < FLT_EPSILON)
+				break;
+
+			axis[0] = x / length;
+			axis[1] = y / length;
+			axis[2] = z / length;
+		}
+
+		const float axis_length_sqr = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2];
+		float min_projection = 0.0f, max_projection = 0.0f;
+		for(Int32 pixel_num = 0; pixel_num < kBlockPixels; ++pixel_num)
+		{
+			if(block.transparent[pixel_num])
+				continue;
+
+			const float projection = ((block.channels[0][pixel_num] - mean[0])*axis[0] + (block.channels[1][pixel_num] - mean[1])*axis[1] + (block.channels[2][pixel_num] - mean[2])*axis[2]) / axis_length_sqr;
+			min_projection = projection < min_projection ? projection : min_projection;
+			max_projection = projection > max_projection ? projection : max_projection;
+		}
+
+		for(Int32 channel = 0; channel < 3; ++channel)
+		{
+			endpoints.colours[0][channel] = Clamp255(mean[channel] + axis[channel]*max_projection);
+			endpoints.colours[1][channel] = Clamp255(mean[channel] + axis[channel]*min_projection);
+		}
+	}
+
+	// picks the nearest palette entry for each pixel and returns the total squared error of the opaque pixels
+	static float FindColourIndices(const ColourBlock& block, const float palette[4][3], const Int32 palette_size, UInt8* indices)
+	{
+		float total_error = 0.0f;
+		for(Int32 first_pixel = 0; first_pixel < kBlockPixels; first_pixel += 4)
+		{
+			const Float4 red = Load4(&block.channels[0][first_pixel]);
+			const Float4 green = Load4(&block.channels[1][first_pixel]);
+			const Float4 blue = Load4(&block.channels[2][first_pixel]);
+
+			Float4 best_error = Splat4(FLT_MAX);
+			Float4 best_index = Splat4(0.0f);
+			for(Int32 entry = 0; entry < palette_size; ++entry)
+			{
+				const Float4 red_difference = Sub4(red, Splat4(palette[entry][0]));
+				const Float4 green_difference = Sub4(green, Splat4(palette[entry][1]));
+				const Float4 blue_difference = Sub4(blue, Splat4(palette[entry][2]));
+				const Float4 error = Add4(Add4(Mul4(red_difference, red_difference), Mul4(green_difference, green_difference)), Mul4(blue_difference, blue_difference));
+				best_index = SelectLess4(error, best_error, Splat4((float)entry), best_index);
+				best_error = SelectLess4(error, best_error, error, best_error);
+			}
+
+			float errors[4], entries[4];
+			Store4(errors, best_error);
+			Store4(entries, best_index);
+			for(Int32 lane = 0; lane < 4; ++lane)
+			{
+				const Int32 pixel_num = first_pixel + lane;
+				if(block.transparent[pixel_num])
+					indices[pixel_num] = 3;
+				else
+				{
+					indices[pixel_num] = (UInt8)entries[lane];
+					total_error += errors[lane];
+				}
+			}
+		}
+		return total_error;
+	}
+
+	// quantises the endpoints and finds the best indices for them
+	// the endpoints are ordered and replaced with the colours the hardware will decode
+	static float EvaluateEndpoints(const ColourBlock& block, const bool three_colour, ColourEndpoints& endpoints, UInt16* packed_endpoints, UInt8* indices)
+	{
+		UInt16 colour0 = ToRGB565(endpoints.colours[0]);
+		UInt16 colour1 = ToRGB565(endpoints.colours[1]);
+
+		// the order of the endpoints chooses between the four colour and three colour with transparency modes
+		if((three_colour && (colour0 > colour1)) || (!three_colour && (colour0 < colour1)))
+		{
+			const UInt16 colour = colour0;
+			colour0 = colour1;
+			colour1 = colour;
+		}
+		packed_endpoints[0] = colour0;
+		packed_endpoints[1] = colour1;
+
+		FromRGB565(colour0, endpoints.colours[0]);
+		FromRGB565(colour1, endpoints.colours[1]);
+
+		float palette[4][3];
+		for(Int32 channel = 0; channel < 3; ++channel)
+		{
+			const float value0 = endpoints.colours[0][channel];
+			const float value1 = endpoints.colours[1][channel];
+			palette[0][channel] = value0;
+			palette[1][channel] = value1;
+			if(three_colour)
+				palette[2][channel] = (value0 + value1) / 2.0f;
+			else
+			{
+				palette[2][channel] = (value0*2.0f + value1) / 3.0f;
+				palette[3][channel] = (value0 + value1*2.0f) / 3.0f;
+			}
+		}
+
+		// equal endpoints decode as three colour mode, which is fine as every pixel then uses the first entry
+		return FindColourIndices(block, palette, three_colour ? 3 : 4, indices);
+	}
+
+	// solves for the endpoints with the least squared error for the current indices
+	static bool RefineEndpoints(const ColourBlock& block, const bool three_colour, const UInt8* indices, ColourEndpoints& endpoints)
+	{
+		static const float kFourColourWeights[4] = { 1.0f, 0.0f, 2.0f/3.0f, 1.0f/3.0f };
+		static const float kThreeColourWeights[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+		const float* weights = three_colour ? kThreeColourWeights : kFourColourWeights;
+
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ax[3] = { 0.0f, 0.0f, 0.0f };
+		float bx[3] = { 0.0f, 0.0f, 0.0f };
+		for(Int32 pixel_num = 0; pixel_num < kBlockPixels; ++pixel_num)
+		{
+			if(block.transparent[pixel_num])
+				continue;
+
+			const float a = weights[indices[pixel_num]];
+			const float b = 1.0f - a;
+			aa += a*a;
+			ab += a*b;
+			bb += b*b;
+			for(Int32 channel = 0; channel < 3; ++channel)
+			{
+				ax[channel] += a*block.channels[channel][pixel_num];
+				bx[channel] += b*block.channels[channel][pixel_num];
+			}
+		}
+
+		const float determinant = aa*bb - ab*ab;
+		if(fabsf(determinant) < FLT_EPSILON)
+			return false;
+
+		for(Int32 channel = 0; channel < 3; ++channel)
+		{
+			endpoints.colours[0][channel] = Clamp255((ax[channel]*bb - bx[channel]*ab) / determinant);
+			endpoints.colours[1][channel] = Clamp255((bx[channel]*aa - ax[channel]*ab) / determinant);
+		}
+		return true;
+	}
+
+	static void WriteColourBlock(const UInt16* packed_endpoints, const UInt8* indices, UInt8* output)
+	{
+		output[0] = (UInt8)(packed_endpoints[0] & 0xff);
+		output[1] = (UInt8)(packed_endpoints[0] >> 8);
+		output[2] = (UInt8)(packed_endpoints[1] & 0xff);
+		output[3] = (UInt8)(packed_endpoints[1] >> 8);
+
+		UInt32 packed_indices = 0;
+		for(Int32 pixel_num = 0; pixel_num < kBlockPixels; ++pixel_num)
+			packed_indices |= (UInt32)indices[pixel_num] << (pixel_num*2);
+		output[4] = (UInt8)(packed_indices & 0xff);
+		output[5] = (UInt8)((packed_indices >> 8) & 0xff);
+		output[6] = (UInt8)((packed_indices >> 16) & 0xff);
+		output[7] = (UInt8)(packed_indices >> 24);
+	}
+
+	static void EncodeColourBlock(const ColourBlock& block, const CompressionQuality quality, UInt8* output)
+	{
+		UInt16 packed_endpoints[2] = { 0, 0 };
+		UInt8 indices[kBlockPixels];
+
+		// three colour mode is only needed for blocks with transparent pixels
+		const bool three_colour = block.num_opaque < kBlockPixels;
+		if(block.num_opaque == 0)
+		{
+			memset(indices, 3, sizeof(indices));
+			WriteColourBlock(packed_endpoints, indices, output);
+			return;
+		}
+
+		ColourEndpoints endpoints;
+		if(quality == CQ_FAST)
+			FitBoundingBox(block, endpoints);
+		else
+			FitPrincipalAxis(block, endpoints);
+
+		float error = EvaluateEndpoints(block, three_colour, endpoints, packed_endpoints, indices);
+
+		if(quality == CQ_HIGH)
+		{
+			for(Int32 iteration = 0; (iteration < kNumRefineIterations) && (error > 0.0f); ++iteration)
+			{
+				ColourEndpoints refined_endpoints;
+				if(!RefineEndpoints(block, three_colour, indices, refined_endpoints))
+					break;
+
+				UInt16 refined_packed_endpoints[2];
+				UInt8 refined_indices[kBlockPixels];
+				const float refined_error = EvaluateEndpoints(block, three_colour, refined_endpoints, refined_packed_endpoints, refined_indices);
+				if(refined_error >= error)
+					break;
+
+				error = refined_error;
+				packed_endpoints[0] = refined_packed_endpoints[0];
+				packed_endpoints[1] = refined_packed_endpoints[1];
+				memcpy(indices, refined_indices, sizeof(indices));
+			}
+		}
+
+		WriteColourBlock(packed_endpoints, indices, output);
+	}
+
+	// returns the total squared error of the best indices for an alpha palette
+	static UInt32 FindAlphaIndices(const UInt8* alpha, const Int32* palette, UInt8* indices)
+	{
+		UInt32 total_error = 0;
+		for(Int32 pixel_num = 0; pixel_num < kBlockPixels; ++pixel_num)
+		{
+			UInt32 best_error = 0xffffffff;
+			for(Int32 entry = 0; entry < 8; ++entry)
+			{
+				const Int32 difference = (Int32)alpha[pixel_num] - palette[entry];
+				const UInt32 error = (UInt32)(difference*difference);
+				if(error < best_error)
+				{
+					best_error = error;
+					indices[pixel_num] = (UInt8)entry;
+				}
+			}
+			total_error += best_error;
+		}
+		return total_error;
+	}
+
+	static void EncodeAlphaBlock(const UInt8* alpha, const CompressionQuality quality, UInt8* output)
+	{
+		Int32 min_alpha = 255, max_alpha = 0;
+		for(Int32 pixel_num = 0; pixel_num < kBlockPixels; ++pixel_num)
+		{
+			min_alpha = alpha[pixel_num] < min_alpha ? alpha[pixel_num] : min_alpha;
+			max_alpha = alpha[pixel_num] > max_alpha ? alpha[pixel_num] : max_alpha;
+		}
+
+		if(min_alpha == max_alpha)
+		{
+			output[0] = output[1] = (UInt8)min_alpha;
+			memset(output+2, 0, 6);
+			return;
+		}
+
+		// eight interpolated values between the extremes
+		Int32 palette[8];
+		palette[0] = max_alpha;
+		palette[1] = min_alpha;
+		for(Int32 entry = 2; entry < 8; ++entry)
+			palette[entry] = ((8-entry)*max_alpha + (entry-1)*min_alpha + 3) / 7;
+
+		UInt8 indices[kBlockPixels];
+		UInt32 error = FindAlphaIndices(alpha, palette, indices);
+
+		// six interpolated values plus exact 0 and 255 can do better when a block is mostly fully on or off
+		if((quality == CQ_HIGH) && (error > 0))
+		{
+			Int32 min_inner_alpha = 255, max_inner_alpha = 0;
+			for(Int32 pixel_num = 0; pixel_num < kBlockPixels; ++pixel_num)
+			{
+				if((alpha[pixel_num] == 0) || (alpha[pixel_num] == 255))
+					continue;
+				min_inner_alpha = alpha[pixel_num] < min_inner_alpha ? alpha[pixel_num] : min_inner_alpha;
+				max_inner_alpha = alpha[pixel_num] > max_inner_alpha ? alpha[pixel_num] : max_inner_alpha;
+			}
+			if(min_inner_alpha > max_inner_alpha)
+				min_inner_alpha = max_inner_alpha = 0;
+
+			Int32 six_value_palette[8];
+			six_value_palette[0] = min_inner_alpha;
+			six_value_palette[1] = max_inner_alpha;
+			for(Int32 entry = 2; entry < 6; ++entry)
+				six_value_palette[entry] = ((6-entry)*min_inner_alpha + (entry-1)*max_inner_alpha + 2) / 5;
+			six_value_palette[6] = 0;
+			six_value_palette[7] = 255;
+
+			UInt8 six_value_indices[kBlockPixels];
+			const UInt32 six_value_error = FindAlphaIndices(alpha, six_value_palette, six_value_indices);
+			if(six_value_error < error)
+			{
+				memcpy(palette, six_value_palette, sizeof(palette));
+				memcpy(indices, six_value_indices, sizeof(indices));
+			}
+		}
+
+		output[0] = (UInt8)palette[0];
+		output[1] = (UInt8)palette[1];
+
+		// 3 bit indices, two groups of eight pixels in 24 bits each
+		for(Int32 group = 0; group < 2; ++group)
+		{
+			UInt32 packed_indices = 0;
+			for(Int32 pixel_num = 0; pixel_num < 8; ++pixel_num)
+				packed_indices |= (UInt32)indices[group*8 + pixel_num] << (pixel_num*3);
+			output[2 + group*3] = (UInt8)(packed_indices & 0xff);
+			output[3 + group*3] = (UInt8)((packed_indices >> 8) & 0xff);
+			output[4 + group*3] = (UInt8)(packed_indices >> 16);
+		}
+	}
+
+	// one row of blocks of one mip level
+	struct CompressionJob
+	{
+		const UInt8* source;
+		UInt32 width;
+		UInt32 height;
+		UInt32 block_y;
+		UInt8* dest;
+	};
+
+	struct CompressionContext
+	{
+		std::vector<CompressionJob> jobs;
+		ImageFormat format;
+		CompressionQuality quality;
+	};
+
+	static void CompressBlockRowJob(void* user_data, Int32 job_index)
+	{
+		const CompressionContext* context = static_cast<const CompressionContext*>(user_data);
+		const CompressionJob& job = context->jobs[job_index];
+		const UInt32 num_blocks = (job.width + kBlockSize-1) / kBlockSize;
+		const bool bc1 = context->format == IF_BC1;
+
+		UInt8* output = job.dest;
+		ColourBlock block;
+		for(UInt32 block_x = 0; block_x < num_blocks; ++block_x)
+		{
+			ReadBlock(job.source, job.width, job.height, block_x, job.block_y, bc1, block);
+			if(!bc1)
+			{
+				EncodeAlphaBlock(block.alpha, context->quality, output);
+				output += 8;
+			}
+			EncodeColourBlock(block, context->quality, output);
+			output += 8;
+		}
+	}
+
+	ImageFormat ChooseCompressedFormat(const ImageData& image_data)
+	{
+		if((image_data.image() != NULL) && (image_data.format() == IF_RGBA8))
+		{
+			const UInt32 num_pixels = image_data.width()*image_data.height();
+			for(UInt32 pixel_num = 0; pixel_num < num_pixels; ++pixel_num)
+			{
+				if(image_data.image()[pixel_num*4+3] != 255)
+					return IF_BC3;
+			}
+		}
+		return IF_BC1;
+	}
+
+	bool CompressImage(const ImageData& source, ImageData& dest, const ImageFormat format, const CompressionQuality quality, ThreadPool* thread_pool)
+	{
+		if((source.image() == NULL) || (source.format() != IF_RGBA8) || (source.width() == 0) || (source.height() == 0))
+			return false;
+		if(((format != IF_BC1) && (format != IF_BC3)) || (quality >= CQ_NUM_QUALITIES))
+			return false;
+
+		ImageData compressed;
+		compressed.set_width(source.width());
+		compressed.set_height(source.height());
+		compressed.set_format(format);
+		compressed.set_num_mips(source.num_mips());
+
+		UInt8* data = static_cast<UInt8*>(malloc(compressed.GetDataSize()));
+		if(data == NULL)
+			return false;
+
+		CompressionContext context;
+		context.format = format;
+		context.quality = quality;
+		for(UInt32 mip_level = 0; mip_level < source.num_mips(); ++mip_level)
+		{
+			CompressionJob job;
+			job.source = source.image() + source.GetMipOffset(mip_level);
+			job.width = source.GetMipWidth(mip_level);
+			job.height = source.GetMipHeight(mip_level);
+
+			const UInt32 num_block_rows = (job.height + kBlockSize-1) / kBlockSize;
+			for(UInt32 block_y = 0; block_y < num_block_rows; ++block_y)
+			{
+				job.block_y = block_y;
+				job.dest = data + compressed.GetMipOffset(mip_level) + block_y*compressed.GetMipPitch(mip_level);
+				context.jobs.push_back(job);
+			}
+		}
+
+		if(thread_pool)
+			thread_pool->ParallelFor((Int32)context.jobs.size(), CompressBlockRowJob, &context);
+		else
+		{
+			for(Int32 job_index = 0; job_index < (Int32)context.jobs.size(); ++job_index)
+				CompressBlockRowJob(&context, job_index);
+		}
+
+		free(dest.image());
+		dest.set_image(data);
+		dest.set_width(compressed.width());
+		dest.set_height(compressed.height());
+		dest.set_format(format);
+		dest.set_num_mips(compressed.num_mips());
+		return true;
+	}
+}
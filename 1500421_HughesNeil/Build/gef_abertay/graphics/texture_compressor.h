@@ -0,0 +1,30 @@
+#ifndef _GEF_TEXTURE_COMPRESSOR_H
+#define _GEF_TEXTURE_COMPRESSOR_H
+
+#include <gef.h>
+#include <graphics/image_data.h>
+#include <cstddef>
+
+namespace gef
+{
+	class ThreadPool;
+
+	enum CompressionQuality
+	{
+		CQ_FAST = 0,	// bounding box endpoints, fast enough to use at load time
+		CQ_NORMAL,		// endpoints along the principal axis of each block's colours
+		CQ_HIGH,		// principal axis endpoints refined by least squares
+		CQ_NUM_QUALITIES
+	};
+
+	// BC1 when every pixel of the image is opaque, BC3 otherwise
+	ImageFormat ChooseCompressedFormat(const ImageData& image_data);
+
+	// compresses every mip level of an RGBA8 image to BC1 or BC3
+	// BC1 pixels with alpha below 128 become fully transparent, everything else is opaque
+	// block rows are split across the threads of thread_pool, or compressed on this thread when it is NULL
+	// source and dest can be the same image
+	bool CompressImage(const ImageData& source, ImageData& dest, const ImageFormat format, const CompressionQuality quality = CQ_NORMAL, ThreadPool* thread_pool = NULL);
+}
+
+#endif // _GEF_TEXTURE_COMPRESSOR_H
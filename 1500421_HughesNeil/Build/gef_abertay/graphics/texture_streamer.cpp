@@ -0,0 +1,337 @@
+#include <graphics/texture_streamer.h>
+#include <assets/cooked_texture_loader.h>
+#include <system/platform.h>
+#include <system/debug_log.h>
+#include <algorithm>
+
+namespace gef
+{
+	struct TextureStreamingLoad
+	{
+		TextureStreamer* streamer;
+		StreamingTexture* texture;
+		UInt32 first_mip;
+
+		// memory reserved for the mips the load adds
+		UInt32 size;
+		ImageData image_data;
+		bool success;
+		bool finished;
+	};
+
+	// texture memory used by first_mip and all the smaller mips
+	static UInt32 GetMipChainSize(const UInt32 width, const UInt32 height, const ImageFormat format, const UInt32 num_mips, const UInt32 first_mip)
+	{
+		ImageData mips;
+		mips.set_width(width);
+		mips.set_height(height);
+		mips.set_format(format);
+		mips.set_num_mips(num_mips);
+		return mips.GetDataSize() - mips.GetMipOffset(first_mip);
+	}
+
+	StreamingTexture::StreamingTexture(TextureStreamer& streamer, const char* filename) :
+		streamer_(streamer),
+		filename_(filename),
+		texture_(NULL),
+		num_mips_(0),
+		tail_mip_(0),
+		resident_mip_(0),
+		requested_mip_(0),
+		wanted_mip_(0),
+		last_request_frame_(0),
+		failed_(false),
+		load_(NULL)
+	{
+	}
+
+	StreamingTexture::~StreamingTexture()
+	{
+		streamer_.Remove(this);
+		DeleteNull(texture_);
+	}
+
+	void StreamingTexture::Bind(const Platform& platform, const int texture_stage_num) const
+	{
+		if(texture_)
+			texture_->Bind(platform, texture_stage_num);
+	}
+
+	void StreamingTexture::Unbind(const Platform& platform, const int texture_stage_num) const
+	{
+		if(texture_)
+			texture_->Unbind(platform, texture_stage_num);
+	}
+
+	void StreamingTexture::RequestScreenSize(const float screen_width, const float screen_height)
+	{
+		// the smallest mip that still has a texel for every pixel
+		UInt32 mip_level = tail_mip_;
+		if((screen_width > 0.0f) && (screen_height > 0.0f))
+		{
+			mip_level = 0;
+			while((mip_level < tail_mip_) && ((float)(width_ >> (mip_level+1)) >= screen_width) && ((float)(height_ >> (mip_level+1)) >= screen_height))
+				++mip_level;
+		}
+
+		RequestMip(mip_level);
+	}
+
+	void StreamingTexture::RequestMip(const UInt32 mip_level)
+	{
+		const UInt32 clamped_mip_level = mip_level < tail_mip_ ? mip_level : tail_mip_;
+		if((last_request_frame_ != streamer_.frame()) || (clamped_mip_level < requested_mip_))
+			requested_mip_ = clamped_mip_level;
+		last_request_frame_ = streamer_.frame();
+	}
+
+	void StreamingTexture::SetResidentTexture(Texture* texture, const UInt32 resident_mip)
+	{
+		delete texture_;
+		texture_ = texture;
+		resident_mip_ = resident_mip;
+		data_size_ = texture->data_size();
+		wasted_bytes_ = texture->wasted_bytes();
+	}
+
+	TextureStreamer::TextureStreamer(Platform& platform, const UInt32 memory_budget, ThreadPool* thread_pool) :
+		platform_(platform),
+		thread_pool_(thread_pool),
+		owns_thread_pool_(false),
+		memory_budget_(memory_budget),
+		memory_used_(0),
+		frame_(1),
+		num_loads_(0)
+	{
+		// reading files doesn't need more than one thread
+		if(thread_pool_ == NULL)
+		{
+			thread_pool_ = new ThreadPool(1);
+			owns_thread_pool_ = true;
+		}
+	}
+
+	TextureStreamer::~TextureStreamer()
+	{
+		WaitForLoads();
+
+		while(!textures_.empty())
+		{
+			DebugOut("TextureStreamer: %s wasn't deleted before the streamer\n", textures_.back()->filename().c_str());
+			delete textures_.back();
+		}
+
+		if(owns_thread_pool_)
+			DeleteNull(thread_pool_);
+	}
+
+	StreamingTexture* TextureStreamer::Load(const char* filename)
+	{
+		CookedTextureLoader cooked_texture_loader;
+		CookedTextureHeader header;
+		if(!cooked_texture_loader.LoadHeader(filename, header))
+			return NULL;
+
+		UInt32 tail_mip = 0;
+		while((tail_mip+1 < header.num_mips) && (((header.width >> tail_mip) > kStreamingTailSize) || ((header.height >> tail_mip) > kStreamingTailSize)))
+			++tail_mip;
+
+		StreamingTexture* texture = new StreamingTexture(*this, filename);
+		texture->width_ = header.width;
+		texture->height_ = header.height;
+		texture->num_mips_ = header.num_mips;
+		texture->tail_mip_ = tail_mip;
+		texture->requested_mip_ = tail_mip;
+		texture->wanted_mip_ = tail_mip;
+
+		Texture* tail_texture = NULL;
+		if(cooked_texture_loader.Load(filename, platform_, texture->tail_data_, tail_mip))
+			tail_texture = Texture::Create(platform_, texture->tail_data_);
+
+		if(tail_texture == NULL)
+		{
+			delete texture;
+			return NULL;
+		}
+
+		texture->SetResidentTexture(tail_texture, tail_mip);
+		textures_.push_back(texture);
+		memory_used_ += texture->data_size_;
+
+		return texture;
+	}
+
+	void TextureStreamer::Remove(StreamingTexture* texture)
+	{
+		std::vector<StreamingTexture*>::iterator texture_iter = std::find(textures_.begin(), textures_.end(), texture);
+		if(texture_iter == textures_.end())
+			return;
+
+		if(texture->load_)
+		{
+			WaitForLoads();
+			memory_used_ -= texture->load_->size;
+			--num_loads_;
+			delete texture->load_;
+			texture->load_ = NULL;
+		}
+
+		memory_used_ -= texture->data_size_;
+		textures_.erase(texture_iter);
+	}
+
+	void TextureStreamer::WaitForLoads()
+	{
+		thread_pool_->WaitForJobs();
+	}
+
+	bool TextureStreamer::LoadFinished(const TextureStreamingLoad* load)
+	{
+#ifndef GEF_NO_THREADS
+		std::lock_guard<std::mutex> lock(mutex_);
+#endif
+		return load->finished;
+	}
+
+	void TextureStreamer::LoadMipsJob(void* user_data, Int32)
+	{
+		TextureStreamingLoad* load = static_cast<TextureStreamingLoad*>(user_data);
+
+		CookedTextureLoader cooked_texture_loader;
+		const bool success = cooked_texture_loader.Load(load->texture->filename_.c_str(), load->streamer->platform_, load->image_data, load->first_mip);
+
+#ifndef GEF_NO_THREADS
+		std::lock_guard<std::mutex> lock(load->streamer->mutex_);
+#endif
+		load->success = success;
+		load->finished = true;
+	}
+
+	void TextureStreamer::StartLoad(StreamingTexture* texture, const UInt32 first_mip, const UInt32 size)
+	{
+		TextureStreamingLoad* load = new TextureStreamingLoad();
+		load->streamer = this;
+		load->texture = texture;
+		load->first_mip = first_mip;
+		load->size = size;
+		load->success = false;
+		load->finished = false;
+
+		texture->load_ = load;
+		memory_used_ += size;
+		++num_loads_;
+
+		thread_pool_->AddJob(LoadMipsJob, load);
+	}
+
+	void TextureStreamer::FinishLoad(StreamingTexture* texture)
+	{
+		TextureStreamingLoad* load = texture->load_;
+		texture->load_ = NULL;
+		memory_used_ -= load->size;
+		--num_loads_;
+
+		// the new texture has all the mips of the old one so it replaces it
+		Texture* mips_texture = NULL;
+		if(load->success)
+			mips_texture = Texture::Create(platform_, load->image_data);
+
+		if(mips_texture)
+		{
+			memory_used_ -= texture->data_size_;
+			texture->SetResidentTexture(mips_texture, load->first_mip);
+			memory_used_ += texture->data_size_;
+		}
+		else
+		{
+			DebugOut("TextureStreamer: failed to load the mips of %s\n", texture->filename_.c_str());
+			texture->failed_ = true;
+		}
+
+		delete load;
+	}
+
+	bool TextureStreamer::DropMips(StreamingTexture* texture)
+	{
+		Texture* tail_texture = Texture::Create(platform_, texture->tail_data_);
+		if(tail_texture == NULL)
+			return false;
+
+		memory_used_ -= texture->data_size_;
+		texture->SetResidentTexture(tail_texture, texture->tail_mip_);
+		memory_used_ += texture->data_size_;
+		return true;
+	}
+
+	bool TextureStreamer::MakeRoom(const UInt32 size)
+	{
+		while(memory_used_ + size > memory_budget_)
+		{
+			// the least recently requested texture with more mips than it needs
+			StreamingTexture* least_recent_texture = NULL;
+			for(std::vector<StreamingTexture*>::const_iterator texture_iter = textures_.begin(); texture_iter != textures_.end(); ++texture_iter)
+			{
+				StreamingTexture* texture = *texture_iter;
+				if((texture->load_ == NULL) && (texture->resident_mip_ < texture->wanted_mip_))
+				{
+					if((least_recent_texture == NULL) || (texture->last_request_frame_ < least_recent_texture->last_request_frame_))
+						least_recent_texture = texture;
+				}
+			}
+
+			if((least_recent_texture == NULL) || !DropMips(least_recent_texture))
+				return false;
+		}
+
+		return true;
+	}
+
+	static bool MoreMipsMissing(const StreamingTexture* a, const StreamingTexture* b)
+	{
+		return (a->resident_mip() - a->wanted_mip()) > (b->resident_mip() - b->wanted_mip());
+	}
+
+	void TextureStreamer::Update()
+	{
+		for(std::vector<StreamingTexture*>::const_iterator texture_iter = textures_.begin(); texture_iter != textures_.end(); ++texture_iter)
+		{
+			StreamingTexture* texture = *texture_iter;
+			if(texture->load_ && LoadFinished(texture->load_))
+				FinishLoad(texture);
+		}
+
+		// textures that weren't requested this frame only need their tail
+		std::vector<StreamingTexture*> textures_to_load;
+		for(std::vector<StreamingTexture*>::const_iterator texture_iter = textures_.begin(); texture_iter != textures_.end(); ++texture_iter)
+		{
+			StreamingTexture* texture = *texture_iter;
+			texture->wanted_mip_ = (texture->last_request_frame_ == frame_) ? texture->requested_mip_ : texture->tail_mip_;
+			if((texture->wanted_mip_ < texture->resident_mip_) && (texture->load_ == NULL) && !texture->failed_)
+				textures_to_load.push_back(texture);
+		}
+
+		// drop mips nothing needs when the budget has been lowered
+		MakeRoom(0);
+
+		std::sort(textures_to_load.begin(), textures_to_load.end(), MoreMipsMissing);
+		for(std::vector<StreamingTexture*>::const_iterator texture_iter = textures_to_load.begin(); (texture_iter != textures_to_load.end()) && (num_loads_ < kMaxStreamingLoads); ++texture_iter)
+		{
+			StreamingTexture* texture = *texture_iter;
+
+			// load as much of the detail asked for as fits in the budget
+			// the mips already resident are freed when the new ones replace them
+			for(UInt32 first_mip = texture->wanted_mip_; first_mip < texture->resident_mip_; ++first_mip)
+			{
+				const UInt32 size = GetMipChainSize(texture->width_, texture->height_, texture->tail_data_.format(), texture->num_mips_, first_mip);
+				const UInt32 extra_size = size > texture->data_size_ ? size - texture->data_size_ : 0;
+				if(MakeRoom(extra_size))
+				{
+					StartLoad(texture, first_mip, extra_size);
+					break;
+				}
+			}
+		}
+
+		++frame_;
+	}
+}
@@ -0,0 +1,133 @@
+#ifndef _GEF_TEXTURE_STREAMER_H
+#define _GEF_TEXTURE_STREAMER_H
+
+#include <gef.h>
+#include <graphics/texture.h>
+#include <graphics/image_data.h>
+#include <system/thread_pool.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace gef
+{
+	class Platform;
+	class TextureStreamer;
+	struct TextureStreamingLoad;
+
+	// mips this size and smaller are loaded with the texture and are always resident
+	const UInt32 kStreamingTailSize = 64;
+
+	// number of textures that can be loading mips at once
+	const Int32 kMaxStreamingLoads = 2;
+
+	// a cooked texture whose larger mips are streamed in and out by a TextureStreamer
+	// it can be used anywhere a Texture can and draws with whichever mips are resident
+	class StreamingTexture : public Texture
+	{
+	public:
+		~StreamingTexture();
+
+		void Bind(const Platform& platform, const int texture_stage_num) const;
+		void Unbind(const Platform& platform, const int texture_stage_num) const;
+
+		// asks for enough detail to draw the texture across screen_width by screen_height pixels
+		// the largest request made before the next TextureStreamer::Update is the one streamed in
+		void RequestScreenSize(const float screen_width, const float screen_height);
+
+		// asks for mip_level and all the smaller mips to be resident
+		void RequestMip(const UInt32 mip_level);
+
+		inline UInt32 num_mips() const { return num_mips_; }
+		// largest mip level that can be drawn with, 0 when the texture is fully loaded
+		inline UInt32 resident_mip() const { return resident_mip_; }
+		// largest mip level that is never streamed out
+		inline UInt32 tail_mip() const { return tail_mip_; }
+		// largest mip level the texture was asked for at the last TextureStreamer::Update
+		inline UInt32 wanted_mip() const { return wanted_mip_; }
+		inline bool loading() const { return load_ != NULL; }
+		inline const std::string& filename() const { return filename_; }
+
+	private:
+		friend class TextureStreamer;
+		StreamingTexture(TextureStreamer& streamer, const char* filename);
+		void SetResidentTexture(Texture* texture, const UInt32 resident_mip);
+
+		TextureStreamer& streamer_;
+		std::string filename_;
+		Texture* texture_;
+
+		// the tail mips are kept so the larger mips can be dropped without reading the file again
+		ImageData tail_data_;
+
+		UInt32 num_mips_;
+		UInt32 tail_mip_;
+		UInt32 resident_mip_;
+		UInt32 requested_mip_;
+		UInt32 wanted_mip_;
+		UInt32 last_request_frame_;
+
+		// a texture whose mips couldn't be read keeps the ones it has
+		bool failed_;
+		TextureStreamingLoad* load_;
+	};
+
+	// streams the mips of cooked textures so they can be drawn as soon as their smallest mips are loaded
+	// each Update starts loading the mips textures were most recently requested at, most needed first,
+	// as long as everything resident fits in the memory budget
+	// to make room, textures that have more mips resident than they were last requested at go back to
+	// their tail mips, the least recently requested first
+	class TextureStreamer
+	{
+	public:
+		// mips are read on thread_pool, or a thread of the streamer's own if it is NULL
+		TextureStreamer(Platform& platform, const UInt32 memory_budget, ThreadPool* thread_pool = NULL);
+		~TextureStreamer();
+
+		// loads the tail mips of a .tex file, returns NULL if it can't be read
+		// textures must be deleted before the streamer
+		StreamingTexture* Load(const char* filename);
+
+		// call once a frame
+		// creates the textures for loads that have finished then starts new loads
+		void Update();
+
+		// blocks until every load in progress has finished
+		void WaitForLoads();
+
+		inline void set_memory_budget(const UInt32 memory_budget) { memory_budget_ = memory_budget; }
+		inline UInt32 memory_budget() const { return memory_budget_; }
+
+		// texture memory of the resident mips plus the mips being loaded will add
+		inline UInt32 memory_used() const { return memory_used_; }
+		inline Int32 num_loads() const { return num_loads_; }
+		inline UInt32 frame() const { return frame_; }
+
+	private:
+		friend class StreamingTexture;
+
+		void Remove(StreamingTexture* texture);
+		bool LoadFinished(const TextureStreamingLoad* load);
+		void FinishLoad(StreamingTexture* texture);
+		void StartLoad(StreamingTexture* texture, const UInt32 first_mip, const UInt32 size);
+		bool DropMips(StreamingTexture* texture);
+		bool MakeRoom(const UInt32 size);
+		static void LoadMipsJob(void* user_data, Int32 job_index);
+
+		Platform& platform_;
+		ThreadPool* thread_pool_;
+		bool owns_thread_pool_;
+		std::vector<StreamingTexture*> textures_;
+		UInt32 memory_budget_;
+		UInt32 memory_used_;
+		UInt32 frame_;
+		Int32 num_loads_;
+
+#ifndef GEF_NO_THREADS
+		// guards the finished flags of loads
+		std::mutex mutex_;
+#endif
+	};
+}
+
+#endif // _GEF_TEXTURE_STREAMER_H
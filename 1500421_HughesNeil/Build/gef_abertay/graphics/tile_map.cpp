@@ -0,0 +1,299 @@
+#include <graphics/tile_map.h>
+#include <graphics/sprite_renderer.h>
+#include <graphics/sprite.h>
+#include <graphics/vertex_buffer.h>
+#include <system/platform.h>
+#include <math.h>
+
+namespace gef
+{
+	TileMap::TileMap(Platform& platform, const UInt32 width, const UInt32 height, const float tile_size, const UInt32 num_layers, const UInt32 chunk_size) :
+		platform_(platform),
+		width_(width),
+		height_(height),
+		tile_size_(tile_size),
+		num_layers_(num_layers),
+		chunk_size_(chunk_size),
+		position_(0.0f, 0.0f),
+		atlas_(NULL),
+		atlas_tiles_across_(0),
+		atlas_tiles_down_(0),
+		num_chunk_builds_(0)
+	{
+		if(chunk_size_ == 0)
+			chunk_size_ = 1;
+		else if(chunk_size_ > kMaxTileMapChunkSize)
+			chunk_size_ = kMaxTileMapChunkSize;
+
+		chunks_across_ = (width_ + chunk_size_ - 1) / chunk_size_;
+		chunks_down_ = (height_ + chunk_size_ - 1) / chunk_size_;
+
+		tiles_.resize(num_layers_);
+		for(UInt32 layer = 0; layer < num_layers_; ++layer)
+			tiles_[layer].resize(width_*height_, kNoTile);
+		layer_depths_.resize(num_layers_, 0.0f);
+
+		Chunk empty_chunk;
+		empty_chunk.vertex_buffer = NULL;
+		empty_chunk.num_quads = 0;
+		empty_chunk.dirty = false;
+		chunks_.resize(num_layers_*chunks_across_*chunks_down_, empty_chunk);
+	}
+
+	TileMap::~TileMap()
+	{
+		for(std::vector<Chunk>::iterator chunk = chunks_.begin(); chunk != chunks_.end(); ++chunk)
+			ReleaseChunk(*chunk);
+	}
+
+	TileMap::Chunk& TileMap::GetChunk(const UInt32 layer, const UInt32 chunk_x, const UInt32 chunk_y)
+	{
+		return chunks_[(layer*chunks_down_ + chunk_y)*chunks_across_ + chunk_x];
+	}
+
+	void TileMap::MarkAllDirty()
+	{
+		for(std::vector<Chunk>::iterator chunk = chunks_.begin(); chunk != chunks_.end(); ++chunk)
+			chunk->dirty = true;
+	}
+
+	void TileMap::SetAtlas(const Texture* atlas, const UInt32 tiles_across, const UInt32 tiles_down)
+	{
+		atlas_ = atlas;
+		if((tiles_across != atlas_tiles_across_) || (tiles_down != atlas_tiles_down_))
+		{
+			atlas_tiles_across_ = tiles_across;
+			atlas_tiles_down_ = tiles_down;
+			MarkAllDirty();
+		}
+	}
+
+	void TileMap::SetTile(const UInt32 layer, const UInt32 x, const UInt32 y, const UInt16 tile)
+	{
+		if((layer >= num_layers_) || (x >= width_) || (y >= height_))
+			return;
+
+		UInt16& map_tile = tiles_[layer][TileIndex(x, y)];
+		if(map_tile != tile)
+		{
+			map_tile = tile;
+			GetChunk(layer, x / chunk_size_, y / chunk_size_).dirty = true;
+		}
+	}
+
+	UInt16 TileMap::GetTile(const UInt32 layer, const UInt32 x, const UInt32 y) const
+	{
+		if((layer >= num_layers_) || (x >= width_) || (y >= height_))
+			return kNoTile;
+
+		return tiles_[layer][TileIndex(x, y)];
+	}
+
+	void TileMap::SetLayer(const UInt32 layer, const UInt16* tiles)
+	{
+		if(layer >= num_layers_)
+			return;
+
+		// only the chunks with a tile that differs are rebuilt
+		for(UInt32 y = 0; y < height_; ++y)
+		{
+			for(UInt32 x = 0; x < width_; ++x)
+				SetTile(layer, x, y, tiles[TileIndex(x, y)]);
+		}
+	}
+
+	void TileMap::ClearLayer(const UInt32 layer)
+	{
+		if(layer >= num_layers_)
+			return;
+
+		for(UInt32 y = 0; y < height_; ++y)
+		{
+			for(UInt32 x = 0; x < width_; ++x)
+				SetTile(layer, x, y, kNoTile);
+		}
+	}
+
+	void TileMap::set_layer_depth(const UInt32 layer, const float depth)
+	{
+		if((layer >= num_layers_) || (layer_depths_[layer] == depth))
+			return;
+
+		layer_depths_[layer] = depth;
+		for(UInt32 chunk_y = 0; chunk_y < chunks_down_; ++chunk_y)
+		{
+			for(UInt32 chunk_x = 0; chunk_x < chunks_across_; ++chunk_x)
+				GetChunk(layer, chunk_x, chunk_y).dirty = true;
+		}
+	}
+
+	void TileMap::set_position(const Vector2& position)
+	{
+		if((position.x != position_.x) || (position.y != position_.y))
+		{
+			position_ = position;
+			MarkAllDirty();
+		}
+	}
+
+	void TileMap::ReleaseChunk(Chunk& chunk)
+	{
+		if(chunk.vertex_buffer)
+		{
+			platform_.RemoveVertexBuffer(chunk.vertex_buffer);
+			DeleteNull(chunk.vertex_buffer);
+		}
+		chunk.num_quads = 0;
+	}
+
+	void TileMap::BuildChunk(const UInt32 layer, const UInt32 chunk_x, const UInt32 chunk_y)
+	{
+		Chunk& chunk = GetChunk(layer, chunk_x, chunk_y);
+		ReleaseChunk(chunk);
+		chunk.dirty = false;
+		++num_chunk_builds_;
+
+		// without an atlas layout every tile shows the whole texture
+		const float uv_width = atlas_tiles_across_ ? 1.0f / (float)atlas_tiles_across_ : 1.0f;
+		const float uv_height = atlas_tiles_down_ ? 1.0f / (float)atlas_tiles_down_ : 1.0f;
+		const UInt32 num_atlas_tiles = atlas_tiles_across_*atlas_tiles_down_;
+		const float z = layer_depths_[layer];
+
+		const UInt32 first_x = chunk_x*chunk_size_;
+		const UInt32 first_y = chunk_y*chunk_size_;
+		const UInt32 end_x = (first_x + chunk_size_) < width_ ? (first_x + chunk_size_) : width_;
+		const UInt32 end_y = (first_y + chunk_size_) < height_ ? (first_y + chunk_size_) : height_;
+
+		build_vertices_.clear();
+		const std::vector<UInt16>& layer_tiles = tiles_[layer];
+		for(UInt32 y = first_y; y < end_y; ++y)
+		{
+			for(UInt32 x = first_x; x < end_x; ++x)
+			{
+				const UInt16 tile = layer_tiles[TileIndex(x, y)];
+				if((tile == kNoTile) || (num_atlas_tiles && (tile >= num_atlas_tiles)))
+					continue;
+
+				float u0 = 0.0f, v0 = 0.0f;
+				if(num_atlas_tiles)
+				{
+					u0 = (float)(tile % atlas_tiles_across_)*uv_width;
+					v0 = (float)(tile / atlas_tiles_across_)*uv_height;
+				}
+				const float x0 = position_.x + (float)x*tile_size_;
+				const float y0 = position_.y + (float)y*tile_size_;
+
+				// the same corners and winding as SpriteBatch
+				SpriteBatchVertex vertices[4];
+				vertices[0].x = x0;				vertices[0].y = y0;				vertices[0].u = u0;				vertices[0].v = v0;
+				vertices[1].x = x0+tile_size_;	vertices[1].y = y0;				vertices[1].u = u0+uv_width;	vertices[1].v = v0;
+				vertices[2].x = x0+tile_size_;	vertices[2].y = y0+tile_size_;	vertices[2].u = u0+uv_width;	vertices[2].v = v0+uv_height;
+				vertices[3].x = x0;				vertices[3].y = y0+tile_size_;	vertices[3].u = u0;				vertices[3].v = v0+uv_height;
+				for(Int32 vertex_num = 0; vertex_num < 4; ++vertex_num)
+				{
+					vertices[vertex_num].z = z;
+					vertices[vertex_num].colour = 0xffffffff;
+					build_vertices_.push_back(vertices[vertex_num]);
+				}
+			}
+		}
+
+		if(build_vertices_.empty())
+			return;
+
+		// the tiles only change when the chunk is rebuilt, so the buffer can be read only
+		chunk.vertex_buffer = VertexBuffer::Create(platform_);
+		if((chunk.vertex_buffer == NULL) || !chunk.vertex_buffer->Init(platform_, &build_vertices_[0], (UInt32)build_vertices_.size(), sizeof(SpriteBatchVertex)))
+		{
+			DeleteNull(chunk.vertex_buffer);
+			return;
+		}
+		platform_.AddVertexBuffer(chunk.vertex_buffer);
+		chunk.num_quads = (UInt32)build_vertices_.size() / 4;
+	}
+
+	void TileMap::DrawTileSprites(SpriteRenderer* renderer, const UInt32 layer, const UInt32 chunk_x, const UInt32 chunk_y)
+	{
+		const float uv_width = atlas_tiles_across_ ? 1.0f / (float)atlas_tiles_across_ : 1.0f;
+		const float uv_height = atlas_tiles_down_ ? 1.0f / (float)atlas_tiles_down_ : 1.0f;
+		const UInt32 num_atlas_tiles = atlas_tiles_across_*atlas_tiles_down_;
+
+		Sprite sprite;
+		sprite.set_texture(atlas_);
+		sprite.set_width(tile_size_);
+		sprite.set_height(tile_size_);
+		sprite.set_uv_width(uv_width);
+		sprite.set_uv_height(uv_height);
+
+		const UInt32 first_x = chunk_x*chunk_size_;
+		const UInt32 first_y = chunk_y*chunk_size_;
+		const UInt32 end_x = (first_x + chunk_size_) < width_ ? (first_x + chunk_size_) : width_;
+		const UInt32 end_y = (first_y + chunk_size_) < height_ ? (first_y + chunk_size_) : height_;
+		const std::vector<UInt16>& layer_tiles = tiles_[layer];
+		for(UInt32 y = first_y; y < end_y; ++y)
+		{
+			for(UInt32 x = first_x; x < end_x; ++x)
+			{
+				const UInt16 tile = layer_tiles[TileIndex(x, y)];
+				if((tile == kNoTile) || (num_atlas_tiles && (tile >= num_atlas_tiles)))
+					continue;
+
+				if(num_atlas_tiles)
+					sprite.set_uv_position(Vector2((float)(tile % atlas_tiles_across_)*uv_width, (float)(tile / atlas_tiles_across_)*uv_height));
+				sprite.set_position(position_.x + ((float)x + 0.5f)*tile_size_, position_.y + ((float)y + 0.5f)*tile_size_, layer_depths_[layer]);
+				renderer->DrawSprite(sprite);
+			}
+		}
+	}
+
+	UInt32 TileMap::Render(SpriteRenderer* renderer, const Vector2& view_min, const Vector2& view_max)
+	{
+		if((chunks_across_ == 0) || (chunks_down_ == 0) || (tile_size_ <= 0.0f))
+			return 0;
+
+		// the range of chunks overlapping the view, clamped to the map
+		const float chunk_world_size = tile_size_*(float)chunk_size_;
+		const float min_x = floorf((view_min.x - position_.x) / chunk_world_size);
+		const float min_y = floorf((view_min.y - position_.y) / chunk_world_size);
+		const float max_x = floorf((view_max.x - position_.x) / chunk_world_size);
+		const float max_y = floorf((view_max.y - position_.y) / chunk_world_size);
+		if(!(max_x >= 0.0f) || !(max_y >= 0.0f) || !(min_x < (float)chunks_across_) || !(min_y < (float)chunks_down_))
+			return 0;
+
+		const UInt32 first_chunk_x = min_x > 0.0f ? (UInt32)min_x : 0;
+		const UInt32 first_chunk_y = min_y > 0.0f ? (UInt32)min_y : 0;
+		const UInt32 last_chunk_x = max_x < (float)(chunks_across_-1) ? (UInt32)max_x : chunks_across_-1;
+		const UInt32 last_chunk_y = max_y < (float)(chunks_down_-1) ? (UInt32)max_y : chunks_down_-1;
+
+		SpriteBatch* batch = renderer->batch();
+		UInt32 num_chunks_drawn = 0;
+		for(UInt32 layer = 0; layer < num_layers_; ++layer)
+		{
+			for(UInt32 chunk_y = first_chunk_y; chunk_y <= last_chunk_y; ++chunk_y)
+			{
+				for(UInt32 chunk_x = first_chunk_x; chunk_x <= last_chunk_x; ++chunk_x)
+				{
+					if(batch == NULL)
+					{
+						DrawTileSprites(renderer, layer, chunk_x, chunk_y);
+						++num_chunks_drawn;
+						continue;
+					}
+
+					// chunks out of view stay dirty until they are next drawn
+					Chunk& chunk = GetChunk(layer, chunk_x, chunk_y);
+					if(chunk.dirty)
+						BuildChunk(layer, chunk_x, chunk_y);
+
+					if(chunk.num_quads)
+					{
+						batch->DrawQuads(chunk.vertex_buffer, atlas_, chunk.num_quads);
+						++num_chunks_drawn;
+					}
+				}
+			}
+		}
+
+		return num_chunks_drawn;
+	}
+}
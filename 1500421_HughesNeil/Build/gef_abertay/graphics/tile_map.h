@@ -0,0 +1,102 @@
+#ifndef _GEF_TILE_MAP_H
+#define _GEF_TILE_MAP_H
+
+#include <gef.h>
+#include <graphics/sprite_batch.h>
+#include <maths/vector2.h>
+#include <vector>
+
+namespace gef
+{
+	class Platform;
+	class SpriteRenderer;
+	class Texture;
+	class VertexBuffer;
+
+	const UInt16 kNoTile = 0xffff;
+	const UInt32 kDefaultTileMapChunkSize = 16;
+
+	// a chunk is one batch draw while it has no more tiles than the renderer's batch size, 32 x 32 fills the default batch
+	const UInt32 kMaxTileMapChunkSize = 32;
+
+	// layers of tiles from one texture atlas, baked into a static vertex buffer for each square chunk of tiles
+	// chunks are only rebuilt after one of their tiles changes and only chunks overlapping the view are drawn
+	// so a large level is a few draws a frame rather than one for every tile
+	// tile 0 is the top left of the atlas and the numbers go across then down
+	class TileMap
+	{
+	public:
+		// chunk_size is in tiles and is clamped to kMaxTileMapChunkSize
+		TileMap(Platform& platform, const UInt32 width, const UInt32 height, const float tile_size, const UInt32 num_layers = 1, const UInt32 chunk_size = kDefaultTileMapChunkSize);
+		~TileMap();
+
+		void SetAtlas(const Texture* atlas, const UInt32 tiles_across, const UInt32 tiles_down);
+		void SetTile(const UInt32 layer, const UInt32 x, const UInt32 y, const UInt16 tile);
+		UInt16 GetTile(const UInt32 layer, const UInt32 x, const UInt32 y) const;
+
+		// fills a whole layer from width * height tiles in rows, kNoTile leaves a gap
+		void SetLayer(const UInt32 layer, const UInt16* tiles);
+		void ClearLayer(const UInt32 layer);
+
+		// layers are drawn in order with later layers on top of earlier ones at the same depth
+		void set_layer_depth(const UInt32 layer, const float depth);
+
+		// the top left corner of tile 0, 0, the chunks are baked in place so this rebuilds them all
+		// scroll by moving the view instead
+		void set_position(const Vector2& position);
+		inline const Vector2& position() const { return position_; }
+
+		// draws the chunks overlapping the view, rebuilding any that have changed, and returns how many were drawn
+		// call between the renderer's Begin and End with its projection set to the view
+		// platforms without batching draw each tile in view as a sprite
+		UInt32 Render(SpriteRenderer* renderer, const Vector2& view_min, const Vector2& view_max);
+
+		inline UInt32 width() const { return width_; }
+		inline UInt32 height() const { return height_; }
+		inline UInt32 num_layers() const { return num_layers_; }
+		inline float tile_size() const { return tile_size_; }
+		inline UInt32 chunk_size() const { return chunk_size_; }
+
+		// count since the map was created
+		inline UInt32 num_chunk_builds() const { return num_chunk_builds_; }
+
+	private:
+		struct Chunk
+		{
+			VertexBuffer* vertex_buffer;
+			UInt32 num_quads;
+			bool dirty;
+		};
+
+		inline UInt32 TileIndex(const UInt32 x, const UInt32 y) const { return y*width_ + x; }
+		Chunk& GetChunk(const UInt32 layer, const UInt32 chunk_x, const UInt32 chunk_y);
+		void MarkAllDirty();
+		void BuildChunk(const UInt32 layer, const UInt32 chunk_x, const UInt32 chunk_y);
+		void ReleaseChunk(Chunk& chunk);
+		void DrawTileSprites(SpriteRenderer* renderer, const UInt32 layer, const UInt32 chunk_x, const UInt32 chunk_y);
+
+		Platform& platform_;
+		UInt32 width_;
+		UInt32 height_;
+		float tile_size_;
+		UInt32 num_layers_;
+		UInt32 chunk_size_;
+		UInt32 chunks_across_;
+		UInt32 chunks_down_;
+		Vector2 position_;
+
+		const Texture* atlas_;
+		UInt32 atlas_tiles_across_;
+		UInt32 atlas_tiles_down_;
+
+		// one array of width * height tiles for each layer
+		std::vector< std::vector<UInt16> > tiles_;
+		std::vector<float> layer_depths_;
+		std::vector<Chunk> chunks_;
+		std::vector<SpriteBatchVertex> build_vertices_;
+
+		UInt32 num_chunk_builds_;
+	};
+}
+
+#endif // _GEF_TILE_MAP_H
@@ -13,6 +13,7 @@ namespace gef
 	{
 		const Vector4& sphere_centre = sphere.position();
 		float sphere_radius = sphere.radius();
+		bool intersects = false;
 
 			// calculate our distances to each of the planes
 		for (int i = 0; i < 6; ++i)
@@ -26,12 +27,13 @@ namespace gef
 				return FI_OUT;
 
 			// else if the distance is between +- radius, then we intersect
+			// keep checking the other planes as the sphere may still be outside one of them
 			if (fabsf(distance) < sphere_radius)
-				return FI_INTERSECTS;
+				intersects = true;
 		}
 
 		// otherwise we are fully in view
-		return FI_IN;
+		return intersects ? FI_INTERSECTS : FI_IN;
 	}
 
 	FrustumIntersect Frustum::Intersects(const Aabb& aabb) const
@@ -91,35 +93,35 @@ namespace gef
 	void Frustum::ExtractPlanesD3D(const Matrix44& viewproj, bool normalise)
 	{
 		// Left clipping plane
-		planes_[0].set_a(viewproj.m(0,3) + viewproj.m(0,0));
-		planes_[0].set_b(viewproj.m(1,3) + viewproj.m(1,0));
-		planes_[0].set_c(viewproj.m(2,3) + viewproj.m(2,0));
-		planes_[0].set_d(viewproj.m(3,3) + viewproj.m(3,0));
+		planes_[FP_LEFT].set_a(viewproj.m(0,3) + viewproj.m(0,0));
+		planes_[FP_LEFT].set_b(viewproj.m(1,3) + viewproj.m(1,0));
+		planes_[FP_LEFT].set_c(viewproj.m(2,3) + viewproj.m(2,0));
+		planes_[FP_LEFT].set_d(viewproj.m(3,3) + viewproj.m(3,0));
 		// Right clipping plane
-		planes_[0].set_a(viewproj.m(0,3) - viewproj.m(0,0));
-		planes_[0].set_b(viewproj.m(1,3) - viewproj.m(1,0));
-		planes_[0].set_c(viewproj.m(2,3) - viewproj.m(2,0));
-		planes_[0].set_d(viewproj.m(3,3) - viewproj.m(3,0));
+		planes_[FP_RIGHT].set_a(viewproj.m(0,3) - viewproj.m(0,0));
+		planes_[FP_RIGHT].set_b(viewproj.m(1,3) - viewproj.m(1,0));
+		planes_[FP_RIGHT].set_c(viewproj.m(2,3) - viewproj.m(2,0));
+		planes_[FP_RIGHT].set_d(viewproj.m(3,3) - viewproj.m(3,0));
 		// Top clipping plane
-		planes_[1].set_a(viewproj.m(0,3) - viewproj.m(0,1));
-		planes_[1].set_b(viewproj.m(1,3) - viewproj.m(1,1));
-		planes_[1].set_c(viewproj.m(2,3) - viewproj.m(2,1));
-		planes_[1].set_d(viewproj.m(3,3) - viewproj.m(3,1));
+		planes_[FP_TOP].set_a(viewproj.m(0,3) - viewproj.m(0,1));
+		planes_[FP_TOP].set_b(viewproj.m(1,3) - viewproj.m(1,1));
+		planes_[FP_TOP].set_c(viewproj.m(2,3) - viewproj.m(2,1));
+		planes_[FP_TOP].set_d(viewproj.m(3,3) - viewproj.m(3,1));
 		// Bottom clipping plane
-		planes_[2].set_a(viewproj.m(0,3) + viewproj.m(0,1));
-		planes_[2].set_b(viewproj.m(1,3) + viewproj.m(1,1));
-		planes_[2].set_c(viewproj.m(2,3) + viewproj.m(2,1));
-		planes_[2].set_d(viewproj.m(3,3) + viewproj.m(3,1));
+		planes_[FP_BOTTOM].set_a(viewproj.m(0,3) + viewproj.m(0,1));
+		planes_[FP_BOTTOM].set_b(viewproj.m(1,3) + viewproj.m(1,1));
+		planes_[FP_BOTTOM].set_c(viewproj.m(2,3) + viewproj.m(2,1));
+		planes_[FP_BOTTOM].set_d(viewproj.m(3,3) + viewproj.m(3,1));
 		// Near clipping plane
-		planes_[3].set_a(viewproj.m(0,2));
-		planes_[3].set_b(viewproj.m(1,2));
-		planes_[3].set_c(viewproj.m(2,2));
-		planes_[3].set_d(viewproj.m(3,2));
+		planes_[FP_NEAR].set_a(viewproj.m(0,2));
+		planes_[FP_NEAR].set_b(viewproj.m(1,2));
+		planes_[FP_NEAR].set_c(viewproj.m(2,2));
+		planes_[FP_NEAR].set_d(viewproj.m(3,2));
 		// Far clipping plane
-		planes_[5].set_a(viewproj.m(0,3) - viewproj.m(0,2));
-		planes_[5].set_b(viewproj.m(1,3) - viewproj.m(1,2));
-		planes_[5].set_c(viewproj.m(2,3) - viewproj.m(2,2));
-		planes_[5].set_d(viewproj.m(3,3) - viewproj.m(3,2));
+		planes_[FP_FAR].set_a(viewproj.m(0,3) - viewproj.m(0,2));
+		planes_[FP_FAR].set_b(viewproj.m(1,3) - viewproj.m(1,2));
+		planes_[FP_FAR].set_c(viewproj.m(2,3) - viewproj.m(2,2));
+		planes_[FP_FAR].set_d(viewproj.m(3,3) - viewproj.m(3,2));
 		// Normalize the plane equations, if requested
 		if (normalise == true)
 		{
@@ -136,35 +138,35 @@ namespace gef
 	void Frustum::ExtractPlanesGL(const Matrix44& viewproj, bool normalise)
 	{
 		// Left clipping plane
-		planes_[0].set_a(viewproj.m(3,0) + viewproj.m(0,0));
-		planes_[0].set_b(viewproj.m(3,1) + viewproj.m(0,1));
-		planes_[0].set_c(viewproj.m(3,2) + viewproj.m(0,2));
-		planes_[0].set_d(viewproj.m(3,3) + viewproj.m(0,3));
+		planes_[FP_LEFT].set_a(viewproj.m(3,0) + viewproj.m(0,0));
+		planes_[FP_LEFT].set_b(viewproj.m(3,1) + viewproj.m(0,1));
+		planes_[FP_LEFT].set_c(viewproj.m(3,2) + viewproj.m(0,2));
+		planes_[FP_LEFT].set_d(viewproj.m(3,3) + viewproj.m(0,3));
 		// Right clipping plane
-		planes_[0].set_a(viewproj.m(3,0) - viewproj.m(0,0));
-		planes_[0].set_b(viewproj.m(3,1) - viewproj.m(0,1));
-		planes_[0].set_c(viewproj.m(3,2) - viewproj.m(0,2));
-		planes_[0].set_d(viewproj.m(3,3) - viewproj.m(0,3));
+		planes_[FP_RIGHT].set_a(viewproj.m(3,0) - viewproj.m(0,0));
+		planes_[FP_RIGHT].set_b(viewproj.m(3,1) - viewproj.m(0,1));
+		planes_[FP_RIGHT].set_c(viewproj.m(3,2) - viewproj.m(0,2));
+		planes_[FP_RIGHT].set_d(viewproj.m(3,3) - viewproj.m(0,3));
 		// Top clipping plane
-		planes_[1].set_a(viewproj.m(3,0) - viewproj.m(1,0));
-		planes_[1].set_b(viewproj.m(3,1) - viewproj.m(1,1));
-		planes_[1].set_c(viewproj.m(3,2) - viewproj.m(1,2));
-		planes_[1].set_d(viewproj.m(3,3) - viewproj.m(1,3));
+		planes_[FP_TOP].set_a(viewproj.m(3,0) - viewproj.m(1,0));
+		planes_[FP_TOP].set_b(viewproj.m(3,1) - viewproj.m(1,1));
+		planes_[FP_TOP].set_c(viewproj.m(3,2) - viewproj.m(1,2));
+		planes_[FP_TOP].set_d(viewproj.m(3,3) - viewproj.m(1,3));
 		// Bottom clipping plane
-		planes_[2].set_a(viewproj.m(3,0) + viewproj.m(1,0));
-		planes_[2].set_b(viewproj.m(3,1) + viewproj.m(1,1));
-		planes_[2].set_c(viewproj.m(3,2) + viewproj.m(1,2));
-		planes_[2].set_d(viewproj.m(3,3) + viewproj.m(1,3));
+		planes_[FP_BOTTOM].set_a(viewproj.m(3,0) + viewproj.m(1,0));
+		planes_[FP_BOTTOM].set_b(viewproj.m(3,1) + viewproj.m(1,1));
+		planes_[FP_BOTTOM].set_c(viewproj.m(3,2) + viewproj.m(1,2));
+		planes_[FP_BOTTOM].set_d(viewproj.m(3,3) + viewproj.m(1,3));
 		// Near clipping plane
-		planes_[3].set_a(viewproj.m(3,0) + viewproj.m(2,0));
-		planes_[3].set_b(viewproj.m(3,1) + viewproj.m(2,1));
-		planes_[3].set_c(viewproj.m(3,2) + viewproj.m(2,2));
-		planes_[3].set_d(viewproj.m(3,3) + viewproj.m(2,3));
+		planes_[FP_NEAR].set_a(viewproj.m(3,0) + viewproj.m(2,0));
+		planes_[FP_NEAR].set_b(viewproj.m(3,1) + viewproj.m(2,1));
+		planes_[FP_NEAR].set_c(viewproj.m(3,2) + viewproj.m(2,2));
+		planes_[FP_NEAR].set_d(viewproj.m(3,3) + viewproj.m(2,3));
 		// Far clipping plane
-		planes_[5].set_a(viewproj.m(3,0) - viewproj.m(2,0));
-		planes_[5].set_b(viewproj.m(3,1) - viewproj.m(2,1));
-		planes_[5].set_c(viewproj.m(3,2) - viewproj.m(2,2));
-		planes_[5].set_d(viewproj.m(3,3) - viewproj.m(2,3));
+		planes_[FP_FAR].set_a(viewproj.m(3,0) - viewproj.m(2,0));
+		planes_[FP_FAR].set_b(viewproj.m(3,1) - viewproj.m(2,1));
+		planes_[FP_FAR].set_c(viewproj.m(3,2) - viewproj.m(2,2));
+		planes_[FP_FAR].set_d(viewproj.m(3,3) - viewproj.m(2,3));
 		// Normalize the plane equations, if requested
 		if (normalise == true)
 		{
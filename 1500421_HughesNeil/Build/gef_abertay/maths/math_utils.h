@@ -5,6 +5,9 @@
 #define FRAMEWORK_DEG_TO_RAD ((float)FRAMEWORK_PI/180.0f)
 #define FRAMEWORK_RAD_TO_DEG ((float)180.f/(float)FRAMEWORK_PI)
 
+#include <gef.h>
+#include <cstring>
+
 namespace gef
 {
 	inline float DegToRad(float angleInDegrees)
@@ -28,6 +31,56 @@ namespace gef
 		return (diff < -(float)FRAMEWORK_PI) ? (diff + 2 * (float)FRAMEWORK_PI) : ((diff >(float)FRAMEWORK_PI) ? (diff - 2 * (float)FRAMEWORK_PI) : diff);
 		//return diff;
 	}
+
+	// IEEE 754 half precision conversion
+	// values too large for a half are clamped to infinity, denormals are flushed to zero
+	inline UInt16 FloatToHalf(float value)
+	{
+		UInt32 bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		const UInt32 sign = (bits >> 16) & 0x8000;
+		const Int32 exponent = (Int32)((bits >> 23) & 0xff) - 127 + 15;
+		UInt32 mantissa = bits & 0x7fffff;
+
+		if(((bits >> 23) & 0xff) == 0xff)
+			return (UInt16)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+		if(exponent <= 0)
+			return (UInt16)sign;
+		if(exponent >= 31)
+			return (UInt16)(sign | 0x7c00);
+
+		// round to nearest
+		mantissa += 0x1000;
+		if(mantissa & 0x800000)
+		{
+			mantissa = 0;
+			if(exponent+1 >= 31)
+				return (UInt16)(sign | 0x7c00);
+			return (UInt16)(sign | ((exponent+1) << 10));
+		}
+
+		return (UInt16)(sign | (exponent << 10) | (mantissa >> 13));
+	}
+
+	inline float HalfToFloat(UInt16 value)
+	{
+		const UInt32 sign = ((UInt32)value & 0x8000) << 16;
+		const UInt32 exponent = ((UInt32)value >> 10) & 0x1f;
+		const UInt32 mantissa = (UInt32)value & 0x3ff;
+
+		UInt32 bits;
+		if(exponent == 0)
+			bits = sign;
+		else if(exponent == 31)
+			bits = sign | 0x7f800000 | (mantissa << 13);
+		else
+			bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
 }
 
 #endif // _GEF_MATH_UTILS_H
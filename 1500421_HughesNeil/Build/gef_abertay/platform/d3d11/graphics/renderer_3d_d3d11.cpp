@@ -168,31 +168,41 @@ namespace gef
 
 	void Renderer3DD3D11::DrawMesh(const  MeshInstance& mesh_instance)
 	{
-		// set up the shader data for default shader
-		if (shader_ == &default_shader_)
-			default_shader_.SetSceneData(default_shader_data_, view_matrix_, projection_matrix_);
+		DrawMeshPrimitives(mesh_instance, SelectMeshLod(mesh_instance), 0, -1, 0, -1);
+	}
 
+	void Renderer3DD3D11::DrawMeshPrimitives(const MeshInstance& mesh_instance, UInt32 lod, Int32 first_primitive, Int32 end_primitive, Int32 start_index, Int32 num_indices)
+	{
 		const Mesh* mesh = mesh_instance.mesh();
 		if(mesh != NULL)
 		{
+			if((end_primitive < 0) || (end_primitive > (Int32)mesh->num_primitives()))
+				end_primitive = (Int32)mesh->num_primitives();
+
+			Shader* shader = GetMeshShader(*mesh);
+
+			// set up the shader data for default shader
+			if (shader == &default_shader_ || shader == &default_packed_shader_)
+				static_cast<Default3DShader*>(shader)->SetSceneData(default_shader_data_, view_matrix_, projection_matrix_);
+
 			set_world_matrix(mesh_instance.transform());
 
 			const VertexBuffer* vertex_buffer = mesh->vertex_buffer();
 			//ShaderGL* shader_GL = static_cast<ShaderGL*>(shader_);
 
-			if(vertex_buffer && shader_)
+			if(vertex_buffer && shader)
 			{
-				shader_->SetMeshData(mesh_instance);
+				shader->SetMeshData(mesh_instance);
 
-				shader_->device_interface()->UseProgram();
+				shader->device_interface()->UseProgram();
 				vertex_buffer->Bind(platform_);
 
 				// vertex format must be set after the vertex buffer is bound
-				shader_->device_interface()->SetVertexFormat();
+				shader->device_interface()->SetVertexFormat();
 
-				for(UInt32 primitive_index=0;primitive_index<mesh->num_primitives();++primitive_index)
+				for(Int32 primitive_index=first_primitive;primitive_index<end_primitive;++primitive_index)
 				{
-					const Primitive* primitive = mesh->GetPrimitive(primitive_index);
+					const Primitive* primitive = mesh->GetLodPrimitive(lod, primitive_index);
 					const IndexBuffer* index_buffer = primitive->index_buffer();
 					if(primitive->type() != UNDEFINED && index_buffer)
 					{
@@ -205,12 +215,12 @@ namespace gef
 
 
 						//only set default shader data if current shader is the default shader
-						shader_->SetMaterialData(material);
+						shader->SetMaterialData(material);
 
 						// GRC FIXME - probably want to split variable data into scene, object, primitive[material?] based
 						// rather than set all variables per primitive
-						shader_->device_interface()->SetVariableData();
-						shader_->device_interface()->BindTextureResources(platform());
+						shader->device_interface()->SetVariableData();
+						shader->device_interface()->BindTextureResources(platform());
 
 						//GLenum primitive_type = primitive_types[primitive->type()];
 
@@ -224,25 +234,31 @@ namespace gef
 						// in case we don't want to draw them all
 
 						if (index_buffer->num_indices() > 0)
-							platform_d3d.device_context()->DrawIndexed(index_buffer->num_indices(), 0, 0);
+						{
+							UInt32 draw_index_count = index_buffer->num_indices() > (UInt32)start_index ? index_buffer->num_indices() - start_index : 0;
+							if ((num_indices >= 0) && ((UInt32)num_indices < draw_index_count))
+								draw_index_count = num_indices;
+							if (draw_index_count > 0)
+								platform_d3d.device_context()->DrawIndexed(draw_index_count, start_index, 0);
+						}
 						else
 							platform_d3d.device_context()->Draw(vertex_buffer->num_vertices(), 0);
 
 
 						index_buffer->Unbind(platform_);
-						shader_->device_interface()->UnbindTextureResources(platform());
+						shader->device_interface()->UnbindTextureResources(platform());
 					}
 				}
 
 				vertex_buffer->Unbind(platform_);
-				shader_->device_interface()->ClearVertexFormat();
+				shader->device_interface()->ClearVertexFormat();
 			}
 		}
 	}
 
-	void Renderer3DD3D11::DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices)
+	void Renderer3DD3D11::DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices, Int32 start_index)
 	{
-
+		DrawMeshPrimitives(mesh_instance, 0, primitive_index, primitive_index+1, start_index, num_indices);
 	}
 	void Renderer3DD3D11::SetFillMode(FillMode fill_mode)
 	{
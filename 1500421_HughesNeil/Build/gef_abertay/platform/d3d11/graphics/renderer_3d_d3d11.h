@@ -31,7 +31,7 @@ namespace gef
 		void End();
 
 		void DrawMesh(const  MeshInstance& mesh_instance);
-		void DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices = -1);
+		void DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices = -1, Int32 start_index = 0);
 		void SetFillMode(FillMode fill_mode);
 		void SetDepthTest(DepthTest depth_test);
 
@@ -39,6 +39,9 @@ namespace gef
 		static const D3D11_PRIMITIVE_TOPOLOGY Renderer3DD3D11::primitive_types[NUM_PRIMITIVE_TYPES];
 
 	private:
+		// end_primitive and num_indices of -1 draw everything
+		void DrawMeshPrimitives(const MeshInstance& mesh_instance, UInt32 lod, Int32 first_primitive, Int32 end_primitive, Int32 start_index, Int32 num_indices);
+
 		ID3D11RasterizerState* default_render_state_;
 		ID3D11RasterizerState* wireframe_render_state_;
 		ID3D11BlendState* default_blend_state_;
@@ -276,6 +276,18 @@ namespace gef
 		case kUByte4:
 			attribute_type = DXGI_FORMAT_R32_UINT;
 			break;
+		case kShort4Norm:
+			attribute_type = DXGI_FORMAT_R16G16B16A16_SNORM;
+			break;
+		case kByte4Norm:
+			attribute_type = DXGI_FORMAT_R8G8B8A8_SNORM;
+			break;
+		case kUByte4Norm:
+			attribute_type = DXGI_FORMAT_R8G8B8A8_UNORM;
+			break;
+		case kHalf2:
+			attribute_type = DXGI_FORMAT_R16G16_FLOAT;
+			break;
 		}
 
 		return attribute_type;
@@ -0,0 +1,30 @@
+#include <platform/d3d11/graphics/sprite_batch_d3d11.h>
+#include <platform/d3d11/system/platform_d3d11.h>
+
+namespace gef
+{
+	SpriteBatch* SpriteBatch::Create(Platform& platform, const UInt32 max_sprites)
+	{
+		SpriteBatchD3D11* sprite_batch = new SpriteBatchD3D11(platform, max_sprites);
+		if(!sprite_batch->Init())
+			DeleteNull(sprite_batch);
+
+		return sprite_batch;
+	}
+
+	SpriteBatchD3D11::SpriteBatchD3D11(Platform& platform, const UInt32 max_sprites) :
+		SpriteBatch(platform, max_sprites)
+	{
+	}
+
+	SpriteBatchD3D11::~SpriteBatchD3D11()
+	{
+	}
+
+	void SpriteBatchD3D11::DrawTriangles(const UInt32 first_index, const UInt32 num_indices, const UInt32 base_vertex)
+	{
+		const PlatformD3D11& platform_d3d = static_cast<const PlatformD3D11&>(platform_);
+		platform_d3d.device_context()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		platform_d3d.device_context()->DrawIndexed(num_indices, first_index, (INT)base_vertex);
+	}
+}
@@ -0,0 +1,19 @@
+#ifndef _GEF_SPRITE_BATCH_D3D11_H
+#define _GEF_SPRITE_BATCH_D3D11_H
+
+#include <graphics/sprite_batch.h>
+
+namespace gef
+{
+	class SpriteBatchD3D11 : public SpriteBatch
+	{
+	public:
+		SpriteBatchD3D11(Platform& platform, const UInt32 max_sprites);
+		~SpriteBatchD3D11();
+
+	protected:
+		void DrawTriangles(const UInt32 first_index, const UInt32 num_indices, const UInt32 base_vertex);
+	};
+}
+
+#endif // _GEF_SPRITE_BATCH_D3D11_H
@@ -6,6 +6,7 @@
 #include <graphics/vertex_buffer.h>
 #include <graphics/sprite.h>
 #include <graphics/shader_interface.h>
+#include <graphics/sprite_batch.h>
 
 namespace gef
 {
@@ -35,6 +36,10 @@ namespace gef
 		platform_.AddShader(&default_shader_);
 		shader_ = &default_shader_;
 
+		batch_ = SpriteBatch::Create(platform_);
+		if (batch_)
+			batch_->set_default_texture(default_texture_);
+
 		projection_matrix_ = platform_.OrthographicFrustum(0.0f, (float)platform_.width(), 0.0f, (float)platform_.height(), -1.0f, 1.0f);
 
 		HRESULT hresult = S_OK;
@@ -104,6 +109,8 @@ namespace gef
 		ReleaseNull(default_render_state_);
 		ReleaseNull(default_depth_stencil_state_);
 
+		DeleteNull(batch_);
+
 		platform_.RemoveShader(&default_shader_);
 
 		if (vertex_buffer_)
@@ -143,10 +150,26 @@ namespace gef
 		platform_d3d.device_context()->RSSetState(default_render_state_);
 		platform_d3d.device_context()->OMSetBlendState(default_blend_state_, NULL, 0xffffffff);
 		platform_d3d.device_context()->OMSetDepthStencilState(default_depth_stencil_state_, 0);
+
+		if (batch_)
+		{
+			batch_->set_projection_matrix(projection_matrix_);
+			batch_->ResetStats();
+		}
 	}
 
 	void SpriteRendererD3D11::DrawSprite(const Sprite& sprite)
 	{
+		if (batch_ && (shader_ == &default_shader_))
+		{
+			batch_->AddSprite(sprite);
+			return;
+		}
+
+		// a flush may have left the batch's vertex buffer bound
+		if (batch_)
+			vertex_buffer_->Bind(platform_);
+
 		if (shader_ == &default_shader_)
 		{
 			const Texture* texture = sprite.texture();
@@ -173,6 +196,9 @@ namespace gef
 
 	void SpriteRendererD3D11::End()
 	{
+		if (batch_)
+			batch_->Flush();
+
 		vertex_buffer_->Unbind(platform_);
 
 		platform_.EndScene();
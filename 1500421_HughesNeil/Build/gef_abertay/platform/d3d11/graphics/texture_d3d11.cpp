@@ -10,10 +10,23 @@ namespace gef
 		return new TextureD3D11(platform, image_data);
 	}
 
+	static DXGI_FORMAT GetDXGIFormat(const ImageFormat format)
+	{
+		switch(format)
+		{
+		case IF_BC1:
+			return DXGI_FORMAT_BC1_UNORM;
+		case IF_BC3:
+			return DXGI_FORMAT_BC3_UNORM;
+		case IF_RGBA8:
+		default:
+			return DXGI_FORMAT_R8G8B8A8_UNORM;
+		}
+	}
+
 	TextureD3D11::TextureD3D11(ID3D11DeviceContext* device_context) :
 	texture_(NULL),
 	shader_resource_view_(NULL),
-	image_data_buffer_(NULL),
 	device_context_(device_context)
 {
 }
@@ -22,16 +35,38 @@ namespace gef
 TextureD3D11::TextureD3D11(const Platform& platform, const ImageData& image_data) :
 	texture_(NULL),
 	shader_resource_view_(NULL),
-	image_data_buffer_(NULL),
 	device_context_(NULL),
 	Texture(platform, image_data)
 {
-	// get the size of the texture data
-	const UInt32 data_size = image_data.width()*image_data.height()*4;
-	image_data_buffer_ = new UInt8[data_size];
-	memcpy(image_data_buffer_, image_data.image(),data_size);
+	ImageData fitted_image_data;
+	const ImageData& texture_image_data = FitImageToPlatform(platform, image_data, fitted_image_data);
+
+	// the device copies the pixel data when the texture is created
+	// so every mip level is passed straight from the image data
+	const UInt32 num_mips = texture_image_data.num_mips() > 0 ? texture_image_data.num_mips() : 1;
+	D3D11_SUBRESOURCE_DATA* initial_data = new D3D11_SUBRESOURCE_DATA[num_mips];
+	for(UInt32 mip_level = 0; mip_level < num_mips; ++mip_level)
+	{
+		initial_data[mip_level].pSysMem = texture_image_data.image() + texture_image_data.GetMipOffset(mip_level);
+		initial_data[mip_level].SysMemPitch = texture_image_data.GetMipPitch(mip_level);
+		initial_data[mip_level].SysMemSlicePitch = texture_image_data.GetMipDataSize(mip_level); // only used for 3D textures
+	}
 
-	CreateTexture(platform, image_data.width(), image_data.height(), (UInt8*)image_data_buffer_, true);
+	D3D11_TEXTURE2D_DESC texture_desc;
+	texture_desc.Width = texture_image_data.width();
+	texture_desc.Height = texture_image_data.height();
+	texture_desc.MipLevels = num_mips;
+	texture_desc.ArraySize = 1;
+	texture_desc.Format = GetDXGIFormat(texture_image_data.format());
+	texture_desc.SampleDesc.Count = 1;
+	texture_desc.SampleDesc.Quality = 0;
+	texture_desc.Usage = D3D11_USAGE_DEFAULT;
+	texture_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	texture_desc.CPUAccessFlags = 0;
+	texture_desc.MiscFlags = 0;
+
+	CreateTexture(platform, texture_desc, initial_data);
+	delete[] initial_data;
 
 	device_context_ = static_cast<const PlatformD3D11&>(platform).device_context();
 }
@@ -45,7 +80,6 @@ void TextureD3D11::Release()
 {
 	ReleaseNull(shader_resource_view_);
 	ReleaseNull(texture_);
-	DeleteArrayNull(image_data_buffer_);
 	device_context_ = NULL;
 }
 
@@ -132,7 +166,7 @@ bool TextureD3D11::CreateTexture(const class Platform& platform, const D3D11_TEX
 		ZeroMemory(&desc_SRV, sizeof(D3D11_SHADER_RESOURCE_VIEW_DESC));
 		desc_SRV.Format = texture_desc.Format;
 		desc_SRV.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-		desc_SRV.Texture2D.MipLevels = 1;
+		desc_SRV.Texture2D.MipLevels = texture_desc.MipLevels;
 		hresult = platform_d3d.device()->CreateShaderResourceView(texture_, &desc_SRV, &shader_resource_view_);
 	}
 
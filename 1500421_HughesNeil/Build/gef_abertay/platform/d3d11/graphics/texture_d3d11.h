@@ -32,7 +32,6 @@ private:
 	ID3D11DeviceContext* device_context_;
 	ID3D11Texture2D* texture_;
 	ID3D11ShaderResourceView* shader_resource_view_;
-	void* image_data_buffer_;
 };
 
 }
@@ -0,0 +1,82 @@
+#include <platform/linux/system/file_linux.h>
+
+namespace gef
+{
+	File* File::Create()
+	{
+		return new FileLinux();
+	}
+
+	FileLinux::FileLinux() :
+		file_(NULL)
+	{
+	}
+
+	FileLinux::~FileLinux()
+	{
+		Close();
+	}
+
+	bool FileLinux::Open(const char* const filename)
+	{
+		file_ = std::fopen(filename, "rb");
+		return file_ != NULL;
+	}
+
+	bool FileLinux::Close()
+	{
+		if (file_)
+		{
+			std::fclose(file_);
+			file_ = NULL;
+		}
+
+		return true;
+	}
+
+	bool FileLinux::GetSize(Int32 &size)
+	{
+		long position = std::ftell(file_);
+		if (position < 0 || std::fseek(file_, 0, SEEK_END) != 0)
+			return false;
+
+		size = static_cast<Int32>(std::ftell(file_));
+
+		return std::fseek(file_, position, SEEK_SET) == 0;
+	}
+
+	bool FileLinux::Seek(const SeekFrom seek_from, const Int32 offset/*, Int32* position*/)
+	{
+		int from = SEEK_SET;
+		switch (seek_from)
+		{
+		case SF_Start:
+			from = SEEK_SET;
+			break;
+		case SF_Current:
+			from = SEEK_CUR;
+			break;
+		case SF_End:
+			from = SEEK_END;
+			break;
+		}
+
+		return std::fseek(file_, offset, from) == 0;
+	}
+
+	bool FileLinux::Read(void *buffer, const Int32 size, Int32& bytes_read)
+	{
+		bytes_read = static_cast<Int32>(std::fread(buffer, 1, size, file_));
+		return (bytes_read == size) || !std::ferror(file_);
+	}
+
+	bool FileLinux::Read(void *buffer, const Int32 size, const Int32 offset, Int32& bytes_read)
+	{
+		bytes_read = 0;
+		if (!Seek(SF_Start, offset))
+			return false;
+
+		return Read(buffer, size, bytes_read);
+	}
+
+}
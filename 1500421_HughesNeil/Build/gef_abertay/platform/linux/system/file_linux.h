@@ -0,0 +1,30 @@
+#ifndef _GEF_FILE_LINUX_H
+#define _GEF_FILE_LINUX_H
+
+#include <system/file.h>
+#include <cstdio>
+
+namespace gef
+{
+
+class FileLinux : public File
+{
+public:
+
+	FileLinux();
+	~FileLinux();
+
+	bool Open(const char* const filename);
+	bool Seek(const SeekFrom seek_from, Int32 offset/*, Int32* position = NULL*/);
+	bool Read(void *buffer, const Int32 size, Int32& bytes_read);
+	bool Read(void *buffer, const Int32 size, const Int32 offset, Int32& bytes_read);
+	bool Close();
+	bool GetSize(Int32 &size);
+
+private:
+	std::FILE* file_;
+};
+
+}
+
+#endif // _GEF_FILE_LINUX_H
@@ -71,31 +71,41 @@ namespace gef
 
 	void Renderer3DVita::DrawMesh(const  MeshInstance& mesh_instance)
 	{
-		// set up the shader data for default shader
-		if (shader_ == &default_shader_)
-			default_shader_.SetSceneData(default_shader_data_, view_matrix_, projection_matrix_);
+		DrawMeshPrimitives(mesh_instance, SelectMeshLod(mesh_instance), 0, -1, 0, -1);
+	}
 
+	void Renderer3DVita::DrawMeshPrimitives(const MeshInstance& mesh_instance, UInt32 lod, Int32 first_primitive, Int32 end_primitive, Int32 start_index, Int32 num_indices)
+	{
 		const Mesh* mesh = mesh_instance.mesh();
 		if (mesh != NULL)
 		{
+			if ((end_primitive < 0) || (end_primitive > (Int32)mesh->num_primitives()))
+				end_primitive = (Int32)mesh->num_primitives();
+
+			Shader* shader = GetMeshShader(*mesh);
+
+			// set up the shader data for default shader
+			if (shader == &default_shader_ || shader == &default_packed_shader_)
+				static_cast<Default3DShader*>(shader)->SetSceneData(default_shader_data_, view_matrix_, projection_matrix_);
+
 			set_world_matrix(mesh_instance.transform());
 
 			const VertexBuffer* vertex_buffer = mesh->vertex_buffer();
 			//ShaderGL* shader_GL = static_cast<ShaderGL*>(shader_);
 
-			if (vertex_buffer && shader_)
+			if (vertex_buffer && shader)
 			{
-				shader_->SetMeshData(mesh_instance);
+				shader->SetMeshData(mesh_instance);
 
-				shader_->device_interface()->UseProgram();
+				shader->device_interface()->UseProgram();
 				vertex_buffer->Bind(platform_);
 
 				// vertex format must be set after the vertex buffer is bound
-				shader_->device_interface()->SetVertexFormat();
+				shader->device_interface()->SetVertexFormat();
 
-				for (UInt32 primitive_index = 0; primitive_index<mesh->num_primitives(); ++primitive_index)
+				for (Int32 primitive_index = first_primitive; primitive_index<end_primitive; ++primitive_index)
 				{
-					const Primitive* primitive = mesh->GetPrimitive(primitive_index);
+					const Primitive* primitive = mesh->GetLodPrimitive(lod, primitive_index);
 					const IndexBuffer* index_buffer = primitive->index_buffer();
 					if (primitive->type() != UNDEFINED && index_buffer)
 					{
@@ -108,29 +118,35 @@ namespace gef
 
 
 						//only set default shader data if current shader is the default shader
-						shader_->SetMaterialData(material);
+						shader->SetMaterialData(material);
 
 						// GRC FIXME - probably want to split variable data into scene, object, primitive[material?] based
 						// rather than set all variables per primitive
-						shader_->device_interface()->SetVariableData();
-						shader_->device_interface()->BindTextureResources(platform());
+						shader->device_interface()->SetVariableData();
+						shader->device_interface()->BindTextureResources(platform());
 
 
 						index_buffer->Bind(platform_);
 
 						const PlatformVita& platform_vita = static_cast<const PlatformVita&>(platform_);
 						const IndexBufferVita* index_buffer_vita = static_cast<const IndexBufferVita*>(primitive->index_buffer());
-						sceGxmDraw(platform_vita.context(), primitive_types[primitive->type()], index_buffer_vita->index_format(), index_buffer_vita->graphics_data(), index_buffer_vita->num_indices());
-
 
+						UInt32 draw_index_count = index_buffer_vita->num_indices() > (UInt32)start_index ? index_buffer_vita->num_indices() - start_index : 0;
+						if ((num_indices >= 0) && ((UInt32)num_indices < draw_index_count))
+							draw_index_count = num_indices;
+						if (draw_index_count > 0)
+						{
+							const UInt8* indices = static_cast<const UInt8*>(index_buffer_vita->graphics_data()) + start_index*index_buffer_vita->index_byte_size();
+							sceGxmDraw(platform_vita.context(), primitive_types[primitive->type()], index_buffer_vita->index_format(), indices, draw_index_count);
+						}
 
 						index_buffer->Unbind(platform_);
-						shader_->device_interface()->UnbindTextureResources(platform());
+						shader->device_interface()->UnbindTextureResources(platform());
 					}
 				}
 
 				vertex_buffer->Unbind(platform_);
-				shader_->device_interface()->ClearVertexFormat();
+				shader->device_interface()->ClearVertexFormat();
 			}
 		}
 	}
@@ -203,9 +219,9 @@ namespace gef
     //	{
     //	}
 
-    void Renderer3DVita::DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices)
+    void Renderer3DVita::DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices, Int32 start_index)
     {
-
+		DrawMeshPrimitives(mesh_instance, 0, primitive_index, primitive_index+1, start_index, num_indices);
     }
 
 	void Renderer3DVita::SetFillMode(FillMode fill_mode)
@@ -25,11 +25,14 @@ namespace gef
 		void DrawMesh(const class MeshInstance& mesh_instance);
 //		void ClearZBuffer();
 
-		void DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices);
+		void DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices = -1, Int32 start_index = 0);
 		void SetFillMode(FillMode fill_mode);
 		void SetDepthTest(DepthTest depth_test);
 
 	protected:
+		// end_primitive and num_indices of -1 draw everything
+		void DrawMeshPrimitives(const MeshInstance& mesh_instance, UInt32 lod, Int32 first_primitive, Int32 end_primitive, Int32 start_index, Int32 num_indices);
+
 		static const SceGxmPrimitiveType primitive_types[NUM_PRIMITIVE_TYPES];
 
 		Texture* default_texture_;
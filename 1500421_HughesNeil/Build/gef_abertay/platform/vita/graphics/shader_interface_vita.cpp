@@ -228,6 +228,18 @@ namespace gef
 		case kMatrix44:
 			attribute_type = SCE_GXM_ATTRIBUTE_FORMAT_F32;
 			break;
+		case kShort4Norm:
+			attribute_type = SCE_GXM_ATTRIBUTE_FORMAT_S16N;
+			break;
+		case kByte4Norm:
+			attribute_type = SCE_GXM_ATTRIBUTE_FORMAT_S8N;
+			break;
+		case kUByte4Norm:
+			attribute_type = SCE_GXM_ATTRIBUTE_FORMAT_U8N;
+			break;
+		case kHalf2:
+			attribute_type = SCE_GXM_ATTRIBUTE_FORMAT_F16;
+			break;
 
 		}
 
@@ -258,6 +270,14 @@ namespace gef
 		case kMatrix44:
 			component_count = 16;
 			break;
+		case kShort4Norm:
+		case kByte4Norm:
+		case kUByte4Norm:
+			component_count = 4;
+			break;
+		case kHalf2:
+			component_count = 2;
+			break;
 		}
 
 		return component_count;
@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <libdbg.h>
 #include <graphics/mesh.h>
+#include <graphics/vertex_buffer.h>
 #include <platform/vita/system/platform_vita.h>
 #include <graphics/skinned_mesh_shader_data.h>
 
@@ -15,7 +16,8 @@ namespace gef
 			ShaderVita(shader_patcher, &_binary_skinning_shader_v_gxp_start, &_binary_skinning_shader_f_gxp_start),
 //			vertex_shader_parameters_(NULL),
 //			fragment_shader_parameters_(NULL),
-			shader_data_(shader_data)
+			shader_data_(shader_data),
+			vertex_stride_(0)
 
 	{
 		const SceGxmProgram *const vertex_program	= &_binary_skinning_shader_v_gxp_start;
@@ -46,48 +48,89 @@ namespace gef
 		fragment_shader_parameters_light_colour_ = sceGxmProgramFindParameterByName(fragment_program, "shader_data_light_colour");
 		SCE_DBG_ASSERT(fragment_shader_parameters_light_colour_ && (sceGxmProgramParameterGetCategory(fragment_shader_parameters_light_colour_) == SCE_GXM_PARAMETER_CATEGORY_UNIFORM));
 
+		position_register_ = sceGxmProgramParameterGetResourceIndex(vertex_param_input_pos_attribute);
+		normal_register_ = sceGxmProgramParameterGetResourceIndex(vertex_param_input_norm_attribute);
+		blend_indices_register_ = sceGxmProgramParameterGetResourceIndex(vertex_param_input_blendindices_attribute);
+		blend_weights_register_ = sceGxmProgramParameterGetResourceIndex(vertex_param_input_blendweights_attribute);
+		uv_register_ = sceGxmProgramParameterGetResourceIndex(vertex_param_input_uv_attribute);
+
+		CreateVertexProgram(sizeof(gef::Mesh::SkinnedVertex));
+
 		Int32 err = SCE_OK;
 
-		// create shaded triangle vertex format
+		// blended fragment program
+		SceGxmBlendInfo	blendInfo;
+		blendInfo.colorFunc = SCE_GXM_BLEND_FUNC_ADD;
+		blendInfo.alphaFunc = SCE_GXM_BLEND_FUNC_ADD;
+		blendInfo.colorSrc = SCE_GXM_BLEND_FACTOR_SRC_ALPHA;
+		blendInfo.colorDst = SCE_GXM_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		blendInfo.alphaSrc = SCE_GXM_BLEND_FACTOR_SRC_ALPHA;
+		blendInfo.alphaDst = SCE_GXM_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		blendInfo.colorMask = SCE_GXM_COLOR_MASK_ALL;
+
+		err = sceGxmShaderPatcherCreateFragmentProgram(
+			shader_patcher,
+			fragment_program_id_,
+			SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4,
+			MSAA_MODE,
+			&blendInfo,
+			vertex_program,
+			&fragment_program_);
+		SCE_DBG_ASSERT(err == SCE_OK);
+	}
+
+	SkinnedMeshShaderVita::~SkinnedMeshShaderVita()
+	{
+	}
+
+	void SkinnedMeshShaderVita::CreateVertexProgram(const UInt32 vertex_stride)
+	{
+		if(vertex_program_)
+		{
+			sceGxmShaderPatcherReleaseVertexProgram(shader_patcher_, vertex_program_);
+			vertex_program_ = NULL;
+		}
+		vertex_stride_ = vertex_stride;
+
+		// attribute offsets and formats for SkinnedVertex or PackedSkinnedVertex
+		const bool packed = vertex_stride == sizeof(gef::Mesh::PackedSkinnedVertex);
 		SceGxmVertexAttribute vertex_attributes[5];
 		vertex_attributes[0].streamIndex = 0;
 		vertex_attributes[0].offset = 0;
-		vertex_attributes[0].format = SCE_GXM_ATTRIBUTE_FORMAT_F32;
+		vertex_attributes[0].format = packed ? SCE_GXM_ATTRIBUTE_FORMAT_S16N : SCE_GXM_ATTRIBUTE_FORMAT_F32;
 		vertex_attributes[0].componentCount = 3;
-		vertex_attributes[0].regIndex = sceGxmProgramParameterGetResourceIndex(vertex_param_input_pos_attribute);
+		vertex_attributes[0].regIndex = position_register_;
 
 		vertex_attributes[1].streamIndex = 0;
-		vertex_attributes[1].offset = 12;
-		vertex_attributes[1].format = SCE_GXM_ATTRIBUTE_FORMAT_F32;
+		vertex_attributes[1].offset = packed ? offsetof(gef::Mesh::PackedSkinnedVertex, nx) : 12;
+		vertex_attributes[1].format = packed ? SCE_GXM_ATTRIBUTE_FORMAT_S8N : SCE_GXM_ATTRIBUTE_FORMAT_F32;
 		vertex_attributes[1].componentCount = 3;
-		vertex_attributes[1].regIndex = sceGxmProgramParameterGetResourceIndex(vertex_param_input_norm_attribute);
+		vertex_attributes[1].regIndex = normal_register_;
 
 		vertex_attributes[2].streamIndex = 0;
-		vertex_attributes[2].offset = 24;
+		vertex_attributes[2].offset = packed ? offsetof(gef::Mesh::PackedSkinnedVertex, bone_indices) : 24;
 		vertex_attributes[2].format = SCE_GXM_ATTRIBUTE_FORMAT_U8;
 		vertex_attributes[2].componentCount = 4;
-		vertex_attributes[2].regIndex = sceGxmProgramParameterGetResourceIndex(vertex_param_input_blendindices_attribute);
+		vertex_attributes[2].regIndex = blend_indices_register_;
 
 		vertex_attributes[3].streamIndex = 0;
-		vertex_attributes[3].offset = 28;
-		vertex_attributes[3].format = SCE_GXM_ATTRIBUTE_FORMAT_F32;
+		vertex_attributes[3].offset = packed ? offsetof(gef::Mesh::PackedSkinnedVertex, bone_weights) : 28;
+		vertex_attributes[3].format = packed ? SCE_GXM_ATTRIBUTE_FORMAT_U8N : SCE_GXM_ATTRIBUTE_FORMAT_F32;
 		vertex_attributes[3].componentCount = 4;
-		vertex_attributes[3].regIndex = sceGxmProgramParameterGetResourceIndex(vertex_param_input_blendweights_attribute);
+		vertex_attributes[3].regIndex = blend_weights_register_;
 
 		vertex_attributes[4].streamIndex = 0;
-		vertex_attributes[4].offset = 44;
-		vertex_attributes[4].format = SCE_GXM_ATTRIBUTE_FORMAT_F32;
+		vertex_attributes[4].offset = packed ? offsetof(gef::Mesh::PackedSkinnedVertex, u) : 44;
+		vertex_attributes[4].format = packed ? SCE_GXM_ATTRIBUTE_FORMAT_F16 : SCE_GXM_ATTRIBUTE_FORMAT_F32;
 		vertex_attributes[4].componentCount = 2;
-		vertex_attributes[4].regIndex = sceGxmProgramParameterGetResourceIndex(vertex_param_input_uv_attribute);
-
+		vertex_attributes[4].regIndex = uv_register_;
 
 		SceGxmVertexStream vertex_streams[1];
-		vertex_streams[0].stride = sizeof(gef::Mesh::SkinnedVertex);
+		vertex_streams[0].stride = vertex_stride;
 		vertex_streams[0].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_32BIT;
 
-		// create shaded triangle shaders
-		err = sceGxmShaderPatcherCreateVertexProgram(
-			shader_patcher,
+		Int32 err = sceGxmShaderPatcherCreateVertexProgram(
+			shader_patcher_,
 			vertex_program_id_,
 			vertex_attributes,
 			5,
@@ -95,31 +138,14 @@ namespace gef
 			1,
 			&vertex_program_);
 		SCE_DBG_ASSERT(err == SCE_OK);
-
-
-		// blended fragment program
-		SceGxmBlendInfo	blendInfo;
-		blendInfo.colorFunc = SCE_GXM_BLEND_FUNC_ADD;
-		blendInfo.alphaFunc = SCE_GXM_BLEND_FUNC_ADD;
-		blendInfo.colorSrc = SCE_GXM_BLEND_FACTOR_SRC_ALPHA;
-		blendInfo.colorDst = SCE_GXM_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-		blendInfo.alphaSrc = SCE_GXM_BLEND_FACTOR_SRC_ALPHA;
-		blendInfo.alphaDst = SCE_GXM_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-		blendInfo.colorMask = SCE_GXM_COLOR_MASK_ALL;
-
-		err = sceGxmShaderPatcherCreateFragmentProgram(
-			shader_patcher,
-			fragment_program_id_,
-			SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4,
-			MSAA_MODE,
-			&blendInfo,
-			sceGxmVertexProgramGetProgram(vertex_program_),
-			&fragment_program_);
-		SCE_DBG_ASSERT(err == SCE_OK);
 	}
 
-	SkinnedMeshShaderVita::~SkinnedMeshShaderVita()
+	void SkinnedMeshShaderVita::SetVertexBuffer(const VertexBuffer* vertex_buffer)
 	{
+		// the stride comes from the bound vertex buffer so packed meshes are read with their own layout
+		const UInt32 vertex_stride = vertex_buffer ? vertex_buffer->vertex_byte_size() : (UInt32)sizeof(gef::Mesh::SkinnedVertex);
+		if(vertex_stride != vertex_stride_)
+			CreateVertexProgram(vertex_stride);
 	}
 
 	void SkinnedMeshShaderVita::SetConstantBuffers(SceGxmContext* context, const void* data)
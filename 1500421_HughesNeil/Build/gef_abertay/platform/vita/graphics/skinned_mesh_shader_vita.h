@@ -12,6 +12,7 @@
 namespace gef
 {
 	class SkinnedMeshShaderData;
+	class VertexBuffer;
 
 	class SkinnedMeshShaderVita : public ShaderVita
 	{
@@ -21,7 +22,12 @@ namespace gef
 
 		void SetConstantBuffers(SceGxmContext* context, const void* data);
 
+		// call before Set, recreates the vertex program if the vertex size has changed
+		void SetVertexBuffer(const VertexBuffer* vertex_buffer);
+
 	private:
+		void CreateVertexProgram(const UInt32 vertex_stride);
+
 		struct Default3DShaderData_VS
 		{
 			Matrix44 wvp;
@@ -49,6 +55,13 @@ namespace gef
 
 		const SkinnedMeshShaderData* const shader_data_;
 
+		UInt32 vertex_stride_;
+		UInt32 position_register_;
+		UInt32 normal_register_;
+		UInt32 blend_indices_register_;
+		UInt32 blend_weights_register_;
+		UInt32 uv_register_;
+
 		Default3DShaderData_VS vertex_shader_data_;
 		Default3DShaderData_FS fragment_shader_data_;
 		BoneMatricesBuffer bone_matrices_data_;
@@ -0,0 +1,11 @@
+#include <graphics/sprite_batch.h>
+
+namespace gef
+{
+	SpriteBatch* SpriteBatch::Create(Platform&, const UInt32)
+	{
+		// there's no compiled batched sprite shader for vita yet
+		// so SpriteRendererVita carries on drawing sprites one at a time
+		return NULL;
+	}
+}
@@ -11,11 +11,27 @@ void graphicsFree(SceUID uid);
 
 namespace gef
 {
+	static const UInt32 kLinearTextureWidthAlignment = 8;
+
 	Texture* Texture::Create(const Platform& platform, const ImageData& image_data)
 	{
 		return new TextureVita(platform, image_data);
 	}
 
+	static SceGxmTextureFormat GetGxmFormat(const ImageFormat format)
+	{
+		switch(format)
+		{
+		case IF_BC1:
+			return SCE_GXM_TEXTURE_FORMAT_UBC1_ABGR;
+		case IF_BC3:
+			return SCE_GXM_TEXTURE_FORMAT_UBC3_ABGR;
+		case IF_RGBA8:
+		default:
+			return SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_ABGR;
+		}
+	}
+
 	TextureVita::TextureVita() :
 		texture_uid_(0),
 		texture_data_(NULL)
@@ -55,19 +71,45 @@ namespace gef
 		SCE_DBG_ASSERT(err == SCE_OK);
 	}
 
-	TextureVita::TextureVita(const class Platform& platform, const ImageData& image_data)
+	TextureVita::TextureVita(const class Platform& platform, const ImageData& image_data) :
+		Texture(platform, image_data)
 	{
 		int err = SCE_OK;
 
+		ImageData fitted_image_data;
+		const ImageData& texture_image_data = FitImageToPlatform(platform, image_data, fitted_image_data);
+
+		// linear texture rows are aligned to 8 pixels
+		// rows of any other width are padded when they are copied
+		// the rows of block compressed textures are rows of blocks
+		const ImageFormat format = texture_image_data.format();
+		const UInt32 width = texture_image_data.width();
+		const UInt32 height = texture_image_data.height();
+		const UInt32 row_size = texture_image_data.GetMipPitch(0);
+		const UInt32 stride = ImageData::GetFormatPitch(format, (width + kLinearTextureWidthAlignment-1) & ~(kLinearTextureWidthAlignment-1));
+		const UInt32 num_rows = texture_image_data.GetMipDataSize(0) / row_size;
+
 		// get the size of the texture data
-		const uint32_t data_size = image_data.width()*image_data.height()*4;
+		// only the top mip level is used on Vita
+		const uint32_t data_size = stride*num_rows;
+		data_size_ = data_size;
+		wasted_bytes_ += (stride - row_size)*num_rows;
 
 		// allocate memory
 		texture_data_ = (uint8_t *)graphicsAlloc(SCE_KERNEL_MEMBLOCK_TYPE_USER_RWDATA_UNCACHE, data_size, SCE_GXM_TEXTURE_ALIGNMENT, SCE_GXM_MEMORY_ATTRIB_READ, &texture_uid_);
-		memcpy(texture_data_, image_data.image(), data_size);
+		if(stride == row_size)
+			memcpy(texture_data_, texture_image_data.image(), data_size);
+		else
+		{
+			for(UInt32 row = 0; row < num_rows; ++row)
+			{
+				memcpy(texture_data_ + row*stride, texture_image_data.image() + row*row_size, row_size);
+				memset(texture_data_ + row*stride + row_size, 0, stride - row_size);
+			}
+		}
 
 		// set up the texture control words
-		SceGxmErrorCode texture_init_err = sceGxmTextureInitLinear(&texture_, texture_data_, SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_ABGR, image_data.width(), image_data.height(), 1);
+		SceGxmErrorCode texture_init_err = sceGxmTextureInitLinear(&texture_, texture_data_, GetGxmFormat(format), width, height, 1);
 		SCE_DBG_ASSERT(texture_init_err == SCE_OK);
 
 //		UInt32 width = sceGxmTextureGetWidth(&texture_);
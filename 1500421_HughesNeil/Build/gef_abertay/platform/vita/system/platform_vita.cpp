@@ -1080,4 +1080,9 @@ buffers before starting the next frame.
 		return new InputManagerVita(*this);
 	}
 
+	NonPowerOfTwoSupport PlatformVita::non_power_of_two_support() const
+	{
+		return NPOT_NO_MIPS;
+	}
+
 }
@@ -115,6 +115,9 @@ namespace gef
 
 		virtual DepthBuffer* CreateDepthBuffer(UInt32 width, UInt32 height) const;
 
+		// textures are created as linear textures with only the top mip level
+		virtual NonPowerOfTwoSupport non_power_of_two_support() const;
+
 		inline SceGxmContext* context() const { return context_; }
 		inline SceGxmShaderPatcher* shader_patcher() const { return shader_patcher_; }
 	private:
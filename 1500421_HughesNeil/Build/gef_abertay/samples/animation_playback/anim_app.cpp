@@ -49,7 +49,7 @@ void AnimApp::Init()
 	// now check to see if there is any mesh data in the file, if so lets create a mesh from it
 	if (model_scene_->meshes.size() > 0)
 	{
-		mesh_ = model_scene_->CreateMesh(platform_, model_scene_->meshes.front());
+		mesh_ = model_scene_->CreateMesh(platform_, *model_scene_->meshes.front());
 
 		// get the player mesh instance to use this mesh for drawing
 		player_.set_mesh(mesh_);
@@ -275,7 +275,7 @@ gef::Animation* AnimApp::LoadAnimation(const char* anim_scene_filename, const ch
 	{
 		// if the animation name is specified then try and find the named anim
 		// otherwise return the first animation if there is one
-		std::map<gef::StringId, gef::Animation*>::const_iterator anim_node_iter;
+		gef::StringIdMap<gef::Animation*>::const_iterator anim_node_iter;
 		if (anim_name)
 			anim_node_iter = anim_scene.animations.find(gef::GetStringId(anim_name));
 		else
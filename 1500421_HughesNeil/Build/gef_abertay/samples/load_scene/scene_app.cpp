@@ -41,7 +41,7 @@ void SceneApp::Init()
 
 	// now check to see if there is any mesh data in the file, if so lets create a mesh from it
 	if (model_scene_->meshes.size() > 0)
-		mesh_ = model_scene_->CreateMesh(platform_, model_scene_->meshes.front());
+		mesh_ = model_scene_->CreateMesh(platform_, *model_scene_->meshes.front());
 
 	// get the player mesh instance to use this mesh for drawing
 	player_.set_mesh(mesh_);
@@ -34,6 +34,11 @@ namespace gef
 		return true;
 	}
 
+	NonPowerOfTwoSupport Platform::non_power_of_two_support() const
+	{
+		return NPOT_FULL;
+	}
+
 	void Platform::AddShader(Shader* shader)
 	{
 		shaders_.push_back(shader);
@@ -26,6 +26,14 @@ namespace gef
 	class ShaderInterface;
 	class DepthBuffer;
 
+	// how much a platform's textures can be sized other than in powers of two
+	enum NonPowerOfTwoSupport
+	{
+		NPOT_NONE = 0,
+		NPOT_NO_MIPS,	// only textures without mips can be any size
+		NPOT_FULL
+	};
+
 	class Platform
 	{
 	public:
@@ -90,6 +98,9 @@ namespace gef
 		// e.g. android devices (phones, tablets, etc.)
 		virtual bool ReadyToRender() const;
 
+		// textures are resized up to powers of two when the platform can't use them at their own size
+		virtual NonPowerOfTwoSupport non_power_of_two_support() const;
+
 
 		inline Int32 width() const { return width_; }
 		inline Int32 height() const { return height_; }
@@ -27,6 +27,11 @@ namespace gef
 			return false;
 	}
 
+	bool StringIdTable::Remove(const StringId string_id)
+	{
+		return table_.erase(string_id) > 0;
+	}
+
 	StringId GetStringId(const std::string& text)
 	{
 		return CRC::GetICRC(text.c_str());
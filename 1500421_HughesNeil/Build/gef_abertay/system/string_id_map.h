@@ -0,0 +1,203 @@
+#ifndef _GEF_STRING_ID_MAP_H
+#define _GEF_STRING_ID_MAP_H
+
+#include <gef.h>
+#include <system/string_id.h>
+#include <vector>
+#include <utility>
+
+namespace gef
+{
+	// open addressing hash map keyed by StringId
+	// entries are stored contiguously with linear probing
+	// iteration order is not sorted
+	// inserting or erasing entries invalidates iterators and pointers to values
+	template <class T>
+	class StringIdMap
+	{
+	public:
+		typedef std::pair<StringId, T> value_type;
+
+		class iterator
+		{
+		public:
+			iterator() : map_(NULL), index_(0) {}
+			iterator(StringIdMap* map, UInt32 index) : map_(map), index_(index) { SkipEmpty(); }
+
+			inline value_type& operator*() const { return map_->slots_[index_]; }
+			inline value_type* operator->() const { return &map_->slots_[index_]; }
+			inline iterator& operator++() { ++index_; SkipEmpty(); return *this; }
+			inline iterator operator++(int) { iterator result = *this; ++(*this); return result; }
+			inline bool operator==(const iterator& rhs) const { return index_ == rhs.index_; }
+			inline bool operator!=(const iterator& rhs) const { return index_ != rhs.index_; }
+		private:
+			inline void SkipEmpty() { while((index_ < map_->capacity()) && !map_->occupied_[index_]) ++index_; }
+
+			friend class StringIdMap;
+			StringIdMap* map_;
+			UInt32 index_;
+		};
+
+		class const_iterator
+		{
+		public:
+			const_iterator() : map_(NULL), index_(0) {}
+			const_iterator(const StringIdMap* map, UInt32 index) : map_(map), index_(index) { SkipEmpty(); }
+			const_iterator(const iterator& iter) : map_(iter.map_), index_(iter.index_) {}
+
+			inline const value_type& operator*() const { return map_->slots_[index_]; }
+			inline const value_type* operator->() const { return &map_->slots_[index_]; }
+			inline const_iterator& operator++() { ++index_; SkipEmpty(); return *this; }
+			inline const_iterator operator++(int) { const_iterator result = *this; ++(*this); return result; }
+			inline bool operator==(const const_iterator& rhs) const { return index_ == rhs.index_; }
+			inline bool operator!=(const const_iterator& rhs) const { return index_ != rhs.index_; }
+		private:
+			inline void SkipEmpty() { while((index_ < map_->capacity()) && !map_->occupied_[index_]) ++index_; }
+
+			const StringIdMap* map_;
+			UInt32 index_;
+		};
+
+		StringIdMap() : size_(0) {}
+
+		inline iterator begin() { return iterator(this, 0); }
+		inline iterator end() { return iterator(this, capacity()); }
+		inline const_iterator begin() const { return const_iterator(this, 0); }
+		inline const_iterator end() const { return const_iterator(this, capacity()); }
+
+		inline UInt32 size() const { return size_; }
+		inline bool empty() const { return size_ == 0; }
+
+		iterator find(const StringId key)
+		{
+			UInt32 index;
+			return FindSlot(key, index) ? iterator(this, index) : end();
+		}
+
+		const_iterator find(const StringId key) const
+		{
+			UInt32 index;
+			return FindSlot(key, index) ? const_iterator(this, index) : end();
+		}
+
+		T& operator[](const StringId key)
+		{
+			UInt32 index;
+			if(FindSlot(key, index))
+				return slots_[index].second;
+
+			// grow when more than 3/4 full
+			if((size_+1)*4 > capacity()*3)
+			{
+				Rehash(capacity() == 0 ? 16 : capacity()*2);
+				FindSlot(key, index);
+			}
+
+			slots_[index] = value_type(key, T());
+			occupied_[index] = 1;
+			++size_;
+			return slots_[index].second;
+		}
+
+		UInt32 erase(const StringId key)
+		{
+			UInt32 index;
+			if(!FindSlot(key, index))
+				return 0;
+
+			// backward shift deletion keeps probe sequences intact without tombstones
+			const UInt32 mask = capacity()-1;
+			UInt32 hole = index;
+			UInt32 next = (hole+1) & mask;
+			while(occupied_[next])
+			{
+				const UInt32 home = Hash(slots_[next].first) & mask;
+				if(((next - home) & mask) >= ((next - hole) & mask))
+				{
+					slots_[hole] = slots_[next];
+					hole = next;
+				}
+				next = (next+1) & mask;
+			}
+
+			slots_[hole] = value_type();
+			occupied_[hole] = 0;
+			--size_;
+			return 1;
+		}
+
+		void clear()
+		{
+			slots_.clear();
+			occupied_.clear();
+			size_ = 0;
+		}
+
+		void reserve(const UInt32 count)
+		{
+			UInt32 new_capacity = 16;
+			while(new_capacity*3 < count*4)
+				new_capacity *= 2;
+			if(new_capacity > capacity())
+				Rehash(new_capacity);
+		}
+
+	private:
+		inline UInt32 capacity() const { return (UInt32)occupied_.size(); }
+
+		static inline UInt32 Hash(const StringId key)
+		{
+			// string ids are CRCs already, just mix the bits so the low bits are well distributed
+			UInt32 hash = key;
+			hash ^= hash >> 16;
+			hash *= 0x45d9f3b;
+			hash ^= hash >> 16;
+			return hash;
+		}
+
+		// returns true if the key is found
+		// otherwise index is the empty slot where the key would be inserted
+		bool FindSlot(const StringId key, UInt32& index) const
+		{
+			if(capacity() == 0)
+			{
+				index = 0;
+				return false;
+			}
+
+			const UInt32 mask = capacity()-1;
+			index = Hash(key) & mask;
+			while(occupied_[index])
+			{
+				if(slots_[index].first == key)
+					return true;
+				index = (index+1) & mask;
+			}
+			return false;
+		}
+
+		void Rehash(const UInt32 new_capacity)
+		{
+			std::vector<value_type> old_slots;
+			std::vector<UInt8> old_occupied;
+			old_slots.swap(slots_);
+			old_occupied.swap(occupied_);
+
+			slots_.resize(new_capacity);
+			occupied_.resize(new_capacity, 0);
+			size_ = 0;
+
+			for(UInt32 slot_num = 0; slot_num < old_occupied.size(); ++slot_num)
+			{
+				if(old_occupied[slot_num])
+					(*this)[old_slots[slot_num].first] = old_slots[slot_num].second;
+			}
+		}
+
+		std::vector<value_type> slots_;
+		std::vector<UInt8> occupied_;
+		UInt32 size_;
+	};
+}
+
+#endif // _GEF_STRING_ID_MAP_H
@@ -0,0 +1,215 @@
+#include <system/thread_pool.h>
+
+#ifndef GEF_NO_THREADS
+#include <atomic>
+#endif
+
+namespace gef
+{
+#ifndef GEF_NO_THREADS
+	ThreadPool::ThreadPool(Int32 num_threads) :
+		jobs_pending_(0),
+		quit_(false)
+	{
+		if(num_threads <= 0)
+		{
+			num_threads = (Int32)std::thread::hardware_concurrency() - 1;
+			if(num_threads < 1)
+				num_threads = 1;
+		}
+
+		threads_.reserve(num_threads);
+		for(Int32 thread_num = 0; thread_num < num_threads; ++thread_num)
+			threads_.push_back(std::thread(&ThreadPool::WorkerThread, this));
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			quit_ = true;
+		}
+		job_added_.notify_all();
+
+		for(std::vector<std::thread>::iterator thread_iter = threads_.begin(); thread_iter != threads_.end(); ++thread_iter)
+			thread_iter->join();
+	}
+
+	void ThreadPool::WorkerThread()
+	{
+		for(;;)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				while(!quit_ && jobs_.empty())
+					job_added_.wait(lock);
+
+				// finish any outstanding jobs before quitting
+				if(jobs_.empty())
+					return;
+
+				job = jobs_.front();
+				jobs_.pop_front();
+			}
+
+			job.function(job.user_data, job.job_index);
+
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				--jobs_pending_;
+				if(jobs_pending_ == 0)
+					jobs_finished_.notify_all();
+			}
+		}
+	}
+
+	void ThreadPool::AddJob(JobFunction function, void* user_data, const Int32 job_index)
+	{
+		Job job;
+		job.function = function;
+		job.user_data = user_data;
+		job.job_index = job_index;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			jobs_.push_back(job);
+			++jobs_pending_;
+		}
+		job_added_.notify_one();
+	}
+
+	void ThreadPool::WaitForJobs()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		while(jobs_pending_ > 0)
+		{
+			// help out rather than sitting idle
+			if(!jobs_.empty())
+			{
+				Job job = jobs_.front();
+				jobs_.pop_front();
+				lock.unlock();
+
+				job.function(job.user_data, job.job_index);
+
+				lock.lock();
+				--jobs_pending_;
+				if(jobs_pending_ == 0)
+					jobs_finished_.notify_all();
+			}
+			else
+				jobs_finished_.wait(lock);
+		}
+	}
+
+	struct ParallelForBatch
+	{
+		ThreadPool::JobFunction function;
+		void* user_data;
+		Int32 job_count;
+		std::atomic<Int32> next_job_index;
+		Int32 helpers_running;
+		std::mutex mutex;
+		std::condition_variable helpers_finished;
+	};
+
+	static void RunParallelForJobs(ParallelForBatch& batch)
+	{
+		for(Int32 job_index = batch.next_job_index++; job_index < batch.job_count; job_index = batch.next_job_index++)
+			batch.function(batch.user_data, job_index);
+	}
+
+	void ThreadPool::ParallelForHelper(void* user_data, Int32)
+	{
+		ParallelForBatch& batch = *static_cast<ParallelForBatch*>(user_data);
+		RunParallelForJobs(batch);
+
+		std::unique_lock<std::mutex> lock(batch.mutex);
+		--batch.helpers_running;
+		if(batch.helpers_running == 0)
+			batch.helpers_finished.notify_all();
+	}
+
+	void ThreadPool::ParallelFor(const Int32 job_count, JobFunction function, void* user_data)
+	{
+		if(job_count <= 1 || threads_.empty())
+		{
+			for(Int32 job_index = 0; job_index < job_count; ++job_index)
+				function(user_data, job_index);
+			return;
+		}
+
+		ParallelForBatch batch;
+		batch.function = function;
+		batch.user_data = user_data;
+		batch.job_count = job_count;
+		batch.next_job_index = 0;
+
+		// helpers go to the front of the queue so they aren't stuck behind background jobs
+		Int32 num_helpers = job_count-1 < (Int32)threads_.size() ? job_count-1 : (Int32)threads_.size();
+		batch.helpers_running = num_helpers;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			for(Int32 helper_num = 0; helper_num < num_helpers; ++helper_num)
+			{
+				Job job;
+				job.function = &ThreadPool::ParallelForHelper;
+				job.user_data = &batch;
+				job.job_index = helper_num;
+				jobs_.push_front(job);
+			}
+			jobs_pending_ += num_helpers;
+		}
+		job_added_.notify_all();
+
+		RunParallelForJobs(batch);
+
+		// all jobs have been started, remove any helpers that haven't
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			for(std::deque<Job>::iterator job_iter = jobs_.begin(); job_iter != jobs_.end();)
+			{
+				if(job_iter->user_data == &batch)
+				{
+					job_iter = jobs_.erase(job_iter);
+					--jobs_pending_;
+					std::unique_lock<std::mutex> batch_lock(batch.mutex);
+					--batch.helpers_running;
+				}
+				else
+					++job_iter;
+			}
+			if(jobs_pending_ == 0)
+				jobs_finished_.notify_all();
+		}
+
+		std::unique_lock<std::mutex> lock(batch.mutex);
+		while(batch.helpers_running > 0)
+			batch.helpers_finished.wait(lock);
+	}
+#else
+	ThreadPool::ThreadPool(Int32)
+	{
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+	}
+
+	void ThreadPool::AddJob(JobFunction function, void* user_data, const Int32 job_index)
+	{
+		function(user_data, job_index);
+	}
+
+	void ThreadPool::WaitForJobs()
+	{
+	}
+
+	void ThreadPool::ParallelFor(const Int32 job_count, JobFunction function, void* user_data)
+	{
+		for(Int32 job_index = 0; job_index < job_count; ++job_index)
+			function(user_data, job_index);
+	}
+#endif
+}
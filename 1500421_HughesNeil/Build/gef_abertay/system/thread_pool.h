@@ -0,0 +1,67 @@
+#ifndef _GEF_THREAD_POOL_H
+#define _GEF_THREAD_POOL_H
+
+#include <gef.h>
+#include <vector>
+#include <deque>
+
+// platforms without std::thread run every job on the calling thread
+#if defined(__psp2__)
+#define GEF_NO_THREADS
+#endif
+
+#ifndef GEF_NO_THREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace gef
+{
+	class ThreadPool
+	{
+	public:
+		typedef void (*JobFunction)(void* user_data, Int32 job_index);
+
+		// num_threads of 0 uses one worker for each hardware thread other than the calling thread
+		ThreadPool(Int32 num_threads = 0);
+		~ThreadPool();
+
+		// runs function(user_data, 0) ... function(user_data, job_count-1) across the workers
+		// the calling thread also runs jobs and the call returns when they have all finished
+		void ParallelFor(const Int32 job_count, JobFunction function, void* user_data);
+
+		// queues a job to run in the background
+		void AddJob(JobFunction function, void* user_data, const Int32 job_index = 0);
+
+		// blocks until all jobs added with AddJob have finished
+		void WaitForJobs();
+
+		inline Int32 num_threads() const { return (Int32)threads_.size(); }
+
+	private:
+		struct Job
+		{
+			JobFunction function;
+			void* user_data;
+			Int32 job_index;
+		};
+
+#ifndef GEF_NO_THREADS
+		void WorkerThread();
+		static void ParallelForHelper(void* user_data, Int32 job_index);
+
+		std::vector<std::thread> threads_;
+		std::deque<Job> jobs_;
+		std::mutex mutex_;
+		std::condition_variable job_added_;
+		std::condition_variable jobs_finished_;
+		Int32 jobs_pending_;
+		bool quit_;
+#else
+		std::vector<Int32> threads_;
+#endif
+	};
+}
+
+#endif // _GEF_THREAD_POOL_H
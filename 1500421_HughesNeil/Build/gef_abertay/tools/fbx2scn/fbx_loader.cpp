@@ -582,8 +582,8 @@ void AddMesh(FbxNode& node, Scene& scene, Platform& platform)
 	// material name -> triangles that use that material
 	std::map<std::string, std::vector<MeshTriangle>> materials_primitives_;
 
-	scene.meshes.push_back(MeshData());
-	gef::MeshData& mesh = scene.meshes.back();
+	scene.meshes.push_back(new MeshData());
+	gef::MeshData& mesh = *scene.meshes.back();
 	gef::VertexData& vertex_buffer_data = mesh.vertex_data;
 
 
@@ -1123,8 +1123,7 @@ const char* GetMeshMaterial(FbxMesh* const fbx_mesh, const Int32 poly_index, gef
 			material_name = lMaterial->GetName();
 			gef::StringId material_name_id = gef::GetStringId(material_name);
 
-			std::map<gef::StringId, MaterialData*>::iterator material_iter = scene.material_data_map.find(material_name_id);
-			if (material_iter == scene.material_data_map.end())
+			if (scene.FindMaterialData(material_name_id) == NULL)
 			{
 				scene.string_id_table.Add(material_name);
 
@@ -1193,7 +1192,7 @@ const char* GetMeshMaterial(FbxMesh* const fbx_mesh, const Int32 poly_index, gef
 				}
 
 				scene.material_data.push_back(material_data);
-				scene.material_data_map[material_name_id] = &scene.material_data.back();
+				scene.material_data_map[material_name_id] = (Int32)scene.material_data.size()-1;
 			}
 		}
 	}
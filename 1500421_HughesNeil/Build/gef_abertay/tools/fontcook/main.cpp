@@ -0,0 +1,102 @@
+#include <assets/font_file.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+
+#ifndef _WIN32
+#include <strings.h>
+#define stricmp strcasecmp
+#endif
+
+static void PrintUsage()
+{
+	std::cout << "usage: fontcook [options] input.fnt" << std::endl << std::endl;
+	std::cout << "  -o <file>     output file, defaults to the input file with a .fnb extension" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* output_filename = NULL;
+	const char* input_filename = NULL;
+
+	for(int arg_num=1; arg_num < argc; ++arg_num)
+	{
+		if(argv[arg_num][0] == '-' && (strlen(argv[arg_num]) > 1))
+		{
+			const char* option = &argv[arg_num][1];
+			if(stricmp(option, "o") == 0)
+			{
+				if(arg_num < argc - 1)
+					output_filename = argv[++arg_num];
+			}
+			else
+			{
+				std::cout << "ERROR: unknown option: " << argv[arg_num] << std::endl;
+				PrintUsage();
+				return -1;
+			}
+		}
+		else
+			input_filename = argv[arg_num];
+	}
+
+	std::cout << std::endl << "Abertay Framework Font Cooker v0.01" << std::endl << std::endl;
+
+	if(input_filename == NULL)
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	std::string default_output_filename;
+	if(output_filename == NULL)
+	{
+		default_output_filename = input_filename;
+		const size_t extension_pos = default_output_filename.find_last_of('.');
+		if((extension_pos != std::string::npos) && (default_output_filename.find_first_of("/\\", extension_pos) == std::string::npos))
+			default_output_filename.erase(extension_pos);
+		default_output_filename += gef::kCompiledFontExtension;
+		output_filename = default_output_filename.c_str();
+	}
+
+	std::cout << "input file: " << input_filename << std::endl;
+	std::cout << "output file: " << output_filename << std::endl;
+	std::cout << std::endl;
+
+	std::ifstream input_file(input_filename, std::ios::in | std::ios::binary);
+	if(!input_file.is_open())
+	{
+		std::cout << "ERROR: failed to load input file: " << input_filename << std::endl;
+		return -1;
+	}
+	std::ostringstream input_stream;
+	input_stream << input_file.rdbuf();
+	const std::string input_data = input_stream.str();
+
+	std::vector<UInt8> font_data;
+	if(!gef::CompileFont(input_data.data(), (Int32)input_data.size(), font_data))
+	{
+		std::cout << "ERROR: no common line in input file, is it a text .fnt file?" << std::endl;
+		return -1;
+	}
+
+	const gef::FontFileHeader* header = reinterpret_cast<const gef::FontFileHeader*>(&font_data[0]);
+	std::cout << "  glyphs:        " << header->num_glyphs << std::endl;
+	std::cout << "  kerning pairs: " << header->num_kerning_pairs << std::endl;
+	std::cout << "  data bytes:    " << font_data.size() << std::endl;
+	std::cout << std::endl;
+
+	std::cout << "Writing output file: " << output_filename << std::endl;
+	std::ofstream output_file(output_filename, std::ios::out | std::ios::binary);
+	if(!output_file.is_open() || !output_file.write(reinterpret_cast<const char*>(&font_data[0]), font_data.size()))
+	{
+		std::cout << "ERROR: failed to write output file: " << output_filename << std::endl;
+		return -1;
+	}
+
+	std::cout << "Success." << std::endl;
+	return 0;
+}
@@ -0,0 +1,330 @@
+#include <graphics/scene.h>
+#include <graphics/mesh_data.h>
+#include <graphics/mesh_optimiser.h>
+#include <graphics/mesh_simplifier.h>
+#include <animation/skeleton.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <strings.h>
+#define stricmp strcasecmp
+#endif
+
+struct SceneStats
+{
+	size_t file_size;
+	Int32 mesh_count;
+	Int32 primitive_count;
+	Int32 vertex_count;
+	Int32 vertex_data_size;
+	Int32 index_count;
+	Int32 index_data_size;
+	Int32 material_count;
+	Int32 skeleton_count;
+	Int32 string_count;
+	Int32 lod_count;
+	Int32 lod_index_count;
+	Int32 cluster_count;
+	float vertex_cache_miss_ratio;
+};
+
+static void GetSceneStats(const gef::Scene& scene, const size_t file_size, SceneStats& stats)
+{
+	memset(&stats, 0, sizeof(stats));
+	stats.file_size = file_size;
+	stats.mesh_count = (Int32)scene.meshes.size();
+	stats.material_count = (Int32)scene.material_data.size();
+	stats.skeleton_count = (Int32)scene.skeletons.size();
+	stats.string_count = (Int32)scene.string_id_table.table().size();
+
+	for(std::vector<gef::MeshData*>::const_iterator mesh_iter = scene.meshes.begin(); mesh_iter != scene.meshes.end(); ++mesh_iter)
+	{
+		stats.primitive_count += (Int32)(*mesh_iter)->primitives.size();
+		stats.vertex_count += (*mesh_iter)->vertex_data.num_vertices;
+		stats.vertex_data_size += (*mesh_iter)->vertex_data.num_vertices*(*mesh_iter)->vertex_data.vertex_byte_size;
+		stats.index_count += (*mesh_iter)->GetIndexCount();
+		stats.index_data_size += (*mesh_iter)->GetIndexDataSize();
+		stats.lod_count += (Int32)(*mesh_iter)->lods.size();
+
+		for(std::vector<gef::PrimitiveData*>::const_iterator prim_iter = (*mesh_iter)->primitives.begin(); prim_iter != (*mesh_iter)->primitives.end(); ++prim_iter)
+			stats.cluster_count += (Int32)(*prim_iter)->clusters.size();
+
+		for(std::vector<gef::MeshLodData>::const_iterator lod_iter = (*mesh_iter)->lods.begin(); lod_iter != (*mesh_iter)->lods.end(); ++lod_iter)
+		{
+			for(std::vector<gef::PrimitiveData>::const_iterator prim_iter = lod_iter->primitives.begin(); prim_iter != lod_iter->primitives.end(); ++prim_iter)
+				stats.lod_index_count += prim_iter->num_indices;
+		}
+
+		// weighted by index count so large meshes count for more
+		stats.vertex_cache_miss_ratio += gef::CalculateVertexCacheMissRatio(**mesh_iter) * (float)(*mesh_iter)->GetIndexCount();
+	}
+
+	if(stats.index_count > 0)
+		stats.vertex_cache_miss_ratio /= (float)stats.index_count;
+}
+
+static void PrintStat(const char* label, const size_t before, const size_t after)
+{
+	std::cout << "  " << label << before << " -> " << after;
+	if(before > 0)
+		std::cout << " (" << (Int32)((after*100)/before) << "%)";
+	std::cout << std::endl;
+}
+
+static void PrintStats(const SceneStats& before, const SceneStats& after)
+{
+	PrintStat("file size:        ", before.file_size, after.file_size);
+	PrintStat("meshes:           ", before.mesh_count, after.mesh_count);
+	PrintStat("primitives:       ", before.primitive_count, after.primitive_count);
+	PrintStat("vertices:         ", before.vertex_count, after.vertex_count);
+	PrintStat("vertex bytes:     ", before.vertex_data_size, after.vertex_data_size);
+	PrintStat("indices:          ", before.index_count, after.index_count);
+	PrintStat("index bytes:      ", before.index_data_size, after.index_data_size);
+	PrintStat("materials:        ", before.material_count, after.material_count);
+	PrintStat("skeletons:        ", before.skeleton_count, after.skeleton_count);
+	PrintStat("strings:          ", before.string_count, after.string_count);
+	PrintStat("lods:             ", before.lod_count, after.lod_count);
+	PrintStat("lod indices:      ", before.lod_index_count, after.lod_index_count);
+	PrintStat("clusters:         ", before.cluster_count, after.cluster_count);
+	std::cout << "  cache miss ratio: " << before.vertex_cache_miss_ratio << " -> " << after.vertex_cache_miss_ratio << std::endl;
+}
+
+// splits meshes with too many vertices for 16 bit indices
+// the first part keeps the mesh name, the others are named <mesh name>_<part number>
+static Int32 SplitLargeMeshes(gef::Scene& scene)
+{
+	Int32 meshes_split = 0;
+	std::vector<gef::MeshData*> meshes;
+	for(std::vector<gef::MeshData*>::iterator mesh_iter = scene.meshes.begin(); mesh_iter != scene.meshes.end(); ++mesh_iter)
+	{
+		if((*mesh_iter)->vertex_data.num_vertices <= 0x10000)
+		{
+			meshes.push_back(*mesh_iter);
+			continue;
+		}
+
+		const size_t first_part = meshes.size();
+		(*mesh_iter)->SplitForShortIndices(meshes);
+
+		std::string mesh_name;
+		if(!scene.string_id_table.Find((*mesh_iter)->name_id, mesh_name))
+		{
+			std::ostringstream name_stream;
+			name_stream << std::hex << (*mesh_iter)->name_id;
+			mesh_name = name_stream.str();
+		}
+		for(size_t part_num = first_part+1; part_num < meshes.size(); ++part_num)
+		{
+			std::ostringstream name_stream;
+			name_stream << mesh_name << "_" << (part_num - first_part);
+			meshes[part_num]->name_id = scene.string_id_table.Add(name_stream.str());
+		}
+
+		delete *mesh_iter;
+		++meshes_split;
+	}
+	scene.meshes.swap(meshes);
+
+	return meshes_split;
+}
+
+static void PrintUsage()
+{
+	std::cout << "usage: scnopt [options] input.scn" << std::endl << std::endl;
+	std::cout << "  -o <file>     output file, defaults to overwriting the input file" << std::endl;
+	std::cout << "  -check        don't write anything, return an error if the file isn't optimised" << std::endl;
+	std::cout << "  -no-dedupe    don't remove duplicate vertices" << std::endl;
+	std::cout << "  -no-strip     don't remove unused materials, skeletons and strings" << std::endl;
+	std::cout << "  -no-weights   don't normalise skin weights" << std::endl;
+	std::cout << "  -no-index     don't shrink index sizes or split meshes with more than 65536 vertices" << std::endl;
+	std::cout << "  -no-sort      don't sort and merge primitives by material" << std::endl;
+	std::cout << "  -no-reorder   don't reorder triangles and vertices for the vertex cache and overdraw" << std::endl;
+	std::cout << "  -pack         convert vertices to the packed 16 and 24 byte formats" << std::endl;
+	std::cout << "  -lods <n>     generate up to n lods for each mesh, each with half the triangles of the one before" << std::endl;
+	std::cout << "  -clusters <n> split triangles into culling clusters of up to n triangles" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* output_filename = NULL;
+	const char* input_filename = NULL;
+	bool check_only = false;
+	bool dedupe_vertices = true;
+	bool strip_unused = true;
+	bool normalise_weights = true;
+	bool compact_indices = true;
+	bool sort_primitives = true;
+	bool reorder_triangles = true;
+	bool pack_vertices = false;
+	Int32 num_lods = 0;
+	Int32 max_cluster_triangles = 0;
+
+	for(int arg_num=1; arg_num < argc; ++arg_num)
+	{
+		if(argv[arg_num][0] == '-' && (strlen(argv[arg_num]) > 1))
+		{
+			const char* option = &argv[arg_num][1];
+			if(stricmp(option, "o") == 0)
+			{
+				if(arg_num < argc - 1)
+					output_filename = argv[++arg_num];
+			}
+			else if(stricmp(option, "check") == 0)
+				check_only = true;
+			else if(stricmp(option, "no-dedupe") == 0)
+				dedupe_vertices = false;
+			else if(stricmp(option, "no-strip") == 0)
+				strip_unused = false;
+			else if(stricmp(option, "no-weights") == 0)
+				normalise_weights = false;
+			else if(stricmp(option, "no-index") == 0)
+				compact_indices = false;
+			else if(stricmp(option, "no-sort") == 0)
+				sort_primitives = false;
+			else if(stricmp(option, "no-reorder") == 0)
+				reorder_triangles = false;
+			else if(stricmp(option, "pack") == 0)
+				pack_vertices = true;
+			else if(stricmp(option, "lods") == 0)
+			{
+				if(arg_num < argc - 1)
+					num_lods = atoi(argv[++arg_num]);
+			}
+			else if(stricmp(option, "clusters") == 0)
+			{
+				if(arg_num < argc - 1)
+					max_cluster_triangles = atoi(argv[++arg_num]);
+			}
+			else
+			{
+				std::cout << "ERROR: unknown option: " << argv[arg_num] << std::endl;
+				PrintUsage();
+				return -1;
+			}
+		}
+		else
+			input_filename = argv[arg_num];
+	}
+
+	std::cout << std::endl << "Abertay Framework Scene Optimiser v0.01" << std::endl << std::endl;
+
+	if(input_filename == NULL)
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	if(output_filename == NULL)
+		output_filename = input_filename;
+
+	std::cout << "input file: " << input_filename << std::endl;
+	if(!check_only)
+		std::cout << "output file: " << output_filename << std::endl;
+	std::cout << std::endl;
+
+	gef::Scene scene;
+	size_t input_file_size = 0;
+	{
+		std::ifstream input_file(input_filename, std::ios::in | std::ios::binary);
+		if(!input_file.is_open() || !scene.ReadScene(input_file))
+		{
+			std::cout << "ERROR: failed to load input file: " << input_filename << std::endl;
+			return -1;
+		}
+
+		input_file.clear();
+		input_file.seekg(0, std::ios::end);
+		input_file_size = (size_t)input_file.tellg();
+	}
+
+	SceneStats before;
+	GetSceneStats(scene, input_file_size, before);
+
+	Int32 vertices_removed = 0;
+	if(dedupe_vertices)
+	{
+		for(std::vector<gef::MeshData*>::iterator mesh_iter = scene.meshes.begin(); mesh_iter != scene.meshes.end(); ++mesh_iter)
+			vertices_removed += (*mesh_iter)->RemoveDuplicateVertices();
+	}
+
+	// split after removing duplicates so meshes are only split when they have to be
+	Int32 meshes_split = 0;
+	if(compact_indices)
+		meshes_split = SplitLargeMeshes(scene);
+
+	for(std::vector<gef::MeshData*>::iterator mesh_iter = scene.meshes.begin(); mesh_iter != scene.meshes.end(); ++mesh_iter)
+	{
+		if(sort_primitives)
+			(*mesh_iter)->SortPrimitivesByMaterial();
+		if(num_lods > 0)
+			gef::GenerateMeshLods(**mesh_iter, num_lods);
+		// reordering throws away any clusters the mesh already has
+		if(reorder_triangles && ((max_cluster_triangles > 0) || !(*mesh_iter)->HasClusters()))
+			gef::OptimiseMesh(**mesh_iter);
+
+		// clusters replace the triangle order so the vertices are reordered again afterwards
+		if(max_cluster_triangles > 0)
+		{
+			gef::BuildMeshClusters(**mesh_iter, max_cluster_triangles);
+			gef::OptimiseVertexFetch(**mesh_iter);
+		}
+		if(compact_indices)
+			(*mesh_iter)->CompactIndices();
+	}
+
+	if(normalise_weights)
+		scene.NormaliseSkinWeights();
+
+	// weights are normalised before packing so they are quantised correctly
+	if(pack_vertices)
+	{
+		for(std::vector<gef::MeshData*>::iterator mesh_iter = scene.meshes.begin(); mesh_iter != scene.meshes.end(); ++mesh_iter)
+			(*mesh_iter)->PackVertices();
+	}
+
+	if(strip_unused)
+		scene.RemoveUnusedData();
+
+	std::ostringstream output_stream(std::ios::out | std::ios::binary);
+	if(!scene.WriteScene(output_stream))
+	{
+		std::cout << "ERROR: failed to build output scene" << std::endl;
+		return -1;
+	}
+	const std::string output_data = output_stream.str();
+
+	SceneStats after;
+	GetSceneStats(scene, output_data.size(), after);
+
+	std::cout << "duplicate vertices removed: " << vertices_removed << std::endl;
+	std::cout << "meshes split for 16 bit indices: " << meshes_split << std::endl;
+	PrintStats(before, after);
+	std::cout << std::endl;
+
+	if(check_only)
+	{
+		if(after.file_size < before.file_size)
+		{
+			std::cout << "ERROR: " << input_filename << " is not optimised, run scnopt on it" << std::endl;
+			return -1;
+		}
+
+		std::cout << "Success." << std::endl;
+		return 0;
+	}
+
+	std::cout << "Writing output file: " << output_filename << std::endl;
+	std::ofstream output_file(output_filename, std::ios::out | std::ios::binary);
+	if(!output_file.is_open() || !output_file.write(output_data.data(), output_data.size()))
+	{
+		std::cout << "ERROR: failed to write output file: " << output_filename << std::endl;
+		return -1;
+	}
+
+	std::cout << "Success." << std::endl;
+	return 0;
+}
@@ -0,0 +1,214 @@
+#include <assets/png_loader.h>
+#include <assets/cooked_texture_loader.h>
+#include <graphics/image_data.h>
+#include <graphics/mip_generator.h>
+#include <graphics/texture_compressor.h>
+#include <system/thread_pool.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <strings.h>
+#define stricmp strcasecmp
+#endif
+
+static void PrintUsage()
+{
+	std::cout << "usage: texcook [options] input.png" << std::endl << std::endl;
+	std::cout << "  -o <file>     output file, defaults to the input file with a .tex extension" << std::endl;
+	std::cout << "  -no-mips      only store the top mip level" << std::endl;
+	std::cout << "  -filter <f>   mip filter: box, kaiser or lanczos, defaults to box" << std::endl;
+	std::cout << "  -srgb         filter colours in linear space" << std::endl;
+	std::cout << "  -premultiply  weight colours by alpha when filtering mips so transparent pixels don't bleed" << std::endl;
+	std::cout << "  -alpha-coverage <ref>" << std::endl;
+	std::cout << "                keep the fraction of pixels with alpha above ref the same in every mip" << std::endl;
+	std::cout << "  -compress <f> block compress to bc1, bc3 or auto, auto picks bc1 for opaque images" << std::endl;
+	std::cout << "  -quality <q>  compression quality: fast, normal or high, defaults to normal" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* output_filename = NULL;
+	const char* input_filename = NULL;
+	bool generate_mips = true;
+	gef::MipGeneratorOptions mip_options;
+	bool compress = false;
+	gef::ImageFormat compressed_format = gef::IF_NUM_FORMATS;
+	gef::CompressionQuality compression_quality = gef::CQ_NORMAL;
+
+	for(int arg_num=1; arg_num < argc; ++arg_num)
+	{
+		if(argv[arg_num][0] == '-' && (strlen(argv[arg_num]) > 1))
+		{
+			const char* option = &argv[arg_num][1];
+			if(stricmp(option, "o") == 0)
+			{
+				if(arg_num < argc - 1)
+					output_filename = argv[++arg_num];
+			}
+			else if(stricmp(option, "no-mips") == 0)
+				generate_mips = false;
+			else if(stricmp(option, "filter") == 0)
+			{
+				if(arg_num < argc - 1)
+				{
+					const char* filter = argv[++arg_num];
+					if(stricmp(filter, "box") == 0)
+						mip_options.filter = gef::RF_BOX;
+					else if(stricmp(filter, "kaiser") == 0)
+						mip_options.filter = gef::RF_KAISER;
+					else if(stricmp(filter, "lanczos") == 0)
+						mip_options.filter = gef::RF_LANCZOS3;
+					else
+					{
+						std::cout << "ERROR: unknown filter: " << filter << std::endl;
+						PrintUsage();
+						return -1;
+					}
+				}
+			}
+			else if(stricmp(option, "srgb") == 0)
+				mip_options.srgb = true;
+			else if(stricmp(option, "premultiply") == 0)
+				mip_options.premultiply_alpha = true;
+			else if(stricmp(option, "alpha-coverage") == 0)
+			{
+				if(arg_num < argc - 1)
+				{
+					mip_options.preserve_alpha_coverage = true;
+					mip_options.alpha_reference = (float)atof(argv[++arg_num]);
+				}
+			}
+			else if(stricmp(option, "compress") == 0)
+			{
+				if(arg_num < argc - 1)
+				{
+					const char* format = argv[++arg_num];
+					compress = true;
+					if(stricmp(format, "bc1") == 0)
+						compressed_format = gef::IF_BC1;
+					else if(stricmp(format, "bc3") == 0)
+						compressed_format = gef::IF_BC3;
+					else if(stricmp(format, "auto") != 0)
+					{
+						std::cout << "ERROR: unknown compressed format: " << format << std::endl;
+						PrintUsage();
+						return -1;
+					}
+				}
+			}
+			else if(stricmp(option, "quality") == 0)
+			{
+				if(arg_num < argc - 1)
+				{
+					const char* quality = argv[++arg_num];
+					if(stricmp(quality, "fast") == 0)
+						compression_quality = gef::CQ_FAST;
+					else if(stricmp(quality, "normal") == 0)
+						compression_quality = gef::CQ_NORMAL;
+					else if(stricmp(quality, "high") == 0)
+						compression_quality = gef::CQ_HIGH;
+					else
+					{
+						std::cout << "ERROR: unknown quality: " << quality << std::endl;
+						PrintUsage();
+						return -1;
+					}
+				}
+			}
+			else
+			{
+				std::cout << "ERROR: unknown option: " << argv[arg_num] << std::endl;
+				PrintUsage();
+				return -1;
+			}
+		}
+		else
+			input_filename = argv[arg_num];
+	}
+
+	std::cout << std::endl << "Abertay Framework Texture Cooker v0.01" << std::endl << std::endl;
+
+	if(input_filename == NULL)
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	std::string default_output_filename;
+	if(output_filename == NULL)
+	{
+		default_output_filename = input_filename;
+		const size_t extension_pos = default_output_filename.find_last_of('.');
+		if((extension_pos != std::string::npos) && (default_output_filename.find_first_of("/\\", extension_pos) == std::string::npos))
+			default_output_filename.erase(extension_pos);
+		default_output_filename += ".tex";
+		output_filename = default_output_filename.c_str();
+	}
+
+	std::cout << "input file: " << input_filename << std::endl;
+	std::cout << "output file: " << output_filename << std::endl;
+	std::cout << std::endl;
+
+	gef::ImageData image_data;
+	gef::PNGLoader png_loader;
+	if(!png_loader.Load(input_filename, image_data))
+	{
+		std::cout << "ERROR: failed to load input file: " << input_filename << std::endl;
+		return -1;
+	}
+
+	if(generate_mips && !gef::GenerateMips(image_data, mip_options))
+	{
+		std::cout << "ERROR: failed to generate mips" << std::endl;
+		return -1;
+	}
+
+	if(compress)
+	{
+		// D3D11 needs the top level of block compressed textures to be a multiple of 4 in both directions
+		if(((image_data.width() % 4) != 0) || ((image_data.height() % 4) != 0))
+			std::cout << "WARNING: size isn't a multiple of 4, not compressing" << std::endl;
+		else
+		{
+			if(compressed_format == gef::IF_NUM_FORMATS)
+				compressed_format = gef::ChooseCompressedFormat(image_data);
+
+			gef::ThreadPool thread_pool;
+			if(!gef::CompressImage(image_data, image_data, compressed_format, compression_quality, &thread_pool))
+			{
+				std::cout << "ERROR: failed to compress texture" << std::endl;
+				return -1;
+			}
+		}
+	}
+
+	std::ostringstream output_stream(std::ios::out | std::ios::binary);
+	if(!gef::WriteCookedTexture(output_stream, image_data))
+	{
+		std::cout << "ERROR: failed to build output texture" << std::endl;
+		return -1;
+	}
+	const std::string output_data = output_stream.str();
+
+	std::cout << "  size:       " << image_data.width() << "x" << image_data.height() << std::endl;
+	std::cout << "  mips:       " << image_data.num_mips() << std::endl;
+	std::cout << "  format:     " << (image_data.format() == gef::IF_BC1 ? "BC1" : (image_data.format() == gef::IF_BC3 ? "BC3" : "RGBA8")) << std::endl;
+	std::cout << "  data bytes: " << image_data.GetDataSize() << std::endl;
+	std::cout << std::endl;
+
+	std::cout << "Writing output file: " << output_filename << std::endl;
+	std::ofstream output_file(output_filename, std::ios::out | std::ios::binary);
+	if(!output_file.is_open() || !output_file.write(output_data.data(), output_data.size()))
+	{
+		std::cout << "ERROR: failed to write output file: " << output_filename << std::endl;
+		return -1;
+	}
+
+	std::cout << "Success." << std::endl;
+	return 0;
+}